@@ -49,15 +49,23 @@ struct SearchEngineData
     using QueryHeap = BinaryHeap<NodeID, NodeID, int, HeapData, UnorderedMapStorage<NodeID, int>>;
 #ifdef MT_STRUCTURES
     using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
-#else
-    using SearchEngineHeapPtr = boost::scoped_ptr<QueryHeap>;
-#endif
     static SearchEngineHeapPtr forward_heap_1;
     static SearchEngineHeapPtr reverse_heap_1;
     static SearchEngineHeapPtr forward_heap_2;
     static SearchEngineHeapPtr reverse_heap_2;
     static SearchEngineHeapPtr forward_heap_3;
     static SearchEngineHeapPtr reverse_heap_3;
+#else
+    // MAPS.ME: heaps are owned by the instance, so searches with different
+    // SearchEngineData instances may run on different threads simultaneously.
+    using SearchEngineHeapPtr = boost::scoped_ptr<QueryHeap>;
+    SearchEngineHeapPtr forward_heap_1;
+    SearchEngineHeapPtr reverse_heap_1;
+    SearchEngineHeapPtr forward_heap_2;
+    SearchEngineHeapPtr reverse_heap_2;
+    SearchEngineHeapPtr forward_heap_3;
+    SearchEngineHeapPtr reverse_heap_3;
+#endif
 
     void InitializeOrClearFirstThreadLocalStorage(const unsigned number_of_nodes);
 
@@ -31,6 +31,7 @@ SOURCES += \
     reader_streambuf.cpp \
     reader_writer_ops.cpp \
     sha2.cpp \
+    shared_reader_cache.cpp \
     uri.cpp \
 #    varint_vector.cpp \
     zip_creator.cpp \
@@ -56,6 +57,7 @@ HEADERS += \
     dd_vector.hpp \
     diff.hpp \
     diff_patch_common.hpp \
+    elias_fano_coder.hpp \
     endianness.hpp \
     file_container.hpp \
     file_name_utils.hpp \
@@ -68,6 +70,7 @@ HEADERS += \
     huffman.hpp \
     internal/file64_api.hpp \
     internal/file_data.hpp \
+    mapped_trie_reader.hpp \
     matrix_traversal.hpp \
     mmap_reader.hpp \
     multilang_utf8_string.hpp \
@@ -81,6 +84,7 @@ HEADERS += \
     reader_wrapper.hpp \
     reader_writer_ops.hpp \
     sha2.hpp \
+    shared_reader_cache.hpp \
     streams.hpp \
     streams_common.hpp \
     streams_sink.hpp \
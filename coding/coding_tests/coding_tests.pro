@@ -21,6 +21,7 @@ SOURCES += ../../testing/testingmain.cpp \
 #    compressed_varnum_vector_test.cpp \
     dd_vector_test.cpp \
     diff_test.cpp \
+    elias_fano_coder_test.cpp \
     endianness_test.cpp \
     file_container_test.cpp \
     file_data_test.cpp \
@@ -36,6 +37,7 @@ SOURCES += ../../testing/testingmain.cpp \
     reader_test.cpp \
     reader_writer_ops_test.cpp \
     sha2_test.cpp \
+    shared_reader_cache_test.cpp \
     succinct_trie_test.cpp \
     trie_test.cpp \
     uri_test.cpp \
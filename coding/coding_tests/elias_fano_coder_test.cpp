@@ -0,0 +1,68 @@
+#include "testing/testing.hpp"
+
+#include "coding/byte_stream.hpp"
+#include "coding/elias_fano_coder.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/random.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+void TestEliasFano(vector<uint32_t> const & values)
+{
+  vector<uint8_t> buffer;
+  PushBackByteSink<vector<uint8_t>> sink(buffer);
+  coding::EncodeEliasFano(sink, values);
+  // The byte after the list must not be read.
+  buffer.push_back(0xFF);
+
+  ArrayByteSource src(buffer.data());
+  vector<uint32_t> decoded;
+  coding::DecodeEliasFano(src, decoded);
+  TEST_EQUAL(values, decoded, ());
+  TEST_EQUAL(src.PtrUC(), buffer.data() + buffer.size() - 1, ());
+}
+}  // namespace
+
+UNIT_TEST(EliasFanoCoder_Smoke)
+{
+  TestEliasFano({});
+  TestEliasFano({0});
+  TestEliasFano({0, 0, 0});
+  TestEliasFano({7});
+  TestEliasFano({1, 2, 3, 4, 5});
+  TestEliasFano({3, 3, 17, 129, 1000, 1000, 1001});
+  TestEliasFano({0, 0xFFFFFFFF});
+  TestEliasFano({0xFFFFFFFF});
+}
+
+UNIT_TEST(EliasFanoCoder_Random)
+{
+  mt19937 rng(0);
+  for (uint32_t maxValue : {10U, 1000U, 100000U, 0xFFFFFFFFU})
+  {
+    for (size_t count : {1, 2, 10, 100, 1000})
+    {
+      uniform_int_distribution<uint32_t> distribution(0, maxValue);
+      vector<uint32_t> values(count);
+      for (auto & value : values)
+        value = distribution(rng);
+      sort(values.begin(), values.end());
+      TestEliasFano(values);
+    }
+  }
+}
+
+UNIT_TEST(EliasFanoCoder_Size)
+{
+  // Dense feature ids take less than four bits per value.
+  vector<uint32_t> values;
+  for (uint32_t i = 0; i < 10000; ++i)
+    values.push_back(i * 3);
+
+  vector<uint8_t> buffer;
+  PushBackByteSink<vector<uint8_t>> sink(buffer);
+  coding::EncodeEliasFano(sink, values);
+  TEST_LESS(buffer.size(), values.size() * 4 / CHAR_BIT + 16, ());
+}
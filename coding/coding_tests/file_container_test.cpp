@@ -3,6 +3,8 @@
 #include "coding/file_container.hpp"
 #include "coding/varint.hpp"
 
+#include "defines.hpp"
+
 #include "base/logging.hpp"
 #include "base/string_utils.hpp"
 #include "base/scope_guard.hpp"
@@ -369,3 +371,37 @@ UNIT_TEST(FilesMappingContainer_PageSize)
 
   FileWriter::DeleteFileX(fName);
 }
+
+UNIT_TEST(FilesContainer_MapFile)
+{
+  string const fName = "file_container.tmp";
+  MY_SCOPE_GUARD(deleteTestFile, bind(&FileWriter::DeleteFileX, cref(fName)));
+
+  char const * key[] = { DATA_FILE_TAG, GEOMETRY_FILE_TAG "0", INDEX_FILE_TAG, "other" };
+  size_t const count[] = { 100, 10000, 5000, 1 };
+  size_t const sz = ARRAY_SIZE(key);
+
+  {
+    FilesContainerW writer(fName);
+    for (size_t i = 0; i < sz; ++i)
+    {
+      FileWriter w = writer.GetWriter(key[i]);
+      for (size_t j = 0; j < count[i]; ++j)
+        WriteToSink(w, static_cast<uint32_t>(i * 100000 + j));
+    }
+  }
+
+  FilesContainerR reader(fName, FilesContainerR::MapFile());
+  TEST(reader.IsMapped(), ());
+  TEST(!FilesContainerR(fName).IsMapped(), ());
+
+  for (size_t i = 0; i < sz; ++i)
+  {
+    FilesContainerR::ReaderT r = reader.GetReader(key[i]);
+    TEST_EQUAL(r.Size(), count[i] * sizeof(uint32_t), ());
+
+    ReaderSource<FilesContainerR::ReaderT> src(r);
+    for (size_t j = 0; j < count[i]; ++j)
+      TEST_EQUAL(ReadPrimitiveFromSource<uint32_t>(src), i * 100000 + j, ());
+  }
+}
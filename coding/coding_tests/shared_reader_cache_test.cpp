@@ -0,0 +1,144 @@
+#include "testing/testing.hpp"
+
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+#include "coding/reader.hpp"
+#include "coding/shared_reader_cache.hpp"
+
+#include "base/scope_guard.hpp"
+
+#include "std/bind.hpp"
+#include "std/random.hpp"
+#include "std/string.hpp"
+#include "std/thread.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+uint32_t const kLogPageSize = 10;
+uint64_t const kMemoryLimit = 64 * 1024;
+
+vector<char> MakeData(size_t size)
+{
+  vector<char> data(size);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i % 253);
+  return data;
+}
+
+void ReadRandomly(SharedReaderCache & cache, uint64_t fileId, MemReader const & reader,
+                  uint32_t seed, size_t count)
+{
+  mt19937 rng(seed);
+  for (size_t i = 0; i < count; ++i)
+  {
+    size_t const pos = rng() % reader.Size();
+    size_t const len = min(static_cast<size_t>(1 + (rng() % 3000)), reader.Size() - pos);
+    string readMem(len, '0'), readCache(len, '0');
+    reader.Read(pos, &readMem[0], len);
+    cache.Read(fileId, kLogPageSize, reader, pos, &readCache[0], len);
+    TEST_EQUAL(readMem, readCache, (pos, len, i));
+  }
+}
+}  // namespace
+
+UNIT_TEST(SharedReaderCache_Smoke)
+{
+  SharedReaderCache & cache = SharedReaderCache::Instance();
+  cache.SetMemoryLimit(kMemoryLimit);
+  MY_SCOPE_GUARD(disableCache, bind(&SharedReaderCache::SetMemoryLimit, ref(cache), 0));
+
+  vector<char> const data1 = MakeData(300000);
+  vector<char> const data2(data1.rbegin(), data1.rend());
+  MemReader const reader1(data1.data(), data1.size());
+  MemReader const reader2(data2.data(), data2.size());
+  uint64_t const fileId1 = cache.RegisterFile("data1", data1.size(), 0, kLogPageSize);
+  uint64_t const fileId2 = cache.RegisterFile("data2", data2.size(), 0, kLogPageSize);
+  MY_SCOPE_GUARD(unregisterFile1, bind(&SharedReaderCache::UnregisterFile, ref(cache), fileId1));
+  MY_SCOPE_GUARD(unregisterFile2, bind(&SharedReaderCache::UnregisterFile, ref(cache), fileId2));
+  TEST_NOT_EQUAL(fileId1, fileId2, ());
+
+  {
+    char c;
+    cache.Read(fileId1, kLogPageSize, reader1, 5, &c, 1);
+    cache.Read(fileId1, kLogPageSize, reader1, 7, &c, 1);
+    ReaderCacheStats const stats = cache.GetStats();
+    TEST_EQUAL(stats.m_misses, 1, ());
+    TEST_EQUAL(stats.m_hits, 1, ());
+    TEST_EQUAL(stats.m_bytesRead, 1 << kLogPageSize, ());
+  }
+
+  // Pages of the files are in the same cache and are evicted when the limit is reached.
+  vector<thread> threads;
+  for (uint32_t i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(&ReadRandomly, ref(cache), i % 2 == 0 ? fileId1 : fileId2,
+                         cref(i % 2 == 0 ? reader1 : reader2), i, 2000);
+  }
+  for (auto & t : threads)
+    t.join();
+
+  ReaderCacheStats const stats = cache.GetStats();
+  LOG(LINFO, (stats));
+  TEST_GREATER(stats.m_hits, 0, ());
+  TEST_GREATER(stats.m_misses, 0, ());
+  TEST_LESS_OR_EQUAL(stats.m_bytesCached, kMemoryLimit, ());
+  TEST_GREATER(stats.m_bytesCached, 0, ());
+}
+
+UNIT_TEST(SharedReaderCache_FileReader)
+{
+  string const fName = "shared_reader_cache.tmp";
+  MY_SCOPE_GUARD(deleteTestFile, bind(&FileWriter::DeleteFileX, cref(fName)));
+
+  vector<char> const data = MakeData(100000);
+  {
+    FileWriter writer(fName);
+    writer.Write(data.data(), data.size());
+  }
+
+  SharedReaderCache & cache = SharedReaderCache::Instance();
+  cache.SetMemoryLimit(kMemoryLimit);
+  MY_SCOPE_GUARD(disableCache, bind(&SharedReaderCache::SetMemoryLimit, ref(cache), 0));
+
+  vector<char> buffer(data.size());
+  {
+    FileReader const reader1(fName);
+    FileReader const reader2("./" + fName);
+    reader1.Read(0, buffer.data(), buffer.size());
+    TEST(buffer == data, ());
+    // Pages which are read last are not evicted yet.
+    reader1.Read(1000, buffer.data(), 1000);
+
+    ReaderCacheStats const stats = cache.GetStats();
+    TEST_GREATER(stats.m_misses, 0, ());
+    TEST_GREATER(stats.m_bytesCached, 0, ());
+
+    // Readers of the same file share pages.
+    FileReader const subReader = reader2.SubReader(1000, 1000);
+    subReader.Read(0, buffer.data(), 1000);
+    TEST(equal(buffer.begin(), buffer.begin() + 1000, data.begin() + 1000), ());
+    TEST_EQUAL(cache.GetStats().m_misses, stats.m_misses, ());
+    TEST_GREATER(cache.GetStats().m_hits, stats.m_hits, ());
+
+    // Pages of the file are kept while it has readers.
+    {
+      FileReader const reader3(fName);
+    }
+    TEST_EQUAL(cache.GetStats().m_bytesCached, stats.m_bytesCached, ());
+  }
+
+  // Pages of the file are dropped with its last reader.
+  TEST_EQUAL(cache.GetStats().m_bytesCached, 0, ());
+
+  // Pages of a changed file are not taken from the cache.
+  vector<char> const changedData(data.rbegin(), data.rend());
+  {
+    FileWriter writer(fName);
+    writer.Write(changedData.data(), changedData.size() / 2);
+  }
+  FileReader const reader(fName);
+  TEST_EQUAL(reader.Size(), changedData.size() / 2, ());
+  reader.Read(0, buffer.data(), reader.Size());
+  TEST(equal(changedData.begin(), changedData.begin() + reader.Size(), buffer.begin()), ());
+}
@@ -2,6 +2,7 @@
 #include "coding/trie.hpp"
 #include "coding/trie_builder.hpp"
 #include "coding/trie_reader.hpp"
+#include "coding/mapped_trie_reader.hpp"
 #include "coding/byte_stream.hpp"
 #include "coding/write_to_sink.hpp"
 
@@ -268,5 +269,28 @@ UNIT_TEST(TrieBuilder_Build)
     for (uint32_t i = 0; i < root->m_edge.size(); ++i)
       maxEdgeValue = max(maxEdgeValue, static_cast<uint32_t>(root->m_edge[i].m_value.m_data[0]));
     TEST_EQUAL(maxEdgeValue, expectedMaxEdgeValue, (v, f.m_v));
+
+    trie::FixedSizeValueReader<4> const valueReader;
+    trie::FixedSizeValueReader<1> const edgeValueReader;
+    trie::MappedIterator<trie::FixedSizeValueReader<4>, trie::FixedSizeValueReader<1>> const
+        mappedRoot(serial.data(), serial.data() + serial.size(), false /* isLeaf */,
+                   trie::DEFAULT_CHAR, valueReader, edgeValueReader);
+    KeyValuePairBackInserter mappedF;
+    trie::ForEachRef(mappedRoot, mappedF, vector<trie::TrieChar>());
+    sort(mappedF.m_v.begin(), mappedF.m_v.end());
+    TEST_EQUAL(v, mappedF.m_v, ());
+
+    TEST_EQUAL(mappedRoot.GetEdgesCount(), root->m_edge.size(), ());
+    decltype(mappedRoot)::EdgeIterator it(mappedRoot);
+    for (size_t i = 0; i < root->m_edge.size(); ++i, it.Next())
+    {
+      TEST(!it.IsEnd(), ());
+      auto const & edge = root->m_edge[i];
+      TEST(equal(edge.m_str.begin(), edge.m_str.end(), it.GetString().begin()), ());
+      TEST_EQUAL(edge.m_str.size(), it.GetString().size(), ());
+      TEST_EQUAL(edge.m_value.m_data[0], it.GetValue().m_data[0], ());
+      TEST_EQUAL(root->GoToEdge(i)->m_value.size(), it.GetChild().GetValuesCount(), ());
+    }
+    TEST(it.IsEnd(), ());
   }
 }
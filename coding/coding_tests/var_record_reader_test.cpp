@@ -69,5 +69,14 @@ UNIT_TEST(VarRecordReader_Simple)
     expectedForEachCalls.push_back(pair<uint64_t, string>(4, longString));
     expectedForEachCalls.push_back(pair<uint64_t, string>(6 + longStringSize, "defg"));
     TEST_EQUAL(forEachCalls, expectedForEachCalls, ());
+
+    TEST_EQUAL(4, recordReader.SkipRecord(0), ());
+    TEST_EQUAL(6 + longStringSize, recordReader.SkipRecord(4), ());
+    TEST_EQUAL(11 + longStringSize, recordReader.SkipRecord(6 + longStringSize), ());
+
+    vector<pair<uint64_t, string> > rangeCalls;
+    recordReader.ForEachRecord(4, 11 + longStringSize, SaveForEachParams(rangeCalls));
+    expectedForEachCalls.erase(expectedForEachCalls.begin());
+    TEST_EQUAL(rangeCalls, expectedForEachCalls, ());
   }
 }
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "coding/bit_streams.hpp"
+#include "coding/reader.hpp"
+#include "coding/varint.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "base/assert.hpp"
+#include "base/macros.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/vector.hpp"
+
+// Elias-Fano coding of a non-decreasing sequence of n integers with the last one u takes
+// about n * (2 + log(u / n)) bits. Every value is split into l = floor(log(u / n)) low bits,
+// which are written as is, and high bits, which are written in unary as gaps between
+// the high bits of the consecutive values.
+//
+// Format:
+//   -- [vu: n].
+//   -- [vu: u] [1 byte: l] if n is not zero.
+//   -- Low bits of the values, n * l bits.
+//   -- High bits of the values, n ones and (u >> l) zeros.
+//   -- Zero bits up to the byte boundary.
+
+namespace coding
+{
+namespace impl
+{
+template <typename TWriter>
+void WriteBits(BitWriter<TWriter> & bitWriter, uint32_t bits, uint32_t n)
+{
+  for (; n >= CHAR_BIT; n -= CHAR_BIT, bits >>= CHAR_BIT)
+    bitWriter.Write(static_cast<uint8_t>(bits & 0xFF), CHAR_BIT);
+  bitWriter.Write(static_cast<uint8_t>(bits & ((1U << n) - 1)), n);
+}
+
+template <typename TSource>
+uint32_t ReadBits(BitReader<TSource> & bitReader, uint32_t n)
+{
+  uint32_t bits = 0;
+  uint32_t shift = 0;
+  for (; n >= CHAR_BIT; n -= CHAR_BIT, shift += CHAR_BIT)
+    bits |= static_cast<uint32_t>(bitReader.Read(CHAR_BIT)) << shift;
+  return bits | (static_cast<uint32_t>(bitReader.Read(n)) << shift);
+}
+
+inline uint8_t GetEliasFanoLowBits(uint32_t count, uint32_t last)
+{
+  uint8_t lowBits = 0;
+  for (uint32_t ratio = last / count; ratio > 1; ratio >>= 1)
+    ++lowBits;
+  return lowBits;
+}
+}  // namespace impl
+
+template <typename TWriter>
+void EncodeEliasFano(TWriter & writer, vector<uint32_t> const & values)
+{
+  uint32_t const count = static_cast<uint32_t>(values.size());
+  WriteVarUint(writer, count);
+  if (count == 0)
+    return;
+
+  uint32_t const last = values.back();
+  uint8_t const lowBits = impl::GetEliasFanoLowBits(count, last);
+  WriteVarUint(writer, last);
+  WriteToSink(writer, lowBits);
+
+  BitWriter<TWriter> bitWriter(writer);
+  for (uint32_t value : values)
+    impl::WriteBits(bitWriter, value, lowBits);
+
+  uint32_t prevHigh = 0;
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    ASSERT(i == 0 || values[i - 1] <= values[i], (values[i - 1], values[i]));
+    uint32_t const high = values[i] >> lowBits;
+    uint32_t gap = high - prevHigh;
+    for (; gap >= CHAR_BIT; gap -= CHAR_BIT)
+      bitWriter.Write(0, CHAR_BIT);
+    bitWriter.Write(0, gap);
+    bitWriter.Write(1, 1);
+    prevHigh = high;
+  }
+}
+
+template <typename TSource>
+void DecodeEliasFano(TSource & src, vector<uint32_t> & values)
+{
+  values.clear();
+  uint32_t const count = ReadVarUint<uint32_t>(src);
+  if (count == 0)
+    return;
+
+  uint32_t const last = ReadVarUint<uint32_t>(src);
+  uint8_t const lowBits = ReadPrimitiveFromSource<uint8_t>(src);
+  ASSERT_EQUAL(lowBits, impl::GetEliasFanoLowBits(count, last), ());
+  UNUSED_VALUE(last);
+
+  values.resize(count);
+  BitReader<TSource> bitReader(src);
+  for (uint32_t & value : values)
+    value = impl::ReadBits(bitReader, lowBits);
+
+  uint32_t high = 0;
+  for (uint32_t & value : values)
+  {
+    while (bitReader.Read(1) == 0)
+      ++high;
+    value |= high << lowBits;
+  }
+  ASSERT_EQUAL(values.back(), last, ());
+}
+}  // namespace coding
@@ -4,6 +4,13 @@
 #include "coding/read_write_utils.hpp"
 #include "coding/write_to_sink.hpp"
 #include "coding/internal/file_data.hpp"
+#include "coding/mmap_reader.hpp"
+
+#include "base/string_utils.hpp"
+
+#include "std/unique_ptr.hpp"
+
+#include "defines.hpp"
 
 #ifndef OMIM_OS_WINDOWS
   #include <unistd.h>
@@ -64,17 +71,54 @@ void FilesContainerBase::ReadInfo(ReaderT & reader)
 FilesContainerR::FilesContainerR(string const & filePath,
                                  uint32_t logPageSize,
                                  uint32_t logPageCount)
-  : m_source(new FileReader(filePath, logPageSize, logPageCount))
+  : m_source(new FileReader(filePath, logPageSize, logPageCount)), m_mapped(false)
 {
   ReadInfo(m_source);
 }
 
 FilesContainerR::FilesContainerR(ReaderT const & file)
-  : m_source(file)
+  : m_source(file), m_mapped(false)
 {
   ReadInfo(m_source);
 }
 
+FilesContainerR::FilesContainerR(string const & filePath, MapFile)
+  : m_source(new MmapReader(filePath)), m_mapped(true)
+{
+  ReadInfo(m_source);
+  AdviseSections();
+}
+
+void FilesContainerR::AdviseSections() const
+{
+  MmapReader const & file = static_cast<MmapReader const &>(*m_source.GetPtr());
+
+  // Sections are advised in the file's order, so a page at the boundary of
+  // two sections gets the advice of the latter one.
+  InfoContainer info(m_info);
+  sort(info.begin(), info.end(), LessOffset());
+  for (Info const & i : info)
+  {
+    MmapReader::Advice advice = MmapReader::Advice::Normal;
+    // Geometry and triangles are decoded point by point for each feature in a rect.
+    if (strings::StartsWith(i.m_tag, GEOMETRY_FILE_TAG) ||
+        strings::StartsWith(i.m_tag, TRIANGLE_FILE_TAG))
+    {
+      advice = MmapReader::Advice::Sequential;
+    }
+    // Only a few pages of index sections are touched by each lookup.
+    else if (i.m_tag == INDEX_FILE_TAG || i.m_tag == SEARCH_INDEX_FILE_TAG ||
+             i.m_tag == COMPRESSED_SEARCH_INDEX_FILE_TAG ||
+             i.m_tag == SUCCINCT_SEARCH_INDEX_FILE_TAG || i.m_tag == METADATA_INDEX_FILE_TAG)
+    {
+      advice = MmapReader::Advice::Random;
+    }
+
+    if (advice != MmapReader::Advice::Normal)
+      unique_ptr<MmapReader>(file.CreateSubReader(i.m_offset, i.m_size))->Advise(advice);
+  }
+}
+
 FilesContainerR::ReaderT FilesContainerR::GetReader(Tag const & tag) const
 {
   Info const * p = GetInfo(tag);
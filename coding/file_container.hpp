@@ -112,8 +112,16 @@ public:
                            uint32_t logPageCount = 10);
   explicit FilesContainerR(ReaderT const & file);
 
+  struct MapFile {};
+  /// Maps the whole file read-only. Readers of sections are views over the shared mapping
+  /// (see MmapReader) without their own page caches. Geometry sections are advised
+  /// for sequential access and index sections for random access.
+  FilesContainerR(string const & filePath, MapFile);
+
   ReaderT GetReader(Tag const & tag) const;
 
+  inline bool IsMapped() const { return m_mapped; }
+
   template <typename F> void ForEachTag(F f) const
   {
     for (size_t i = 0; i < m_info.size(); ++i)
@@ -124,7 +132,10 @@ public:
   inline string const & GetFileName() const { return m_source.GetName(); }
 
 private:
+  void AdviseSections() const;
+
   ReaderT m_source;
+  bool m_mapped;
 };
 
 class FilesMappingContainer : public FilesContainerBase
@@ -1,7 +1,12 @@
 #include "coding/file_reader.hpp"
 #include "coding/reader_cache.hpp"
+#include "coding/shared_reader_cache.hpp"
 #include "coding/internal/file_data.hpp"
 
+#include "base/logging.hpp"
+
+#include "std/unique_ptr.hpp"
+
 #ifndef LOG_FILE_READER_STATS
 #define LOG_FILE_READER_STATS 0
 #endif // LOG_FILE_READER_STATS
@@ -31,8 +36,24 @@ class FileReader::FileReaderData
 {
 public:
   FileReaderData(string const & fileName, uint32_t logPageSize, uint32_t logPageCount)
-    : m_FileData(fileName), m_ReaderCache(logPageSize, logPageCount)
+    : m_FileData(fileName), m_LogPageSize(logPageSize), m_FileId(0)
   {
+    SharedReaderCache & sharedCache = SharedReaderCache::Instance();
+    if (sharedCache.IsEnabled())
+    {
+      // Readers of the same file share pages, the file is the same while its path,
+      // size and modification time are the same.
+      string path = fileName;
+      uint64_t modificationTime = 0;
+      if (!my::GetFileIdentity(fileName, path, modificationTime))
+        LOG(LWARNING, ("Can't get identity of the file", fileName));
+      m_FileId = sharedCache.RegisterFile(path, m_FileData.Size(), modificationTime, logPageSize);
+    }
+    else
+    {
+      m_ReaderCache.reset(new TReaderCache(logPageSize, logPageCount));
+    }
+
 #if LOG_FILE_READER_STATS
     m_ReadCallCount = 0;
 #endif
@@ -41,8 +62,11 @@ public:
   ~FileReaderData()
   {
 #if LOG_FILE_READER_STATS
-    LOG(LINFO, ("FileReader", GetName(), m_ReaderCache.GetStatsStr()));
+    if (m_ReaderCache)
+      LOG(LINFO, ("FileReader", GetName(), m_ReaderCache->GetStatsStr()));
 #endif
+    if (!m_ReaderCache)
+      SharedReaderCache::Instance().UnregisterFile(m_FileId);
   }
 
   uint64_t Size() const { return m_FileData.Size(); }
@@ -52,16 +76,29 @@ public:
 #if LOG_FILE_READER_STATS
     if (((++m_ReadCallCount) & LOG_FILE_READER_EVERY_N_READS_MASK) == 0)
     {
-      LOG(LINFO, ("FileReader", GetName(), m_ReaderCache.GetStatsStr()));
+      if (m_ReaderCache)
+        LOG(LINFO, ("FileReader", GetName(), m_ReaderCache->GetStatsStr()));
+      else
+        LOG(LINFO, ("FileReader", GetName(), SharedReaderCache::Instance().GetStats()));
     }
 #endif
 
-    return m_ReaderCache.Read(m_FileData, pos, p, size);
+    if (!m_ReaderCache)
+    {
+      SharedReaderCache::Instance().Read(m_FileId, m_LogPageSize, m_FileData, pos, p, size);
+      return;
+    }
+    m_ReaderCache->Read(m_FileData, pos, p, size);
   }
 
 private:
+  typedef ReaderCache<FileDataWithCachedSize, LOG_FILE_READER_STATS> TReaderCache;
+
   FileDataWithCachedSize m_FileData;
-  ReaderCache<FileDataWithCachedSize, LOG_FILE_READER_STATS> m_ReaderCache;
+  uint32_t const m_LogPageSize;
+  // Pages are read through the shared cache with m_FileId if the own cache is absent.
+  unique_ptr<TReaderCache> m_ReaderCache;
+  uint64_t m_FileId;
 
 #if LOG_FILE_READER_STATS
   uint32_t m_ReadCallCount;
@@ -6,6 +6,8 @@
 // FileReader, cheap to copy, not thread safe.
 // It is assumed that file is not modified during FireReader lifetime,
 // because of caching and assumption that Size() is constant.
+// Pages are cached by the reader itself or by SharedReaderCache if it is enabled
+// when the reader is created.
 class FileReader : public ModelReader
 {
   typedef ModelReader base_type;
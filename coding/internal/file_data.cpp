@@ -8,6 +8,7 @@
 #include "base/logging.hpp"
 
 #include "std/cerrno.hpp"
+#include "std/cstdlib.hpp"
 #include "std/cstring.hpp"
 #include "std/exception.hpp"
 #include "std/fstream.hpp"
@@ -15,6 +16,9 @@
 
 #ifdef OMIM_OS_WINDOWS
   #include <io.h>
+  #include <sys/stat.h>
+#elif !defined(OMIM_OS_TIZEN)
+  #include <sys/stat.h>
 #endif
 
 #ifdef OMIM_OS_TIZEN
@@ -220,6 +224,39 @@ bool GetFileSize(string const & fName, uint64_t & sz)
   }
 }
 
+bool GetFileIdentity(string const & fName, string & canonicalPath, uint64_t & modificationTime)
+{
+#ifdef OMIM_OS_WINDOWS
+  char path[_MAX_PATH];
+  if (!_fullpath(path, fName.c_str(), _MAX_PATH))
+    return false;
+  struct _stat64 st;
+  if (_stat64(path, &st) != 0)
+    return false;
+  canonicalPath = path;
+  modificationTime = static_cast<uint64_t>(st.st_mtime);
+  return true;
+#elif defined OMIM_OS_TIZEN
+  uint64_t sz;
+  if (!GetFileSize(fName, sz))
+    return false;
+  canonicalPath = fName;
+  modificationTime = 0;
+  return true;
+#else
+  char * path = realpath(fName.c_str(), nullptr);
+  if (!path)
+    return false;
+  canonicalPath = path;
+  free(path);
+  struct stat st;
+  if (stat(canonicalPath.c_str(), &st) != 0)
+    return false;
+  modificationTime = static_cast<uint64_t>(st.st_mtime);
+  return true;
+#endif
+}
+
 namespace
 {
 bool CheckFileOperationResult(int res, string const & fName)
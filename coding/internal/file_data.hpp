@@ -56,6 +56,10 @@ private:
 };
 
 bool GetFileSize(string const & fName, uint64_t & sz);
+/// Gets the canonical path and the modification time of the file, which identify
+/// the file together with its size.
+/// @return false if the file can't be found.
+bool GetFileIdentity(string const & fName, string & canonicalPath, uint64_t & modificationTime);
 bool DeleteFileX(string const & fName);
 bool RenameFileX(string const & fOld, string const & fNew);
 /// @return false if copy fails. DO NOT THROWS exceptions
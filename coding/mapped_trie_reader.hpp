@@ -0,0 +1,250 @@
+#pragma once
+
+#include "coding/byte_stream.hpp"
+#include "coding/file_container.hpp"
+#include "coding/trie.hpp"
+#include "coding/varint.hpp"
+
+#include "base/assert.hpp"
+#include "base/bits.hpp"
+#include "base/buffer_vector.hpp"
+
+#include "std/cstdint.hpp"
+
+namespace trie
+{
+// Iterator over a trie serialized by trie::Build which lies in memory, e.g. in a section
+// mapped by FilesMappingContainer::Map. Unlike Iterator0 it is a small value which points
+// into the data: values and edges are decoded on demand, children are created on the stack.
+// Readers are not owned and must outlive the iterator. Besides operator() they must have
+// Skip(ArrayByteSource &) which moves the source past a value without decoding it.
+template <class ValueReaderT, class EdgeValueReaderT>
+class MappedIterator
+{
+public:
+  using ValueType = typename ValueReaderT::ValueType;
+  using EdgeValueType = typename EdgeValueReaderT::ValueType;
+  using EdgeStrT = buffer_vector<TrieChar, 32>;
+
+  // Decodes edges of the node one by one, the edge string buffer is reused.
+  class EdgeIterator
+  {
+  public:
+    explicit EdgeIterator(MappedIterator const & node)
+      : m_node(node), m_src(node.m_edgesBegin), m_index(0), m_baseChar(node.m_baseChar),
+        m_childOffset(0), m_nextChildOffset(0), m_isLeaf(false)
+    {
+      if (!IsEnd())
+        ParseEdge();
+    }
+
+    bool IsEnd() const { return m_index >= m_node.m_edgesCount; }
+
+    void Next()
+    {
+      ASSERT(!IsEnd(), ());
+      ++m_index;
+      m_childOffset = m_nextChildOffset;
+      if (!IsEnd())
+        ParseEdge();
+    }
+
+    uint32_t GetIndex() const { return m_index; }
+    EdgeStrT const & GetString() const { return m_str; }
+    EdgeValueType const & GetValue() const { return m_value; }
+
+    MappedIterator GetChild() const
+    {
+      ASSERT(!IsEnd(), ());
+      uint8_t const * begin = m_node.m_childrenBegin + m_childOffset;
+      return MappedIterator(begin, m_node.m_childrenBegin + m_nextChildOffset, m_isLeaf,
+                            m_str.back(), *m_node.m_valueReader, *m_node.m_edgeValueReader);
+    }
+
+  private:
+    void ParseEdge()
+    {
+      // The same format as Iterator0::ParseNode reads.
+      uint8_t const header = ReadPrimitiveFromSource<uint8_t>(m_src);
+      m_isLeaf = ((header & 128) != 0);
+      m_str.clear();
+      if (header & 64)
+      {
+        m_str.push_back(m_baseChar + bits::ZigZagDecode(header & 63U));
+      }
+      else
+      {
+        uint32_t edgeLen = (header & 63);
+        if (edgeLen == 63)
+          edgeLen = ReadVarUint<uint32_t>(m_src);
+        edgeLen += 1;
+
+        TrieChar c = m_baseChar;
+        for (uint32_t i = 0; i < edgeLen; ++i)
+          m_str.push_back(c += ReadVarInt<int32_t>(m_src));
+      }
+
+      (*m_node.m_edgeValueReader)(m_src, m_value);
+
+      if (m_index + 1 != m_node.m_edgesCount)
+        m_nextChildOffset = m_childOffset + ReadVarUint<uint32_t>(m_src);
+      else
+        m_nextChildOffset = static_cast<uint32_t>(m_node.m_end - m_node.m_childrenBegin);
+
+      m_baseChar = m_str[0];
+    }
+
+    MappedIterator const & m_node;
+    ArrayByteSource m_src;
+    uint32_t m_index;
+    TrieChar m_baseChar;
+    uint32_t m_childOffset;
+    uint32_t m_nextChildOffset;
+    bool m_isLeaf;
+    EdgeStrT m_str;
+    EdgeValueType m_value;
+  };
+
+  MappedIterator(uint8_t const * begin, uint8_t const * end, bool isLeaf, TrieChar baseChar,
+                 ValueReaderT const & valueReader, EdgeValueReaderT const & edgeValueReader)
+    : m_end(end), m_valuesBegin(begin), m_edgesBegin(end), m_childrenBegin(end),
+      m_valuesCount(0), m_edgesCount(0), m_baseChar(baseChar), m_valueReader(&valueReader),
+      m_edgeValueReader(&edgeValueReader)
+  {
+    if (isLeaf)
+      ParseLeaf();
+    else
+      ParseNode();
+  }
+
+  uint32_t GetValuesCount() const { return m_valuesCount; }
+  uint32_t GetEdgesCount() const { return m_edgesCount; }
+
+  template <class TFn>
+  void ForEachValue(TFn && fn) const
+  {
+    ArrayByteSource src(m_valuesBegin);
+    ValueType value;
+    for (uint32_t i = 0; i < m_valuesCount; ++i)
+    {
+      (*m_valueReader)(src, value);
+      fn(value);
+    }
+  }
+
+  MappedIterator GoToEdge(uint32_t i) const
+  {
+    ASSERT_LESS(i, m_edgesCount, ());
+    EdgeIterator it(*this);
+    while (it.GetIndex() != i)
+      it.Next();
+    return it.GetChild();
+  }
+
+private:
+  void ParseLeaf()
+  {
+    ArrayByteSource src(m_valuesBegin);
+    while (src.PtrUC() < m_end)
+    {
+      m_valueReader->Skip(src);
+      ++m_valuesCount;
+    }
+    ASSERT_EQUAL(src.PtrUC(), m_end, ());
+  }
+
+  void ParseNode()
+  {
+    ArrayByteSource src(m_valuesBegin);
+
+    // [1: header]: [2: min(valueCount, 3)] [6: min(childCount, 63)]
+    uint8_t const header = ReadPrimitiveFromSource<uint8_t>(src);
+    m_valuesCount = (header >> 6);
+    m_edgesCount = (header & 63);
+    if (m_valuesCount == 3)
+      m_valuesCount = ReadVarUint<uint32_t>(src);
+    if (m_edgesCount == 63)
+      m_edgesCount = ReadVarUint<uint32_t>(src);
+    m_valuesBegin = src.PtrUC();
+
+    // Values and edges have variable sizes, so they are skipped to find the children.
+    // Values are decoded only by ForEachValue.
+    for (uint32_t i = 0; i < m_valuesCount; ++i)
+      m_valueReader->Skip(src);
+    m_edgesBegin = src.PtrUC();
+
+    for (uint32_t i = 0; i < m_edgesCount; ++i)
+    {
+      uint8_t const edgeHeader = ReadPrimitiveFromSource<uint8_t>(src);
+      if ((edgeHeader & 64) == 0)
+      {
+        uint32_t edgeLen = (edgeHeader & 63);
+        if (edgeLen == 63)
+          edgeLen = ReadVarUint<uint32_t>(src);
+        for (uint32_t j = 0; j <= edgeLen; ++j)
+          ReadVarInt<int32_t>(src);
+      }
+      m_edgeValueReader->Skip(src);
+      if (i + 1 != m_edgesCount)
+        ReadVarUint<uint32_t>(src);
+    }
+    m_childrenBegin = src.PtrUC();
+    ASSERT_LESS_OR_EQUAL(m_childrenBegin, m_end, ());
+  }
+
+  uint8_t const * m_end;
+  uint8_t const * m_valuesBegin;
+  uint8_t const * m_edgesBegin;
+  uint8_t const * m_childrenBegin;
+  uint32_t m_valuesCount;
+  uint32_t m_edgesCount;
+  TrieChar m_baseChar;
+  ValueReaderT const * m_valueReader;
+  EdgeValueReaderT const * m_edgeValueReader;
+};
+
+// Trie in a section of the mapped container. Keeps the section mapped while it is alive.
+template <class ValueReaderT, class EdgeValueReaderT>
+class MappedTrie
+{
+public:
+  using TIterator = MappedIterator<ValueReaderT, EdgeValueReaderT>;
+
+  MappedTrie(FilesMappingContainer const & cont, FilesContainerBase::Tag const & tag,
+             ValueReaderT const & valueReader = ValueReaderT(),
+             EdgeValueReaderT const & edgeValueReader = EdgeValueReaderT())
+    : m_handle(cont.Map(tag)), m_valueReader(valueReader), m_edgeValueReader(edgeValueReader)
+  {
+  }
+
+  // Returns iterator to the root of the trie.
+  TIterator GetRoot() const
+  {
+    uint8_t const * data = m_handle.GetData<uint8_t>();
+    return TIterator(data, data + m_handle.GetSize(), false /* isLeaf */, DEFAULT_CHAR,
+                     m_valueReader, m_edgeValueReader);
+  }
+
+private:
+  FilesMappingContainer::Handle m_handle;
+  ValueReaderT m_valueReader;
+  EdgeValueReaderT m_edgeValueReader;
+};
+
+template <class ValueReaderT, class EdgeValueReaderT, typename F, typename StringT>
+void ForEachRef(MappedIterator<ValueReaderT, EdgeValueReaderT> const & iter, F & f,
+                StringT const & s)
+{
+  iter.ForEachValue([&f, &s](typename ValueReaderT::ValueType const & value)
+                    {
+                      f(s, value);
+                    });
+  for (typename MappedIterator<ValueReaderT, EdgeValueReaderT>::EdgeIterator it(iter);
+       !it.IsEnd(); it.Next())
+  {
+    StringT s1(s);
+    s1.insert(s1.end(), it.GetString().begin(), it.GetString().end());
+    ForEachRef(it.GetChild(), f, s1);
+  }
+}
+}  // namespace trie
@@ -1,5 +1,8 @@
 #include "coding/mmap_reader.hpp"
 
+#include "base/logging.hpp"
+#include "base/macros.hpp"
+
 #include "std/target_os.hpp"
 #include "std/cstring.hpp"
 
@@ -90,6 +93,32 @@ uint8_t * MmapReader::Data() const
   return m_data->m_memory;
 }
 
+void MmapReader::Advise(Advice advice) const
+{
+#ifndef OMIM_OS_WINDOWS
+  if (m_size == 0)
+    return;
+
+  int flag = MADV_NORMAL;
+  switch (advice)
+  {
+  case Advice::Normal: flag = MADV_NORMAL; break;
+  case Advice::Sequential: flag = MADV_SEQUENTIAL; break;
+  case Advice::Random: flag = MADV_RANDOM; break;
+  }
+
+  // madvise needs a page-aligned address, so the pages of neighbouring
+  // ranges at the boundaries get the advice too.
+  uint64_t const pageSize = sysconf(_SC_PAGE_SIZE);
+  uint64_t const begin = (m_offset / pageSize) * pageSize;
+  uint64_t const end = m_offset + m_size;
+  if (madvise(m_data->m_memory + begin, end - begin, flag) != 0)
+    LOG(LWARNING, ("madvise failed for", GetName(), "range:", m_offset, m_size));
+#else
+  UNUSED_VALUE(advice);
+#endif
+}
+
 void MmapReader::SetOffsetAndSize(uint64_t offset, uint64_t size)
 {
   ASSERT_LESS_OR_EQUAL(offset + size, Size(), (offset, size));
@@ -17,6 +17,14 @@ class MmapReader : public ModelReader
   MmapReader(MmapReader const & reader, uint64_t offset, uint64_t size);
 
 public:
+  /// Hints for the kernel about the access pattern of the reader's range.
+  enum class Advice
+  {
+    Normal,
+    Sequential,
+    Random
+  };
+
   explicit MmapReader(string const & fileName);
 
   virtual uint64_t Size() const;
@@ -26,6 +34,9 @@ public:
   /// Direct file/memory access
   uint8_t * Data() const;
 
+  /// Calls madvise for the pages of [offset, offset + size) of the reader.
+  void Advise(Advice advice) const;
+
 protected:
   // Used in special derived readers.
   void SetOffsetAndSize(uint64_t offset, uint64_t size);
@@ -0,0 +1,172 @@
+#include "coding/shared_reader_cache.hpp"
+
+#include "std/sstream.hpp"
+
+
+string DebugPrint(ReaderCacheStats const & stats)
+{
+  ostringstream out;
+  out << "ReaderCacheStats [ hits: " << stats.m_hits << ", misses: " << stats.m_misses
+      << ", bytes read: " << stats.m_bytesRead << ", bytes cached: " << stats.m_bytesCached
+      << " ]";
+  return out.str();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SharedReaderCache::Shard
+/////////////////////////////////////////////////////////////////////////////
+
+void SharedReaderCache::Shard::Reset(uint64_t memoryLimit)
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_memoryLimit = memoryLimit;
+  m_bytesCached = 0;
+  m_pages.clear();
+  m_index.clear();
+  m_hand = 0;
+}
+
+bool SharedReaderCache::Shard::CopyFromPage(Key const & key, size_t offset, char * dst,
+                                            size_t size)
+{
+  lock_guard<mutex> lock(m_mutex);
+  auto const it = m_index.find(key);
+  if (it == m_index.end())
+    return false;
+
+  Page & page = m_pages[it->second];
+  ASSERT_LESS_OR_EQUAL(offset + size, page.m_data.size(), ());
+  memcpy(dst, page.m_data.data() + offset, size);
+  page.m_used = true;
+  ++m_stats.m_hits;
+  return true;
+}
+
+void SharedReaderCache::Shard::AddPage(Key const & key, vector<char> && data)
+{
+  lock_guard<mutex> lock(m_mutex);
+  ++m_stats.m_misses;
+  m_stats.m_bytesRead += data.size();
+
+  if (data.size() > m_memoryLimit || m_index.count(key) != 0)
+    return;
+
+  while (m_bytesCached + data.size() > m_memoryLimit)
+    EvictPage();
+
+  m_bytesCached += data.size();
+  m_index.emplace(key, m_pages.size());
+  m_pages.emplace_back(key, move(data));
+}
+
+void SharedReaderCache::Shard::EvictPage()
+{
+  ASSERT(!m_pages.empty(), ());
+
+  // Gives a second chance to the pages which were used since the last pass of the hand.
+  while (true)
+  {
+    if (m_hand >= m_pages.size())
+      m_hand = 0;
+    Page & page = m_pages[m_hand];
+    if (!page.m_used)
+      break;
+    page.m_used = false;
+    ++m_hand;
+  }
+
+  RemovePage(m_hand);
+}
+
+void SharedReaderCache::Shard::RemoveFile(uint64_t fileId)
+{
+  lock_guard<mutex> lock(m_mutex);
+  for (size_t i = 0; i < m_pages.size();)
+  {
+    if (m_pages[i].m_key.m_fileId == fileId)
+      RemovePage(i);
+    else
+      ++i;
+  }
+}
+
+void SharedReaderCache::Shard::RemovePage(size_t index)
+{
+  m_bytesCached -= m_pages[index].m_data.size();
+  m_index.erase(m_pages[index].m_key);
+  if (index + 1 != m_pages.size())
+  {
+    m_pages[index] = move(m_pages.back());
+    m_index[m_pages[index].m_key] = index;
+  }
+  m_pages.pop_back();
+}
+
+void SharedReaderCache::Shard::AddStats(ReaderCacheStats & stats) const
+{
+  lock_guard<mutex> lock(m_mutex);
+  stats.m_hits += m_stats.m_hits;
+  stats.m_misses += m_stats.m_misses;
+  stats.m_bytesRead += m_stats.m_bytesRead;
+  stats.m_bytesCached += m_bytesCached;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SharedReaderCache
+/////////////////////////////////////////////////////////////////////////////
+
+// static
+SharedReaderCache & SharedReaderCache::Instance()
+{
+  static SharedReaderCache cache;
+  return cache;
+}
+
+void SharedReaderCache::SetMemoryLimit(uint64_t bytes)
+{
+  m_memoryLimit = bytes;
+  for (Shard & shard : m_shards)
+    shard.Reset(bytes / kShardsCount);
+}
+
+uint64_t SharedReaderCache::RegisterFile(string const & path, uint64_t size,
+                                         uint64_t modificationTime, uint32_t logPageSize)
+{
+  lock_guard<mutex> lock(m_filesMutex);
+  auto const res = m_files.emplace(FileKey{path, size, modificationTime, logPageSize},
+                                   FileInfo{m_nextFileId, 0});
+  FileInfo & info = res.first->second;
+  if (res.second)
+  {
+    m_fileIds.emplace(info.m_id, res.first);
+    ++m_nextFileId;
+  }
+  ++info.m_readersCount;
+  return info.m_id;
+}
+
+void SharedReaderCache::UnregisterFile(uint64_t fileId)
+{
+  {
+    lock_guard<mutex> lock(m_filesMutex);
+    auto const it = m_fileIds.find(fileId);
+    ASSERT(it != m_fileIds.end(), (fileId));
+    if (it == m_fileIds.end() || --it->second->second.m_readersCount != 0)
+      return;
+    m_files.erase(it->second);
+    m_fileIds.erase(it);
+  }
+
+  // The file has no readers, so its pages are not added while they are removed,
+  // and the id is not given to other files.
+  for (Shard & shard : m_shards)
+    shard.RemoveFile(fileId);
+}
+
+ReaderCacheStats SharedReaderCache::GetStats() const
+{
+  ReaderCacheStats stats;
+  for (Shard const & shard : m_shards)
+    shard.AddStats(stats);
+  return stats;
+}
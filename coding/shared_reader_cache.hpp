@@ -0,0 +1,189 @@
+#pragma once
+
+#include "base/assert.hpp"
+#include "base/macros.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
+#include "std/cstdint.hpp"
+#include "std/cstring.hpp"
+#include "std/map.hpp"
+#include "std/mutex.hpp"
+#include "std/string.hpp"
+#include "std/tuple.hpp"
+#include "std/unordered_map.hpp"
+#include "std/vector.hpp"
+
+/// Counters of SharedReaderCache summed over its shards.
+struct ReaderCacheStats
+{
+  ReaderCacheStats() : m_hits(0), m_misses(0), m_bytesRead(0), m_bytesCached(0) {}
+
+  /// Pages found in the cache.
+  uint64_t m_hits;
+  /// Pages read from files.
+  uint64_t m_misses;
+  /// Bytes read from files.
+  uint64_t m_bytesRead;
+  /// Bytes of pages in the cache now.
+  uint64_t m_bytesCached;
+};
+
+string DebugPrint(ReaderCacheStats const & stats);
+
+/// Process-wide cache of file pages keyed by (file, page), which is shared by
+/// readers on all threads. Pages are spread over shards with their own locks,
+/// pages of each shard are evicted by the CLOCK algorithm when the memory limit
+/// of the shard is reached. Pages of a file are dropped when its last reader
+/// is unregistered.
+/// The cache is disabled until a memory limit is set, see FileReader for its users.
+class SharedReaderCache
+{
+  DISALLOW_COPY_AND_MOVE(SharedReaderCache);
+
+public:
+  static SharedReaderCache & Instance();
+
+  /// Drops all cached pages. Zero limit disables the cache.
+  void SetMemoryLimit(uint64_t bytes);
+  bool IsEnabled() const { return m_memoryLimit != 0; }
+
+  /// Registers a reader of the file which is identified by its canonical path, size and
+  /// modification time, see my::GetFileIdentity. Readers of the same file with the same
+  /// page size share pages.
+  /// @return Id of the file for keys of its pages.
+  uint64_t RegisterFile(string const & path, uint64_t size, uint64_t modificationTime,
+                        uint32_t logPageSize);
+  /// Unregisters a reader of the file, pages of the file are dropped with its last reader.
+  void UnregisterFile(uint64_t fileId);
+
+  template <class TReader>
+  void Read(uint64_t fileId, uint32_t logPageSize, TReader & reader, uint64_t pos, void * p,
+            size_t size)
+  {
+    ASSERT_LESS_OR_EQUAL(pos + size, reader.Size(), (pos, size, reader.Size()));
+    char * dst = static_cast<char *>(p);
+    while (size > 0)
+    {
+      uint64_t const pageNum = pos >> logPageSize;
+      size_t const offset = static_cast<size_t>(pos - (pageNum << logPageSize));
+      size_t const copySize = min(size, (size_t(1) << logPageSize) - offset);
+      ReadFromPage(fileId, logPageSize, reader, pageNum, offset, dst, copySize);
+      size -= copySize;
+      pos += copySize;
+      dst += copySize;
+    }
+  }
+
+  ReaderCacheStats GetStats() const;
+
+private:
+  struct FileKey
+  {
+    bool operator<(FileKey const & rhs) const
+    {
+      return tie(m_path, m_size, m_modificationTime, m_logPageSize) <
+             tie(rhs.m_path, rhs.m_size, rhs.m_modificationTime, rhs.m_logPageSize);
+    }
+
+    string m_path;
+    uint64_t m_size;
+    uint64_t m_modificationTime;
+    uint32_t m_logPageSize;
+  };
+
+  struct FileInfo
+  {
+    uint64_t m_id;
+    size_t m_readersCount;
+  };
+
+  struct Key
+  {
+    Key(uint64_t fileId, uint64_t page) : m_fileId(fileId), m_page(page) {}
+
+    bool operator==(Key const & rhs) const
+    {
+      return m_fileId == rhs.m_fileId && m_page == rhs.m_page;
+    }
+
+    uint64_t m_fileId;
+    uint64_t m_page;
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(Key const & key) const
+    {
+      uint64_t const h = key.m_page * 0x9E3779B97F4A7C15ULL ^ key.m_fileId;
+      return static_cast<size_t>(h ^ (h >> 32));
+    }
+  };
+
+  class Shard
+  {
+  public:
+    Shard() : m_memoryLimit(0), m_bytesCached(0), m_hand(0) {}
+
+    void Reset(uint64_t memoryLimit);
+
+    /// Copies [offset, offset + size) of the page into dst if the page is cached.
+    bool CopyFromPage(Key const & key, size_t offset, char * dst, size_t size);
+    void AddPage(Key const & key, vector<char> && data);
+    void RemoveFile(uint64_t fileId);
+
+    void AddStats(ReaderCacheStats & stats) const;
+
+  private:
+    struct Page
+    {
+      Page(Key const & key, vector<char> && data) : m_key(key), m_data(move(data)), m_used(true) {}
+
+      Key m_key;
+      vector<char> m_data;
+      // Is set on each hit and cleared by the clock hand.
+      bool m_used;
+    };
+
+    void EvictPage();
+    void RemovePage(size_t index);
+
+    mutable mutex m_mutex;
+    uint64_t m_memoryLimit;
+    uint64_t m_bytesCached;
+    vector<Page> m_pages;
+    unordered_map<Key, size_t, KeyHash> m_index;
+    size_t m_hand;
+    ReaderCacheStats m_stats;
+  };
+
+  static size_t constexpr kShardsCount = 16;
+
+  SharedReaderCache() : m_memoryLimit(0), m_nextFileId(0) {}
+
+  template <class TReader>
+  void ReadFromPage(uint64_t fileId, uint32_t logPageSize, TReader & reader, uint64_t pageNum,
+                    size_t offset, char * dst, size_t size)
+  {
+    Key const key(fileId, pageNum);
+    Shard & shard = m_shards[KeyHash()(key) % kShardsCount];
+    if (shard.CopyFromPage(key, offset, dst, size))
+      return;
+
+    // The page is read without the lock of the shard, so a page which is read by
+    // several threads at once is added by each of them.
+    uint64_t const pos = pageNum << logPageSize;
+    vector<char> data(min(size_t(1) << logPageSize, static_cast<size_t>(reader.Size() - pos)));
+    reader.Read(pos, data.data(), data.size());
+    memcpy(dst, data.data() + offset, size);
+    shard.AddPage(key, move(data));
+  }
+
+  Shard m_shards[kShardsCount];
+  atomic<uint64_t> m_memoryLimit;
+
+  mutex m_filesMutex;
+  map<FileKey, FileInfo> m_files;
+  unordered_map<uint64_t, map<FileKey, FileInfo>::iterator> m_fileIds;
+  uint64_t m_nextFileId;
+};
@@ -111,11 +111,15 @@ void BuildSuccinctTrie(TWriter & writer, TIter const beg, TIter const end,
 
   vector<TEntry> entries;
   vector<strings::UniString> entryStrings;
+  // Iterators of StringsFile compare only their end flags, so the first entry is marked
+  // by the flag instead of the comparison with |beg|.
+  bool isFirst = true;
   for (TIter it = beg; it != end; ++it)
   {
     TEntry entry = *it;
-    if (it != beg && entry == prevEntry)
+    if (!isFirst && entry == prevEntry)
       continue;
+    isFirst = false;
     TrieChar const * const keyData = entry.GetKeyData();
     TTrieString key(keyData, keyData + entry.GetKeySize());
     using namespace std::rel_ops;  // ">=" for keys.
@@ -4,6 +4,7 @@
 #include "base/base.hpp"
 #include "base/buffer_vector.hpp"
 
+#include "std/shared_ptr.hpp"
 #include "std/unique_ptr.hpp"
 
 
@@ -39,6 +40,59 @@ public:
   virtual Iterator<ValueT, EdgeValueT> * GoToEdge(size_t i) const = 0;
 };
 
+// Value wrapper of Iterator with the interface of MappedIterator, so algorithms over
+// tries may be written once for both. Children are still allocated by GoToEdge.
+template <typename ValueT, typename EdgeValueT>
+class IteratorNode
+{
+public:
+  using TIterator = Iterator<ValueT, EdgeValueT>;
+  using ValueType = ValueT;
+  using EdgeValueType = EdgeValueT;
+  using EdgeStrT = typename TIterator::Edge::EdgeStrT;
+
+  class EdgeIterator
+  {
+  public:
+    explicit EdgeIterator(IteratorNode const & node) : m_node(node), m_index(0) {}
+
+    bool IsEnd() const { return m_index >= m_node.m_iter->m_edge.size(); }
+    void Next() { ++m_index; }
+
+    uint32_t GetIndex() const { return m_index; }
+    EdgeStrT const & GetString() const { return m_node.m_iter->m_edge[m_index].m_str; }
+    EdgeValueT const & GetValue() const { return m_node.m_iter->m_edge[m_index].m_value; }
+
+    IteratorNode GetChild() const { return m_node.GoToEdge(m_index); }
+
+  private:
+    IteratorNode const & m_node;
+    uint32_t m_index;
+  };
+
+  // Takes the ownership of iter.
+  explicit IteratorNode(TIterator * iter) : m_iter(iter) { ASSERT(m_iter, ()); }
+
+  uint32_t GetValuesCount() const { return static_cast<uint32_t>(m_iter->m_value.size()); }
+  uint32_t GetEdgesCount() const { return static_cast<uint32_t>(m_iter->m_edge.size()); }
+
+  template <class TFn>
+  void ForEachValue(TFn && fn) const
+  {
+    for (auto const & value : m_iter->m_value)
+      fn(value);
+  }
+
+  IteratorNode GoToEdge(uint32_t i) const
+  {
+    ASSERT_LESS(i, m_iter->m_edge.size(), ());
+    return IteratorNode(m_iter->GoToEdge(i));
+  }
+
+private:
+  shared_ptr<TIterator const> m_iter;
+};
+
 struct EmptyValueReader
 {
   typedef unsigned char ValueType;
@@ -50,6 +104,11 @@ struct EmptyValueReader
   {
     value = 0;
   }
+
+  template <typename SourceT>
+  void Skip(SourceT &) const
+  {
+  }
 };
 
 template <unsigned int N>
@@ -65,6 +124,12 @@ struct FixedSizeValueReader
   {
     src.Read(&value.m_data[0], N);
   }
+
+  template <typename SourceT>
+  void Skip(SourceT & src) const
+  {
+    src.Advance(N);
+  }
 };
 
 template <typename ValueT, typename EdgeValueT, typename F, typename StringT>
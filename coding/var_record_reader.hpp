@@ -56,12 +56,34 @@ public:
     return pos + fullSize;
   }
 
+  // Returns the position of the next record, only the size of the record at pos is read.
+  uint64_t SkipRecord(uint64_t const pos) const
+  {
+    ASSERT_LESS(pos, m_ReaderSize, ());
+    // The size of the size is at most 5 bytes.
+    char buffer[5];
+    uint32_t const initialSize =
+        static_cast<uint32_t>(min(static_cast<uint64_t>(sizeof(buffer)), m_ReaderSize - pos));
+    m_Reader.Read(pos, &buffer[0], initialSize);
+    ArrayByteSource source(&buffer[0]);
+    uint32_t const recordSize = VarRecordSizeReaderFn(source);
+    return pos + (source.PtrC() - &buffer[0]) + recordSize;
+  }
+
   template <typename F>
   void ForEachRecord(F const & f) const
   {
-    uint64_t pos = 0;
+    ForEachRecord(0, m_ReaderSize, f);
+  }
+
+  // Calls f for the records in [beginPos, endPos), beginPos must be a position of a record.
+  template <typename F>
+  void ForEachRecord(uint64_t beginPos, uint64_t endPos, F const & f) const
+  {
+    ASSERT_LESS_OR_EQUAL(endPos, m_ReaderSize, ());
+    uint64_t pos = beginPos;
     vector<char> buffer;
-    while (pos < m_ReaderSize)
+    while (pos < endPos)
     {
       uint32_t offset = 0, size = 0;
       uint64_t nextPos = ReadRecord(pos, buffer, offset, size);
@@ -69,9 +91,11 @@ public:
       f(static_cast<uint32_t>(pos), &buffer[offset], static_cast<uint32_t>(size - offset));
       pos = nextPos;
     }
-    ASSERT_EQUAL(pos, m_ReaderSize, ());
+    ASSERT_EQUAL(pos, endPos, ());
   }
 
+  uint64_t Size() const { return m_ReaderSize; }
+
   bool IsEqual(string const & fName) const { return m_Reader.IsEqual(fName); }
 
 protected:
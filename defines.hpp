@@ -24,12 +24,15 @@
 #define METADATA_FILE_TAG "meta"
 #define METADATA_INDEX_FILE_TAG "metaidx"
 #define COMPRESSED_SEARCH_INDEX_FILE_TAG "csdx"
+#define SUCCINCT_SEARCH_INDEX_FILE_TAG "ssdx"
 
 #define ROUTING_MATRIX_FILE_TAG "mercedes"
 #define ROUTING_EDGEDATA_FILE_TAG "daewoo"
 #define ROUTING_EDGEID_FILE_TAG "infinity"
 #define ROUTING_SHORTCUTS_FILE_TAG  "skoda"
 #define ROUTING_CROSS_CONTEXT_TAG "chrysler"
+#define ROUTING_LANDMARKS_FILE_TAG "landmarks"
+#define ROUTING_PEDESTRIAN_CH_FILE_TAG "pedestrian_ch"
 
 #define ROUTING_FTSEG_FILE_TAG  "ftseg"
 #define ROUTING_NODEIND_TO_FTSEGIND_FILE_TAG  "node2ftseg"
@@ -56,6 +59,8 @@
 #define PACKED_POLYGONS_FILE "packed_polygons.bin"
 #define PACKED_POLYGONS_INFO_TAG "info"
 
+#define CROSS_MWM_OVERLAY_FILE "cross_mwm_overlay.bin"
+
 #define EXTERNAL_RESOURCES_FILE "external_resources.txt"
 
 /// How many langs we're supporting on indexing stage
@@ -0,0 +1,64 @@
+#include "generator/contraction_hierarchy_generator.hpp"
+#include "generator/pedestrian_roads.hpp"
+
+#include "routing/contraction_hierarchy.hpp"
+
+#include "coding/file_container.hpp"
+
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/vector.hpp"
+
+#include "defines.hpp"
+
+namespace routing
+{
+bool BuildPedestrianContractionHierarchy(string const & baseDir, string const & countryName)
+{
+  string const mwmFile = baseDir + countryName + DATA_FILE_EXTENSION;
+
+  // Road points outside of the country borders are where roads of other mwms may start.
+  vector<m2::RegionD> borders;
+  if (!LoadPedestrianRoadsBorders(baseDir, countryName, borders))
+    return false;
+
+  ContractionHierarchyBuilder builder;
+  auto const addRoad = [&](uint32_t featureId, vector<m2::PointD> const & points,
+                           double speedKMPH, bool bidirectional)
+  {
+    builder.AddRoad(featureId, points, speedKMPH, bidirectional);
+    for (auto const & point : points)
+    {
+      if (IsOutsideBorders(borders, point))
+        builder.AddExit(point);
+    }
+  };
+
+  try
+  {
+    ForEachPedestrianRoad(mwmFile, countryName, addRoad);
+
+    my::Timer timer;
+    ContractionHierarchy hierarchy;
+    builder.Build(hierarchy);
+    LOG(LINFO, ("Contraction hierarchy is built in", timer.ElapsedSeconds(), "seconds"));
+    if (hierarchy.GetVerticesCount() == 0)
+    {
+      LOG(LWARNING, ("No pedestrian roads in", mwmFile));
+      return false;
+    }
+
+    FilesContainerW cont(mwmFile, FileWriter::OP_WRITE_EXISTING);
+    FileWriter writer = cont.GetWriter(ROUTING_PEDESTRIAN_CH_FILE_TAG);
+    hierarchy.Serialize(writer);
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("Can't build contraction hierarchy for", mwmFile, e.Msg()));
+    return false;
+  }
+
+  return true;
+}
+}  // namespace routing
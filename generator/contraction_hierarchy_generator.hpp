@@ -0,0 +1,13 @@
+#pragma once
+
+#include "std/string.hpp"
+
+namespace routing
+{
+/// Builds a contraction hierarchy section for pedestrian routing,
+/// see routing::ContractionHierarchy. Country borders are read from the borders
+/// directory of baseDir.
+/// @param[in]  baseDir   Full path to .mwm files directory.
+/// @param[in]  countryName   Country name same with .mwm file name.
+bool BuildPedestrianContractionHierarchy(string const & baseDir, string const & countryName);
+}
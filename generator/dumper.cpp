@@ -200,12 +200,24 @@ namespace feature
     feature::DataHeader header(container);
     serial::CodingParams cp(trie::GetCodingParams(header.GetDefCodingParams()));
 
-    unique_ptr<trie::DefaultIterator> const pTrieRoot(
-        trie::ReadTrie(container.GetReader(SEARCH_INDEX_FILE_TAG), trie::ValueReader(cp),
-                       trie::TEdgeValueReader()));
+    string tag;
+    CHECK(search::GetSearchIndexTag(container, tag), ("No search index in", fPath));
 
     SearchTokensCollector f;
-    trie::ForEachRef(*pTrieRoot, f, strings::UniString());
+    if (tag == SEARCH_INDEX_FILE_TAG)
+    {
+      // The whole trie is traversed, so it is read from the mapped section.
+      FilesMappingContainer mappedContainer(fPath);
+      trie::MappedSearchTrie const trie(mappedContainer, tag, trie::ValueReader(cp),
+                                        trie::TEdgeValueReader());
+      trie::ForEachRef(trie.GetRoot(), f, strings::UniString());
+    }
+    else
+    {
+      unique_ptr<trie::DefaultIterator> const pTrieRoot(
+          trie::ReadSearchIndexTrie(tag, container.GetReader(tag), trie::ValueReader(cp)));
+      trie::ForEachRef(*pTrieRoot, f, strings::UniString());
+    }
     f.Finish();
 
     while (!f.tokens.empty())
@@ -131,6 +131,33 @@ void FeatureBuilder1::AddPolygon(vector<m2::PointD> & poly)
   m_polygons.back().swap(poly);
 }
 
+bool FeatureBuilder1::ReplacePoints(function<bool(m2::PointD &)> const & fn)
+{
+  bool changed = false;
+  if (m_params.GetGeomType() == GEOM_POINT)
+  {
+    changed = fn(m_center);
+  }
+  else
+  {
+    for (TPointSeq & points : m_polygons)
+    {
+      for (auto & pt : points)
+        changed = fn(pt) || changed;
+    }
+  }
+
+  if (!changed)
+    return false;
+
+  m_limitRect.MakeEmpty();
+  if (m_params.GetGeomType() == GEOM_POINT)
+    m_limitRect.Add(m_center);
+  for (TPointSeq const & points : m_polygons)
+    CalcRect(points, m_limitRect);
+  return true;
+}
+
 bool FeatureBuilder1::RemoveInvalidTypes()
 {
   if (!m_params.FinishAddingTypes())
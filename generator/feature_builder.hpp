@@ -8,6 +8,7 @@
 #include "coding/read_write_utils.hpp"
 
 #include "std/bind.hpp"
+#include "std/function.hpp"
 
 
 namespace serial { class CodingParams; }
@@ -45,6 +46,10 @@ public:
   inline bool IsArea() const { return (GetGeomType() == feature::GEOM_AREA); }
 
   void AddPolygon(vector<m2::PointD> & poly);
+
+  /// Calls fn for every point of the geometry, fn returns true if it has changed the point.
+  /// @return true if any point is changed.
+  bool ReplacePoints(function<bool(m2::PointD &)> const & fn);
   //@}
 
   inline feature::Metadata const & GetMetadata() const { return m_params.GetMetadata(); }
@@ -153,6 +158,7 @@ public:
   void AddOsmId(osm::Id id);
   void SetOsmId(osm::Id id);
   osm::Id GetLastOsmId() const;
+  inline vector<osm::Id> const & GetOsmIds() const { return m_osmIds; }
   string GetOsmIdsString() const;
   //@}
 
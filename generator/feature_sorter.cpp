@@ -24,6 +24,13 @@
 #include "base/string_utils.hpp"
 #include "base/logging.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
+#include "std/condition_variable.hpp"
+#include "std/exception.hpp"
+#include "std/mutex.hpp"
+#include "std/thread.hpp"
+
 namespace
 {
   typedef pair<uint64_t, uint64_t> CellAndOffsetT;
@@ -178,17 +185,35 @@ namespace feature
       }
     }
 
+    /// Simplified and serialized geometry of a feature. Outer geometry is kept in memory
+    /// until the feature is written, so geometry of features can be made on several threads.
+    struct FeatureGeometry
+    {
+      struct OuterGeometry
+      {
+        OuterGeometry(int scaleIndex, bool isTriangles)
+          : m_scaleIndex(scaleIndex), m_isTriangles(isTriangles)
+        {
+        }
+
+        int m_scaleIndex;
+        bool m_isTriangles;
+        vector<char> m_data;
+      };
+
+      FeatureBuilder2::SupportingData m_buffer;
+      // In the order of processing of scales.
+      vector<OuterGeometry> m_outer;
+    };
+
   private:
     typedef vector<m2::PointD> points_t;
     typedef list<points_t> polygons_t;
 
     class GeometryHolder
     {
-    public:
-      FeatureBuilder2::SupportingData m_buffer;
-
-    private:
-      FeaturesCollector2 & m_rMain;
+      FeatureGeometry & m_geometry;
+      FeatureBuilder2::SupportingData & m_buffer;
       FeatureBuilder2 & m_rFB;
 
       points_t m_current;
@@ -208,8 +233,9 @@ namespace feature
         points_t toSave(points.begin() + 1, points.end());
 
         m_buffer.m_ptsMask |= (1 << i);
-        m_buffer.m_ptsOffset.push_back(m_rMain.GetFileSize(*m_rMain.m_geoFile[i]));
-        serial::SaveOuterPath(toSave, cp, *m_rMain.m_geoFile[i]);
+        m_geometry.m_outer.emplace_back(i, false /* isTriangles */);
+        MemWriter<vector<char>> writer(m_geometry.m_outer.back().m_data);
+        serial::SaveOuterPath(toSave, cp, writer);
       }
 
       void WriteOuterTriangles(polygons_t const & polys, int i)
@@ -241,10 +267,11 @@ namespace feature
 
         //CHECK_LESS_OR_EQUAL(saver.GetBufferSize(), checkSaver.GetBufferSize(), ());
 
-        // saving to file
+        // saving to buffer, it's written to file with the feature
         m_buffer.m_trgMask |= (1 << i);
-        m_buffer.m_trgOffset.push_back(m_rMain.GetFileSize(*m_rMain.m_trgFile[i]));
-        saver.Save(*m_rMain.m_trgFile[i]);
+        m_geometry.m_outer.emplace_back(i, true /* isTriangles */);
+        MemWriter<vector<char>> writer(m_geometry.m_outer.back().m_data);
+        saver.Save(writer);
       }
 
       void FillInnerPointsMask(points_t const & points, uint32_t scaleIndex)
@@ -293,10 +320,10 @@ namespace feature
       };
 
     public:
-      GeometryHolder(FeaturesCollector2 & rMain,
+      GeometryHolder(FeatureGeometry & geometry,
                      FeatureBuilder2 & fb,
                      DataHeader const & header)
-        : m_rMain(rMain), m_rFB(fb), m_header(header),
+        : m_geometry(geometry), m_buffer(geometry.m_buffer), m_rFB(fb), m_header(header),
           m_ptsInner(true), m_trgInner(true)
       {
       }
@@ -379,8 +406,8 @@ namespace feature
       }
     };
 
-    void SimplifyPoints(points_t const & in, points_t & out, int level,
-                        bool isCoast, m2::RectD const & rect)
+    static void SimplifyPoints(points_t const & in, points_t & out, int level,
+                               bool isCoast, m2::RectD const & rect)
     {
       if (isCoast)
       {
@@ -423,7 +450,15 @@ namespace feature
   public:
     void operator() (FeatureBuilder2 & fb)
     {
-      GeometryHolder holder(*this, fb, m_header);
+      FeatureGeometry geometry;
+      MakeGeometry(fb, geometry);
+      WriteFeature(fb, geometry);
+    }
+
+    /// Simplifies and serializes geometry of the feature, is safe to call on several threads.
+    void MakeGeometry(FeatureBuilder2 & fb, FeatureGeometry & geometry) const
+    {
+      GeometryHolder holder(geometry, fb, m_header);
 
       bool const isLine = fb.IsLine();
       bool const isArea = fb.IsArea();
@@ -494,12 +529,24 @@ namespace feature
           }
         }
       }
+    }
+
+    /// Writes outer geometry and the feature, features should be written in their order in mwm.
+    void WriteFeature(FeatureBuilder2 & fb, FeatureGeometry & geometry)
+    {
+      FeatureBuilder2::SupportingData & buffer = geometry.m_buffer;
+      for (auto const & outer : geometry.m_outer)
+      {
+        FileWriter & w = *(outer.m_isTriangles ? m_trgFile : m_geoFile)[outer.m_scaleIndex];
+        (outer.m_isTriangles ? buffer.m_trgOffset : buffer.m_ptsOffset).push_back(GetFileSize(w));
+        w.Write(outer.m_data.data(), outer.m_data.size());
+      }
 
-      if (fb.PreSerialize(holder.m_buffer))
+      if (fb.PreSerialize(buffer))
       {
-        fb.Serialize(holder.m_buffer, m_header.GetDefCodingParams());
+        fb.Serialize(buffer, m_header.GetDefCodingParams());
 
-        uint32_t const ftID = WriteFeatureBase(holder.m_buffer.m_buffer, fb);
+        uint32_t const ftID = WriteFeatureBase(buffer.m_buffer, fb);
 
         if (!fb.GetMetadata().Empty())
         {
@@ -537,6 +584,165 @@ namespace feature
     }
   };
 
+  /// Features in a block are read on this thread, geometry of them is made on worker threads
+  /// while the previous block is written in the sorted order on this thread.
+  /// Workers live as long as the generator, an exception of a worker is rethrown on this thread.
+  class ParallelGeometryGenerator
+  {
+  public:
+    ParallelGeometryGenerator(FileReader const & reader, FeaturesCollector2 & collector,
+                              uint32_t threadsCount)
+      : m_reader(reader), m_collector(collector), m_threadsCount(threadsCount)
+    {
+      for (uint32_t i = 0; i < m_threadsCount; ++i)
+        m_threads.emplace_back(&ParallelGeometryGenerator::Work, this);
+    }
+
+    ~ParallelGeometryGenerator()
+    {
+      {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_startCv.notify_all();
+      for (auto & t : m_threads)
+        t.join();
+    }
+
+    void Run(vector<CellAndOffsetT> const & offsets)
+    {
+      size_t const blocksCount = (offsets.size() + kBlockSize - 1) / kBlockSize;
+      if (blocksCount == 0)
+        return;
+
+      ReadBlock(offsets, 0, m_blocks[0]);
+      StartBlock(m_blocks[0]);
+      for (size_t i = 0; i < blocksCount; ++i)
+      {
+        Block & block = m_blocks[i % 2];
+        FinishBlock(block);
+
+        if (i + 1 < blocksCount)
+        {
+          Block & next = m_blocks[(i + 1) % 2];
+          ReadBlock(offsets, (i + 1) * kBlockSize, next);
+          StartBlock(next);
+        }
+
+        for (size_t j = 0; j < block.m_features.size(); ++j)
+          m_collector.WriteFeature(GetFeatureBuilder2(block.m_features[j]), block.m_geometries[j]);
+      }
+    }
+
+  private:
+    static size_t constexpr kBlockSize = 4096;
+
+    struct Block
+    {
+      vector<FeatureBuilder1> m_features;
+      vector<FeaturesCollector2::FeatureGeometry> m_geometries;
+      atomic<size_t> m_next;
+      // Guarded by m_mutex.
+      uint32_t m_finishedThreads = 0;
+      exception_ptr m_exception;
+    };
+
+    void ReadBlock(vector<CellAndOffsetT> const & offsets, size_t begin, Block & block)
+    {
+      size_t const end = min(begin + kBlockSize, offsets.size());
+      block.m_features.clear();
+      block.m_features.resize(end - begin);
+      block.m_geometries.clear();
+      block.m_geometries.resize(end - begin);
+      for (size_t i = begin; i < end; ++i)
+      {
+        ReaderSource<FileReader> src(m_reader);
+        src.Skip(offsets[i].second);
+        ReadFromSourceRowFormat(src, block.m_features[i - begin]);
+      }
+    }
+
+    /// Workers take one block at once, so the next block is started after all of them
+    /// have finished the previous one.
+    void StartBlock(Block & block)
+    {
+      {
+        lock_guard<mutex> lock(m_mutex);
+        block.m_next = 0;
+        block.m_finishedThreads = 0;
+        block.m_exception = exception_ptr();
+        m_current = &block;
+        ++m_generation;
+      }
+      m_startCv.notify_all();
+    }
+
+    void FinishBlock(Block & block)
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_finishCv.wait(lock, [&]() { return block.m_finishedThreads == m_threadsCount; });
+      if (block.m_exception)
+        rethrow_exception(block.m_exception);
+    }
+
+    void Work()
+    {
+      uint64_t generation = 0;
+      while (true)
+      {
+        Block * block;
+        {
+          unique_lock<mutex> lock(m_mutex);
+          m_startCv.wait(lock, [&]() { return m_stop || m_generation != generation; });
+          if (m_stop)
+            return;
+          generation = m_generation;
+          block = m_current;
+        }
+
+        exception_ptr exception;
+        try
+        {
+          // Features are taken one by one because time to simplify them differs a lot.
+          for (size_t j = block->m_next++; j < block->m_features.size(); j = block->m_next++)
+          {
+            m_collector.MakeGeometry(GetFeatureBuilder2(block->m_features[j]),
+                                     block->m_geometries[j]);
+          }
+        }
+        catch (...)
+        {
+          exception = current_exception();
+          // Other workers stop taking features of the block.
+          block->m_next = block->m_features.size();
+        }
+
+        {
+          lock_guard<mutex> lock(m_mutex);
+          if (exception && !block->m_exception)
+            block->m_exception = exception;
+          ++block->m_finishedThreads;
+        }
+        m_finishCv.notify_one();
+      }
+    }
+
+    FileReader const & m_reader;
+    FeaturesCollector2 & m_collector;
+    uint32_t const m_threadsCount;
+    Block m_blocks[2];
+
+    mutex m_mutex;
+    condition_variable m_startCv;
+    condition_variable m_finishCv;
+    // Guarded by m_mutex.
+    Block * m_current = nullptr;
+    uint64_t m_generation = 0;
+    bool m_stop = false;
+
+    vector<thread> m_threads;
+  };
+
   bool GenerateFinalFeatures(feature::GenerateInfo const & info, string const & name, int mapType)
   {
     string const srcFilePath = info.GetTmpFileName(name);
@@ -592,16 +798,27 @@ namespace feature
       {
         FeaturesCollector2 collector(datFilePath, header, info.m_versionDate);
 
-        for (size_t i = 0; i < midPoints.m_vec.size(); ++i)
+        uint32_t threadsCount = info.m_threadsCount;
+        if (threadsCount == 0)
+          threadsCount = max(thread::hardware_concurrency(), 1U);
+
+        if (threadsCount == 1)
         {
-          ReaderSource<FileReader> src(reader);
-          src.Skip(midPoints.m_vec[i].second);
+          for (size_t i = 0; i < midPoints.m_vec.size(); ++i)
+          {
+            ReaderSource<FileReader> src(reader);
+            src.Skip(midPoints.m_vec[i].second);
 
-          FeatureBuilder1 f;
-          ReadFromSourceRowFormat(src, f);
+            FeatureBuilder1 f;
+            ReadFromSourceRowFormat(src, f);
 
-          // emit the feature
-          collector(GetFeatureBuilder2(f));
+            // emit the feature
+            collector(GetFeatureBuilder2(f));
+          }
+        }
+        else
+        {
+          ParallelGeometryGenerator(reader, collector, threadsCount).Run(midPoints.m_vec);
         }
       }
       catch (Writer::Exception const & ex)
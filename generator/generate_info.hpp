@@ -18,18 +18,22 @@ struct GenerateInfo
   {
     Memory,
     Index,
-    File
+    File,
+    Sorted
   };
 
   enum class OsmSourceType
   {
     XML,
-    O5M
+    O5M,
+    PBF
   };
 
 
   // Directory for .mwm.tmp files.
   string m_tmpDir;
+  // Directory for .mwm.tmp files which are updated by m_osmChangeFiles, they are only read.
+  string m_baseTmpDir;
   // Directory for result .mwm files.
   string m_targetDir;
   // Directory for all intermediate files.
@@ -41,9 +45,15 @@ struct GenerateInfo
   NodeStorageType m_nodeStorageType;
   OsmSourceType m_osmFileType;
   string m_osmFileName;
+  // OSM change files (.osc) to update features of countries.
+  vector<string> m_osmChangeFiles;
 
   uint32_t m_versionDate = 0;
 
+  /// Number of threads for the generation passes which can run in parallel,
+  /// 0 means all cores.
+  uint32_t m_threadsCount = 1;
+
   vector<string> m_bucketNames;
 
   bool m_createWorld = false;
@@ -63,6 +73,8 @@ struct GenerateInfo
       m_osmFileType = OsmSourceType::XML;
     else if (type == "o5m")
       m_osmFileType = OsmSourceType::O5M;
+    else if (type == "pbf")
+      m_osmFileType = OsmSourceType::PBF;
     else
       LOG(LCRITICAL, ("Unknown source type:", type));
   }
@@ -75,6 +87,8 @@ struct GenerateInfo
       m_nodeStorageType = NodeStorageType::Index;
     else if (type == "mem")
       m_nodeStorageType = NodeStorageType::Memory;
+    else if (type == "sorted")
+      m_nodeStorageType = NodeStorageType::Sorted;
     else
       LOG(LCRITICAL, ("Incorrect node_storage type:", type));
   }
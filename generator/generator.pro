@@ -18,14 +18,20 @@ SOURCES += \
     borders_loader.cpp \
     check_model.cpp \
     coastlines_generator.cpp \
+    contraction_hierarchy_generator.cpp \
     dumper.cpp \
     feature_builder.cpp \
     feature_generator.cpp \
     feature_merger.cpp \
     feature_sorter.cpp \
+    intermediate_data.cpp \
+    landmarks_generator.cpp \
     osm2type.cpp \
+    osm_change.cpp \
     osm_id.cpp \
+    osm_pbf_source.cpp \
     osm_source.cpp \
+    pedestrian_roads.cpp \
     routing_generator.cpp \
     statistics.cpp \
     tesselator.cpp \
@@ -38,6 +44,7 @@ HEADERS += \
     borders_loader.hpp \
     check_model.hpp \
     coastlines_generator.hpp \
+    contraction_hierarchy_generator.hpp \
     dumper.hpp \
     intermediate_data.hpp\
     intermediate_elements.hpp\
@@ -48,13 +55,19 @@ HEADERS += \
     feature_sorter.hpp \
     gen_mwm_info.hpp \
     generate_info.hpp \
+    landmarks_generator.hpp \
     osm2meta.hpp \
     osm2type.hpp \
     osm2meta.hpp \
+    osm_change.hpp \
     osm_element.hpp \
     osm_id.hpp \
+    osm_o5m_pipeline.hpp \
     osm_o5m_source.hpp \
+    osm_pbf_source.hpp \
     osm_xml_source.hpp \
+    pedestrian_roads.hpp \
+    pipeline_queue.hpp \
     polygonizer.hpp \
     routing_generator.hpp \
     statistics.hpp \
@@ -100,6 +100,28 @@ UNIT_TEST(FBuilder_LineTypes)
   TEST_EQUAL(fb2.GetTypesCount(), 4, ());
 }
 
+UNIT_TEST(FBuilder_ReplacePoints)
+{
+  FeatureBuilder1 fb;
+  fb.AddPoint(m2::PointD(0, 0));
+  fb.AddPoint(m2::PointD(1, 1));
+  fb.AddPoint(m2::PointD(2, 0));
+  fb.SetLinear();
+
+  TEST(!fb.ReplacePoints([](m2::PointD &) { return false; }), ());
+  TEST_EQUAL(fb.GetLimitRect(), m2::RectD(0, 0, 2, 1), ());
+
+  TEST(fb.ReplacePoints([](m2::PointD & pt)
+  {
+    if (pt != m2::PointD(1, 1))
+      return false;
+    pt = m2::PointD(1, 5);
+    return true;
+  }), ());
+  TEST_EQUAL(fb.GetOuterGeometry()[1], m2::PointD(1, 5), ());
+  TEST_EQUAL(fb.GetLimitRect(), m2::RectD(0, 0, 2, 5), ());
+}
+
 UNIT_TEST(FVisibility_RemoveNoDrawableTypes)
 {
   classificator::Load();
@@ -0,0 +1,129 @@
+#include "testing/testing.hpp"
+
+#include "generator/feature_builder.hpp"
+#include "generator/feature_generator.hpp"
+#include "generator/feature_sorter.hpp"
+#include "generator/generate_info.hpp"
+
+#include "indexer/classificator.hpp"
+#include "indexer/classificator_loader.hpp"
+#include "indexer/data_header.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_name_utils.hpp"
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+
+#include "base/scope_guard.hpp"
+#include "base/string_utils.hpp"
+
+#include "std/bind.hpp"
+#include "std/cmath.hpp"
+#include "std/random.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+#include "defines.hpp"
+
+namespace
+{
+string const kTestName = "feature_sorter_test";
+
+// Features are processed by blocks of 4096 features, so there are two full blocks
+// and a partial one.
+size_t const kFeaturesCount = 2 * 4096 + 1000;
+
+void WriteRawFeatures(string const & fileName)
+{
+  Classificator const & c = classif();
+  uint32_t const lineType = c.GetTypeByPath({"highway", "primary"});
+  uint32_t const areaType = c.GetTypeByPath({"building"});
+  uint32_t const pointType = c.GetTypeByPath({"amenity", "cafe"});
+
+  mt19937 rng(0);
+  uniform_real_distribution<double> coord(-10, 10);
+  uniform_real_distribution<double> step(-0.01, 0.01);
+
+  feature::FeaturesCollector collector(fileName);
+  for (size_t i = 0; i < kFeaturesCount; ++i)
+  {
+    FeatureBuilder1 fb;
+    FeatureParams params;
+    m2::PointD const start(coord(rng), coord(rng));
+    switch (i % 3)
+    {
+    case 0:
+    {
+      params.AddType(lineType);
+      m2::PointD pt = start;
+      for (size_t j = 0; j < 1 + i % 50; ++j)
+      {
+        fb.AddPoint(pt);
+        pt += m2::PointD(0.001 + fabs(step(rng)), step(rng));
+      }
+      fb.AddPoint(pt);
+      fb.SetLinear();
+      break;
+    }
+    case 1:
+    {
+      params.AddType(areaType);
+      double const size = 0.0001 * (1 + i % 100);
+      fb.AddPoint(start);
+      fb.AddPoint(start + m2::PointD(size, 0));
+      fb.AddPoint(start + m2::PointD(size, size));
+      fb.AddPoint(start + m2::PointD(size / 2, size * 1.5));
+      fb.AddPoint(start + m2::PointD(0, size));
+      fb.AddPoint(start);
+      fb.SetArea();
+      break;
+    }
+    default:
+      params.AddType(pointType);
+      fb.SetCenter(start);
+      break;
+    }
+    params.name.AddString(0, "Feature " + strings::to_string(i));
+    params.FinishAddingTypes();
+    fb.SetParams(params);
+    TEST(fb.PreSerialize(), ());
+    collector(fb);
+  }
+}
+
+string GenerateMwm(feature::GenerateInfo const & info, uint32_t threadsCount)
+{
+  feature::GenerateInfo threadsInfo(info);
+  threadsInfo.m_threadsCount = threadsCount;
+  TEST(feature::GenerateFinalFeatures(threadsInfo, kTestName, feature::DataHeader::country), ());
+
+  string data;
+  FileReader(info.GetTargetFileName(kTestName)).ReadAsString(data);
+  return data;
+}
+}  // namespace
+
+// Geometry made on several threads should give the same mwm as on one thread.
+UNIT_TEST(GenerateFinalFeatures_Threads)
+{
+  classificator::Load();
+
+  feature::GenerateInfo info;
+  info.m_tmpDir = info.m_targetDir = GetPlatform().WritableDir();
+
+  string const rawFile = info.GetTmpFileName(kTestName);
+  string const mwmFile = info.GetTargetFileName(kTestName);
+  string const osm2ftFile = mwmFile + OSM2FEATURE_FILE_EXTENSION;
+  MY_SCOPE_GUARD(deleteRawFile, bind(&FileWriter::DeleteFileX, cref(rawFile)));
+  MY_SCOPE_GUARD(deleteMwmFile, bind(&FileWriter::DeleteFileX, cref(mwmFile)));
+  MY_SCOPE_GUARD(deleteOsm2ftFile, bind(&FileWriter::DeleteFileX, cref(osm2ftFile)));
+
+  WriteRawFeatures(rawFile);
+
+  string const expected = GenerateMwm(info, 1);
+  TEST(!expected.empty(), ());
+  TEST(GenerateMwm(info, 2) == expected, ());
+  TEST(GenerateMwm(info, 4) == expected, ());
+  TEST(GenerateMwm(info, 0) == expected, ());
+}
@@ -22,10 +22,13 @@ SOURCES += \
     classificator_tests.cpp \
     coasts_test.cpp \
     feature_builder_test.cpp \
+    feature_sorter_test.cpp \
     feature_merger_test.cpp \
     metadata_test.cpp \
+    osm_change_test.cpp \
     osm_id_test.cpp \
     osm_o5m_source_test.cpp \
+    osm_pbf_source_test.cpp \
     osm_type_test.cpp \
     tesselator_test.cpp \
     triangles_tree_coding_test.cpp \
@@ -8,8 +8,17 @@
 
 #include "testing/testing.hpp"
 
+#include "generator/intermediate_data.hpp"
 #include "generator/intermediate_elements.hpp"
 
+#include "base/math.hpp"
+#include "base/scope_guard.hpp"
+
+#include "std/bind.hpp"
+#include "std/limits.hpp"
+#include "std/map.hpp"
+#include "std/random.hpp"
+
 
 UNIT_TEST(Intermediate_Data_empty_way_element_save_load_test)
 {
@@ -99,3 +108,97 @@ UNIT_TEST(Intermediate_Data_relation_element_save_load_test)
   TEST_NOT_EQUAL(e2.tags["key1old"], "value1old", ());
   TEST_NOT_EQUAL(e2.tags["key2old"], "value2old", ());
 }
+
+namespace
+{
+string const kNodesFile = "sorted_point_storage_test";
+uint64_t const kFarId = (1 << 20) + 5;
+
+void TestPoints(cache::SortedFilePointStorage<cache::EMode::Read> const & storage,
+                map<uint64_t, pair<double, double>> const & points, uint64_t maxId)
+{
+  for (uint64_t id = 0; id <= maxId; ++id)
+  {
+    double lat = 0, lon = 0;
+    auto const it = points.find(id);
+    bool const found = storage.GetPoint(id, lat, lon);
+    TEST_EQUAL(found, it != points.end(), (id));
+    if (found && it != points.end())
+    {
+      TEST(my::AlmostEqualAbs(lat, it->second.first, 1e-7), (id, lat));
+      TEST(my::AlmostEqualAbs(lon, it->second.second, 1e-7), (id, lon));
+    }
+  }
+}
+}  // namespace
+
+UNIT_TEST(Intermediate_Data_sorted_point_storage_test)
+{
+  string const sortedFile = kNodesFile + ".sorted";
+  MY_SCOPE_GUARD(deleteSortedFile, bind(&FileWriter::DeleteFileX, cref(sortedFile)));
+
+  // Points are added in random order, with gaps of several blocks between ids.
+  mt19937 rng(0);
+  uniform_real_distribution<double> coord(-90, 90);
+  map<uint64_t, pair<double, double>> points;
+  vector<uint64_t> ids;
+  for (uint64_t id = 1; id < 5000; id += 1 + rng() % (id < 2000 ? 3 : 700))
+    ids.push_back(id);
+  ids.push_back(kFarId);
+  shuffle(ids.begin(), ids.end(), rng);
+
+  {
+    cache::SortedFilePointStorage<cache::EMode::Write> storage(kNodesFile);
+    for (uint64_t id : ids)
+    {
+      double const lat = coord(rng);
+      double const lon = 2 * coord(rng);
+      storage.AddPoint(id, lat, lon);
+      points[id] = make_pair(lat, lon);
+    }
+    TEST_EQUAL(storage.GetProcessedPoint(), ids.size(), ());
+    storage.Finish(4 /* threadsCount */);
+  }
+
+  cache::SortedFilePointStorage<cache::EMode::Read> storage(kNodesFile);
+  TestPoints(storage, points, 5500);
+  double lat = 0, lon = 0;
+  TEST(storage.GetPoint(kFarId, lat, lon), ());
+  TEST(!storage.GetPoint(numeric_limits<uint64_t>::max(), lat, lon), ());
+}
+
+// Points which don't fit in memory are sorted by runs and merged.
+UNIT_TEST(Intermediate_Data_sorted_point_storage_external_sort_test)
+{
+  string const unsortedFile = kNodesFile + ".unsorted";
+  string const sortedFile = kNodesFile + ".sorted";
+  MY_SCOPE_GUARD(deleteUnsortedFile, bind(&FileWriter::DeleteFileX, cref(unsortedFile)));
+  MY_SCOPE_GUARD(deleteSortedFile, bind(&FileWriter::DeleteFileX, cref(sortedFile)));
+
+  mt19937 rng(1);
+  map<uint64_t, pair<double, double>> points;
+  {
+    FileWriter writer(unsortedFile);
+    for (size_t i = 0; i < 20000; ++i)
+    {
+      cache::PointStorage::LatLonPos ll;
+      ll.pos = rng() % 100000;
+      ll.lat = static_cast<int32_t>(rng() % 1800000000) - 900000000;
+      ll.lon = static_cast<int32_t>(rng() % 1800000000) - 900000000;
+      if (!points.emplace(ll.pos, make_pair(ll.lat / 1E+7, ll.lon / 1E+7)).second)
+        continue;
+      writer.Write(&ll, sizeof(ll));
+    }
+  }
+
+  for (size_t maxPointsInMemory : {1000, 7000, 100000})
+  {
+    {
+      FileWriter writer(sortedFile);
+      cache::detail::BuildSortedPoints(unsortedFile, writer, 4 /* threadsCount */,
+                                       maxPointsInMemory);
+    }
+    cache::SortedFilePointStorage<cache::EMode::Read> storage(kNodesFile);
+    TestPoints(storage, points, 100000);
+  }
+}
@@ -0,0 +1,360 @@
+#include "testing/testing.hpp"
+
+#include "generator/borders_loader.hpp"
+#include "generator/feature_builder.hpp"
+#include "generator/generate_info.hpp"
+#include "generator/osm_change.hpp"
+#include "generator/osm_element.hpp"
+#include "generator/osm_id.hpp"
+#include "generator/osm_source.hpp"
+
+#include "indexer/classificator.hpp"
+#include "indexer/classificator_loader.hpp"
+#include "indexer/mercator.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_name_utils.hpp"
+#include "coding/file_reader.hpp"
+#include "coding/file_writer.hpp"
+
+#include "base/scope_guard.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/bind.hpp"
+#include "std/map.hpp"
+#include "std/sstream.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+#include "defines.hpp"
+
+namespace
+{
+using EntityType = OsmElement::EntityType;
+using Action = osm::OsmChange::Action;
+
+OsmElement MakeNode(uint64_t id, double lat, double lon)
+{
+  OsmElement e;
+  e.type = EntityType::Node;
+  e.id = id;
+  e.lat = lat;
+  e.lon = lon;
+  return e;
+}
+
+char const osc_data[] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="test">
+  <create>
+    <node id="10" version="1" lat="55.5" lon="37.6">
+      <tag k="amenity" v="cafe"/>
+    </node>
+  </create>
+  <modify>
+    <node id="11" version="2" lat="55.6" lon="37.7"/>
+    <way id="100" version="3">
+      <nd ref="10"/>
+      <nd ref="11"/>
+      <tag k="highway" v="primary"/>
+    </way>
+  </modify>
+  <delete>
+    <relation id="200" version="4">
+      <member type="way" ref="100" role="outer"/>
+    </relation>
+  </delete>
+  <modify>
+    <node id="10" version="2" lat="55.4" lon="37.6">
+      <tag k="amenity" v="cafe"/>
+    </node>
+  </modify>
+</osmChange>
+)";
+
+// Left and Right countries are split by the 1st meridian.
+char const left_poly[] = R"(Left
+1
+  0.0  0.0
+  1.0  0.0
+  1.0  1.0
+  0.0  1.0
+  0.0  0.0
+END
+END
+)";
+
+char const right_poly[] = R"(Right
+1
+  1.0  0.0
+  2.0  0.0
+  2.0  1.0
+  1.0  1.0
+  1.0  0.0
+END
+END
+)";
+
+char const planet_data[] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<osm version="0.6" generator="test">
+  <node id="1" lat="0.5" lon="0.5">
+    <tag k="amenity" v="cafe"/>
+  </node>
+  <node id="2" lat="0.6" lon="0.4">
+    <tag k="amenity" v="bank"/>
+  </node>
+  <node id="3" lat="0.2" lon="0.1"/>
+  <node id="4" lat="0.3" lon="0.2"/>
+  <node id="5" lat="0.2" lon="0.3"/>
+  <node id="6" lat="0.2" lon="1.2"/>
+  <node id="7" lat="0.2" lon="1.4"/>
+  <node id="8" lat="0.4" lon="1.4"/>
+  <node id="9" lat="0.4" lon="1.2"/>
+  <node id="12" lat="0.3" lon="0.2"/>
+  <node id="13" lat="0.4" lon="0.1"/>
+  <way id="10">
+    <nd ref="3"/>
+    <nd ref="4"/>
+    <nd ref="5"/>
+    <tag k="highway" v="residential"/>
+  </way>
+  <way id="20">
+    <nd ref="6"/>
+    <nd ref="7"/>
+    <nd ref="8"/>
+    <nd ref="9"/>
+    <nd ref="6"/>
+  </way>
+  <way id="40">
+    <nd ref="12"/>
+    <nd ref="13"/>
+    <tag k="highway" v="residential"/>
+  </way>
+  <relation id="30">
+    <member type="way" ref="20" role="outer"/>
+    <tag k="type" v="multipolygon"/>
+    <tag k="landuse" v="forest"/>
+  </relation>
+</osm>
+)";
+
+// The cafe moves to Right, the bank is deleted, a node of the road moves
+// and the outer way of the forest gets a new node. The other road has a node
+// at the old point of the moved one, which stays in place.
+char const planet_osc_data[] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="test">
+  <modify>
+    <node id="1" version="2" lat="0.5" lon="1.6">
+      <tag k="amenity" v="cafe"/>
+    </node>
+    <node id="4" version="2" lat="0.35" lon="0.2"/>
+  </modify>
+  <delete>
+    <node id="2" version="2" lat="0.6" lon="0.4"/>
+  </delete>
+  <create>
+    <node id="11" version="1" lat="0.3" lon="1.5"/>
+  </create>
+  <modify>
+    <way id="20" version="2">
+      <nd ref="6"/>
+      <nd ref="7"/>
+      <nd ref="11"/>
+      <nd ref="8"/>
+      <nd ref="9"/>
+      <nd ref="6"/>
+    </way>
+  </modify>
+</osmChange>
+)";
+
+void WriteFile(string const & fileName, string const & data)
+{
+  FileWriter writer(fileName);
+  writer.Write(data.data(), data.size());
+}
+
+string ReadFile(string const & fileName)
+{
+  string data;
+  FileReader(fileName).ReadAsString(data);
+  return data;
+}
+
+void RemoveDir(string const & dir)
+{
+  Platform::FilesList files;
+  Platform::GetFilesByType(dir, Platform::FILE_TYPE_REGULAR, files);
+  for (auto const & file : files)
+    FileWriter::DeleteFileX(my::JoinFoldersToPath(dir, file));
+  Platform::RmDir(dir);
+}
+
+map<osm::Id, FeatureBuilder1> ReadFeatures(string const & fileName)
+{
+  map<osm::Id, FeatureBuilder1> features;
+  feature::ForEachFromDatRawFormat(fileName, [&features](FeatureBuilder1 const & fb, uint64_t)
+  {
+    features[fb.GetLastOsmId()] = fb;
+  });
+  return features;
+}
+
+bool HasPoint(FeatureBuilder1 const & fb, double lat, double lon)
+{
+  m2::PointD const pt = MercatorBounds::FromLatLon(lat, lon);
+  auto const & points = fb.GetOuterGeometry();
+  return any_of(points.begin(), points.end(), [&pt](m2::PointD const & p)
+  {
+    return p.EqualDxDy(pt, 1e-5);
+  });
+}
+}  // namespace
+
+UNIT_TEST(OSM_Change_LastChangeWins)
+{
+  osm::OsmChange change;
+  change.Add(MakeNode(1, 10.0, 20.0), Action::Create);
+  change.Add(MakeNode(2, 10.0, 20.0), Action::Modify);
+  change.Add(MakeNode(1, 11.0, 21.0), Action::Modify);
+  change.Add(MakeNode(2, 10.0, 20.0), Action::Delete);
+
+  TEST_EQUAL(change.GetCount(EntityType::Node), 2, ());
+  TEST_EQUAL(change.GetCount(EntityType::Way), 0, ());
+
+  auto const * node = change.Find(EntityType::Node, 1);
+  TEST(node, ());
+  TEST_EQUAL(node->m_action, Action::Modify, ());
+  TEST_EQUAL(node->m_element.lat, 11.0, ());
+  TEST(!node->IsDeleted(), ());
+
+  node = change.Find(EntityType::Node, 2);
+  TEST(node, ());
+  TEST(node->IsDeleted(), ());
+
+  // Ids of different types don't mix.
+  TEST(!change.Find(EntityType::Way, 1), ());
+  TEST(!change.Find(EntityType::Node, 3), ());
+
+  size_t count = 0;
+  change.ForEach(EntityType::Node, [&count](osm::OsmChange::Element const &) { ++count; });
+  TEST_EQUAL(count, 2, ());
+}
+
+UNIT_TEST(OSM_Change_StringToAction)
+{
+  TEST_EQUAL(osm::OsmChange::StringToAction("create"), Action::Create, ());
+  TEST_EQUAL(osm::OsmChange::StringToAction("modify"), Action::Modify, ());
+  TEST_EQUAL(osm::OsmChange::StringToAction("delete"), Action::Delete, ());
+}
+
+UNIT_TEST(OSM_Change_FromXML)
+{
+  istringstream ss(osc_data);
+  SourceReader reader(ss);
+
+  osm::OsmChange change;
+  BuildChangeFromXML(reader, change);
+
+  TEST_EQUAL(change.GetCount(EntityType::Node), 2, ());
+  TEST_EQUAL(change.GetCount(EntityType::Way), 1, ());
+  TEST_EQUAL(change.GetCount(EntityType::Relation), 1, ());
+
+  auto const * node = change.Find(EntityType::Node, 10);
+  TEST(node, ());
+  TEST_EQUAL(node->m_action, Action::Modify, ());
+  TEST_EQUAL(node->m_element.lat, 55.4, ());
+  TEST_EQUAL(node->m_element.Tags().size(), 1, ());
+
+  auto const * way = change.Find(EntityType::Way, 100);
+  TEST(way, ());
+  TEST_EQUAL(way->m_action, Action::Modify, ());
+  TEST_EQUAL(way->m_element.Nodes(), vector<uint64_t>({10, 11}), ());
+  TEST_EQUAL(way->m_element.Tags().size(), 1, ());
+
+  auto const * relation = change.Find(EntityType::Relation, 200);
+  TEST(relation, ());
+  TEST(relation->IsDeleted(), ());
+  TEST_EQUAL(relation->m_element.Members().size(), 1, ());
+}
+
+// Features are generated from the planet, then countries are updated by the change.
+UNIT_TEST(OSM_Change_UpdateFeatures)
+{
+  classificator::Load();
+
+  feature::GenerateInfo info;
+  info.m_targetDir = info.m_intermediateDir = info.m_tmpDir =
+      my::JoinFoldersToPath(GetPlatform().WritableDir(), "osm_change_test/");
+  string const bordersDir = info.m_targetDir + BORDERS_DIR;
+  string const updateDir = info.m_tmpDir + "update/";
+  TEST_EQUAL(GetPlatform().MkDir(info.m_tmpDir), Platform::ERR_OK, ());
+  MY_SCOPE_GUARD(removeDir, bind(&RemoveDir, info.m_tmpDir));
+  TEST_EQUAL(GetPlatform().MkDir(bordersDir), Platform::ERR_OK, ());
+  MY_SCOPE_GUARD(removeBordersDir, bind(&RemoveDir, bordersDir));
+  TEST_EQUAL(GetPlatform().MkDir(updateDir), Platform::ERR_OK, ());
+  MY_SCOPE_GUARD(removeUpdateDir, bind(&RemoveDir, updateDir));
+
+  WriteFile(bordersDir + "Left" BORDERS_EXTENSION, left_poly);
+  WriteFile(bordersDir + "Right" BORDERS_EXTENSION, right_poly);
+  info.m_osmFileName = info.m_tmpDir + "planet.osm";
+  WriteFile(info.m_osmFileName, planet_data);
+  info.m_osmChangeFiles.push_back(info.m_tmpDir + "planet.osc");
+  WriteFile(info.m_osmChangeFiles.back(), planet_osc_data);
+
+  info.m_osmFileType = feature::GenerateInfo::OsmSourceType::XML;
+  info.m_nodeStorageType = feature::GenerateInfo::NodeStorageType::Index;
+  info.m_splitByPolygons = true;
+
+  TEST(GenerateIntermediateData(info), ());
+  TEST(GenerateFeatures(info), ());
+  sort(info.m_bucketNames.begin(), info.m_bucketNames.end());
+  TEST_EQUAL(info.m_bucketNames, vector<string>({"Left", "Right"}), ());
+
+  string const leftData = ReadFile(info.GetTmpFileName("Left"));
+  string const rightData = ReadFile(info.GetTmpFileName("Right"));
+  {
+    auto const left = ReadFeatures(info.GetTmpFileName("Left"));
+    TEST_EQUAL(left.size(), 4, ());
+    TEST_EQUAL(left.count(osm::Id::Node(1)), 1, ());
+    TEST_EQUAL(left.count(osm::Id::Node(2)), 1, ());
+    TEST_EQUAL(left.count(osm::Id::Way(10)), 1, ());
+    TEST_EQUAL(left.count(osm::Id::Way(40)), 1, ());
+
+    auto const right = ReadFeatures(info.GetTmpFileName("Right"));
+    TEST_EQUAL(right.size(), 1, ());
+    TEST_EQUAL(right.count(osm::Id::Relation(30)), 1, ());
+  }
+
+  info.m_bucketNames.clear();
+  info.m_baseTmpDir = info.m_tmpDir;
+  info.m_tmpDir = updateDir;
+  TEST(UpdateFeatures(info), ());
+  TEST_EQUAL(info.m_bucketNames, vector<string>({"Left", "Right"}), ());
+
+  // Base files are kept.
+  TEST(ReadFile(my::JoinFoldersToPath(info.m_baseTmpDir, "Left" DATA_FILE_EXTENSION_TMP)) ==
+           leftData, ());
+  TEST(ReadFile(my::JoinFoldersToPath(info.m_baseTmpDir, "Right" DATA_FILE_EXTENSION_TMP)) ==
+           rightData, ());
+
+  auto const left = ReadFeatures(info.GetTmpFileName("Left"));
+  TEST_EQUAL(left.size(), 2, ());
+  auto const road = left.find(osm::Id::Way(10));
+  TEST(road != left.end(), ());
+  TEST(HasPoint(road->second, 0.35, 0.2), ());
+  TEST(!HasPoint(road->second, 0.3, 0.2), ());
+  auto const otherRoad = left.find(osm::Id::Way(40));
+  TEST(otherRoad != left.end(), ());
+  TEST(HasPoint(otherRoad->second, 0.3, 0.2), ());
+  TEST(!HasPoint(otherRoad->second, 0.35, 0.2), ());
+
+  auto const right = ReadFeatures(info.GetTmpFileName("Right"));
+  TEST_EQUAL(right.size(), 2, ());
+  auto const cafe = right.find(osm::Id::Node(1));
+  TEST(cafe != right.end(), ());
+  TEST(cafe->second.GetKeyPoint().EqualDxDy(MercatorBounds::FromLatLon(0.5, 1.6), 1e-5), ());
+  auto const forest = right.find(osm::Id::Relation(30));
+  TEST(forest != right.end(), ());
+  TEST(HasPoint(forest->second, 0.3, 1.5), ());
+}
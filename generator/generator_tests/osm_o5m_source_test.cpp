@@ -1,5 +1,6 @@
 #include "testing/testing.hpp"
 
+#include "generator/osm_o5m_pipeline.hpp"
 #include "generator/osm_o5m_source.hpp"
 #include "std/iterator.hpp"
 #include "std/set.hpp"
@@ -181,3 +182,67 @@ UNIT_TEST(OSM_O5M_Source_Relation_read_test)
     }
   }
 }
+
+UNIT_TEST(OSM_O5M_Pipeline_test)
+{
+  string const data(begin(relation_o5m_data), end(relation_o5m_data));
+  auto const convert = [](osm::O5MSource::Entity const & em, OsmElement & p)
+  {
+    osm::ConvertO5MEntity(em, p, true /* filterTags */);
+  };
+
+  vector<OsmElement> expected;
+  {
+    stringstream ss(data);
+    osm::O5MSource dataset([&ss](uint8_t * buffer, size_t size)
+    {
+      return ss.read(reinterpret_cast<char *>(buffer), size).gcount();
+    }, 10 /* buffer size */);
+    for (auto const & em : dataset)
+    {
+      expected.emplace_back();
+      convert(em, expected.back());
+    }
+  }
+  TEST_GREATER(expected.size(), 2, ());
+
+  // Small blocks and batches to split entities between them.
+  stringstream ss(data);
+  osm::O5MPipeline pipeline([&ss](uint8_t * buffer, size_t size)
+  {
+    return ss.read(reinterpret_cast<char *>(buffer), size).gcount();
+  }, convert, 7 /* block size */, 2 /* batch size */);
+
+  vector<OsmElement> elements;
+  pipeline.Run([&elements](OsmElement * e) { elements.push_back(*e); });
+  TEST_EQUAL(elements, expected, ());
+}
+
+// An error of the reader is passed to the processing thread.
+UNIT_TEST(OSM_O5M_Pipeline_ReadError_test)
+{
+  string const data(begin(relation_o5m_data), end(relation_o5m_data));
+  stringstream ss(data);
+  size_t readsCount = 0;
+  osm::O5MPipeline pipeline([&ss, &readsCount](uint8_t * buffer, size_t size) -> size_t
+  {
+    if (++readsCount == 3)
+      throw runtime_error("Read error");
+    return ss.read(reinterpret_cast<char *>(buffer), size).gcount();
+  }, [](osm::O5MSource::Entity const & em, OsmElement & p)
+  {
+    osm::ConvertO5MEntity(em, p, true /* filterTags */);
+  }, 7 /* block size */, 2 /* batch size */);
+
+  bool thrown = false;
+  try
+  {
+    pipeline.Run([](OsmElement *) {});
+  }
+  catch (runtime_error const & e)
+  {
+    thrown = true;
+    TEST_EQUAL(string(e.what()), "Read error", ());
+  }
+  TEST(thrown, ());
+}
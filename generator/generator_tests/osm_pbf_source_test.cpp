@@ -0,0 +1,316 @@
+#include "testing/testing.hpp"
+
+#include "generator/osm_element.hpp"
+#include "generator/osm_pbf_source.hpp"
+
+#include "base/math.hpp"
+
+#include "std/sstream.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+#include <zlib.h>
+
+namespace
+{
+/// Writer of protocol buffers wire format to build test files.
+class ProtobufWriter
+{
+public:
+  void Varint(uint32_t field, uint64_t value)
+  {
+    Key(field, 0);
+    WriteVarint(value);
+  }
+
+  void SVarint(uint32_t field, int64_t value) { Varint(field, ZigZag(value)); }
+
+  void Bytes(uint32_t field, string const & value)
+  {
+    Key(field, 2);
+    WriteVarint(value.size());
+    m_data += value;
+  }
+
+  /// Writes packed repeated field of delta coded sint64 values.
+  void PackedDelta(uint32_t field, vector<int64_t> const & values)
+  {
+    ProtobufWriter packed;
+    int64_t prev = 0;
+    for (int64_t v : values)
+    {
+      packed.WriteVarint(ZigZag(v - prev));
+      prev = v;
+    }
+    Bytes(field, packed.m_data);
+  }
+
+  void Packed(uint32_t field, vector<uint64_t> const & values)
+  {
+    ProtobufWriter packed;
+    for (uint64_t v : values)
+      packed.WriteVarint(v);
+    Bytes(field, packed.m_data);
+  }
+
+  string const & Data() const { return m_data; }
+
+private:
+  static uint64_t ZigZag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ (v >> 63); }
+
+  void Key(uint32_t field, uint32_t wireType) { WriteVarint((field << 3) | wireType); }
+
+  void WriteVarint(uint64_t value)
+  {
+    while (value >= 0x80)
+    {
+      m_data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    m_data.push_back(static_cast<char>(value));
+  }
+
+  string m_data;
+};
+
+void WriteBlob(string const & type, string const & data, bool compress, string & file)
+{
+  ProtobufWriter blob;
+  if (compress)
+  {
+    uLongf size = compressBound(data.size());
+    string zlibData(size, 0);
+    TEST_EQUAL(compress2(reinterpret_cast<Bytef *>(&zlibData[0]), &size,
+                         reinterpret_cast<Bytef const *>(data.data()), data.size(), 9),
+               Z_OK, ());
+    zlibData.resize(size);
+    blob.Varint(2, data.size());
+    blob.Bytes(3, zlibData);
+  }
+  else
+  {
+    blob.Bytes(1, data);
+  }
+
+  ProtobufWriter header;
+  header.Bytes(1, type);
+  header.Varint(3, blob.Data().size());
+
+  uint32_t const size = header.Data().size();
+  char const sizeBytes[4] = {static_cast<char>(size >> 24), static_cast<char>(size >> 16),
+                             static_cast<char>(size >> 8), static_cast<char>(size)};
+  file.append(sizeBytes, sizeof(sizeBytes));
+  file += header.Data();
+  file += blob.Data();
+}
+
+string MakeHeaderBlock(vector<string> const & features)
+{
+  ProtobufWriter block;
+  for (auto const & feature : features)
+    block.Bytes(4, feature);
+  return block.Data();
+}
+
+string MakeStringTable(vector<string> const & strings)
+{
+  ProtobufWriter table;
+  for (auto const & s : strings)
+    table.Bytes(1, s);
+  return table.Data();
+}
+
+// Strings: 1 amenity, 2 cafe, 3 name, 4 Sun, 5 highway, 6 primary, 7 type, 8 route, 9 outer.
+vector<string> const kStrings = {"", "amenity", "cafe", "name", "Sun", "highway", "primary",
+                                 "type", "route", "outer"};
+
+string MakeNodesBlock()
+{
+  ProtobufWriter dense;
+  dense.PackedDelta(1, {10, 11, 15});
+  // Granularity is 100 and coordinates are in 1e-7 degrees.
+  dense.PackedDelta(8, {555000000, 555000100, -100000000});
+  dense.PackedDelta(9, {376000000, 376000200, 1800000000});
+  dense.Packed(10, {1, 2, 3, 4, 0, 0, 5, 6, 0});
+
+  ProtobufWriter node;
+  node.SVarint(1, 20);
+  node.Packed(2, {3});
+  node.Packed(3, {4});
+  node.SVarint(8, 1);
+  node.SVarint(9, -1);
+
+  ProtobufWriter group;
+  group.Bytes(2, dense.Data());
+  group.Bytes(1, node.Data());
+
+  ProtobufWriter block;
+  block.Bytes(1, MakeStringTable(kStrings));
+  block.Bytes(2, group.Data());
+  return block.Data();
+}
+
+string MakeWaysBlock()
+{
+  ProtobufWriter way;
+  way.Varint(1, 100);
+  // Unpacked repeated fields are accepted too.
+  way.Varint(2, 5);
+  way.Varint(3, 6);
+  way.PackedDelta(8, {10, 11, 15, 10});
+
+  ProtobufWriter relation;
+  relation.Varint(1, 200);
+  relation.Packed(2, {7});
+  relation.Packed(3, {8});
+  relation.Packed(8, {9, 0});
+  relation.PackedDelta(9, {100, 15});
+  relation.Packed(10, {1, 0});
+
+  ProtobufWriter ways;
+  ways.Bytes(3, way.Data());
+  ProtobufWriter relations;
+  relations.Bytes(4, relation.Data());
+
+  ProtobufWriter block;
+  block.Bytes(1, MakeStringTable(kStrings));
+  block.Bytes(2, ways.Data());
+  block.Bytes(2, relations.Data());
+  // Granularity and offsets are after the groups.
+  block.Varint(17, 1000);
+  block.Varint(19, 5);
+  return block.Data();
+}
+
+OsmElement MakeNode(uint64_t id, double lat, double lon, vector<OsmElement::Tag> const & tags)
+{
+  OsmElement e;
+  e.type = OsmElement::EntityType::Node;
+  e.id = id;
+  e.lat = lat;
+  e.lon = lon;
+  e.m_tags = tags;
+  return e;
+}
+
+vector<OsmElement> MakeExpected()
+{
+  vector<OsmElement> expected;
+  expected.push_back(MakeNode(10, 55.5, 37.6, {{"amenity", "cafe"}, {"name", "Sun"}}));
+  expected.push_back(MakeNode(11, 55.50001, 37.60002, {}));
+  expected.push_back(MakeNode(15, -10.0, 180.0, {{"highway", "primary"}}));
+  expected.push_back(MakeNode(20, 1E-7, -1E-7, {{"name", "Sun"}}));
+
+  OsmElement way;
+  way.type = OsmElement::EntityType::Way;
+  way.id = 100;
+  for (uint64_t nd : {10, 11, 15, 10})
+    way.AddNd(nd);
+  way.m_tags = {{"highway", "primary"}};
+  expected.push_back(way);
+
+  OsmElement relation;
+  relation.type = OsmElement::EntityType::Relation;
+  relation.id = 200;
+  relation.AddMember(100, OsmElement::EntityType::Way, "outer");
+  relation.AddMember(15, OsmElement::EntityType::Node, "");
+  relation.m_tags = {{"type", "route"}};
+  expected.push_back(relation);
+  return expected;
+}
+
+vector<OsmElement> ReadPbf(string const & data, uint32_t threadsCount)
+{
+  stringstream ss(data);
+  osm::PbfSource source([&ss](char * buffer, size_t size)
+  {
+    return ss.read(buffer, size).gcount();
+  }, threadsCount, false /* filterTags */);
+
+  vector<OsmElement> elements;
+  source.Run([&elements](OsmElement * e) { elements.push_back(*e); });
+  return elements;
+}
+
+void TestElements(vector<OsmElement> const & elements, vector<OsmElement> const & expected)
+{
+  TEST_EQUAL(elements.size(), expected.size(), ());
+  for (size_t i = 0; i < min(elements.size(), expected.size()); ++i)
+  {
+    // Coordinates are compared approximately, other fields must be equal.
+    OsmElement e = elements[i];
+    TEST(my::AlmostEqualAbs(e.lat, expected[i].lat, 1E-9), (i, e.lat));
+    TEST(my::AlmostEqualAbs(e.lon, expected[i].lon, 1E-9), (i, e.lon));
+    e.lat = expected[i].lat;
+    e.lon = expected[i].lon;
+    TEST_EQUAL(e, expected[i], (i));
+  }
+}
+
+bool IsFormatError(string const & data, uint32_t threadsCount)
+{
+  try
+  {
+    ReadPbf(data, threadsCount);
+  }
+  catch (osm::PbfFormatException const &)
+  {
+    return true;
+  }
+  return false;
+}
+}  // namespace
+
+UNIT_TEST(OSM_PBF_Source_Smoke)
+{
+  string data;
+  WriteBlob("OSMHeader", MakeHeaderBlock({"OsmSchema-V0.6", "DenseNodes"}), false, data);
+  WriteBlob("OSMData", MakeNodesBlock(), false, data);
+  WriteBlob("OSMData", MakeWaysBlock(), true, data);
+
+  vector<OsmElement> const expected = MakeExpected();
+  TestElements(ReadPbf(data, 1), expected);
+  TestElements(ReadPbf(data, 4), expected);
+}
+
+UNIT_TEST(OSM_PBF_Source_Order)
+{
+  string data;
+  WriteBlob("OSMHeader", MakeHeaderBlock({"OsmSchema-V0.6"}), true, data);
+  vector<OsmElement> expected;
+  vector<OsmElement> const blockElements = MakeExpected();
+  // The nodes block has four nodes, the ways block has a way and a relation.
+  auto const nodesEnd = blockElements.begin() + 4;
+  for (size_t i = 0; i < 50; ++i)
+  {
+    bool const isNodes = i % 2 == 0;
+    WriteBlob("OSMData", isNodes ? MakeNodesBlock() : MakeWaysBlock(), i % 3 == 0, data);
+    if (isNodes)
+      expected.insert(expected.end(), blockElements.begin(), nodesEnd);
+    else
+      expected.insert(expected.end(), nodesEnd, blockElements.end());
+  }
+
+  // Elements are processed in the file's order whatever the number of threads.
+  TestElements(ReadPbf(data, 1), expected);
+  TestElements(ReadPbf(data, 3), expected);
+  TestElements(ReadPbf(data, 8), expected);
+}
+
+UNIT_TEST(OSM_PBF_Source_Errors)
+{
+  for (uint32_t threadsCount : {1, 4})
+  {
+    string data;
+    WriteBlob("OSMHeader", MakeHeaderBlock({"OsmSchema-V0.6", "HistoricalInformation"}), false,
+              data);
+    WriteBlob("OSMData", MakeNodesBlock(), false, data);
+    TEST(IsFormatError(data, threadsCount), (threadsCount));
+
+    data.clear();
+    WriteBlob("OSMData", MakeNodesBlock(), true, data);
+    WriteBlob("OSMData", MakeWaysBlock(), true, data);
+    data.resize(data.size() - 10);
+    TEST(IsFormatError(data, threadsCount), (threadsCount));
+  }
+}
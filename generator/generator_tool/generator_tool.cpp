@@ -8,6 +8,8 @@
 #include "generator/unpack_mwm.hpp"
 #include "generator/generate_info.hpp"
 #include "generator/check_model.hpp"
+#include "generator/contraction_hierarchy_generator.hpp"
+#include "generator/landmarks_generator.hpp"
 #include "generator/routing_generator.hpp"
 #include "generator/osm_source.hpp"
 
@@ -21,6 +23,8 @@
 
 #include "coding/file_name_utils.hpp"
 
+#include "base/stl_add.hpp"
+#include "base/string_utils.hpp"
 #include "base/timer.hpp"
 
 #include "defines.hpp"
@@ -46,12 +50,15 @@ DEFINE_bool(emit_coasts, false, "push coasts features from intermediate file to
 
 DEFINE_bool(generate_features, false, "2nd pass - generate intermediate features");
 DEFINE_bool(generate_geometry, false, "3rd pass - split and simplify geometry and triangles for features");
+DEFINE_uint64(threads_count, 0, "Number of threads for --generate_geometry, --split_by_polygons and o5m and pbf decoding in --preprocess and --generate_features, 0 to use all cores");
 DEFINE_bool(generate_index, false, "4rd pass - generate index");
 DEFINE_bool(generate_search_index, false, "5th pass - generate search index");
+DEFINE_uint64(search_index_threads, 0, "Number of threads for --generate_search_index, 0 to use all cores");
+DEFINE_bool(succinct_search_index, false, "Generate succinct search index instead of the default trie");
 DEFINE_bool(calc_statistics, false, "Calculate feature statistics for specified mwm bucket files");
 DEFINE_bool(type_statistics, false, "Calculate statistics by type for specified mwm bucket files");
 DEFINE_bool(preload_cache, false, "Preload all ways and relations cache");
-DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem");
+DEFINE_string(node_storage, "map", "Type of storage for intermediate points representation. Available: raw, map, mem, sorted");
 DEFINE_string(data_path, "", "Working directory, 'path_to_exe/../../data' if empty.");
 DEFINE_string(output, "", "File name for process (without 'mwm' ext).");
 DEFINE_string(intermediate_data_path, "", "Path to stored nodes, ways, relations.");
@@ -69,8 +76,13 @@ DEFINE_bool(generate_addresses_file, false, "Generate .addr file (for '--output'
 DEFINE_string(osrm_file_name, "", "Input osrm file to generate routing info");
 DEFINE_bool(make_routing, false, "Make routing info based on osrm file");
 DEFINE_bool(make_cross_section, false, "Make corss section in routing file for cross mwm routing");
+DEFINE_bool(make_cross_mwm_overlay, false, "Merge cross sections of all routing files in data_path into one overlay file");
+DEFINE_bool(make_landmarks, false, "Make landmarks section in mwm for pedestrian routing");
+DEFINE_uint64(landmarks_count, 8, "Number of landmarks for --make_landmarks, 8 to 16 is reasonable");
+DEFINE_bool(make_pedestrian_ch, false, "Make contraction hierarchy section in mwm for pedestrian routing");
 DEFINE_string(osm_file_name, "", "Input osm area file");
-DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m]");
+DEFINE_string(osm_file_type, "xml", "Input osm area file type [xml, o5m, pbf]");
+DEFINE_string(osm_change, "", "Comma separated OSM change files (.osc) to update features of countries by --generate_features with intermediate data of --preprocess. Updated .mwm.tmp files are written to the osm_change subdirectory of the .mwm.tmp files directory");
 DEFINE_string(user_resource_path, "", "User defined resource path for classificator.txt and etc.");
 DEFINE_uint64(planet_version, my::TodayAsYYMMDD(), "Version as YYMMDD, by default - today");
 
@@ -107,6 +119,7 @@ int main(int argc, char ** argv)
   genInfo.m_preloadCache = FLAGS_preload_cache;
 
   genInfo.m_versionDate = static_cast<uint32_t>(FLAGS_planet_version);
+  genInfo.m_threadsCount = static_cast<uint32_t>(FLAGS_threads_count);
 
   if (!FLAGS_node_storage.empty())
     genInfo.SetNodeStorageType(FLAGS_node_storage);
@@ -127,7 +140,7 @@ int main(int argc, char ** argv)
   if (FLAGS_make_coasts || FLAGS_generate_features || FLAGS_generate_geometry ||
       FLAGS_generate_index || FLAGS_generate_search_index ||
       FLAGS_calc_statistics || FLAGS_type_statistics || FLAGS_dump_types || FLAGS_dump_prefixes ||
-      FLAGS_check_mwm)
+      FLAGS_check_mwm || FLAGS_make_landmarks || FLAGS_make_pedestrian_ch)
   {
     classificator::Load();
     classif().SortClassificator();
@@ -145,10 +158,27 @@ int main(int argc, char ** argv)
     genInfo.m_fileName = FLAGS_output;
     genInfo.m_genAddresses = FLAGS_generate_addresses_file;
 
-    if (!GenerateFeatures(genInfo))
+    if (!FLAGS_osm_change.empty())
+    {
+      strings::Tokenize(FLAGS_osm_change, ",", MakeBackInsertFunctor(genInfo.m_osmChangeFiles));
+
+      // Base .mwm.tmp files are kept, the following passes read the updated ones.
+      genInfo.m_baseTmpDir = genInfo.m_tmpDir;
+      genInfo.m_tmpDir = genInfo.m_baseTmpDir + "osm_change" + my::GetNativeSeparator();
+      if (pl.MkDir(genInfo.m_tmpDir) == Platform::ERR_UNKNOWN)
+      {
+        LOG(LCRITICAL, ("Can't create directory", genInfo.m_tmpDir));
+        return -1;
+      }
+      if (!UpdateFeatures(genInfo))
+        return -1;
+    }
+    else if (!GenerateFeatures(genInfo))
+    {
       return -1;
+    }
 
-    if (FLAGS_generate_world)
+    if (FLAGS_generate_world && FLAGS_osm_change.empty())
     {
       genInfo.m_bucketNames.push_back(WORLD_FILE_NAME);
       genInfo.m_bucketNames.push_back(WORLD_COASTS_FILE_NAME);
@@ -197,7 +227,10 @@ int main(int argc, char ** argv)
     {
       LOG(LINFO, ("Generating search index for ", datFile));
 
-      if (!indexer::BuildSearchIndexFromDatFile(datFile, true))
+      if (!indexer::BuildSearchIndexFromDatFile(
+              datFile, true, static_cast<uint32_t>(FLAGS_search_index_threads),
+              FLAGS_succinct_search_index ? indexer::SearchIndexFormat::Succinct
+                                          : indexer::SearchIndexFormat::Trie))
         LOG(LCRITICAL, ("Error generating search index."));
     }
   }
@@ -259,5 +292,24 @@ int main(int argc, char ** argv)
   if (!FLAGS_osrm_file_name.empty() && FLAGS_make_cross_section)
     routing::BuildCrossRoutingIndex(path, FLAGS_output, FLAGS_osrm_file_name);
 
+  if (FLAGS_make_cross_mwm_overlay)
+    routing::BuildCrossMwmOverlay(path);
+
+  if (FLAGS_make_landmarks)
+  {
+    LOG(LINFO, ("Generating landmarks for", datFile));
+
+    if (!routing::BuildLandmarks(path, FLAGS_output, static_cast<uint32_t>(FLAGS_landmarks_count)))
+      LOG(LCRITICAL, ("Error generating landmarks."));
+  }
+
+  if (FLAGS_make_pedestrian_ch)
+  {
+    LOG(LINFO, ("Generating pedestrian contraction hierarchy for", datFile));
+
+    if (!routing::BuildPedestrianContractionHierarchy(path, FLAGS_output))
+      LOG(LCRITICAL, ("Error generating pedestrian contraction hierarchy."));
+  }
+
   return 0;
 }
@@ -0,0 +1,242 @@
+#include "generator/intermediate_data.hpp"
+
+#include "coding/byte_stream.hpp"
+#include "coding/varint.hpp"
+
+#include "base/logging.hpp"
+#include "base/string_utils.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/queue.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
+
+namespace cache
+{
+namespace detail
+{
+namespace
+{
+using TPoint = PointStorage::LatLonPos;
+
+// Parts smaller than this are not sorted on a separate thread.
+size_t constexpr kMinPointsToSortOnThread = 1 << 16;
+size_t constexpr kRunBufferPoints = 1 << 16;
+// Points files are read sequentially by big chunks, so pages of readers are big.
+uint32_t constexpr kLogPageSize = 20;
+uint32_t constexpr kLogPageCount = 1;
+
+bool LessById(TPoint const & p1, TPoint const & p2) { return p1.pos < p2.pos; }
+
+/// Sorts parts of points on threads and then merges them level by level,
+/// merges of one level are done on threads too.
+void SortPoints(vector<TPoint> & points, uint32_t threadsCount)
+{
+  size_t const partsCount =
+      max(min(static_cast<size_t>(threadsCount), points.size() / kMinPointsToSortOnThread),
+          static_cast<size_t>(1));
+
+  vector<vector<TPoint>::iterator> bounds;
+  for (size_t i = 0; i <= partsCount; ++i)
+    bounds.push_back(points.begin() + points.size() * i / partsCount);
+
+  {
+    vector<thread> threads;
+    for (size_t i = 0; i < partsCount; ++i)
+      threads.emplace_back([&bounds, i]() { sort(bounds[i], bounds[i + 1], &LessById); });
+    for (auto & t : threads)
+      t.join();
+  }
+
+  for (size_t width = 1; width < partsCount; width *= 2)
+  {
+    vector<thread> threads;
+    for (size_t i = 0; i + width < partsCount; i += 2 * width)
+    {
+      auto const first = bounds[i];
+      auto const middle = bounds[i + width];
+      auto const last = bounds[min(i + 2 * width, partsCount)];
+      threads.emplace_back([first, middle, last]()
+      {
+        inplace_merge(first, middle, last, &LessById);
+      });
+    }
+    for (auto & t : threads)
+      t.join();
+  }
+}
+
+/// Writes sorted points to blocks of kSortedPointsBlockIds ids.
+class BlocksWriter
+{
+public:
+  explicit BlocksWriter(Writer & writer)
+    : m_writer(writer), m_start(writer.Pos()), m_lastId(0), m_lat(0), m_lon(0)
+  {
+  }
+
+  void Add(TPoint const & p)
+  {
+    if (!m_offsets.empty() && p.pos <= m_lastId)
+    {
+      // Points are sorted, so the same id was added again, the first point is kept.
+      LOG(LWARNING, ("Duplicate node", p.pos));
+      return;
+    }
+
+    uint64_t const block = p.pos / kSortedPointsBlockIds;
+    if (block + 1 != m_offsets.size())
+    {
+      FlushBlock();
+      while (m_offsets.size() <= block)
+        m_offsets.push_back(m_writer.Pos() - m_start);
+      m_lastId = block * kSortedPointsBlockIds;
+      m_lat = 0;
+      m_lon = 0;
+    }
+
+    PushBackByteSink<vector<uint8_t>> sink(m_block);
+    WriteVarUint(sink, p.pos - m_lastId);
+    WriteVarInt(sink, static_cast<int64_t>(p.lat) - m_lat);
+    WriteVarInt(sink, static_cast<int64_t>(p.lon) - m_lon);
+    m_lastId = p.pos;
+    m_lat = p.lat;
+    m_lon = p.lon;
+  }
+
+  void Finish()
+  {
+    FlushBlock();
+    m_offsets.push_back(m_writer.Pos() - m_start);
+    uint64_t const count = m_offsets.size();
+    m_writer.Write(m_offsets.data(), count * sizeof(uint64_t));
+    m_writer.Write(&count, sizeof(count));
+    LOG(LINFO, ("Nodes are written to", count - 1, "blocks,", m_writer.Pos() - m_start, "bytes"));
+  }
+
+private:
+  void FlushBlock()
+  {
+    if (m_block.empty())
+      return;
+    m_writer.Write(m_block.data(), m_block.size());
+    m_block.clear();
+  }
+
+  Writer & m_writer;
+  uint64_t const m_start;
+  vector<uint64_t> m_offsets;
+  vector<uint8_t> m_block;
+  uint64_t m_lastId;
+  int64_t m_lat;
+  int64_t m_lon;
+};
+
+/// Buffered reader of a sorted run of points.
+class RunReader
+{
+public:
+  explicit RunReader(string const & fileName)
+    : m_reader(fileName, kLogPageSize, kLogPageCount), m_pos(0), m_index(0)
+  {
+    ReadBuffer();
+  }
+
+  bool IsEmpty() const { return m_index == m_buffer.size(); }
+  TPoint const & Top() const { return m_buffer[m_index]; }
+
+  void Pop()
+  {
+    if (++m_index == m_buffer.size())
+      ReadBuffer();
+  }
+
+private:
+  void ReadBuffer()
+  {
+    uint64_t const size = min(m_reader.Size() - m_pos,
+                              static_cast<uint64_t>(kRunBufferPoints * sizeof(TPoint)));
+    m_buffer.resize(size / sizeof(TPoint));
+    m_reader.Read(m_pos, m_buffer.data(), m_buffer.size() * sizeof(TPoint));
+    m_pos += m_buffer.size() * sizeof(TPoint);
+    m_index = 0;
+  }
+
+  FileReader m_reader;
+  uint64_t m_pos;
+  vector<TPoint> m_buffer;
+  size_t m_index;
+};
+
+void MergeRuns(vector<string> const & runFiles, BlocksWriter & writer)
+{
+  vector<unique_ptr<RunReader>> runs;
+  for (auto const & runFile : runFiles)
+    runs.emplace_back(new RunReader(runFile));
+
+  using TItem = pair<uint64_t, size_t>;
+  priority_queue<TItem, vector<TItem>, greater<TItem>> queue;
+  for (size_t i = 0; i < runs.size(); ++i)
+  {
+    if (!runs[i]->IsEmpty())
+      queue.emplace(runs[i]->Top().pos, i);
+  }
+
+  while (!queue.empty())
+  {
+    size_t const index = queue.top().second;
+    queue.pop();
+    RunReader & run = *runs[index];
+    writer.Add(run.Top());
+    run.Pop();
+    if (!run.IsEmpty())
+      queue.emplace(run.Top().pos, index);
+  }
+}
+}  // namespace
+
+void BuildSortedPoints(string const & unsortedFile, Writer & writer, uint32_t threadsCount,
+                       size_t maxPointsInMemory)
+{
+  FileReader reader(unsortedFile, kLogPageSize, kLogPageCount);
+  uint64_t const fileSize = reader.Size();
+  CHECK_EQUAL(fileSize % sizeof(TPoint), 0, ("Damaged file."));
+  uint64_t const count = fileSize / sizeof(TPoint);
+
+  BlocksWriter blocksWriter(writer);
+  vector<TPoint> points;
+  if (count <= maxPointsInMemory)
+  {
+    points.resize(count);
+    reader.Read(0, points.data(), fileSize);
+    SortPoints(points, threadsCount);
+    for (auto const & p : points)
+      blocksWriter.Add(p);
+    blocksWriter.Finish();
+    return;
+  }
+
+  // External sort: runs are sorted in memory and are merged from files.
+  vector<string> runFiles;
+  for (uint64_t first = 0; first < count; first += maxPointsInMemory)
+  {
+    points.resize(min(static_cast<uint64_t>(maxPointsInMemory), count - first));
+    reader.Read(first * sizeof(TPoint), points.data(), points.size() * sizeof(TPoint));
+    SortPoints(points, threadsCount);
+
+    runFiles.push_back(unsortedFile + "." + strings::to_string(runFiles.size()));
+    FileWriter runWriter(runFiles.back());
+    runWriter.Write(points.data(), points.size() * sizeof(TPoint));
+  }
+  points.clear();
+  points.shrink_to_fit();
+
+  LOG(LINFO, ("Merging", runFiles.size(), "sorted runs of nodes"));
+  MergeRuns(runFiles, blocksWriter);
+  blocksWriter.Finish();
+
+  for (auto const & runFile : runFiles)
+    FileWriter::DeleteFileX(runFile);
+}
+}  // namespace detail
+}  // namespace cache
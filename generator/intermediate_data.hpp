@@ -2,10 +2,12 @@
 
 #include "generator/intermediate_elements.hpp"
 
+#include "coding/byte_stream.hpp"
 #include "coding/file_name_utils.hpp"
 #include "coding/file_reader.hpp"
 #include "coding/file_writer.hpp"
 #include "coding/mmap_reader.hpp"
+#include "coding/varint.hpp"
 
 #include "base/logging.hpp"
 
@@ -13,6 +15,7 @@
 #include "std/deque.hpp"
 #include "std/exception.hpp"
 #include "std/limits.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
@@ -241,6 +244,10 @@ public:
 
   inline size_t GetProcessedPoint() const { return m_processedPoint; }
   inline void IncProcessedPoint() { ++m_processedPoint; }
+
+  /// Is called when all points are added, storages which need to process
+  /// the added points override it, see SortedFilePointStorage::Finish.
+  void Finish(uint32_t /* threadsCount */) {}
 };
 
 template <EMode TMode>
@@ -425,4 +432,150 @@ public:
   }
 };
 
+namespace detail
+{
+/// Sorts points of the unsorted file of PointStorage::LatLonPos by id and writes
+/// them in the format of SortedFilePointStorage. Points are sorted on threadsCount
+/// threads by runs of maxPointsInMemory points, which are merged on disk.
+void BuildSortedPoints(string const & unsortedFile, Writer & writer, uint32_t threadsCount,
+                       size_t maxPointsInMemory);
+
+/// Number of ids in a block of SortedFilePointStorage.
+uint64_t constexpr kSortedPointsBlockIds = 256;
+/// Maximum size of a block: two bytes of id and five bytes of every coordinate for a point.
+size_t constexpr kSortedPointsMaxBlockSize = kSortedPointsBlockIds * 12;
+}  // namespace detail
+
+/// Stores nodes sorted by id in blocks of kSortedPointsBlockIds consecutive ids.
+/// Ids and coordinates are delta coded in a block, and the block of id is found
+/// by the table of blocks offsets at the end of file:
+/// [blocks][offset of every block and end of blocks: uint64_t][size of table: uint64_t]
+/// Points are written unsorted and sorted by Finish of the storage for writing.
+template <EMode TMode>
+class SortedFilePointStorage : public PointStorage
+{
+#ifdef OMIM_OS_WINDOWS
+  using TFileReader = FileReader;
+#else
+  using TFileReader = MmapReader;
+#endif
+
+  typename conditional<TMode == EMode::Write, FileWriter, TFileReader>::type m_file;
+  unique_ptr<FileWriter> m_unsortedFile;
+  vector<uint64_t> m_offsets;
+
+  constexpr static double const kValueOrder = 1E+7;
+  static size_t constexpr kMaxPointsInMemory = 1 << 26;
+
+public:
+  explicit SortedFilePointStorage(string const & name) : m_file(name + ".sorted")
+  {
+    InitStorage<TMode>();
+  }
+
+  ~SortedFilePointStorage() { DoneStorage<TMode>(); }
+
+  /// Sorts the added points on threadsCount threads. Nothing can be added after it.
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Write, void>::type Finish(uint32_t threadsCount)
+  {
+    CHECK(m_unsortedFile, ("Finish() already was called."));
+    string const unsortedFile = m_unsortedFile->GetName();
+    m_unsortedFile.reset();
+
+    LOG(LINFO, ("Nodes sorting is started"));
+    detail::BuildSortedPoints(unsortedFile, m_file, threadsCount, kMaxPointsInMemory);
+    LOG(LINFO, ("Nodes sorting is finished"));
+    FileWriter::DeleteFileX(unsortedFile);
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type InitStorage()
+  {
+    m_unsortedFile.reset(new FileWriter(m_file.GetName() + ".tmp"));
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type InitStorage()
+  {
+    uint64_t const fileSize = m_file.Size();
+    uint64_t count = 0;
+    CHECK_GREATER_OR_EQUAL(fileSize, sizeof(count), ("Damaged file."));
+    m_file.Read(fileSize - sizeof(count), &count, sizeof(count));
+    CHECK_LESS_OR_EQUAL(count * sizeof(uint64_t) + sizeof(count), fileSize, ("Damaged file."));
+
+    m_offsets.resize(count);
+    if (count != 0)
+    {
+      m_file.Read(fileSize - sizeof(count) - count * sizeof(uint64_t), m_offsets.data(),
+                  count * sizeof(uint64_t));
+    }
+  }
+
+  // The storage which is destroyed without Finish, e.g. by an exception, is left unsorted.
+  template <EMode T>
+  typename enable_if<T == EMode::Write, void>::type DoneStorage()
+  {
+    if (!m_unsortedFile)
+      return;
+    LOG(LWARNING, ("Nodes weren't sorted, Finish() wasn't called."));
+    string const unsortedFile = m_unsortedFile->GetName();
+    m_unsortedFile.reset();
+    FileWriter::DeleteFileX(unsortedFile);
+  }
+
+  template <EMode T>
+  typename enable_if<T == EMode::Read, void>::type DoneStorage() {}
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Write, void>::type AddPoint(uint64_t id, double lat, double lng)
+  {
+    int64_t const lat64 = lat * kValueOrder;
+    int64_t const lng64 = lng * kValueOrder;
+
+    LatLonPos ll;
+    ll.pos = id;
+    ll.lat = static_cast<int32_t>(lat64);
+    ll.lon = static_cast<int32_t>(lng64);
+    CHECK_EQUAL(static_cast<int64_t>(ll.lat), lat64, ("Latitude is out of 32bit boundary!"));
+    CHECK_EQUAL(static_cast<int64_t>(ll.lon), lng64, ("Longtitude is out of 32bit boundary!"));
+    m_unsortedFile->Write(&ll, sizeof(ll));
+
+    IncProcessedPoint();
+  }
+
+  template <EMode T = TMode>
+  typename enable_if<T == EMode::Read, bool>::type GetPoint(uint64_t id, double & lat,
+                                                            double & lng) const
+  {
+    uint64_t const block = id / detail::kSortedPointsBlockIds;
+    if (block + 1 >= m_offsets.size())
+      return false;
+    size_t const size = static_cast<size_t>(m_offsets[block + 1] - m_offsets[block]);
+    CHECK_LESS_OR_EQUAL(size, detail::kSortedPointsMaxBlockSize, ("Damaged file."));
+    uint8_t buffer[detail::kSortedPointsMaxBlockSize];
+    m_file.Read(m_offsets[block], buffer, size);
+
+    ArrayByteSource src(buffer);
+    uint64_t pointId = block * detail::kSortedPointsBlockIds;
+    int64_t lat64 = 0;
+    int64_t lng64 = 0;
+    while (src.PtrUC() < buffer + size)
+    {
+      pointId += ReadVarUint<uint64_t>(src);
+      lat64 += ReadVarInt<int64_t>(src);
+      lng64 += ReadVarInt<int64_t>(src);
+      if (pointId == id)
+      {
+        lat = static_cast<double>(lat64) / kValueOrder;
+        lng = static_cast<double>(lng64) / kValueOrder;
+        return true;
+      }
+      if (pointId > id)
+        break;
+    }
+    return false;
+  }
+};
+
 }  // namespace cache
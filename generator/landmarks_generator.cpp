@@ -0,0 +1,61 @@
+#include "generator/landmarks_generator.hpp"
+#include "generator/pedestrian_roads.hpp"
+
+#include "routing/landmarks.hpp"
+
+#include "coding/file_container.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/vector.hpp"
+
+#include "defines.hpp"
+
+namespace routing
+{
+bool BuildLandmarks(string const & baseDir, string const & countryName, uint32_t landmarksCount)
+{
+  string const mwmFile = baseDir + countryName + DATA_FILE_EXTENSION;
+
+  // Road points outside of the country borders are where roads of other mwms may start.
+  vector<m2::RegionD> borders;
+  if (!LoadPedestrianRoadsBorders(baseDir, countryName, borders))
+    return false;
+
+  LandmarksTableBuilder builder;
+  auto const addRoad = [&](uint32_t /* featureId */, vector<m2::PointD> const & points,
+                           double speedKMPH, bool bidirectional)
+  {
+    builder.AddRoad(points, speedKMPH, bidirectional);
+    for (auto const & point : points)
+    {
+      if (IsOutsideBorders(borders, point))
+        builder.AddExit(point);
+    }
+  };
+
+  try
+  {
+    ForEachPedestrianRoad(mwmFile, countryName, addRoad);
+
+    LandmarksTable table;
+    builder.Build(landmarksCount, table);
+    if (table.GetLandmarksCount() == 0)
+    {
+      LOG(LWARNING, ("No landmarks for", mwmFile));
+      return false;
+    }
+
+    FilesContainerW cont(mwmFile, FileWriter::OP_WRITE_EXISTING);
+    FileWriter writer = cont.GetWriter(ROUTING_LANDMARKS_FILE_TAG);
+    table.Serialize(writer);
+  }
+  catch (RootException const & e)
+  {
+    LOG(LERROR, ("Can't build landmarks for", mwmFile, e.Msg()));
+    return false;
+  }
+
+  return true;
+}
+}  // namespace routing
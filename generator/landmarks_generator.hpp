@@ -0,0 +1,14 @@
+#pragma once
+
+#include "std/cstdint.hpp"
+#include "std/string.hpp"
+
+namespace routing
+{
+/// Builds a landmarks section for pedestrian routing, see routing::LandmarksTable.
+/// Country borders are read from the borders directory of baseDir.
+/// @param[in]  baseDir   Full path to .mwm files directory.
+/// @param[in]  countryName   Country name same with .mwm file name.
+/// @param[in]  landmarksCount   Number of landmarks to choose.
+bool BuildLandmarks(string const & baseDir, string const & countryName, uint32_t landmarksCount);
+}
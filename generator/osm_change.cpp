@@ -0,0 +1,60 @@
+#include "generator/osm_change.hpp"
+
+#include "base/assert.hpp"
+
+namespace osm
+{
+void OsmChange::Add(OsmElement const & e, Action action)
+{
+  Element & element = GetElements(e.type)[e.id];
+  element.m_element = e;
+  element.m_action = action;
+}
+
+OsmChange::Element const * OsmChange::Find(OsmElement::EntityType type, uint64_t id) const
+{
+  TElements const & elements = GetElements(type);
+  auto const it = elements.find(id);
+  return it == elements.end() ? nullptr : &it->second;
+}
+
+// static
+OsmChange::Action OsmChange::StringToAction(string const & s)
+{
+  if (s == "create")
+    return Action::Create;
+  if (s == "modify")
+    return Action::Modify;
+  CHECK_EQUAL(s, "delete", ("Unknown action of osmChange."));
+  return Action::Delete;
+}
+
+OsmChange::TElements const & OsmChange::GetElements(OsmElement::EntityType type) const
+{
+  switch (type)
+  {
+    case OsmElement::EntityType::Node: return m_nodes;
+    case OsmElement::EntityType::Way: return m_ways;
+    case OsmElement::EntityType::Relation: return m_relations;
+    default: break;
+  }
+  CHECK(false, ("Unexpected element type in osmChange:", static_cast<uint16_t>(type)));
+  return m_nodes;
+}
+
+OsmChange::TElements & OsmChange::GetElements(OsmElement::EntityType type)
+{
+  return const_cast<TElements &>(static_cast<OsmChange const *>(this)->GetElements(type));
+}
+
+string DebugPrint(OsmChange::Action action)
+{
+  switch (action)
+  {
+    case OsmChange::Action::Create: return "create";
+    case OsmChange::Action::Modify: return "modify";
+    case OsmChange::Action::Delete: return "delete";
+  }
+  return "unknown";
+}
+}  // namespace osm
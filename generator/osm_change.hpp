@@ -0,0 +1,57 @@
+#pragma once
+
+#include "generator/osm_element.hpp"
+
+#include "std/unordered_map.hpp"
+
+namespace osm
+{
+/// Elements of OSM change files (.osc). The last change of an element wins,
+/// so several files can be added in their order.
+class OsmChange
+{
+public:
+  enum class Action
+  {
+    Create,
+    Modify,
+    Delete
+  };
+
+  struct Element
+  {
+    OsmElement m_element;
+    Action m_action;
+
+    bool IsDeleted() const { return m_action == Action::Delete; }
+  };
+
+  void Add(OsmElement const & e, Action action);
+
+  /// @return nullptr if the element is not changed.
+  Element const * Find(OsmElement::EntityType type, uint64_t id) const;
+
+  template <typename ToDo>
+  void ForEach(OsmElement::EntityType type, ToDo && toDo) const
+  {
+    for (auto const & p : GetElements(type))
+      toDo(p.second);
+  }
+
+  size_t GetCount(OsmElement::EntityType type) const { return GetElements(type).size(); }
+
+  static Action StringToAction(string const & s);
+
+private:
+  using TElements = unordered_map<uint64_t, Element>;
+
+  TElements const & GetElements(OsmElement::EntityType type) const;
+  TElements & GetElements(OsmElement::EntityType type);
+
+  TElements m_nodes;
+  TElements m_ways;
+  TElements m_relations;
+};
+
+string DebugPrint(OsmChange::Action action);
+}  // namespace osm
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "generator/osm_element.hpp"
+#include "generator/osm_o5m_source.hpp"
+#include "generator/pipeline_queue.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/atomic.hpp"
+#include "std/cstring.hpp"
+#include "std/exception.hpp"
+#include "std/function.hpp"
+#include "std/thread.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace osm
+{
+/// Conversion of an o5m entity to OsmElement.
+/// @param filterTags Tags are passed through OsmElement::AddTag, otherwise all tags are kept.
+inline void ConvertO5MEntity(O5MSource::Entity const & em, OsmElement & p, bool filterTags)
+{
+  using TType = O5MSource::EntityType;
+
+  auto translate = [](TType t) -> OsmElement::EntityType
+  {
+    switch (t)
+    {
+      case TType::Node: return OsmElement::EntityType::Node;
+      case TType::Way: return OsmElement::EntityType::Way;
+      case TType::Relation: return OsmElement::EntityType::Relation;
+      default: return OsmElement::EntityType::Unknown;
+    }
+  };
+
+  p.id = em.id;
+
+  switch (em.type)
+  {
+    case TType::Node:
+    {
+      p.type = OsmElement::EntityType::Node;
+      p.lat = em.lat;
+      p.lon = em.lon;
+      break;
+    }
+    case TType::Way:
+    {
+      p.type = OsmElement::EntityType::Way;
+      for (uint64_t nd : em.Nodes())
+        p.AddNd(nd);
+      break;
+    }
+    case TType::Relation:
+    {
+      p.type = OsmElement::EntityType::Relation;
+      for (auto const & member : em.Members())
+        p.AddMember(member.ref, translate(member.type), member.role);
+      break;
+    }
+    default: break;
+  }
+
+  for (auto const & tag : em.Tags())
+  {
+    if (filterTags)
+      p.AddTag(tag.key, tag.value);
+    else
+      p.m_tags.emplace_back(tag.key, tag.value);
+  }
+}
+
+/// Reads o5m stream on three threads: the first one reads the stream by blocks, the second one
+/// decodes entities to OsmElements and the calling thread processes elements in their order
+/// in the stream. O5M entities are delta coded and refer to strings of previous entities,
+/// so they can't be decoded out of order.
+class O5MPipeline
+{
+public:
+  using TConverter = function<void(O5MSource::Entity const &, OsmElement &)>;
+
+  /// @param blockSize Size of blocks read from the stream.
+  /// @param batchSize Number of elements passed to the processing thread at once.
+  O5MPipeline(TReadFunc const & reader, TConverter const & converter,
+              size_t blockSize = 4 * 1024 * 1024, size_t batchSize = 4096)
+    : m_reader(reader), m_converter(converter), m_blockSize(blockSize), m_batchSize(batchSize),
+      m_blocks(kMaxQueueSize), m_batches(kMaxQueueSize), m_blockOffset(0), m_cancelled(false)
+  {
+  }
+
+  template <typename TProcessor>
+  void Run(TProcessor && processor)
+  {
+    thread readThread(&O5MPipeline::ReadBlocks, this);
+    thread decodeThread(&O5MPipeline::DecodeBlocks, this);
+
+    vector<OsmElement> batch;
+    try
+    {
+      while (m_batches.Pop(batch))
+      {
+        for (auto & e : batch)
+          processor(&e);
+      }
+    }
+    catch (...)
+    {
+      m_cancelled = true;
+      m_blocks.Close();
+      m_batches.Close();
+      readThread.join();
+      decodeThread.join();
+      throw;
+    }
+
+    readThread.join();
+    decodeThread.join();
+    if (m_decodeError)
+      rethrow_exception(m_decodeError);
+  }
+
+private:
+  static size_t constexpr kMaxQueueSize = 4;
+
+  void ReadBlocks()
+  {
+    try
+    {
+      while (true)
+      {
+        vector<uint8_t> block(m_blockSize);
+        block.resize(m_reader(block.data(), block.size()));
+        bool const isLast = block.empty();
+        if (!m_blocks.Push(move(block)) || isLast)
+          return;
+      }
+    }
+    catch (...)
+    {
+      // The error is rethrown by the decoding thread when it reaches the end of the blocks,
+      // and is passed to the processing thread as a decode error.
+      m_readError = current_exception();
+      m_blocks.Close();
+    }
+  }
+
+  size_t ReadFromBlocks(uint8_t * buffer, size_t size)
+  {
+    size_t read = 0;
+    while (read < size)
+    {
+      if (m_blockOffset == m_block.size())
+      {
+        m_blockOffset = 0;
+        if (!m_blocks.Pop(m_block) || m_block.empty())
+        {
+          // O5MSource doesn't expect the end of the stream, so decoding is stopped by exception.
+          if (m_readError)
+            rethrow_exception(m_readError);
+          if (m_cancelled)
+            throw runtime_error("O5M decoding is cancelled");
+          m_block.clear();
+          break;
+        }
+      }
+      size_t const count = min(size - read, m_block.size() - m_blockOffset);
+      memcpy(buffer + read, m_block.data() + m_blockOffset, count);
+      m_blockOffset += count;
+      read += count;
+    }
+    return read;
+  }
+
+  void DecodeBlocks()
+  {
+    try
+    {
+      O5MSource dataset([this](uint8_t * buffer, size_t size)
+      {
+        return ReadFromBlocks(buffer, size);
+      });
+
+      vector<OsmElement> batch;
+      for (auto const & em : dataset)
+      {
+        batch.emplace_back();
+        m_converter(em, batch.back());
+        if (batch.size() == m_batchSize)
+        {
+          if (!m_batches.Push(move(batch)))
+            break;
+          batch.clear();
+        }
+      }
+      if (!batch.empty())
+        m_batches.Push(move(batch));
+    }
+    catch (...)
+    {
+      m_decodeError = current_exception();
+    }
+
+    // The rest of the stream after the end of the dataset is not read.
+    m_blocks.Close();
+    m_batches.Close();
+  }
+
+  TReadFunc m_reader;
+  TConverter m_converter;
+  size_t const m_blockSize;
+  size_t const m_batchSize;
+
+  PipelineQueue<vector<uint8_t>> m_blocks;
+  PipelineQueue<vector<OsmElement>> m_batches;
+
+  // Block which is decoded now, is used on the decoding thread only.
+  vector<uint8_t> m_block;
+  size_t m_blockOffset;
+
+  // Is set before m_blocks is closed, so it's read by the decoding thread after Pop fails.
+  exception_ptr m_readError;
+  exception_ptr m_decodeError;
+  atomic<bool> m_cancelled;
+};
+}  // namespace osm
@@ -0,0 +1,622 @@
+#include "generator/osm_pbf_source.hpp"
+
+#include "generator/pipeline_queue.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/exception.hpp"
+#include "std/future.hpp"
+#include "std/thread.hpp"
+#include "std/utility.hpp"
+
+#include <zlib.h>
+
+namespace osm
+{
+namespace
+{
+// Limits of the format, see PBF Format definition.
+uint32_t const kMaxBlobHeaderSize = 64 * 1024;
+uint32_t const kMaxBlobSize = 32 * 1024 * 1024;
+
+/// Reader of protocol buffers wire format, only the types used by PBF are supported.
+class ProtobufReader
+{
+public:
+  enum WireType
+  {
+    WIRE_VARINT = 0,
+    WIRE_FIXED64 = 1,
+    WIRE_BYTES = 2,
+    WIRE_FIXED32 = 5
+  };
+
+  ProtobufReader(char const * begin, char const * end)
+    : m_p(begin), m_end(end), m_field(0), m_wireType(WIRE_VARINT)
+  {
+  }
+
+  explicit ProtobufReader(string const & data) : ProtobufReader(data.data(), data.data() + data.size())
+  {
+  }
+
+  /// Reads the key of the next field.
+  bool Next()
+  {
+    if (m_p == m_end)
+      return false;
+    uint64_t const key = ReadVarint();
+    m_field = static_cast<uint32_t>(key >> 3);
+    m_wireType = static_cast<uint32_t>(key & 0x7);
+    return true;
+  }
+
+  uint32_t Field() const { return m_field; }
+
+  uint64_t ReadVarint()
+  {
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      if (m_p == m_end)
+        MYTHROW(PbfFormatException, ("Unexpected end of varint."));
+      uint8_t const b = static_cast<uint8_t>(*m_p++);
+      value |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0)
+        return value;
+    }
+    MYTHROW(PbfFormatException, ("Too long varint."));
+  }
+
+  int64_t ReadSVarint()
+  {
+    uint64_t const value = ReadVarint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  ProtobufReader ReadMessage()
+  {
+    CheckWireType(WIRE_BYTES);
+    uint64_t const size = ReadVarint();
+    if (size > static_cast<uint64_t>(m_end - m_p))
+      MYTHROW(PbfFormatException, ("Field", m_field, "is out of message."));
+    char const * begin = m_p;
+    m_p += size;
+    return ProtobufReader(begin, m_p);
+  }
+
+  string ReadString()
+  {
+    ProtobufReader const message = ReadMessage();
+    return string(message.m_p, message.m_end);
+  }
+
+  /// Calls toDo for every value of a repeated varint field, which may be packed or not.
+  template <typename ToDo>
+  void ForEachVarint(ToDo && toDo)
+  {
+    if (m_wireType == WIRE_VARINT)
+    {
+      toDo(ReadVarint());
+      return;
+    }
+    ProtobufReader packed = ReadMessage();
+    while (packed.m_p != packed.m_end)
+      toDo(packed.ReadVarint());
+  }
+
+  void Skip()
+  {
+    switch (m_wireType)
+    {
+    case WIRE_VARINT: ReadVarint(); break;
+    case WIRE_FIXED64: SkipBytes(8); break;
+    case WIRE_BYTES: ReadMessage(); break;
+    case WIRE_FIXED32: SkipBytes(4); break;
+    default: MYTHROW(PbfFormatException, ("Unsupported wire type", m_wireType));
+    }
+  }
+
+private:
+  void CheckWireType(uint32_t wireType) const
+  {
+    if (m_wireType != wireType)
+      MYTHROW(PbfFormatException, ("Field", m_field, "has wire type", m_wireType));
+  }
+
+  void SkipBytes(size_t size)
+  {
+    if (size > static_cast<size_t>(m_end - m_p))
+      MYTHROW(PbfFormatException, ("Field", m_field, "is out of message."));
+    m_p += size;
+  }
+
+  char const * m_p;
+  char const * m_end;
+  uint32_t m_field;
+  uint32_t m_wireType;
+};
+
+int64_t ZigZagDecode(uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// Fields of PrimitiveBlock which are needed to decode its groups.
+class PrimitiveBlock
+{
+public:
+  PrimitiveBlock(bool filterTags, vector<OsmElement> & elements)
+    : m_filterTags(filterTags), m_elements(elements), m_granularity(100), m_latOffset(0),
+      m_lonOffset(0)
+  {
+  }
+
+  void Decode(string const & data)
+  {
+    vector<ProtobufReader> groups;
+    ProtobufReader block(data);
+    while (block.Next())
+    {
+      switch (block.Field())
+      {
+      case 1:
+      {
+        ProtobufReader table = block.ReadMessage();
+        while (table.Next())
+        {
+          if (table.Field() == 1)
+            m_strings.push_back(table.ReadString());
+          else
+            table.Skip();
+        }
+        break;
+      }
+      case 2: groups.push_back(block.ReadMessage()); break;
+      case 17: m_granularity = static_cast<int32_t>(block.ReadVarint()); break;
+      case 19: m_latOffset = static_cast<int64_t>(block.ReadVarint()); break;
+      case 20: m_lonOffset = static_cast<int64_t>(block.ReadVarint()); break;
+      default: block.Skip(); break;
+      }
+    }
+
+    for (auto & group : groups)
+    {
+      while (group.Next())
+      {
+        switch (group.Field())
+        {
+        case 1: DecodeNode(group.ReadMessage()); break;
+        case 2: DecodeDenseNodes(group.ReadMessage()); break;
+        case 3: DecodeWay(group.ReadMessage()); break;
+        case 4: DecodeRelation(group.ReadMessage()); break;
+        default: group.Skip(); break;
+        }
+      }
+    }
+  }
+
+private:
+  string const & GetString(uint64_t index) const
+  {
+    if (index >= m_strings.size())
+      MYTHROW(PbfFormatException, ("String index", index, "is out of table", m_strings.size()));
+    return m_strings[index];
+  }
+
+  double ToDegrees(int64_t value, int64_t offset) const
+  {
+    return 1E-9 * (offset + static_cast<int64_t>(m_granularity) * value);
+  }
+
+  void AddTag(OsmElement & e, uint64_t key, uint64_t value) const
+  {
+    if (m_filterTags)
+      e.AddTag(GetString(key), GetString(value));
+    else
+      e.m_tags.emplace_back(GetString(key), GetString(value));
+  }
+
+  void AddTags(OsmElement & e, vector<uint64_t> const & keys, vector<uint64_t> const & values) const
+  {
+    if (keys.size() != values.size())
+      MYTHROW(PbfFormatException, ("Different number of keys and values of", e.id));
+    for (size_t i = 0; i < keys.size(); ++i)
+      AddTag(e, keys[i], values[i]);
+  }
+
+  OsmElement & AddElement(OsmElement::EntityType type)
+  {
+    m_elements.emplace_back();
+    m_elements.back().type = type;
+    return m_elements.back();
+  }
+
+  void DecodeNode(ProtobufReader node)
+  {
+    OsmElement & e = AddElement(OsmElement::EntityType::Node);
+    vector<uint64_t> keys, values;
+    int64_t lat = 0, lon = 0;
+    while (node.Next())
+    {
+      switch (node.Field())
+      {
+      case 1: e.id = node.ReadSVarint(); break;
+      case 2: node.ForEachVarint([&keys](uint64_t v) { keys.push_back(v); }); break;
+      case 3: node.ForEachVarint([&values](uint64_t v) { values.push_back(v); }); break;
+      case 8: lat = node.ReadSVarint(); break;
+      case 9: lon = node.ReadSVarint(); break;
+      default: node.Skip(); break;
+      }
+    }
+    e.lat = ToDegrees(lat, m_latOffset);
+    e.lon = ToDegrees(lon, m_lonOffset);
+    AddTags(e, keys, values);
+  }
+
+  void DecodeDenseNodes(ProtobufReader dense)
+  {
+    vector<int64_t> ids, lats, lons;
+    vector<uint64_t> keysValues;
+    auto const addDelta = [](vector<int64_t> & v)
+    {
+      return [&v](uint64_t delta) { v.push_back((v.empty() ? 0 : v.back()) + ZigZagDecode(delta)); };
+    };
+    while (dense.Next())
+    {
+      switch (dense.Field())
+      {
+      case 1: dense.ForEachVarint(addDelta(ids)); break;
+      case 8: dense.ForEachVarint(addDelta(lats)); break;
+      case 9: dense.ForEachVarint(addDelta(lons)); break;
+      case 10: dense.ForEachVarint([&keysValues](uint64_t v) { keysValues.push_back(v); }); break;
+      default: dense.Skip(); break;
+      }
+    }
+    if (lats.size() != ids.size() || lons.size() != ids.size())
+      MYTHROW(PbfFormatException, ("Different number of ids and coordinates of dense nodes."));
+
+    // Tags of the nodes are key and value string indices, tags of each node end with 0.
+    size_t kv = 0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      OsmElement & e = AddElement(OsmElement::EntityType::Node);
+      e.id = ids[i];
+      e.lat = ToDegrees(lats[i], m_latOffset);
+      e.lon = ToDegrees(lons[i], m_lonOffset);
+      while (kv < keysValues.size() && keysValues[kv] != 0)
+      {
+        if (kv + 1 == keysValues.size())
+          MYTHROW(PbfFormatException, ("Key without value of", e.id));
+        AddTag(e, keysValues[kv], keysValues[kv + 1]);
+        kv += 2;
+      }
+      ++kv;
+    }
+  }
+
+  void DecodeWay(ProtobufReader way)
+  {
+    OsmElement & e = AddElement(OsmElement::EntityType::Way);
+    vector<uint64_t> keys, values;
+    while (way.Next())
+    {
+      switch (way.Field())
+      {
+      case 1: e.id = way.ReadVarint(); break;
+      case 2: way.ForEachVarint([&keys](uint64_t v) { keys.push_back(v); }); break;
+      case 3: way.ForEachVarint([&values](uint64_t v) { values.push_back(v); }); break;
+      case 8:
+      {
+        int64_t ref = 0;
+        way.ForEachVarint([&e, &ref](uint64_t delta)
+        {
+          ref += ZigZagDecode(delta);
+          e.AddNd(ref);
+        });
+        break;
+      }
+      default: way.Skip(); break;
+      }
+    }
+    AddTags(e, keys, values);
+  }
+
+  void DecodeRelation(ProtobufReader relation)
+  {
+    OsmElement & e = AddElement(OsmElement::EntityType::Relation);
+    vector<uint64_t> keys, values, roles, types;
+    vector<int64_t> ids;
+    int64_t id = 0;
+    while (relation.Next())
+    {
+      switch (relation.Field())
+      {
+      case 1: e.id = relation.ReadVarint(); break;
+      case 2: relation.ForEachVarint([&keys](uint64_t v) { keys.push_back(v); }); break;
+      case 3: relation.ForEachVarint([&values](uint64_t v) { values.push_back(v); }); break;
+      case 8: relation.ForEachVarint([&roles](uint64_t v) { roles.push_back(v); }); break;
+      case 9:
+        relation.ForEachVarint([&ids, &id](uint64_t delta)
+        {
+          id += ZigZagDecode(delta);
+          ids.push_back(id);
+        });
+        break;
+      case 10: relation.ForEachVarint([&types](uint64_t v) { types.push_back(v); }); break;
+      default: relation.Skip(); break;
+      }
+    }
+    if (roles.size() != ids.size() || types.size() != ids.size())
+      MYTHROW(PbfFormatException, ("Different number of members fields of", e.id));
+
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      OsmElement::EntityType type = OsmElement::EntityType::Unknown;
+      switch (types[i])
+      {
+      case 0: type = OsmElement::EntityType::Node; break;
+      case 1: type = OsmElement::EntityType::Way; break;
+      case 2: type = OsmElement::EntityType::Relation; break;
+      }
+      e.AddMember(ids[i], type, GetString(roles[i]));
+    }
+    AddTags(e, keys, values);
+  }
+
+  bool const m_filterTags;
+  vector<OsmElement> & m_elements;
+
+  vector<string> m_strings;
+  int32_t m_granularity;
+  int64_t m_latOffset;
+  int64_t m_lonOffset;
+};
+
+size_t const kSupportedFeaturesCount = 2;
+char const * const kSupportedFeatures[kSupportedFeaturesCount] = {"OsmSchema-V0.6", "DenseNodes"};
+}  // namespace
+
+PbfSource::PbfSource(TReadFunc const & reader, uint32_t threadsCount, bool filterTags)
+  : m_reader(reader), m_threadsCount(max(threadsCount, 1U)), m_filterTags(filterTags)
+{
+}
+
+void PbfSource::Run(TProcessor const & processor)
+{
+  if (m_threadsCount == 1)
+    RunSequentially(processor);
+  else
+    RunInParallel(processor);
+}
+
+// static
+void PbfSource::DecodePrimitiveBlock(string const & data, bool filterTags,
+                                     vector<OsmElement> & elements)
+{
+  PrimitiveBlock(filterTags, elements).Decode(data);
+}
+
+bool PbfSource::ReadBlob(Blob & blob)
+{
+  auto const readExactly = [this](char * p, size_t size)
+  {
+    size_t read = 0;
+    while (read < size)
+    {
+      size_t const count = m_reader(p + read, size - read);
+      if (count == 0)
+        break;
+      read += count;
+    }
+    return read;
+  };
+
+  unsigned char sizeBytes[4];
+  size_t const read = readExactly(reinterpret_cast<char *>(sizeBytes), sizeof(sizeBytes));
+  if (read == 0)
+    return false;
+  if (read != sizeof(sizeBytes))
+    MYTHROW(PbfFormatException, ("Unexpected end of file."));
+
+  uint32_t const headerSize = (static_cast<uint32_t>(sizeBytes[0]) << 24) |
+                              (static_cast<uint32_t>(sizeBytes[1]) << 16) |
+                              (static_cast<uint32_t>(sizeBytes[2]) << 8) | sizeBytes[3];
+  if (headerSize > kMaxBlobHeaderSize)
+    MYTHROW(PbfFormatException, ("Too big blob header", headerSize));
+
+  string header(headerSize, 0);
+  if (readExactly(&header[0], header.size()) != header.size())
+    MYTHROW(PbfFormatException, ("Unexpected end of file."));
+
+  blob.m_type.clear();
+  uint64_t dataSize = 0;
+  ProtobufReader reader(header);
+  while (reader.Next())
+  {
+    switch (reader.Field())
+    {
+    case 1: blob.m_type = reader.ReadString(); break;
+    case 3: dataSize = reader.ReadVarint(); break;
+    default: reader.Skip(); break;
+    }
+  }
+  if (dataSize > kMaxBlobSize)
+    MYTHROW(PbfFormatException, ("Too big blob", dataSize));
+
+  blob.m_data.assign(dataSize, 0);
+  if (readExactly(&blob.m_data[0], blob.m_data.size()) != blob.m_data.size())
+    MYTHROW(PbfFormatException, ("Unexpected end of file."));
+  return true;
+}
+
+// static
+string PbfSource::UnpackBlob(string const & blob)
+{
+  string raw;
+  string zlibData;
+  uint64_t rawSize = 0;
+  bool isZlib = false;
+
+  ProtobufReader reader(blob);
+  while (reader.Next())
+  {
+    switch (reader.Field())
+    {
+    case 1: raw = reader.ReadString(); break;
+    case 2: rawSize = reader.ReadVarint(); break;
+    case 3: zlibData = reader.ReadString(); isZlib = true; break;
+    case 4: MYTHROW(PbfFormatException, ("LZMA compressed blobs are not supported."));
+    default: reader.Skip(); break;
+    }
+  }
+  if (!isZlib)
+    return raw;
+
+  if (rawSize > kMaxBlobSize)
+    MYTHROW(PbfFormatException, ("Too big blob", rawSize));
+  raw.assign(rawSize, 0);
+  uLongf size = static_cast<uLongf>(rawSize);
+  int const res = uncompress(reinterpret_cast<Bytef *>(&raw[0]), &size,
+                             reinterpret_cast<Bytef const *>(zlibData.data()),
+                             static_cast<uLong>(zlibData.size()));
+  if (res != Z_OK || size != rawSize)
+    MYTHROW(PbfFormatException, ("Can't uncompress blob, zlib error", res));
+  return raw;
+}
+
+// static
+void PbfSource::CheckHeaderBlock(string const & data)
+{
+  ProtobufReader reader(data);
+  while (reader.Next())
+  {
+    if (reader.Field() != 4)
+    {
+      reader.Skip();
+      continue;
+    }
+    string const feature = reader.ReadString();
+    if (find(kSupportedFeatures, kSupportedFeatures + kSupportedFeaturesCount, feature) ==
+        kSupportedFeatures + kSupportedFeaturesCount)
+    {
+      MYTHROW(PbfFormatException, ("Unsupported required feature", feature));
+    }
+  }
+}
+
+void PbfSource::RunSequentially(TProcessor const & processor)
+{
+  Blob blob;
+  vector<OsmElement> elements;
+  while (ReadBlob(blob))
+  {
+    if (blob.m_type == "OSMHeader")
+    {
+      CheckHeaderBlock(UnpackBlob(blob.m_data));
+    }
+    else if (blob.m_type == "OSMData")
+    {
+      elements.clear();
+      DecodePrimitiveBlock(UnpackBlob(blob.m_data), m_filterTags, elements);
+      for (auto & e : elements)
+        processor(&e);
+    }
+  }
+}
+
+void PbfSource::RunInParallel(TProcessor const & processor)
+{
+  using TElements = vector<OsmElement>;
+
+  struct Job
+  {
+    string m_blob;
+    promise<TElements> m_result;
+  };
+
+  // Results are popped in the file's order, the size of the queue limits the number
+  // of blobs which are decoded at once.
+  size_t const maxBlobs = 2 * m_threadsCount;
+  PipelineQueue<future<TElements>> results(maxBlobs);
+  PipelineQueue<Job> jobs(maxBlobs);
+
+  // Blobs are read on one thread, because reading of the next blob needs the size of the previous one.
+  thread readThread([this, &results, &jobs]()
+  {
+    try
+    {
+      Blob blob;
+      while (ReadBlob(blob))
+      {
+        if (blob.m_type == "OSMHeader")
+          CheckHeaderBlock(UnpackBlob(blob.m_data));
+        if (blob.m_type != "OSMData")
+          continue;
+
+        Job job;
+        job.m_blob.swap(blob.m_data);
+        if (!results.Push(job.m_result.get_future()) || !jobs.Push(move(job)))
+          break;
+      }
+    }
+    catch (...)
+    {
+      promise<TElements> error;
+      error.set_exception(current_exception());
+      results.Push(error.get_future());
+    }
+    jobs.Close();
+    results.Close();
+  });
+
+  vector<thread> decodeThreads;
+  for (uint32_t i = 0; i < m_threadsCount; ++i)
+  {
+    decodeThreads.emplace_back([this, &jobs]()
+    {
+      Job job;
+      while (jobs.Pop(job))
+      {
+        try
+        {
+          TElements elements;
+          DecodePrimitiveBlock(UnpackBlob(job.m_blob), m_filterTags, elements);
+          job.m_result.set_value(move(elements));
+        }
+        catch (...)
+        {
+          job.m_result.set_exception(current_exception());
+        }
+      }
+    });
+  }
+
+  auto const joinThreads = [&]()
+  {
+    readThread.join();
+    for (auto & t : decodeThreads)
+      t.join();
+  };
+
+  try
+  {
+    future<TElements> result;
+    while (results.Pop(result))
+    {
+      TElements elements = result.get();
+      for (auto & e : elements)
+        processor(&e);
+    }
+  }
+  catch (...)
+  {
+    results.Close();
+    jobs.Close();
+    joinThreads();
+    throw;
+  }
+  joinThreads();
+}
+}  // namespace osm
@@ -0,0 +1,57 @@
+// See PBF Format definition at http://wiki.openstreetmap.org/wiki/PBF_Format
+#pragma once
+
+#include "generator/osm_element.hpp"
+
+#include "base/exception.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/function.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+namespace osm
+{
+DECLARE_EXCEPTION(PbfFormatException, RootException);
+
+/// Reads blobs of OSM PBF file and decodes them into OsmElements. Blobs are compressed
+/// independently, so they are decompressed and decoded on several threads, but
+/// elements are passed to the processor on the calling thread in the file's order.
+class PbfSource
+{
+public:
+  using TReadFunc = function<size_t(char *, size_t)>;
+  using TProcessor = function<void(OsmElement *)>;
+
+  /// @param threadsCount Number of threads which decode blobs, blobs are decoded
+  ///                     on the calling thread if it's 1.
+  /// @param filterTags Tags are passed through OsmElement::AddTag, otherwise all tags are kept.
+  PbfSource(TReadFunc const & reader, uint32_t threadsCount, bool filterTags);
+
+  void Run(TProcessor const & processor);
+
+  /// Decodes the data of uncompressed OSMData blob to elements.
+  static void DecodePrimitiveBlock(string const & data, bool filterTags,
+                                   vector<OsmElement> & elements);
+
+private:
+  struct Blob
+  {
+    string m_type;
+    string m_data;
+  };
+
+  /// @return False at the end of file.
+  bool ReadBlob(Blob & blob);
+  /// @return Uncompressed data of the blob.
+  static string UnpackBlob(string const & blob);
+  static void CheckHeaderBlock(string const & data);
+
+  void RunSequentially(TProcessor const & processor);
+  void RunInParallel(TProcessor const & processor);
+
+  TReadFunc m_reader;
+  uint32_t const m_threadsCount;
+  bool const m_filterTags;
+};
+}  // namespace osm
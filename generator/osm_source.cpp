@@ -2,8 +2,11 @@
 #include "generator/feature_generator.hpp"
 #include "generator/intermediate_data.hpp"
 #include "generator/intermediate_elements.hpp"
+#include "generator/osm_change.hpp"
 #include "generator/osm_translator.hpp"
+#include "generator/osm_o5m_pipeline.hpp"
 #include "generator/osm_o5m_source.hpp"
+#include "generator/osm_pbf_source.hpp"
 #include "generator/osm_xml_source.hpp"
 #include "generator/osm_source.hpp"
 #include "generator/polygonizer.hpp"
@@ -12,10 +15,20 @@
 
 #include "indexer/classificator.hpp"
 #include "indexer/mercator.hpp"
+#include "indexer/point_to_int64.hpp"
 
+#include "platform/platform.hpp"
+
+#include "coding/file_writer.hpp"
 #include "coding/parse_xml.hpp"
+#include "coding/varint.hpp"
 
 #include "std/fstream.hpp"
+#include "std/iterator.hpp"
+#include "std/map.hpp"
+#include "std/set.hpp"
+#include "std/thread.hpp"
+#include "std/unordered_map.hpp"
 
 #include "defines.hpp"
 
@@ -47,6 +60,29 @@ uint64_t SourceReader::Read(char * buffer, uint64_t bufferSize)
 
 namespace
 {
+/// Only these relations are stored in the intermediate data.
+bool IsCachedRelationType(string const & relationType)
+{
+  return relationType == "multipolygon" || relationType == "route" ||
+         relationType == "boundary";
+}
+
+template <typename TElement>
+void MakeRelationElement(TElement const & em, RelationElement & relation)
+{
+  for (auto const & member : em.Members())
+  {
+    if (member.type == TElement::EntityType::Node)
+      relation.nodes.emplace_back(make_pair(member.ref, string(member.role)));
+    else if (member.type == TElement::EntityType::Way)
+      relation.ways.emplace_back(make_pair(member.ref, string(member.role)));
+    // we just ignore type == "relation"
+  }
+
+  for (auto const & tag : em.Tags())
+    relation.tags.emplace(make_pair(string(tag.key), string(tag.value)));
+}
+
 template <class TNodesHolder, cache::EMode TMode>
 class IntermediateData
 {
@@ -124,10 +160,11 @@ public:
   void AddWay(TKey id, WayElement const & e) { m_ways.Write(id, e); }
   bool GetWay(TKey id, WayElement & e) { return m_ways.Read(id, e); }
 
+  bool GetRelation(TKey id, RelationElement & e) { return m_relations.Read(id, e); }
+
   void AddRelation(TKey id, RelationElement const & e)
   {
-    string const & relationType = e.GetType();
-    if (!(relationType == "multipolygon" || relationType == "route" || relationType == "boundary"))
+    if (!IsCachedRelationType(e.GetType()))
       return;
 
     m_relations.Write(id, e);
@@ -243,11 +280,10 @@ public:
   void operator()(FeatureBuilder1 fb)
   {
     uint32_t const coastType = Type(NATURAL_COASTLINE);
-    bool const hasCoast = fb.HasType(coastType);
 
     if (m_coasts)
     {
-      if (hasCoast)
+      if (fb.HasType(coastType))
       {
         CHECK(fb.GetGeomType() != feature::GEOM_POINT, ());
         // leave only coastline type
@@ -257,7 +293,22 @@ public:
       return;
     }
 
-    if (hasCoast)
+    if (!FixTypes(fb))
+      return;
+
+    if (m_world)
+      (*m_world)(fb);
+
+    if (m_countries)
+      (*m_countries)(fb);
+  }
+
+  /// Replaces coast types by land ones for the world and countries.
+  /// @return false if the feature has no valid types.
+  bool FixTypes(FeatureBuilder1 & fb) const
+  {
+    uint32_t const coastType = Type(NATURAL_COASTLINE);
+    if (fb.HasType(coastType))
     {
       fb.PopExactType(Type(NATURAL_LAND));
       fb.PopExactType(coastType);
@@ -268,14 +319,7 @@ public:
       fb.AddType(Type(NATURAL_LAND));
     }
 
-    if (!fb.RemoveInvalidTypes())
-      return;
-
-    if (m_world)
-      (*m_world)(fb);
-
-    if (m_countries)
-      (*m_countries)(fb);
+    return fb.RemoveInvalidTypes();
   }
 
   /// @return false if coasts are not merged and FLAG_fail_on_coasts is set
@@ -320,6 +364,11 @@ public:
           (*m_countries)(fb);
       });
     }
+
+    // Features are split by countries on threads, all of them should be written before
+    // names of countries are taken.
+    if (m_countries)
+      m_countries->Finish();
     return true;
   }
 
@@ -331,6 +380,587 @@ public:
       names.clear();
   }
 };
+
+/// Intermediate data with OSM changes applied over it: changed elements are taken from
+/// the change, other ones are taken from the base data.
+template <class TDataCache>
+class ChangedIntermediateData
+{
+  using TKey = uint64_t;
+  using TIndex = unordered_multimap<TKey, TKey>;
+  using EntityType = OsmElement::EntityType;
+
+  TDataCache & m_base;
+  osm::OsmChange const & m_change;
+
+  // Indexes of changed relations, base indexes are used for other ones.
+  TIndex m_nodeToRelations;
+  TIndex m_wayToRelations;
+
+  class RelationsReader
+  {
+    ChangedIntermediateData & m_data;
+
+  public:
+    explicit RelationsReader(ChangedIntermediateData & data) : m_data(data) {}
+    bool Read(TKey id, RelationElement & e) { return m_data.GetRelation(id, e); }
+  };
+
+  RelationsReader m_reader;
+
+  /// Skips changed relations of the base data.
+  template <class ToDo>
+  struct RelationProcessor
+  {
+    ChangedIntermediateData & m_data;
+    ToDo & m_toDo;
+    bool m_stopped = false;
+
+    RelationProcessor(ChangedIntermediateData & data, ToDo & toDo) : m_data(data), m_toDo(toDo) {}
+
+    bool operator()(TKey id, RelationElement const & e)
+    {
+      if (m_data.IsChangedRelation(id))
+        return false;
+      m_stopped = m_toDo(id, e);
+      return m_stopped;
+    }
+  };
+
+  template <class ToDo>
+  struct CachedRelationProcessor
+  {
+    ChangedIntermediateData & m_data;
+    ToDo & m_toDo;
+    bool m_stopped = false;
+
+    CachedRelationProcessor(ChangedIntermediateData & data, ToDo & toDo)
+      : m_data(data), m_toDo(toDo)
+    {
+    }
+
+    template <class TReader>
+    bool operator()(TKey id, TReader &)
+    {
+      if (m_data.IsChangedRelation(id))
+        return false;
+      m_stopped = m_toDo(id, m_data.m_reader);
+      return m_stopped;
+    }
+  };
+
+  bool IsChangedRelation(TKey id) const
+  {
+    return m_change.Find(EntityType::Relation, id) != nullptr;
+  }
+
+  template <class ToDo>
+  void ForEachChangedRelation(TIndex const & index, TKey id, ToDo && toDo)
+  {
+    auto const range = index.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (toDo(it->second))
+        return;
+    }
+  }
+
+public:
+  ChangedIntermediateData(TDataCache & base, osm::OsmChange const & change)
+    : m_base(base), m_change(change), m_reader(*this)
+  {
+    m_change.ForEach(EntityType::Relation, [this](osm::OsmChange::Element const & e)
+    {
+      RelationElement relation;
+      if (e.IsDeleted() || !GetRelation(e.m_element.id, relation) ||
+          !IsCachedRelationType(relation.GetType()))
+      {
+        return;
+      }
+
+      for (auto const & node : relation.nodes)
+        m_nodeToRelations.emplace(node.first, e.m_element.id);
+      for (auto const & way : relation.ways)
+        m_wayToRelations.emplace(way.first, e.m_element.id);
+    });
+  }
+
+  bool GetNode(TKey id, double & lat, double & lng)
+  {
+    auto const * e = m_change.Find(EntityType::Node, id);
+    if (!e)
+      return m_base.GetNode(id, lat, lng);
+    if (e->IsDeleted())
+      return false;
+
+    auto const pt = MercatorBounds::FromLatLon(e->m_element.lat, e->m_element.lon);
+    lat = pt.y;
+    lng = pt.x;
+    return true;
+  }
+
+  bool GetWay(TKey id, WayElement & e)
+  {
+    auto const * changed = m_change.Find(EntityType::Way, id);
+    if (!changed)
+      return m_base.GetWay(id, e);
+    if (changed->IsDeleted())
+      return false;
+
+    e.nodes = changed->m_element.Nodes();
+    return e.IsValid();
+  }
+
+  bool GetRelation(TKey id, RelationElement & e)
+  {
+    auto const * changed = m_change.Find(EntityType::Relation, id);
+    if (!changed)
+      return m_base.GetRelation(id, e);
+    if (changed->IsDeleted())
+      return false;
+
+    MakeRelationElement(changed->m_element, e);
+    return e.IsValid();
+  }
+
+  template <class ToDo>
+  void ForEachRelationByWay(TKey id, ToDo && toDo)
+  {
+    RelationProcessor<ToDo> processor(*this, toDo);
+    m_base.ForEachRelationByWay(id, processor);
+    if (processor.m_stopped)
+      return;
+
+    ForEachChangedRelation(m_wayToRelations, id, [this, &toDo](TKey relationId)
+    {
+      RelationElement e;
+      return GetRelation(relationId, e) && toDo(relationId, e);
+    });
+  }
+
+  template <class ToDo>
+  void ForEachRelationByNodeCached(TKey id, ToDo && toDo)
+  {
+    CachedRelationProcessor<ToDo> processor(*this, toDo);
+    m_base.ForEachRelationByNodeCached(id, processor);
+    if (!processor.m_stopped)
+      ForEachRelationCached(m_nodeToRelations, id, toDo);
+  }
+
+  template <class ToDo>
+  void ForEachRelationByWayCached(TKey id, ToDo && toDo)
+  {
+    CachedRelationProcessor<ToDo> processor(*this, toDo);
+    m_base.ForEachRelationByWayCached(id, processor);
+    if (!processor.m_stopped)
+      ForEachRelationCached(m_wayToRelations, id, toDo);
+  }
+
+private:
+  template <class ToDo>
+  void ForEachRelationCached(TIndex const & index, TKey id, ToDo & toDo)
+  {
+    ForEachChangedRelation(index, id, [this, &toDo](TKey relationId)
+    {
+      return toDo(relationId, m_reader);
+    });
+  }
+};
+
+/// Collects features of countries, it's the same as MainFeaturesEmitter does
+/// for the countries generator.
+class CountryFeaturesCollector
+{
+  MainFeaturesEmitter const & m_emitter;
+  vector<FeatureBuilder1> & m_features;
+
+public:
+  CountryFeaturesCollector(MainFeaturesEmitter const & emitter, vector<FeatureBuilder1> & features)
+    : m_emitter(emitter), m_features(features)
+  {
+  }
+
+  void operator()(FeatureBuilder1 fb)
+  {
+    if (m_emitter.FixTypes(fb) && feature::PreprocessForCountryMap(fb))
+      m_features.push_back(fb);
+  }
+};
+
+/// Makes new .mwm.tmp files of the countries which are affected by OSM changes from
+/// the base ones: features of changed elements are removed from the countries and are
+/// emitted again, unchanged features which have moved nodes get new positions of the nodes.
+/// Base files in info.m_baseTmpDir are only read, so the same base can be updated again
+/// by a longer list of changes.
+/// @note Countries are found by old points of changed nodes and old rects of changed ways.
+/// A feature with a moved node is in a country which contains the node, and its old rect
+/// adds the other countries of the feature when it's patched. So a feature is missed only
+/// when the node is out of all country polygons, as ways aren't indexed by their nodes.
+template <class TDataCache>
+class CountriesUpdater
+{
+  using EntityType = OsmElement::EntityType;
+  using TChangedData = ChangedIntermediateData<TDataCache>;
+
+  feature::GenerateInfo const & m_info;
+  TDataCache & m_base;
+  osm::OsmChange const & m_change;
+  TChangedData m_changed;
+
+  borders::CountriesContainerT m_countries;
+  set<string> m_affectedCountries;
+  // Countries which have base .mwm.tmp files.
+  set<string> m_existingCountries;
+
+  set<uint64_t> m_affectedRelations;
+  // Features with these ids are emitted again.
+  set<osm::Id> m_removedIds;
+  // Moved nodes by their old points, which are coded as in .mwm.tmp files:
+  // pairs of node ids and new points, several nodes may have the same old point.
+  map<m2::PointU, vector<pair<uint64_t, m2::PointD>>> m_movedPoints;
+
+  // New and patched features to split by countries.
+  vector<FeatureBuilder1> m_features;
+  // Serialized patched features, one feature may be found in several countries.
+  set<FeatureBuilder1::TBuffer> m_patched;
+
+  string GetBaseFileName(string const & country) const
+  {
+    return my::JoinFoldersToPath(m_info.m_baseTmpDir, country + DATA_FILE_EXTENSION_TMP);
+  }
+
+  string GetKeptFileName(string const & country) const
+  {
+    return m_info.GetTmpFileName(country, DATA_FILE_EXTENSION_TMP ".kept");
+  }
+
+  void AddRect(m2::RectD const & rect)
+  {
+    if (!rect.IsValid())
+      return;
+    m_countries.ForEachInRect(rect, [this](borders::CountryPolygons const & c)
+    {
+      m_affectedCountries.insert(c.m_name);
+    });
+  }
+
+  bool GetBasePoint(uint64_t id, m2::PointD & pt) { return m_base.GetNode(id, pt.y, pt.x); }
+
+  void AddBaseWayRect(uint64_t id)
+  {
+    WayElement way(id);
+    if (!m_base.GetWay(id, way))
+      return;
+
+    m2::RectD rect;
+    for (uint64_t nd : way.nodes)
+    {
+      m2::PointD pt;
+      if (GetBasePoint(nd, pt))
+        rect.Add(pt);
+    }
+    AddRect(rect);
+  }
+
+  void CollectChangedElements()
+  {
+    m_change.ForEach(EntityType::Node, [this](osm::OsmChange::Element const & e)
+    {
+      uint64_t const id = e.m_element.id;
+      m_removedIds.insert(osm::Id::Node(id));
+
+      m2::PointD oldPt;
+      if (!GetBasePoint(id, oldPt))
+        return;
+      AddRect(m2::RectD(oldPt, oldPt));
+
+      if (e.IsDeleted())
+        return;
+      m2::PointD const newPt = MercatorBounds::FromLatLon(e.m_element.lat, e.m_element.lon);
+      m2::PointU const oldCodedPt = PointD2PointU(oldPt, POINT_COORD_BITS);
+      if (oldCodedPt != PointD2PointU(newPt, POINT_COORD_BITS))
+        m_movedPoints[oldCodedPt].emplace_back(id, newPt);
+    });
+
+    m_change.ForEach(EntityType::Way, [this](osm::OsmChange::Element const & e)
+    {
+      uint64_t const id = e.m_element.id;
+      m_removedIds.insert(osm::Id::Way(id));
+      AddBaseWayRect(id);
+
+      // Multipolygons of the way are built again.
+      m_base.ForEachRelationByWay(id, [this](uint64_t relationId, RelationElement const &)
+      {
+        m_affectedRelations.insert(relationId);
+        return false;
+      });
+    });
+
+    m_change.ForEach(EntityType::Relation, [this](osm::OsmChange::Element const & e)
+    {
+      m_affectedRelations.insert(e.m_element.id);
+    });
+
+    for (uint64_t id : m_affectedRelations)
+    {
+      m_removedIds.insert(osm::Id::Relation(id));
+
+      RelationElement relation;
+      if (!m_base.GetRelation(id, relation))
+        continue;
+      for (auto const & way : relation.ways)
+        AddBaseWayRect(way.first);
+    }
+  }
+
+  void EmitChangedFeatures()
+  {
+    feature::GenerateInfo typesInfo;
+    MainFeaturesEmitter emitter(typesInfo);
+    CountryFeaturesCollector collector(emitter, m_features);
+    OsmToFeatureTranslator<CountryFeaturesCollector, TChangedData> parser(
+        collector, m_changed, 0 /* coastType */, string() /* addrFilePath */);
+
+    for (EntityType type : {EntityType::Node, EntityType::Way})
+    {
+      m_change.ForEach(type, [&parser](osm::OsmChange::Element const & e)
+      {
+        if (e.IsDeleted())
+          return;
+        OsmElement element = e.m_element;
+        parser.EmitElement(&element);
+      });
+    }
+
+    for (uint64_t id : m_affectedRelations)
+    {
+      auto const * changed = m_change.Find(EntityType::Relation, id);
+      if (changed && changed->IsDeleted())
+        continue;
+
+      OsmElement element;
+      if (changed)
+      {
+        element = changed->m_element;
+      }
+      else
+      {
+        RelationElement relation;
+        if (!m_base.GetRelation(id, relation))
+          continue;
+
+        element.type = EntityType::Relation;
+        element.id = id;
+        for (auto const & way : relation.ways)
+          element.AddMember(way.first, EntityType::Way, way.second);
+        for (auto const & node : relation.nodes)
+          element.AddMember(node.first, EntityType::Node, node.second);
+        for (auto const & tag : relation.tags)
+          element.AddTag(tag.first, tag.second);
+      }
+      parser.EmitElement(&element);
+    }
+
+    parser.Finish();
+
+    for (auto const & fb : m_features)
+      AddRect(fb.GetLimitRect());
+  }
+
+  bool IsRemoved(FeatureBuilder1 const & fb) const
+  {
+    for (auto const & id : fb.GetOsmIds())
+    {
+      if (m_removedIds.count(id) != 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool HasMovedPoint(FeatureBuilder1 const & fb) const
+  {
+    for (auto const & points : fb.GetGeometry())
+    {
+      for (auto const & pt : points)
+      {
+        if (m_movedPoints.count(PointD2PointU(pt, POINT_COORD_BITS)) != 0)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  /// Moves points of the features of ways. A point is moved only when a base way
+  /// of the feature has the moved node, so nodes which have the same old point
+  /// aren't mixed up.
+  /// @note Features of relations aren't patched: relations are emitted again only
+  /// when their ways or members are changed.
+  bool Patch(FeatureBuilder1 & fb) const
+  {
+    if (m_movedPoints.empty() || fb.GetGeomType() == feature::GEOM_POINT ||
+        !HasMovedPoint(fb))
+    {
+      return false;
+    }
+
+    set<uint64_t> nodes;
+    for (auto const & id : fb.GetOsmIds())
+    {
+      if (!id.IsWay())
+        continue;
+      WayElement way(id.OsmId());
+      if (m_base.GetWay(id.OsmId(), way))
+        nodes.insert(way.nodes.begin(), way.nodes.end());
+    }
+    if (nodes.empty())
+      return false;
+
+    return fb.ReplacePoints([this, &nodes](m2::PointD & pt)
+    {
+      auto const it = m_movedPoints.find(PointD2PointU(pt, POINT_COORD_BITS));
+      if (it == m_movedPoints.end())
+        return false;
+      for (auto const & node : it->second)
+      {
+        if (nodes.count(node.first) != 0)
+        {
+          pt = node.second;
+          return true;
+        }
+      }
+      return false;
+    });
+  }
+
+  /// Copies unchanged features of the base country file to the kept file
+  /// and collects patched ones.
+  void ScanCountry(string const & country)
+  {
+    string const fileName = GetBaseFileName(country);
+    if (!Platform::IsFileExistsByFullPath(fileName))
+      return;
+    m_existingCountries.insert(country);
+
+    FileWriter kept(GetKeptFileName(country));
+    FileReader reader(fileName);
+    ReaderSource<FileReader> src(reader);
+    size_t keptCount = 0;
+    size_t removedCount = 0;
+
+    while (src.Size() > 0)
+    {
+      uint32_t const sz = ReadVarUint<uint32_t>(src);
+      FeatureBuilder1::TBuffer buffer(sz);
+      src.Read(buffer.data(), sz);
+
+      FeatureBuilder1 fb;
+      fb.Deserialize(buffer);
+      if (IsRemoved(fb))
+      {
+        ++removedCount;
+        continue;
+      }
+
+      m2::RectD const oldRect = fb.GetLimitRect();
+      if (Patch(fb))
+      {
+        ++removedCount;
+        if (m_patched.insert(buffer).second)
+        {
+          // The feature may be in countries which are not affected yet.
+          AddRect(oldRect);
+          AddRect(fb.GetLimitRect());
+          m_features.push_back(fb);
+        }
+        continue;
+      }
+
+      WriteVarUint(kept, sz);
+      kept.Write(buffer.data(), sz);
+      ++keptCount;
+    }
+
+    LOG(LINFO, (country, "features kept:", keptCount, "removed:", removedCount));
+  }
+
+  void WriteCountries(vector<string> & names)
+  {
+    // Removes files of the previous update, kept features are appended to them.
+    for (auto const & country : m_existingCountries)
+      FileWriter::DeleteFileX(m_info.GetTmpFileName(country));
+
+    set<string> countries = m_existingCountries;
+    {
+      feature::Polygonizer<feature::FeaturesCollector> polygonizer(m_info);
+      for (auto const & fb : m_features)
+        polygonizer(fb);
+      polygonizer.Finish();
+      countries.insert(polygonizer.Names().begin(), polygonizer.Names().end());
+    }
+
+    for (auto const & country : m_existingCountries)
+    {
+      string const keptFileName = GetKeptFileName(country);
+      {
+        FileReader reader(keptFileName);
+        ReaderSource<FileReader> kept(reader);
+        FileWriter writer(m_info.GetTmpFileName(country), FileWriter::OP_APPEND);
+        rw::ReadAndWrite(kept, writer);
+      }
+      FileWriter::DeleteFileX(keptFileName);
+    }
+
+    names.assign(countries.begin(), countries.end());
+  }
+
+public:
+  CountriesUpdater(feature::GenerateInfo const & info, TDataCache & base,
+                   osm::OsmChange const & change)
+    : m_info(info), m_base(base), m_change(change), m_changed(base, change)
+  {
+    CHECK(!info.m_baseTmpDir.empty(), ("Base .mwm.tmp files are not set."));
+    CHECK_NOT_EQUAL(my::JoinFoldersToPath(info.m_baseTmpDir, string()),
+                    my::JoinFoldersToPath(info.m_tmpDir, string()),
+                    ("Base .mwm.tmp files can't be updated in place."));
+
+    // Countries are the same as Polygonizer has.
+    if (info.m_splitByPolygons)
+    {
+      CHECK(borders::LoadCountriesList(info.m_targetDir, m_countries),
+            ("Error loading country polygons files"));
+    }
+    else
+    {
+      m_countries.Add(borders::CountryPolygons(info.m_fileName), MercatorBounds::FullRect());
+    }
+  }
+
+  /// @param[out] names Countries which .mwm.tmp files are written to info.m_tmpDir.
+  void Update(vector<string> & names)
+  {
+    CollectChangedElements();
+    EmitChangedFeatures();
+    LOG(LINFO, ("Features of changed elements:", m_features.size(), "moved nodes:",
+                m_movedPoints.size(), "affected relations:", m_affectedRelations.size()));
+
+    // Patched features can add countries, so countries are scanned until all of them are done.
+    set<string> scanned;
+    while (scanned.size() != m_affectedCountries.size())
+    {
+      vector<string> countries;
+      set_difference(m_affectedCountries.begin(), m_affectedCountries.end(), scanned.begin(),
+                     scanned.end(), back_inserter(countries));
+      for (auto const & country : countries)
+      {
+        ScanCountry(country);
+        scanned.insert(country);
+      }
+    }
+    LOG(LINFO, ("Affected countries:", scanned.size(), "patched features:", m_patched.size()));
+
+    WriteCountries(names);
+  }
+};
 }  // anonymous namespace
 
 
@@ -360,17 +990,7 @@ void AddElementToCache(TCache & cache, TElement const & em)
     {
       // store relation
       RelationElement relation;
-      for (auto const & member : em.Members())
-      {
-        if (member.type == TElement::EntityType::Node)
-          relation.nodes.emplace_back(make_pair(member.ref, string(member.role)));
-        else if (member.type == TElement::EntityType::Way)
-          relation.ways.emplace_back(make_pair(member.ref, string(member.role)));
-        // we just ignore type == "relation"
-      }
-
-      for (auto const & tag : em.Tags())
-        relation.tags.emplace(make_pair(string(tag.key), string(tag.value)));
+      MakeRelationElement(em, relation);
 
       if (relation.IsValid())
         cache.AddRelation(em.id, relation);
@@ -395,76 +1015,93 @@ void BuildFeaturesFromXML(SourceReader & stream, function<void(OsmElement *)> pr
   ParseXMLSequence(stream, parser);
 }
 
-template <typename TCache>
-void BuildIntermediateDataFromO5M(SourceReader & stream, TCache & cache)
+void BuildChangeFromXML(SourceReader & stream, osm::OsmChange & change)
 {
-  using TType = osm::O5MSource::EntityType;
+  XMLChangeSource parser([&change](OsmElement * e, osm::OsmChange::Action action)
+  {
+    change.Add(*e, action);
+  });
+  ParseXMLSequence(stream, parser);
+}
 
-  osm::O5MSource dataset([&stream](uint8_t * buffer, size_t size)
+template <typename TCache>
+void BuildIntermediateDataFromO5M(SourceReader & stream, TCache & cache, bool usePipeline)
+{
+  auto readFn = [&stream](uint8_t * buffer, size_t size)
   {
     return stream.Read(reinterpret_cast<char *>(buffer), size);
-  });
+  };
+
+  if (usePipeline)
+  {
+    // Relations keep all tags in the cache.
+    osm::O5MPipeline pipeline(readFn, [](osm::O5MSource::Entity const & em, OsmElement & p)
+    {
+      osm::ConvertO5MEntity(em, p, false /* filterTags */);
+    });
+    pipeline.Run([&cache](OsmElement * e) { AddElementToCache(cache, *e); });
+    return;
+  }
 
+  osm::O5MSource dataset(readFn);
   for (auto const & e : dataset)
     AddElementToCache(cache, e);
 }
 
-void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor)
+void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor,
+                          bool usePipeline)
 {
-  using TType = osm::O5MSource::EntityType;
-
-  osm::O5MSource dataset([&stream](uint8_t * buffer, size_t size)
+  auto readFn = [&stream](uint8_t * buffer, size_t size)
   {
     return stream.Read(reinterpret_cast<char *>(buffer), size);
-  });
+  };
 
-  auto translate = [](TType t) -> OsmElement::EntityType
+  if (usePipeline)
   {
-    switch (t)
+    osm::O5MPipeline pipeline(readFn, [](osm::O5MSource::Entity const & em, OsmElement & p)
     {
-      case TType::Node: return OsmElement::EntityType::Node;
-      case TType::Way: return OsmElement::EntityType::Way;
-      case TType::Relation: return OsmElement::EntityType::Relation;
-      default: return OsmElement::EntityType::Unknown;
-    }
-  };
+      osm::ConvertO5MEntity(em, p, true /* filterTags */);
+    });
+    pipeline.Run(processor);
+    return;
+  }
 
+  osm::O5MSource dataset(readFn);
   for (auto const & em : dataset)
   {
     OsmElement p;
-    p.id = em.id;
+    osm::ConvertO5MEntity(em, p, true /* filterTags */);
+    processor(&p);
+  }
+}
 
-    switch (em.type)
-    {
-      case TType::Node:
-      {
-        p.type = OsmElement::EntityType::Node;
-        p.lat = em.lat;
-        p.lon = em.lon;
-        break;
-      }
-      case TType::Way:
-      {
-        p.type = OsmElement::EntityType::Way;
-        for (uint64_t nd : em.Nodes())
-          p.AddNd(nd);
-        break;
-      }
-      case TType::Relation:
-      {
-        p.type = OsmElement::EntityType::Relation;
-        for (auto const & member : em.Members())
-          p.AddMember(member.ref, translate(member.type), member.role);
-        break;
-      }
-      default: break;
-    }
+// Number of threads of GenerateInfo::m_threadsCount where 0 means all cores.
+uint32_t GetThreadsCount(feature::GenerateInfo const & info)
+{
+  if (info.m_threadsCount != 0)
+    return info.m_threadsCount;
+  return max(thread::hardware_concurrency(), 1U);
+}
 
-    for (auto const & tag : em.Tags())
-      p.AddTag(tag.key, tag.value);
+template <typename TCache>
+void BuildIntermediateDataFromPBF(SourceReader & stream, TCache & cache, uint32_t threadsCount)
+{
+  // Relations keep all tags in the cache.
+  osm::PbfSource source([&stream](char * buffer, size_t size)
+  {
+    return stream.Read(buffer, size);
+  }, threadsCount, false /* filterTags */);
+  source.Run([&cache](OsmElement * e) { AddElementToCache(cache, *e); });
+}
 
-    processor(&p);
-  }
+void BuildFeaturesFromPBF(SourceReader & stream, function<void(OsmElement *)> processor,
+                          uint32_t threadsCount)
+{
+  osm::PbfSource source([&stream](char * buffer, size_t size)
+  {
+    return stream.Read(buffer, size);
+  }, threadsCount, true /* filterTags */);
+  source.Run(processor);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -496,7 +1133,10 @@ bool GenerateFeaturesImpl(feature::GenerateInfo & info)
         BuildFeaturesFromXML(reader, fn);
         break;
       case feature::GenerateInfo::OsmSourceType::O5M:
-        BuildFeaturesFromO5M(reader, fn);
+        BuildFeaturesFromO5M(reader, fn, info.m_threadsCount != 1);
+        break;
+      case feature::GenerateInfo::OsmSourceType::PBF:
+        BuildFeaturesFromPBF(reader, fn, GetThreadsCount(info));
         break;
     }
 
@@ -518,6 +1158,38 @@ bool GenerateFeaturesImpl(feature::GenerateInfo & info)
   return true;
 }
 
+template <class TNodesHolder>
+bool UpdateFeaturesImpl(feature::GenerateInfo & info)
+{
+  try
+  {
+    osm::OsmChange change;
+    for (auto const & fileName : info.m_osmChangeFiles)
+    {
+      SourceReader reader(fileName);
+      BuildChangeFromXML(reader, change);
+    }
+    LOG(LINFO, ("Changed nodes:", change.GetCount(OsmElement::EntityType::Node),
+                "ways:", change.GetCount(OsmElement::EntityType::Way),
+                "relations:", change.GetCount(OsmElement::EntityType::Relation)));
+
+    TNodesHolder nodes(info.GetIntermediateFileName(NODES_FILE, ""));
+
+    using TDataCache = IntermediateData<TNodesHolder, cache::EMode::Read>;
+    TDataCache cache(nodes, info);
+    cache.LoadIndex();
+
+    CountriesUpdater<TDataCache> updater(info, cache, change);
+    updater.Update(info.m_bucketNames);
+  }
+  catch (Reader::Exception const & e)
+  {
+    LOG(LCRITICAL, ("Error with file ", e.what()));
+  }
+
+  return true;
+}
+
 template <class TNodesHolder>
 bool GenerateIntermediateDataImpl(feature::GenerateInfo & info)
 {
@@ -537,11 +1209,15 @@ bool GenerateIntermediateDataImpl(feature::GenerateInfo & info)
         BuildIntermediateDataFromXML(reader, cache);
         break;
       case feature::GenerateInfo::OsmSourceType::O5M:
-        BuildIntermediateDataFromO5M(reader, cache);
+        BuildIntermediateDataFromO5M(reader, cache, info.m_threadsCount != 1);
+        break;
+      case feature::GenerateInfo::OsmSourceType::PBF:
+        BuildIntermediateDataFromPBF(reader, cache, GetThreadsCount(info));
         break;
     }
 
     cache.SaveIndex();
+    nodes.Finish(GetThreadsCount(info));
     LOG(LINFO, ("Added points count = ", nodes.GetProcessedPoint()));
   }
   catch (Writer::Exception const & e)
@@ -561,6 +1237,24 @@ bool GenerateFeatures(feature::GenerateInfo & info)
       return GenerateFeaturesImpl<cache::MapFilePointStorage<cache::EMode::Read>>(info);
     case feature::GenerateInfo::NodeStorageType::Memory:
       return GenerateFeaturesImpl<cache::RawMemPointStorage<cache::EMode::Read>>(info);
+    case feature::GenerateInfo::NodeStorageType::Sorted:
+      return GenerateFeaturesImpl<cache::SortedFilePointStorage<cache::EMode::Read>>(info);
+  }
+  return false;
+}
+
+bool UpdateFeatures(feature::GenerateInfo & info)
+{
+  switch (info.m_nodeStorageType)
+  {
+    case feature::GenerateInfo::NodeStorageType::File:
+      return UpdateFeaturesImpl<cache::RawFilePointStorage<cache::EMode::Read>>(info);
+    case feature::GenerateInfo::NodeStorageType::Index:
+      return UpdateFeaturesImpl<cache::MapFilePointStorage<cache::EMode::Read>>(info);
+    case feature::GenerateInfo::NodeStorageType::Memory:
+      return UpdateFeaturesImpl<cache::RawMemPointStorage<cache::EMode::Read>>(info);
+    case feature::GenerateInfo::NodeStorageType::Sorted:
+      return UpdateFeaturesImpl<cache::SortedFilePointStorage<cache::EMode::Read>>(info);
   }
   return false;
 }
@@ -575,6 +1269,8 @@ bool GenerateIntermediateData(feature::GenerateInfo & info)
       return GenerateIntermediateDataImpl<cache::MapFilePointStorage<cache::EMode::Write>>(info);
     case feature::GenerateInfo::NodeStorageType::Memory:
       return GenerateIntermediateDataImpl<cache::RawMemPointStorage<cache::EMode::Write>>(info);
+    case feature::GenerateInfo::NodeStorageType::Sorted:
+      return GenerateIntermediateDataImpl<cache::SortedFilePointStorage<cache::EMode::Write>>(info);
   }
   return false;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "generator/generate_info.hpp"
+#include "generator/osm_change.hpp"
 #include "generator/osm_element.hpp"
 
 #include "std/function.hpp"
@@ -35,6 +36,12 @@ public:
 bool GenerateFeatures(feature::GenerateInfo & info);
 bool GenerateIntermediateData(feature::GenerateInfo & info);
 
+/// Updates .mwm.tmp files of countries from info.m_baseTmpDir by info.m_osmChangeFiles applied
+/// to the intermediate data and writes them to info.m_tmpDir, info.m_bucketNames are set to
+/// the updated countries.
+bool UpdateFeatures(feature::GenerateInfo & info);
+
 void BuildFeaturesFromO5M(SourceReader & stream, function<void(OsmElement *)> processor);
 void BuildFeaturesFromXML(SourceReader & stream, function<void(OsmElement *)> processor);
+void BuildChangeFromXML(SourceReader & stream, osm::OsmChange & change);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "generator/osm_change.hpp"
 #include "generator/osm_element.hpp"
 
 class XMLSource
@@ -94,3 +95,43 @@ public:
     }
   }
 };
+
+/// Parser of osmChange files: elements are nested in <create>, <modify> and <delete>
+/// tags and are parsed by XMLSource one level deeper.
+class XMLChangeSource
+{
+  XMLSource m_source;
+  size_t m_depth = 0;
+  osm::OsmChange::Action m_action = osm::OsmChange::Action::Modify;
+
+  using TEmmiterFn = function<void(OsmElement *, osm::OsmChange::Action)>;
+
+public:
+  XMLChangeSource(TEmmiterFn fn)
+    : m_source([this, fn](OsmElement * e) { fn(e, m_action); })
+  {
+  }
+
+  void CharData(string const &) {}
+
+  void AddAttr(string const & key, string const & value)
+  {
+    if (m_depth > 2)
+      m_source.AddAttr(key, value);
+  }
+
+  bool Push(string const & tagName)
+  {
+    if (++m_depth == 1)
+      return true;
+    if (m_depth == 2)
+      m_action = osm::OsmChange::StringToAction(tagName);
+    return m_source.Push(tagName);
+  }
+
+  void Pop(string const & v)
+  {
+    if (m_depth-- > 1)
+      m_source.Pop(v);
+  }
+};
@@ -0,0 +1,73 @@
+#include "generator/pedestrian_roads.hpp"
+#include "generator/borders_generator.hpp"
+#include "generator/borders_loader.hpp"
+
+#include "routing/pedestrian_model.hpp"
+
+#include "indexer/feature.hpp"
+#include "indexer/feature_processor.hpp"
+
+#include "platform/platform.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+
+#include "defines.hpp"
+
+namespace routing
+{
+void ForEachPedestrianRoad(string const & mwmFile, string const & countryName,
+                           TPedestrianRoadFn const & fn)
+{
+  // Vehicle models are chosen by the country part of the name, see FeaturesRoadGraph.
+  string const country = countryName.substr(0, countryName.find('_'));
+  shared_ptr<IVehicleModel> const vehicleModel =
+      PedestrianModelFactory().GetVehicleModelForCountry(country);
+
+  vector<m2::PointD> points;
+  auto addRoad = [&](FeatureType const & ft, uint32_t index)
+  {
+    if (ft.GetFeatureType() != feature::GEOM_LINE)
+      return;
+
+    double const speedKMPH = vehicleModel->GetSpeed(ft);
+    if (speedKMPH <= 0.0)
+      return;
+
+    ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
+    points.clear();
+    for (size_t i = 0; i < ft.GetPointsCount(); ++i)
+      points.push_back(ft.GetPoint(i));
+
+    fn(index, points, speedKMPH, !vehicleModel->IsOneWay(ft));
+  };
+  feature::ForEachFromDat(mwmFile, addRoad);
+}
+
+bool LoadPedestrianRoadsBorders(string const & baseDir, string const & countryName,
+                                vector<m2::RegionD> & borders)
+{
+  borders.clear();
+  string const bordersFile = baseDir + BORDERS_DIR + countryName + BORDERS_EXTENSION;
+  if (!Platform::IsFileExistsByFullPath(bordersFile))
+  {
+    LOG(LWARNING, ("No borders for", countryName, "exits of roads won't be limited by them."));
+    return true;
+  }
+  if (!osm::LoadBorders(bordersFile, borders))
+  {
+    LOG(LERROR, ("Can't load borders", bordersFile));
+    return false;
+  }
+  return true;
+}
+
+bool IsOutsideBorders(vector<m2::RegionD> const & borders, m2::PointD const & point)
+{
+  if (borders.empty())
+    return false;
+  auto const inside = [&point](m2::RegionD const & region) { return region.Contains(point); };
+  return find_if(borders.begin(), borders.end(), inside) == borders.end();
+}
+}  // namespace routing
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "geometry/point2d.hpp"
+#include "geometry/region2d.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/function.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+using TPedestrianRoadFn = function<void(uint32_t featureId, vector<m2::PointD> const & points,
+                                        double speedKMPH, bool bidirectional)>;
+
+/// Calls fn for every road of the mwm which is passable for pedestrians, with the same
+/// geometry and speeds as FeaturesRoadGraph uses.
+/// @param[in]  mwmFile   Full path to the .mwm file.
+/// @param[in]  countryName   Country name same with .mwm file name.
+void ForEachPedestrianRoad(string const & mwmFile, string const & countryName,
+                           TPedestrianRoadFn const & fn);
+
+/// Loads the country borders from the borders directory of baseDir. Without the borders
+/// file the borders are empty, so the mwm is considered to be the only one.
+/// @return False if the borders file can't be loaded.
+bool LoadPedestrianRoadsBorders(string const & baseDir, string const & countryName,
+                                vector<m2::RegionD> & borders);
+
+/// @return True if the point is outside of non-empty borders, roads of other mwms may start there.
+bool IsOutsideBorders(vector<m2::RegionD> const & borders, m2::PointD const & point);
+}  // namespace routing
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/mutex.hpp"
+#include "std/utility.hpp"
+
+namespace osm
+{
+/// Queue with limited size between threads. Close() wakes up both sides:
+/// Pop returns false when the queue is closed and empty, Push drops values
+/// to a closed queue and returns false.
+template <typename T>
+class PipelineQueue
+{
+public:
+  explicit PipelineQueue(size_t maxSize) : m_maxSize(maxSize), m_closed(false) {}
+
+  bool Push(T && value)
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this]() { return m_closed || m_queue.size() < m_maxSize; });
+    if (m_closed)
+      return false;
+    m_queue.push_back(move(value));
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  bool Pop(T & value)
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [this]() { return m_closed || !m_queue.empty(); });
+    if (m_queue.empty())
+      return false;
+    value = move(m_queue.front());
+    m_queue.pop_front();
+    m_notFull.notify_one();
+    return true;
+  }
+
+  void Close()
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_closed = true;
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+  }
+
+private:
+  size_t const m_maxSize;
+  bool m_closed;
+  deque<T> m_queue;
+  mutex m_mutex;
+  condition_variable m_notEmpty;
+  condition_variable m_notFull;
+};
+}  // namespace osm
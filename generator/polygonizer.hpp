@@ -15,7 +15,12 @@
 #include "base/buffer_vector.hpp"
 #include "base/macros.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/map.hpp"
+#include "std/shared_ptr.hpp"
 #include "std/string.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
 
 
 #ifndef PARALLEL_POLYGONIZER
@@ -38,24 +43,59 @@ namespace feature
   {
     feature::GenerateInfo const & m_info;
 
-    vector<FeatureOutT*> m_Buckets;
+    using TFeatures = shared_ptr<vector<FeatureBuilder1> const>;
+    using TCountriesFeatures =
+        vector<pair<borders::CountryPolygons const *, vector<FeatureBuilder1 const *>>>;
+
+    // Features of the country are written by one thread at once, threads write
+    // to different countries in parallel. Features of a batch are written after
+    // all previous batches are split, so the output doesn't depend on threads.
+    struct Bucket
+    {
+      explicit Bucket(string const & fileName) : m_out(fileName) {}
+
+      FeatureOutT m_out;
+      // Features of the batches which aren't written yet by batch numbers,
+      // the batch keeps its features alive.
+      map<size_t, pair<TFeatures, vector<FeatureBuilder1 const *>>> m_pending;
+#if PARALLEL_POLYGONIZER
+      QMutex m_mutex;
+#endif
+    };
+
+    // Number of features which are split by countries in one task.
+    static size_t constexpr kBatchSize = 1024;
+
+    vector<Bucket*> m_Buckets;
     vector<string> m_Names;
     borders::CountriesContainerT m_countries;
+    vector<FeatureBuilder1> m_Batch;
+    size_t m_BatchesCount = 0;
+
+    // Batches which are split, but some of the previous ones are not, with their buckets.
+    map<size_t, vector<Bucket *>> m_SplitBatches;
+    // All batches before this one are split.
+    size_t m_NextBatch = 0;
 
 #if PARALLEL_POLYGONIZER
+    bool m_IsParallel;
     QThreadPool m_ThreadPool;
     QSemaphore m_ThreadPoolSemaphore;
-    QMutex m_EmitFeatureMutex;
+    QMutex m_BucketsMutex;
+    QMutex m_BatchesMutex;
 #endif
 
   public:
     explicit Polygonizer(feature::GenerateInfo const & info) : m_info(info)
-#if PARALLEL_POLYGONIZER
-    , m_ThreadPoolSemaphore(m_ThreadPool.maxThreadCount() * 8)
-#endif
     {
 #if PARALLEL_POLYGONIZER
-      LOG(LINFO, ("Polygonizer thread pool threads:", m_ThreadPool.maxThreadCount()));
+      m_IsParallel = (info.m_threadsCount != 1);
+      if (info.m_threadsCount != 0)
+        m_ThreadPool.setMaxThreadCount(static_cast<int>(info.m_threadsCount));
+      // Limits the number of batches which wait for a thread or for the previous batches.
+      m_ThreadPoolSemaphore.release(m_ThreadPool.maxThreadCount() * 2);
+      if (m_IsParallel)
+        LOG(LINFO, ("Polygonizer thread pool threads:", m_ThreadPool.maxThreadCount()));
 #endif
 
       if (info.m_splitByPolygons)
@@ -112,50 +152,75 @@ namespace feature
 
     void operator () (FeatureBuilder1 const & fb)
     {
-      buffer_vector<borders::CountryPolygons const *, 32> vec;
-      m_countries.ForEachInRect(fb.GetLimitRect(), InsertCountriesPtr(vec));
-
-      switch (vec.size())
-      {
-      case 0:
-        break;
-      case 1:
-        EmitFeature(vec[0], fb);
-        break;
-      default:
-        {
-#if PARALLEL_POLYGONIZER
-          m_ThreadPoolSemaphore.acquire();
-          m_ThreadPool.start(new PolygonizerTask(this, vec, fb));
-#else
-          PolygonizerTask task(this, vec, fb);
-          task.RunBase();
-#endif
-        }
-      }
+      m_Batch.push_back(fb);
+      if (m_Batch.size() == kBatchSize)
+        StartBatch();
     }
 
+    /// Waits for all features to be written, Names() are complete and sorted after it.
     void Finish()
     {
+      if (!m_Batch.empty())
+        StartBatch();
 #if PARALLEL_POLYGONIZER
       m_ThreadPool.waitForDone();
 #endif
+      ASSERT(m_SplitBatches.empty(), ());
+      ASSERT_EQUAL(m_NextBatch, m_BatchesCount, ());
+      sort(m_Names.begin(), m_Names.end());
     }
 
-    void EmitFeature(borders::CountryPolygons const * country, FeatureBuilder1 const & fb)
+    /// Adds the features of the batch to the countries, they are written when all
+    /// previous batches are added.
+    void EmitFeatures(size_t batch, TFeatures const & batchFeatures,
+                      TCountriesFeatures & countries)
     {
+      vector<Bucket *> buckets;
+      for (auto & country : countries)
+      {
+        Bucket & bucket = GetBucket(country.first);
+        {
 #if PARALLEL_POLYGONIZER
-      QMutexLocker mutexLocker(&m_EmitFeatureMutex);
-      UNUSED_VALUE(mutexLocker);
+          QMutexLocker mutexLocker(&bucket.m_mutex);
+          UNUSED_VALUE(mutexLocker);
 #endif
-      if (country->m_index == -1)
+          auto & pending = bucket.m_pending[batch];
+          pending.first = batchFeatures;
+          pending.second.swap(country.second);
+        }
+        buckets.push_back(&bucket);
+      }
+
+      // Takes the buckets of this batch and of the following split ones
+      // if this batch is the next one.
+      size_t nextBatch;
+      size_t doneBatches = 0;
       {
-        m_Names.push_back(country->m_name);
-        m_Buckets.push_back(new FeatureOutT(m_info.GetTmpFileName(country->m_name)));
-        country->m_index = static_cast<int>(m_Buckets.size())-1;
+#if PARALLEL_POLYGONIZER
+        QMutexLocker mutexLocker(&m_BatchesMutex);
+        UNUSED_VALUE(mutexLocker);
+#endif
+        m_SplitBatches[batch].swap(buckets);
+        while (!m_SplitBatches.empty() && m_SplitBatches.begin()->first == m_NextBatch)
+        {
+          auto & split = m_SplitBatches.begin()->second;
+          buckets.insert(buckets.end(), split.begin(), split.end());
+          m_SplitBatches.erase(m_SplitBatches.begin());
+          ++m_NextBatch;
+          ++doneBatches;
+        }
+        nextBatch = m_NextBatch;
       }
 
-      (*(m_Buckets[country->m_index]))(fb);
+      sort(buckets.begin(), buckets.end());
+      buckets.erase(unique(buckets.begin(), buckets.end()), buckets.end());
+      for (Bucket * bucket : buckets)
+        WritePending(*bucket, nextBatch);
+
+#if PARALLEL_POLYGONIZER
+      if (m_IsParallel && doneBatches != 0)
+        m_ThreadPoolSemaphore.release(static_cast<int>(doneBatches));
+#endif
     }
 
     vector<string> const & Names() const
@@ -166,42 +231,120 @@ namespace feature
   private:
     friend class PolygonizerTask;
 
+    void StartBatch()
+    {
+      vector<FeatureBuilder1> batch;
+      batch.swap(m_Batch);
+      m_Batch.reserve(kBatchSize);
+      size_t const number = m_BatchesCount++;
+
+#if PARALLEL_POLYGONIZER
+      if (m_IsParallel)
+      {
+        m_ThreadPoolSemaphore.acquire();
+        m_ThreadPool.start(new PolygonizerTask(this, number, move(batch)));
+        return;
+      }
+#endif
+      PolygonizerTask task(this, number, move(batch));
+      task.RunBase();
+    }
+
+    /// Writes features of the bucket from the batches before nextBatch.
+    void WritePending(Bucket & bucket, size_t nextBatch)
+    {
+#if PARALLEL_POLYGONIZER
+      QMutexLocker mutexLocker(&bucket.m_mutex);
+      UNUSED_VALUE(mutexLocker);
+#endif
+      auto & pending = bucket.m_pending;
+      while (!pending.empty() && pending.begin()->first < nextBatch)
+      {
+        for (FeatureBuilder1 const * fb : pending.begin()->second.second)
+          bucket.m_out(*fb);
+        pending.erase(pending.begin());
+      }
+    }
+
+    Bucket & GetBucket(borders::CountryPolygons const * country)
+    {
+#if PARALLEL_POLYGONIZER
+      QMutexLocker mutexLocker(&m_BucketsMutex);
+      UNUSED_VALUE(mutexLocker);
+#endif
+      if (country->m_index == -1)
+      {
+        m_Names.push_back(country->m_name);
+        m_Buckets.push_back(new Bucket(m_info.GetTmpFileName(country->m_name)));
+        country->m_index = static_cast<int>(m_Buckets.size())-1;
+      }
+      return *m_Buckets[country->m_index];
+    }
+
     class PolygonizerTask
 #if PARALLEL_POLYGONIZER
       : public QRunnable
 #endif
     {
+      using TCountryFeature = pair<borders::CountryPolygons const *, FeatureBuilder1 const *>;
+
     public:
-      PolygonizerTask(Polygonizer * pPolygonizer,
-                      buffer_vector<borders::CountryPolygons const *, 32> const & countries,
-                      FeatureBuilder1 const & fb)
-        : m_pPolygonizer(pPolygonizer), m_Countries(countries), m_FB(fb) {}
+      PolygonizerTask(Polygonizer * pPolygonizer, size_t batch, vector<FeatureBuilder1> && features)
+        : m_pPolygonizer(pPolygonizer), m_Batch(batch),
+          m_Features(make_shared<vector<FeatureBuilder1>>(move(features)))
+      {
+      }
 
       void RunBase()
       {
-        for (size_t i = 0; i < m_Countries.size(); ++i)
+        // Features are grouped by countries to lock every country once per batch,
+        // features of the country keep their order.
+        vector<TCountryFeature> emitted;
+        for (FeatureBuilder1 const & fb : *m_Features)
+        {
+          buffer_vector<borders::CountryPolygons const *, 32> vec;
+          m_pPolygonizer->m_countries.ForEachInRect(fb.GetLimitRect(), InsertCountriesPtr(vec));
+
+          if (vec.size() == 1)
+          {
+            emitted.emplace_back(vec[0], &fb);
+            continue;
+          }
+
+          for (size_t i = 0; i < vec.size(); ++i)
+          {
+            PointChecker doCheck(vec[i]->m_regions);
+            fb.ForEachGeometryPoint(doCheck);
+
+            if (doCheck.m_belongs)
+              emitted.emplace_back(vec[i], &fb);
+          }
+        }
+
+        stable_sort(emitted.begin(), emitted.end(),
+                    [](TCountryFeature const & p1, TCountryFeature const & p2)
         {
-          PointChecker doCheck(m_Countries[i]->m_regions);
-          m_FB.ForEachGeometryPoint(doCheck);
+          return p1.first < p2.first;
+        });
 
-          if (doCheck.m_belongs)
-            m_pPolygonizer->EmitFeature(m_Countries[i], m_FB);
+        TCountriesFeatures countries;
+        for (size_t i = 0; i < emitted.size(); ++i)
+        {
+          if (i == 0 || emitted[i - 1].first != emitted[i].first)
+            countries.emplace_back(emitted[i].first, vector<FeatureBuilder1 const *>());
+          countries.back().second.push_back(emitted[i].second);
         }
+        m_pPolygonizer->EmitFeatures(m_Batch, m_Features, countries);
       }
 
 #if PARALLEL_POLYGONIZER
-      void run()
-      {
-        RunBase();
-
-        m_pPolygonizer->m_ThreadPoolSemaphore.release();
-      }
+      void run() { RunBase(); }
 #endif
 
     private:
       Polygonizer * m_pPolygonizer;
-      buffer_vector<borders::CountryPolygons const *, 32> m_Countries;
-      FeatureBuilder1 m_FB;
+      size_t const m_Batch;
+      shared_ptr<vector<FeatureBuilder1>> m_Features;
     };
   };
 }
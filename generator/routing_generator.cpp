@@ -4,6 +4,7 @@
 #include "generator/borders_loader.hpp"
 #include "generator/gen_mwm_info.hpp"
 
+#include "routing/cross_mwm_overlay.hpp"
 #include "routing/osrm2feature_map.hpp"
 #include "routing/osrm_data_facade.hpp"
 #include "routing/osrm_engine.hpp"
@@ -16,9 +17,13 @@
 #include "indexer/index.hpp"
 #include "indexer/mercator.hpp"
 
+#include "platform/mwm_version.hpp"
+#include "platform/platform.hpp"
+
 #include "geometry/distance_on_sphere.hpp"
 
 #include "coding/file_container.hpp"
+#include "coding/file_writer.hpp"
 #include "coding/read_write_utils.hpp"
 #include "coding/internal/file_data.hpp"
 
@@ -431,4 +436,45 @@ void BuildRoutingIndex(string const & baseDir, string const & countryName, strin
   VERIFY(my::GetFileSize(fPath, sz), ());
   LOG(LINFO, ("Nodes stored:", stored, "Routing index file size:", sz));
 }
+
+void BuildCrossMwmOverlay(string const & baseDir)
+{
+  LOG(LINFO, ("Cross mwm overlay builder"));
+  string const extension = string(DATA_FILE_EXTENSION) + ROUTING_FILE_EXTENSION;
+  Platform::FilesList files;
+  Platform::GetFilesByExt(baseDir, extension, files);
+
+  CrossMwmOverlayBuilder builder;
+  for (string const & file : files)
+  {
+    string const countryName = file.substr(0, file.size() - extension.size());
+    FilesContainerR routingCont(baseDir + file);
+    if (!routingCont.IsExist(ROUTING_CROSS_CONTEXT_TAG))
+    {
+      LOG(LWARNING, ("No cross section in", file));
+      continue;
+    }
+    // The routing file has the same version as the mwm, see CheckMwmConsistency.
+    version::MwmVersion version;
+    if (!version::ReadVersion(routingCont, version))
+    {
+      LOG(LWARNING, ("No version in", file));
+      continue;
+    }
+
+    ModelReaderPtr const reader = routingCont.GetReader(ROUTING_CROSS_CONTEXT_TAG);
+    CrossRoutingContextReader context;
+    context.Load(*reader.GetPtr());
+    builder.AddMwm(countryName, version.timestamp, context);
+  }
+
+  CrossMwmOverlay overlay;
+  builder.Build(overlay);
+
+  FileWriter writer(baseDir + CROSS_MWM_OVERLAY_FILE);
+  overlay.Serialize(writer);
+  LOG(LINFO, ("Cross mwm overlay of", files.size(), "routing files is written,", writer.Pos(),
+              "bytes"));
+}
+
 }
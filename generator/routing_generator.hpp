@@ -15,4 +15,8 @@ void BuildRoutingIndex(string const & baseDir, string const & countryName, strin
 /// @param[in]  countryName   Country name same with .mwm and .border file name.
 /// @param[in]  osrmFile  Full path to .osrm file (all prepared osrm files should be there).
 void BuildCrossRoutingIndex(string const & baseDir, string const & countryName, string const & osrmFile);
+
+/// Merges cross sections of all .mwm.routing files into one CROSS_MWM_OVERLAY_FILE.
+/// @param[in]  baseDir   Full path to .mwm.routing files directory, the overlay is written there.
+void BuildCrossMwmOverlay(string const & baseDir);
 }
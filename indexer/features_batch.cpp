@@ -0,0 +1,81 @@
+#include "indexer/features_batch.hpp"
+
+#include "indexer/feature.hpp"
+#include "indexer/feature_algo.hpp"
+
+#include "base/assert.hpp"
+
+
+void FeaturesBatch::Reset(uint32_t fields, int scale)
+{
+  m_fields = fields;
+  m_scale = scale;
+
+  m_indices.clear();
+  m_geomTypes.clear();
+  m_types.clear();
+  m_typesBegin.clear();
+  m_names.clear();
+  m_centers.clear();
+  m_points.clear();
+  m_pointsBegin.clear();
+
+  if (m_fields & FIELD_TYPES)
+    m_typesBegin.push_back(0);
+  if (m_fields & FIELD_GEOMETRY)
+    m_pointsBegin.push_back(0);
+}
+
+void FeaturesBatch::Append(uint32_t index, FeatureType const & ft)
+{
+  feature::EGeomType const geomType = ft.GetFeatureType();
+  m_indices.push_back(index);
+  m_geomTypes.push_back(geomType);
+
+  if (m_fields & FIELD_TYPES)
+  {
+    ft.ForEachType([this](uint32_t type) { m_types.push_back(type); });
+    m_typesBegin.push_back(static_cast<uint32_t>(m_types.size()));
+  }
+
+  if (m_fields & FIELD_NAMES)
+  {
+    StringUtf8Multilang names;
+    auto addName = [&names](int8_t lang, string const & name)
+    {
+      names.AddString(lang, name);
+      return true;
+    };
+    ft.ForEachNameRef(addName);
+    m_names.push_back(move(names));
+  }
+
+  if (m_fields & FIELD_CENTER)
+    m_centers.push_back(feature::GetCenter(ft, m_scale));
+
+  if (m_fields & FIELD_GEOMETRY)
+  {
+    switch (geomType)
+    {
+    case feature::GEOM_POINT:
+      m_points.push_back(ft.GetCenter());
+      break;
+    case feature::GEOM_LINE:
+      ft.ForEachPoint([this](m2::PointD const & pt) { m_points.push_back(pt); }, m_scale);
+      break;
+    case feature::GEOM_AREA:
+      ft.ForEachTriangle([this](m2::PointD const & p1, m2::PointD const & p2,
+                                m2::PointD const & p3)
+      {
+        m_points.push_back(p1);
+        m_points.push_back(p2);
+        m_points.push_back(p3);
+      }, m_scale);
+      break;
+    default:
+      ASSERT(false, (geomType));
+      break;
+    }
+    m_pointsBegin.push_back(static_cast<uint32_t>(m_points.size()));
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "indexer/feature_decl.hpp"
+
+#include "coding/multilang_utf8_string.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/vector.hpp"
+
+class FeatureType;
+
+/// Requested fields of several features as a structure of arrays, is filled by
+/// FeaturesVector::ReadBatch. Fields of the i-th feature are at the i-th position
+/// of the arrays, variable-size fields are in [m_xxxBegin[i], m_xxxBegin[i + 1]).
+/// Arrays of fields which are not requested are empty.
+class FeaturesBatch
+{
+public:
+  enum Field
+  {
+    FIELD_TYPES = 1 << 0,
+    FIELD_NAMES = 1 << 1,
+    FIELD_CENTER = 1 << 2,
+    /// Points of lines, vertices of area triangles or the point of point features.
+    FIELD_GEOMETRY = 1 << 3,
+    FIELD_ALL = FIELD_TYPES | FIELD_NAMES | FIELD_CENTER | FIELD_GEOMETRY
+  };
+
+  FeaturesBatch() : m_fields(0), m_scale(0) {}
+
+  /// Removes features of the previous batch, keeps memory of the arrays.
+  void Reset(uint32_t fields, int scale);
+
+  /// Parses requested fields of the feature.
+  void Append(uint32_t index, FeatureType const & ft);
+
+  size_t size() const { return m_indices.size(); }
+  bool empty() const { return m_indices.empty(); }
+  uint32_t GetFields() const { return m_fields; }
+  int GetScale() const { return m_scale; }
+
+  template <typename ToDo>
+  void ForEachType(size_t i, ToDo && toDo) const
+  {
+    ASSERT(m_fields & FIELD_TYPES, ());
+    for (uint32_t j = m_typesBegin[i]; j < m_typesBegin[i + 1]; ++j)
+      toDo(m_types[j]);
+  }
+
+  template <typename ToDo>
+  void ForEachPoint(size_t i, ToDo && toDo) const
+  {
+    ASSERT(m_fields & FIELD_GEOMETRY, ());
+    for (uint32_t j = m_pointsBegin[i]; j < m_pointsBegin[i + 1]; ++j)
+      toDo(m_points[j]);
+  }
+
+  vector<uint32_t> m_indices;
+  vector<feature::EGeomType> m_geomTypes;
+
+  vector<uint32_t> m_types;
+  vector<uint32_t> m_typesBegin;
+
+  vector<StringUtf8Multilang> m_names;
+
+  vector<m2::PointD> m_centers;
+
+  vector<m2::PointD> m_points;
+  vector<uint32_t> m_pointsBegin;
+
+private:
+  uint32_t m_fields;
+  int m_scale;
+};
@@ -5,6 +5,19 @@
 #include "platform/constants.hpp"
 #include "platform/mwm_version.hpp"
 
+#include "coding/byte_stream.hpp"
+#include "coding/varint.hpp"
+
+#include "std/algorithm.hpp"
+
+
+namespace
+{
+// Records which are closer than the gap are read at once with the gap.
+uint64_t constexpr kMaxBatchGap = 4 * 1024;
+// Maximal size of records which are read at once.
+uint64_t constexpr kMaxBatchChunkSize = 1024 * 1024;
+}  // namespace
 
 void FeaturesVector::GetByIndex(uint32_t index, FeatureType & ft) const
 {
@@ -14,6 +27,80 @@ void FeaturesVector::GetByIndex(uint32_t index, FeatureType & ft) const
   ft.Deserialize(m_LoadInfo.GetLoader(), &m_buffer[offset]);
 }
 
+void FeaturesVector::ReadBatch(vector<uint32_t> const & indices, uint32_t fields, int scale,
+                               FeaturesBatch & batch) const
+{
+  ASSERT(is_sorted(indices.begin(), indices.end()), ());
+  batch.Reset(fields, scale);
+
+  if (!m_table)
+  {
+    // Ends of records are unknown without the offsets table, so they are read one by one.
+    for (uint32_t index : indices)
+    {
+      FeatureType ft;
+      GetByIndex(index, ft);
+      batch.Append(index, ft);
+    }
+    return;
+  }
+
+  auto const reader = m_LoadInfo.GetDataReader();
+  uint64_t const dataSize = reader.Size();
+  auto const getEnd = [&](uint32_t index) -> uint64_t
+  {
+    return index + 1 < m_table->size() ? m_table->GetFeatureOffset(index + 1) : dataSize;
+  };
+
+  size_t i = 0;
+  while (i < indices.size())
+  {
+    uint64_t const chunkBegin = m_table->GetFeatureOffset(indices[i]);
+    uint64_t chunkEnd = getEnd(indices[i]);
+    size_t j = i + 1;
+    for (; j < indices.size(); ++j)
+    {
+      uint64_t const begin = m_table->GetFeatureOffset(indices[j]);
+      uint64_t const end = getEnd(indices[j]);
+      if (begin > chunkEnd + kMaxBatchGap || end - chunkBegin > kMaxBatchChunkSize)
+        break;
+      chunkEnd = max(chunkEnd, end);
+    }
+
+    size_t const chunkSize = static_cast<size_t>(chunkEnd - chunkBegin);
+    if (m_buffer.size() < chunkSize)
+      m_buffer.resize(chunkSize);
+    reader.Read(chunkBegin, m_buffer.data(), chunkSize);
+
+    for (; i < j; ++i)
+    {
+      ArrayByteSource src(&m_buffer[m_table->GetFeatureOffset(indices[i]) - chunkBegin]);
+      // Skip the record size.
+      ReadVarUint<uint32_t>(src);
+
+      FeatureType ft;
+      ft.Deserialize(m_LoadInfo.GetLoader(), src.PtrC());
+      batch.Append(indices[i], ft);
+    }
+  }
+}
+
+
+void FeaturesVector::GetBlockPositions(uint32_t blockSize, vector<uint64_t> & positions) const
+{
+  ASSERT_GREATER(blockSize, 0, ());
+  positions.clear();
+  uint64_t const size = m_RecordReader.Size();
+  uint64_t pos = 0;
+  for (uint32_t index = 0; pos < size; ++index)
+  {
+    if (index % blockSize == 0)
+      positions.push_back(pos);
+    pos = m_RecordReader.SkipRecord(pos);
+  }
+  ASSERT_EQUAL(pos, size, ());
+  positions.push_back(size);
+}
 
 FeaturesVectorTest::FeaturesVectorTest(string const & filePath)
   : FeaturesVectorTest((FilesContainerR(filePath, READER_CHUNK_LOG_SIZE, READER_CHUNK_LOG_COUNT)))
@@ -1,6 +1,7 @@
 #pragma once
 #include "feature.hpp"
 #include "feature_loader_base.hpp"
+#include "features_batch.hpp"
 
 #include "coding/var_record_reader.hpp"
 
@@ -22,10 +23,25 @@ public:
 
   void GetByIndex(uint32_t index, FeatureType & ft) const;
 
+  /// Reads requested fields of features with sorted indices to batch.
+  /// Records of close features are read from the data section at once.
+  /// @param[in] fields Combination of FeaturesBatch::Field values.
+  void ReadBatch(vector<uint32_t> const & indices, uint32_t fields, int scale,
+                 FeaturesBatch & batch) const;
+
   template <class ToDo> void ForEach(ToDo && toDo) const
   {
-    uint32_t index = 0;
-    m_RecordReader.ForEachRecord([&] (uint32_t pos, char const * data, uint32_t /*size*/)
+    ForEachInRange(0, m_RecordReader.Size(), 0, forward<ToDo>(toDo));
+  }
+
+  /// Calls toDo for the features whose records are in [beginPos, endPos) of the data section.
+  /// @param[in] beginIndex Index of the first of the features.
+  template <class ToDo>
+  void ForEachInRange(uint64_t beginPos, uint64_t endPos, uint32_t beginIndex, ToDo && toDo) const
+  {
+    uint32_t index = beginIndex;
+    m_RecordReader.ForEachRecord(beginPos, endPos, [&] (uint32_t pos, char const * data,
+                                                        uint32_t /*size*/)
     {
       FeatureType ft;
       ft.Deserialize(m_LoadInfo.GetLoader(), data);
@@ -33,6 +49,10 @@ public:
     });
   }
 
+  /// Gets positions of every blockSize-th feature's record in the data section followed by
+  /// the size of the section. Only sizes of the records are read.
+  void GetBlockPositions(uint32_t blockSize, vector<uint64_t> & positions) const;
+
   template <class ToDo> static void ForEachOffset(ModelReaderPtr reader, ToDo && toDo)
   {
     VarRecordReader<ModelReaderPtr, &VarRecordSizeReaderVarint> recordReader(reader, 256);
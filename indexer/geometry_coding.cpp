@@ -3,12 +3,148 @@
 #include "base/assert.hpp"
 #include "base/stl_add.hpp"
 
+#include "std/algorithm.hpp"
 #include "std/complex.hpp"
 #include "std/vector.hpp"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define GEOMETRY_CODING_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GEOMETRY_CODING_NEON
+#endif
+
 
 namespace
 {
+#if defined(GEOMETRY_CODING_SSE2)
+  // One step of bits::PerfectUnshuffle on each 32-bit lane.
+  template <int kShift>
+  inline __m128i UnshuffleStep(__m128i x, uint32_t mask, uint32_t keep)
+  {
+    __m128i const m = _mm_set1_epi32(static_cast<int>(mask));
+    __m128i const k = _mm_set1_epi32(static_cast<int>(keep));
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(x, m), kShift),
+                                     _mm_and_si128(_mm_srli_epi32(x, kShift), m)),
+                        _mm_and_si128(x, k));
+  }
+
+  inline __m128i PerfectUnshuffle(__m128i x)
+  {
+    x = UnshuffleStep<1>(x, 0x22222222, 0x99999999);
+    x = UnshuffleStep<2>(x, 0x0C0C0C0C, 0xC3C3C3C3);
+    x = UnshuffleStep<4>(x, 0x00F000F0, 0xF00FF00F);
+    return UnshuffleStep<8>(x, 0x0000FF00, 0xFF0000FF);
+  }
+
+  inline __m128i ZigZagDecode(__m128i x)
+  {
+    __m128i const sign = _mm_sub_epi32(_mm_setzero_si128(),
+                                       _mm_and_si128(x, _mm_set1_epi32(1)));
+    return _mm_xor_si128(_mm_srli_epi32(x, 1), sign);
+  }
+
+  // Splits 4 deltas.
+  inline void SplitDeltas4(uint64_t const * deltas, int32_t * dx, int32_t * dy)
+  {
+    // Lanes are [lo0, hi0, lo1, hi1] and [lo2, hi2, lo3, hi3], then [lo0, lo1, hi0, hi1] ...
+    __m128i const a = _mm_shuffle_epi32(
+        PerfectUnshuffle(_mm_loadu_si128(reinterpret_cast<__m128i const *>(deltas))),
+        _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i const b = _mm_shuffle_epi32(
+        PerfectUnshuffle(_mm_loadu_si128(reinterpret_cast<__m128i const *>(deltas + 2))),
+        _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i const lo = _mm_unpacklo_epi64(a, b);
+    __m128i const hi = _mm_unpackhi_epi64(a, b);
+
+    // The same as bits::BitwiseSplit.
+    __m128i const lowHalf = _mm_set1_epi32(0xFFFF);
+    __m128i const x = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(hi, lowHalf), 16),
+                                   _mm_and_si128(lo, lowHalf));
+    __m128i const y = _mm_or_si128(_mm_andnot_si128(lowHalf, hi), _mm_srli_epi32(lo, 16));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dx), ZigZagDecode(x));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dy), ZigZagDecode(y));
+  }
+#elif defined(GEOMETRY_CODING_NEON)
+  // One step of bits::PerfectUnshuffle on each 32-bit lane.
+  template <int kShift>
+  inline uint32x4_t UnshuffleStep(uint32x4_t x, uint32_t mask, uint32_t keep)
+  {
+    uint32x4_t const m = vdupq_n_u32(mask);
+    return vorrq_u32(vorrq_u32(vshlq_n_u32(vandq_u32(x, m), kShift),
+                               vandq_u32(vshrq_n_u32(x, kShift), m)),
+                     vandq_u32(x, vdupq_n_u32(keep)));
+  }
+
+  inline uint32x4_t PerfectUnshuffle(uint32x4_t x)
+  {
+    x = UnshuffleStep<1>(x, 0x22222222, 0x99999999);
+    x = UnshuffleStep<2>(x, 0x0C0C0C0C, 0xC3C3C3C3);
+    x = UnshuffleStep<4>(x, 0x00F000F0, 0xF00FF00F);
+    return UnshuffleStep<8>(x, 0x0000FF00, 0xFF0000FF);
+  }
+
+  inline int32x4_t ZigZagDecode(uint32x4_t x)
+  {
+    int32x4_t const sign = vnegq_s32(vreinterpretq_s32_u32(vandq_u32(x, vdupq_n_u32(1))));
+    return veorq_s32(vreinterpretq_s32_u32(vshrq_n_u32(x, 1)), sign);
+  }
+
+  // Splits 4 deltas.
+  inline void SplitDeltas4(uint64_t const * deltas, int32_t * dx, int32_t * dy)
+  {
+    uint32x4_t const a = PerfectUnshuffle(vreinterpretq_u32_u64(vld1q_u64(deltas)));
+    uint32x4_t const b = PerfectUnshuffle(vreinterpretq_u32_u64(vld1q_u64(deltas + 2)));
+    // Even lanes are low halves of deltas, odd lanes are high halves.
+    uint32x4x2_t const halves = vuzpq_u32(a, b);
+    uint32x4_t const lo = halves.val[0];
+    uint32x4_t const hi = halves.val[1];
+
+    // The same as bits::BitwiseSplit.
+    uint32x4_t const lowHalf = vdupq_n_u32(0xFFFF);
+    uint32x4_t const x = vorrq_u32(vshlq_n_u32(vandq_u32(hi, lowHalf), 16),
+                                   vandq_u32(lo, lowHalf));
+    uint32x4_t const y = vorrq_u32(vbicq_u32(hi, lowHalf), vshrq_n_u32(lo, 16));
+
+    vst1q_s32(dx, ZigZagDecode(x));
+    vst1q_s32(dy, ZigZagDecode(y));
+  }
+#endif
+
+  // Decodes deltas of the polyline by blocks: the block is split at once by
+  // geo_coding::SplitDeltas, so only the prediction depends on previous points.
+  class DeltasDecoder
+  {
+  public:
+    explicit DeltasDecoder(geo_coding::InDeltasT const & deltas)
+      : m_deltas(deltas), m_blockBegin(0), m_blockEnd(0)
+    {
+    }
+
+    m2::PointU Decode(size_t i, m2::PointU const & prediction)
+    {
+      if (i >= m_blockEnd)
+      {
+        m_blockBegin = i;
+        m_blockEnd = min(i + kBlockSize, m_deltas.size());
+        geo_coding::SplitDeltas(&m_deltas[i], m_blockEnd - m_blockBegin, m_dx, m_dy);
+      }
+      ASSERT_GREATER_OR_EQUAL(i, m_blockBegin, ());
+      return DecodeDelta(m_dx[i - m_blockBegin], m_dy[i - m_blockBegin], prediction);
+    }
+
+  private:
+    static size_t constexpr kBlockSize = 64;
+
+    geo_coding::InDeltasT const & m_deltas;
+    size_t m_blockBegin;
+    size_t m_blockEnd;
+    int32_t m_dx[kBlockSize];
+    int32_t m_dy[kBlockSize];
+  };
+
   inline m2::PointU ClampPoint(m2::PointU const & maxPoint, m2::Point<double> const & point)
   {
     typedef m2::PointU::value_type uvalue_t;
@@ -67,6 +203,27 @@ m2::PointU PredictPointInTriangle(m2::PointU const & maxPoint,
 
 namespace geo_coding
 {
+void SplitDeltas(uint64_t const * deltas, size_t count, int32_t * dx, int32_t * dy)
+{
+  size_t i = 0;
+#if defined(GEOMETRY_CODING_SSE2) || defined(GEOMETRY_CODING_NEON)
+  for (; i + 4 <= count; i += 4)
+    SplitDeltas4(deltas + i, dx + i, dy + i);
+#endif
+  SplitDeltasScalar(deltas + i, count - i, dx + i, dy + i);
+}
+
+void SplitDeltasScalar(uint64_t const * deltas, size_t count, int32_t * dx, int32_t * dy)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    uint32_t x, y;
+    bits::BitwiseSplit(deltas[i], x, y);
+    dx[i] = bits::ZigZagDecode(x);
+    dy[i] = bits::ZigZagDecode(y);
+  }
+}
+
   bool TestDecoding(InPointsT const & points,
                     m2::PointU const & basePoint,
                     m2::PointU const & maxPoint,
@@ -113,9 +270,10 @@ void DecodePolylinePrev1(InDeltasT const & deltas,
   size_t const count = deltas.size();
   if (count > 0)
   {
-    points.push_back(DecodeDelta(deltas[0], basePoint));
+    DeltasDecoder decoder(deltas);
+    points.push_back(decoder.Decode(0, basePoint));
     for (size_t i = 1; i < count; ++i)
-      points.push_back(DecodeDelta(deltas[i], points.back()));
+      points.push_back(decoder.Decode(i, points.back()));
   }
 }
 
@@ -148,15 +306,16 @@ void DecodePolylinePrev2(InDeltasT const & deltas,
   size_t const count = deltas.size();
   if (count > 0)
   {
-    points.push_back(DecodeDelta(deltas[0], basePoint));
+    DeltasDecoder decoder(deltas);
+    points.push_back(decoder.Decode(0, basePoint));
     if (count > 1)
     {
-      points.push_back(DecodeDelta(deltas[1], points.back()));
+      points.push_back(decoder.Decode(1, points.back()));
       for (size_t i = 2; i < count; ++i)
       {
         size_t const n = points.size();
-        points.push_back(DecodeDelta(deltas[i],
-                                     PredictPointInPolyline(maxPoint, points[n-1], points[n-2])));
+        points.push_back(decoder.Decode(i,
+                                        PredictPointInPolyline(maxPoint, points[n-1], points[n-2])));
       }
     }
   }
@@ -259,16 +418,17 @@ void DecodeTriangleStrip(InDeltasT const & deltas,
   {
     ASSERT_GREATER(count, 2, ());
 
-    points.push_back(DecodeDelta(deltas[0], basePoint));
-    points.push_back(DecodeDelta(deltas[1], points.back()));
-    points.push_back(DecodeDelta(deltas[2], points.back()));
+    DeltasDecoder decoder(deltas);
+    points.push_back(decoder.Decode(0, basePoint));
+    points.push_back(decoder.Decode(1, points.back()));
+    points.push_back(decoder.Decode(2, points.back()));
 
     for (size_t i = 3; i < count; ++i)
     {
       size_t const n = points.size();
       m2::PointU const prediction =
           PredictPointInTriangle(maxPoint, points[n-1], points[n-2], points[n-3]);
-      points.push_back(DecodeDelta(deltas[i], prediction));
+      points.push_back(decoder.Decode(i, prediction));
     }
   }
 }
@@ -22,6 +22,12 @@ inline m2::PointU DecodeDelta(uint64_t delta, m2::PointU const & prediction)
   bits::BitwiseSplit(delta, x, y);
   return m2::PointU(prediction.x + bits::ZigZagDecode(x), prediction.y + bits::ZigZagDecode(y));
 }
+
+/// Decodes delta which is already split by geo_coding::SplitDeltas.
+inline m2::PointU DecodeDelta(int32_t dx, int32_t dy, m2::PointU const & prediction)
+{
+  return m2::PointU(prediction.x + dx, prediction.y + dy);
+}
 //@}
 
 
@@ -52,6 +58,14 @@ namespace geo_coding
   typedef array_read<uint64_t> InDeltasT;
   typedef array_write<uint64_t> OutDeltasT;
 
+/// Splits deltas into offsets of points from their predictions, i.e.
+/// DecodeDelta(deltas[i], p) == DecodeDelta(dx[i], dy[i], p).
+/// Uses SSE2 or NEON when they are available.
+void SplitDeltas(uint64_t const * deltas, size_t count, int32_t * dx, int32_t * dy);
+
+/// The same as SplitDeltas but without SIMD.
+void SplitDeltasScalar(uint64_t const * deltas, size_t count, int32_t * dx, int32_t * dy);
+
 void EncodePolylinePrev1(InPointsT const & points,
                          m2::PointU const & basePoint,
                          m2::PointU const & maxPoint,
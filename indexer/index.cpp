@@ -1,5 +1,6 @@
 #include "indexer/index.hpp"
 
+#include "platform/constants.hpp"
 #include "platform/local_country_file_utils.hpp"
 
 #include "coding/file_name_utils.hpp"
@@ -7,6 +8,8 @@
 
 #include "base/logging.hpp"
 
+#include "std/algorithm.hpp"
+
 using platform::CountryFile;
 using platform::LocalCountryFile;
 
@@ -14,8 +17,19 @@ using platform::LocalCountryFile;
 // MwmValue implementation
 //////////////////////////////////////////////////////////////////////////////////
 
-MwmValue::MwmValue(LocalCountryFile const & localFile)
-    : m_cont(platform::GetCountryReader(localFile, MapOptions::Map)),
+namespace
+{
+FilesContainerR CreateContainer(LocalCountryFile const & localFile, bool mapFile)
+{
+  // Files from resources are read through the platform, see LocalCountryFile.
+  if (mapFile && !localFile.GetDirectory().empty())
+    return FilesContainerR(localFile.GetPath(MapOptions::Map), FilesContainerR::MapFile());
+  return FilesContainerR(platform::GetCountryReader(localFile, MapOptions::Map));
+}
+}  // namespace
+
+MwmValue::MwmValue(LocalCountryFile const & localFile, bool mapFile)
+    : m_cont(CreateContainer(localFile, mapFile)),
       m_file(localFile),
       m_table(0)
 {
@@ -32,13 +46,24 @@ void MwmValue::SetTable(MwmInfoEx & info)
   m_table = info.m_table.get();
 }
 
+size_t MwmValue::GetMemorySize() const
+{
+  // Pages of the mapped file are held by the OS.
+  if (m_cont.IsMapped())
+    return sizeof(*this);
+  // The most part of memory is held by the page cache of the container's reader,
+  // see Platform::GetReader. The cache never holds more than the whole file.
+  uint64_t const pageCacheBytes = uint64_t(1) << (READER_CHUNK_LOG_SIZE + READER_CHUNK_LOG_COUNT);
+  return sizeof(*this) + static_cast<size_t>(min(m_cont.GetFileSize(), pageCacheBytes));
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 // Index implementation
 //////////////////////////////////////////////////////////////////////////////////
 
 unique_ptr<MwmInfo> Index::CreateInfo(platform::LocalCountryFile const & localFile) const
 {
-  MwmValue value(localFile);
+  MwmValue value(localFile, m_mapFiles);
 
   feature::DataHeader const & h = value.GetHeader();
   if (!h.IsMWMSuitable())
@@ -57,7 +82,7 @@ unique_ptr<MwmInfo> Index::CreateInfo(platform::LocalCountryFile const & localFi
 
 unique_ptr<MwmSet::MwmValueBase> Index::CreateValue(MwmInfo & info) const
 {
-  unique_ptr<MwmValue> p(new MwmValue(info.GetLocalFile()));
+  unique_ptr<MwmValue> p(new MwmValue(info.GetLocalFile(), m_mapFiles));
   p->SetTable(dynamic_cast<MwmInfoEx &>(info));
   ASSERT(p->GetHeader().IsMWMSuitable(), ());
   return unique_ptr<MwmSet::MwmValueBase>(move(p));
@@ -112,3 +137,10 @@ void Index::FeaturesLoaderGuard::GetFeatureByIndex(uint32_t index, FeatureType &
   m_vector.GetByIndex(index, ft);
   ft.SetID(FeatureID(m_handle.GetId(), index));
 }
+
+void Index::FeaturesLoaderGuard::ReadFeaturesBatch(vector<uint32_t> const & indices,
+                                                   uint32_t fields, int scale,
+                                                   FeaturesBatch & batch)
+{
+  m_vector.ReadBatch(indices, fields, scale, batch);
+}
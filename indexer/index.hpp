@@ -17,9 +17,16 @@
 
 #include "std/algorithm.hpp"
 #include "std/limits.hpp"
+#include "std/shared_ptr.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
+namespace trie
+{
+template <class TReader>
+struct SuccinctSearchData;
+struct MappedSearchData;
+}  // namespace trie
 
 class MwmInfoEx : public MwmInfo
 {
@@ -35,9 +42,25 @@ public:
   platform::LocalCountryFile const m_file;
   feature::FeaturesOffsetsTable const * m_table;
 
-  explicit MwmValue(platform::LocalCountryFile const & localFile);
+  /// Parsed succinct search index, it's created by the first search in the mwm,
+  /// see trie::ReadSearchIndexTrie(MwmValue const &, ...). A value is used by one
+  /// handle at a time, so it needs no lock.
+  mutable shared_ptr<trie::SuccinctSearchData<ModelReaderPtr>> m_succinctSearchData;
+  /// Mapped search index section, see trie::MapSearchIndex. It's not mapped again
+  /// after a failure.
+  mutable shared_ptr<trie::MappedSearchData> m_mappedSearchData;
+  mutable bool m_searchIndexNotMapped = false;
+
+  /// @param[in] mapFile The whole mwm is mapped instead of reading it through page caches,
+  ///                    see FilesContainerR(string const &, MapFile).
+  explicit MwmValue(platform::LocalCountryFile const & localFile, bool mapFile = false);
   void SetTable(MwmInfoEx & info);
 
+  /// @name MwmSet::MwmValueBase overrides.
+  //@{
+  size_t GetMemorySize() const override;
+  //@}
+
   inline feature::DataHeader const & GetHeader() const { return m_factory.GetHeader(); }
   inline version::MwmVersion const & GetMwmVersion() const { return m_factory.GetMwmVersion(); }
   inline string const & GetCountryFileName() const { return m_file.GetCountryFile().GetNameWithoutExt(); }
@@ -87,6 +110,11 @@ public:
 
   bool RemoveObserver(Observer const & observer);
 
+  /// Maps whole mwm files for reading instead of the page caches of each mwm.
+  /// Is suitable for servers with many mwms in memory. Applies to the mwms
+  /// which are not loaded yet, so should be called before registering maps.
+  void SetMapFiles(bool mapFiles) { m_mapFiles = mapFiles; }
+
 private:
 
   template <typename F> class ReadMWMFunctor
@@ -228,6 +256,9 @@ public:
     string GetCountryFileName() const;
     bool IsWorld() const;
     void GetFeatureByIndex(uint32_t index, FeatureType & ft);
+    /// @see FeaturesVector::ReadBatch.
+    void ReadFeaturesBatch(vector<uint32_t> const & indices, uint32_t fields, int scale,
+                           FeaturesBatch & batch);
 
   private:
     MwmHandle m_handle;
@@ -336,4 +367,6 @@ private:
   }
 
   my::ObserverList<Observer> m_observers;
+
+  bool m_mapFiles = false;
 };
@@ -31,6 +31,7 @@ SOURCES += \
     feature_loader_base.cpp \
     feature_utils.cpp \
     feature_visibility.cpp \
+    features_batch.cpp \
     features_offsets_table.cpp \
     features_vector.cpp \
     ftypes_matcher.cpp \
@@ -76,6 +77,7 @@ HEADERS += \
     feature_processor.hpp \
     feature_utils.hpp \
     feature_visibility.hpp \
+    features_batch.hpp \
     features_offsets_table.hpp \
     features_vector.hpp \
     ftypes_matcher.hpp \
@@ -0,0 +1,103 @@
+#include "testing/testing.hpp"
+
+#include "indexer/feature_algo.hpp"
+#include "indexer/features_batch.hpp"
+#include "indexer/features_vector.hpp"
+#include "indexer/scales.hpp"
+
+#include "platform/platform.hpp"
+
+#include "coding/file_container.hpp"
+
+#include "defines.hpp"
+
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+
+namespace
+{
+vector<uint32_t> GetTypes(FeatureType const & ft)
+{
+  vector<uint32_t> types;
+  ft.ForEachType([&types](uint32_t type) { types.push_back(type); });
+  return types;
+}
+
+vector<m2::PointD> GetGeometry(FeatureType const & ft, int scale)
+{
+  vector<m2::PointD> points;
+  switch (ft.GetFeatureType())
+  {
+  case feature::GEOM_POINT:
+    points.push_back(ft.GetCenter());
+    break;
+  case feature::GEOM_LINE:
+    ft.ForEachPoint([&points](m2::PointD const & pt) { points.push_back(pt); }, scale);
+    break;
+  default:
+    ft.ForEachTriangle([&points](m2::PointD const & p1, m2::PointD const & p2,
+                                 m2::PointD const & p3)
+    {
+      points.push_back(p1);
+      points.push_back(p2);
+      points.push_back(p3);
+    }, scale);
+    break;
+  }
+  return points;
+}
+}  // namespace
+
+UNIT_TEST(FeaturesBatch_ReadBatch)
+{
+  FeaturesVectorTest features(
+      FilesContainerR(GetPlatform().GetReader("minsk-pass" DATA_FILE_EXTENSION)));
+  FeaturesVector const & featuresVector = features.GetVector();
+
+  uint32_t count = 0;
+  featuresVector.ForEach([&count](FeatureType const &, uint32_t) { ++count; });
+  TEST_GREATER(count, 0, ());
+
+  // Both close and distant features to check coalesced and separate reads.
+  vector<uint32_t> indices;
+  for (uint32_t i = 0; i < count; i += (i % 100 < 10 ? 1 : 37))
+    indices.push_back(i);
+  indices.push_back(count - 1);
+
+  int const scale = scales::GetUpperScale();
+  FeaturesBatch batch;
+  featuresVector.ReadBatch(indices, FeaturesBatch::FIELD_ALL, scale, batch);
+  TEST_EQUAL(batch.size(), indices.size(), ());
+
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    FeatureType ft;
+    featuresVector.GetByIndex(indices[i], ft);
+
+    TEST_EQUAL(batch.m_indices[i], indices[i], ());
+    TEST_EQUAL(batch.m_geomTypes[i], ft.GetFeatureType(), (i));
+
+    vector<uint32_t> types;
+    batch.ForEachType(i, [&types](uint32_t type) { types.push_back(type); });
+    TEST_EQUAL(types, GetTypes(ft), (i));
+
+    string name, batchName;
+    ft.GetName(FeatureType::DEFAULT_LANG, name);
+    batch.m_names[i].GetString(StringUtf8Multilang::DEFAULT_CODE, batchName);
+    TEST_EQUAL(name, batchName, (i));
+
+    TEST(m2::AlmostEqualULPs(batch.m_centers[i], feature::GetCenter(ft, scale)), (i));
+
+    vector<m2::PointD> points;
+    batch.ForEachPoint(i, [&points](m2::PointD const & pt) { points.push_back(pt); });
+    TEST_EQUAL(points, GetGeometry(ft, scale), (i));
+  }
+
+  // Only requested fields are read.
+  featuresVector.ReadBatch(indices, FeaturesBatch::FIELD_TYPES, scale, batch);
+  TEST_EQUAL(batch.size(), indices.size(), ());
+  TEST(batch.m_names.empty(), ());
+  TEST(batch.m_centers.empty(), ());
+  TEST(batch.m_points.empty(), ());
+}
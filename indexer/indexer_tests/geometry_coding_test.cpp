@@ -16,6 +16,10 @@
 #include "coding/writer.hpp"
 
 #include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/limits.hpp"
+#include "std/random.hpp"
 
 
 typedef m2::PointU PU;
@@ -197,3 +201,114 @@ UNIT_TEST(DecodeEncodePolyline_DataSet1)
   TestPolylineEncode("DataSet1", points, GetMaxPoint(),
                      &geo_coding::EncodePolyline, &geo_coding::DecodePolyline);
 }
+
+UNIT_TEST(SplitDeltas)
+{
+  mt19937 rng(0);
+  uniform_int_distribution<uint64_t> distr;
+
+  vector<uint64_t> deltas = {0, 1, 2, 3, numeric_limits<uint64_t>::max(),
+                             EncodeDelta(PU(0, 0), PU(numeric_limits<uint32_t>::max(), 0)),
+                             EncodeDelta(PU(0, numeric_limits<uint32_t>::max()), PU(0, 0))};
+  for (size_t i = 0; i < 1000; ++i)
+    deltas.push_back(distr(rng));
+
+  // All sizes check the tails which are not multiple of SIMD width.
+  for (size_t count = 0; count <= deltas.size(); count += (count < 16 ? 1 : 97))
+  {
+    vector<int32_t> dx(count), dy(count), scalarDx(count), scalarDy(count);
+    geo_coding::SplitDeltas(deltas.data(), count, dx.data(), dy.data());
+    geo_coding::SplitDeltasScalar(deltas.data(), count, scalarDx.data(), scalarDy.data());
+    TEST_EQUAL(dx, scalarDx, (count));
+    TEST_EQUAL(dy, scalarDy, (count));
+
+    PU const prediction(1000, 2000);
+    for (size_t i = 0; i < count; ++i)
+      TEST_EQUAL(DecodeDelta(deltas[i], prediction), DecodeDelta(dx[i], dy[i], prediction), (i));
+  }
+}
+
+namespace
+{
+// Decoding of the polyline one delta after another as it was before SplitDeltas.
+void DecodePolylinePrev2Scalar(geo_coding::InDeltasT const & deltas, PU const & basePoint,
+                               PU const & maxPoint, geo_coding::OutPointsT & points)
+{
+  size_t const count = deltas.size();
+  if (count > 0)
+  {
+    points.push_back(DecodeDelta(deltas[0], basePoint));
+    if (count > 1)
+    {
+      points.push_back(DecodeDelta(deltas[1], points.back()));
+      for (size_t i = 2; i < count; ++i)
+      {
+        size_t const n = points.size();
+        points.push_back(DecodeDelta(deltas[i],
+                                     PredictPointInPolyline(maxPoint, points[n-1], points[n-2])));
+      }
+    }
+  }
+}
+
+double BenchmarkDecoding(vector<uint64_t> const & deltas, PU const & basePoint,
+                         PU const & maxPoint, size_t iterations, vector<PU> & points,
+                         void (* fnDecode)(geo_coding::InDeltasT const & deltas,
+                                           PU const & basePoint, PU const & maxPoint,
+                                           geo_coding::OutPointsT & points))
+{
+  points.resize(deltas.size());
+  my::Timer timer;
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    geo_coding::OutPointsT adapt(points);
+    fnDecode(make_read_adapter(deltas), basePoint, maxPoint, adapt);
+  }
+  return timer.ElapsedSeconds();
+}
+}  // namespace
+
+UNIT_TEST(DecodePolyline_Benchmark)
+{
+  size_t constexpr kPointsCount = 10000;
+  size_t constexpr kIterations = 100;
+
+  mt19937 rng(0);
+  uniform_int_distribution<int32_t> step(-1000, 1000);
+  PU const maxPoint = GetMaxPoint();
+  PU const basePoint = serial::CodingParams().GetBasePoint();
+
+  vector<PU> points;
+  PU pt(maxPoint.x / 2, maxPoint.y / 2);
+  for (size_t i = 0; i < kPointsCount; ++i)
+  {
+    pt = PU(pt.x + step(rng), pt.y + step(rng));
+    points.push_back(pt);
+  }
+
+  vector<uint64_t> deltas(points.size());
+  geo_coding::OutDeltasT deltasA(deltas);
+  geo_coding::EncodePolyline(make_read_adapter(points), basePoint, maxPoint, deltasA);
+
+  vector<PU> scalarPoints, bulkPoints;
+  double const scalarTime = BenchmarkDecoding(deltas, basePoint, maxPoint, kIterations,
+                                              scalarPoints, &DecodePolylinePrev2Scalar);
+  double const bulkTime = BenchmarkDecoding(deltas, basePoint, maxPoint, kIterations, bulkPoints,
+                                            &geo_coding::DecodePolyline);
+  TEST_EQUAL(points, scalarPoints, ());
+  TEST_EQUAL(points, bulkPoints, ());
+
+  vector<int32_t> dx(deltas.size()), dy(deltas.size());
+  my::Timer timer;
+  for (size_t i = 0; i < kIterations; ++i)
+    geo_coding::SplitDeltasScalar(deltas.data(), deltas.size(), dx.data(), dy.data());
+  double const splitScalarTime = timer.ElapsedSeconds();
+  timer.Reset();
+  for (size_t i = 0; i < kIterations; ++i)
+    geo_coding::SplitDeltas(deltas.data(), deltas.size(), dx.data(), dy.data());
+  double const splitTime = timer.ElapsedSeconds();
+
+  LOG(LINFO, ("Points:", kPointsCount, "iterations:", kIterations));
+  LOG(LINFO, ("Polyline decoding, scalar:", scalarTime, "bulk:", bulkTime));
+  LOG(LINFO, ("Deltas splitting, scalar:", splitScalarTime, "bulk:", splitTime));
+}
@@ -7,6 +7,7 @@
 #include "base/macros.hpp"
 
 #include "std/initializer_list.hpp"
+#include "std/thread.hpp"
 #include "std/unordered_map.hpp"
 
 using platform::CountryFile;
@@ -157,3 +158,107 @@ UNIT_TEST(MwmSetLockAndIdTest)
   TEST(!handle.GetId().IsAlive(), ());
   TEST(!handle.GetId().GetInfo().get(), ());
 }
+
+UNIT_TEST(MwmSetCacheBudgetTest)
+{
+  size_t const kValueSize = MwmSet::MwmValueBase().GetMemorySize();
+  TestMwmSet mwmSet(2 * kValueSize);
+  for (auto const & name : {"0", "1", "2"})
+    UNUSED_VALUE(mwmSet.Register(LocalCountryFile::MakeForTesting(name)));
+
+  UNUSED_VALUE(mwmSet.GetMwmHandleByCountryFile(CountryFile("0")));
+  UNUSED_VALUE(mwmSet.GetMwmHandleByCountryFile(CountryFile("0")));
+
+  MwmSet::CacheStats stats = mwmSet.GetCacheStats();
+  TEST_EQUAL(1, stats.m_hits, (stats));
+  TEST_EQUAL(1, stats.m_misses, (stats));
+  TEST_EQUAL(0, stats.m_evictions, (stats));
+  TEST_EQUAL(kValueSize, stats.m_bytes, (stats));
+
+  // Value of mwm 0 is the least recently used one and must be evicted.
+  UNUSED_VALUE(mwmSet.GetMwmHandleByCountryFile(CountryFile("1")));
+  UNUSED_VALUE(mwmSet.GetMwmHandleByCountryFile(CountryFile("2")));
+
+  stats = mwmSet.GetCacheStats();
+  TEST_EQUAL(1, stats.m_hits, (stats));
+  TEST_EQUAL(3, stats.m_misses, (stats));
+  TEST_EQUAL(1, stats.m_evictions, (stats));
+  TEST_EQUAL(2 * kValueSize, stats.m_bytes, (stats));
+
+  UNUSED_VALUE(mwmSet.GetMwmHandleByCountryFile(CountryFile("2")));
+  UNUSED_VALUE(mwmSet.GetMwmHandleByCountryFile(CountryFile("0")));
+
+  stats = mwmSet.GetCacheStats();
+  TEST_EQUAL(2, stats.m_hits, (stats));
+  TEST_EQUAL(4, stats.m_misses, (stats));
+  TEST_EQUAL(2, stats.m_evictions, (stats));
+
+  mwmSet.ClearCache();
+  TEST_EQUAL(0, mwmSet.GetCacheStats().m_bytes, ());
+}
+
+UNIT_TEST(MwmSetConcurrentLockTest)
+{
+  size_t const kNumThreads = 8;
+  size_t const kNumIterations = 1000;
+
+  TestMwmSet mwmSet;
+  vector<MwmSet::MwmId> ids;
+  for (auto const & name : {"0", "1", "2", "3", "4", "5"})
+    ids.push_back(mwmSet.Register(LocalCountryFile::MakeForTesting(name)).first);
+
+  auto lockValues = [&](size_t seed)
+  {
+    for (size_t i = 0; i < kNumIterations; ++i)
+    {
+      MwmSet::MwmHandle const handle = mwmSet.GetMwmHandleById(ids[(seed + i) % ids.size()]);
+      TEST(handle.IsAlive(), ());
+    }
+  };
+
+  vector<thread> threads;
+  for (size_t i = 0; i < kNumThreads; ++i)
+    threads.emplace_back(lockValues, i);
+  for (auto & t : threads)
+    t.join();
+
+  for (auto const & id : ids)
+    TEST_EQUAL(0, id.GetInfo()->GetNumRefs(), (id));
+
+  MwmSet::CacheStats const stats = mwmSet.GetCacheStats();
+  TEST_EQUAL(kNumThreads * kNumIterations, stats.m_hits + stats.m_misses, (stats));
+}
+
+UNIT_TEST(MwmSetConcurrentDeregisterTest)
+{
+  size_t const kNumThreads = 4;
+  size_t const kNumIterations = 100;
+
+  for (size_t i = 0; i < kNumIterations; ++i)
+  {
+    TestMwmSet mwmSet;
+    MwmSet::MwmId const id = mwmSet.Register(LocalCountryFile::MakeForTesting("0")).first;
+
+    // Handles of a deregistered mwm are empty.
+    auto lockValues = [&]()
+    {
+      for (size_t j = 0; j < kNumIterations; ++j)
+      {
+        MwmSet::MwmHandle const handle = mwmSet.GetMwmHandleById(id);
+        if (!handle.IsAlive())
+          TEST(!id.IsAlive(), ());
+      }
+    };
+
+    vector<thread> threads;
+    for (size_t j = 0; j < kNumThreads; ++j)
+      threads.emplace_back(lockValues);
+    mwmSet.Deregister(CountryFile("0"));
+    for (auto & t : threads)
+      t.join();
+
+    TEST(!id.IsAlive(), ());
+    TEST_EQUAL(0, id.GetInfo()->GetNumRefs(), ());
+    TEST(!mwmSet.GetMwmHandleById(id).IsAlive(), ());
+  }
+}
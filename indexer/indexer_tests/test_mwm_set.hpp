@@ -13,6 +13,9 @@ namespace tests
 
 class TestMwmSet : public MwmSet
 {
+public:
+  explicit TestMwmSet(size_t cacheBytes = kDefaultCacheBytes) : MwmSet(cacheBytes) {}
+
 protected:
   /// @name MwmSet overrides
   //@{
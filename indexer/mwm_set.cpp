@@ -9,13 +9,17 @@
 #include "base/stl_add.hpp"
 
 #include "std/algorithm.hpp"
+#include "std/limits.hpp"
 #include "std/sstream.hpp"
 
 
 using platform::CountryFile;
 using platform::LocalCountryFile;
 
-MwmInfo::MwmInfo() : m_minScale(0), m_maxScale(0), m_status(STATUS_DEREGISTERED), m_numRefs(0) {}
+MwmInfo::MwmInfo()
+  : m_minScale(0), m_maxScale(0), m_status(STATUS_DEREGISTERED), m_numRefs(0), m_cacheShard(0)
+{
+}
 
 MwmInfo::MwmTypeT MwmInfo::GetType() const
 {
@@ -73,6 +77,16 @@ MwmSet::MwmHandle & MwmSet::MwmHandle::operator=(MwmHandle && handle)
   return *this;
 }
 
+MwmSet::MwmSet(size_t cacheBytes)
+  : m_nextShard(0)
+  , m_cacheBytes(cacheBytes)
+  , m_cachedBytes(0)
+  , m_tick(0)
+  , m_hits(0)
+  , m_misses(0)
+  , m_evictions(0)
+{
+}
 
 MwmSet::MwmId MwmSet::GetMwmIdByCountryFileImpl(CountryFile const & countryFile) const
 {
@@ -125,6 +139,8 @@ pair<MwmSet::MwmId, MwmSet::RegResult> MwmSet::RegisterImpl(LocalCountryFile con
     return make_pair(MwmId(), RegResult::UnsupportedFileFormat);
 
   info->m_file = localFile;
+  info->m_cacheShard = m_nextShard;
+  m_nextShard = (m_nextShard + 1) % kNumShards;
   info->SetStatus(MwmInfo::STATUS_REGISTERED);
   m_info[localFile.GetCountryName()].push_back(info);
 
@@ -137,9 +153,11 @@ bool MwmSet::DeregisterImpl(MwmId const & id)
     return false;
 
   shared_ptr<MwmInfo> const & info = id.GetInfo();
+  unique_lock<mutex> shardLock(GetShard(*info).m_lock);
   if (info->m_numRefs == 0)
   {
     info->SetStatus(MwmInfo::STATUS_DEREGISTERED);
+    shardLock.unlock();
     vector<shared_ptr<MwmInfo>> & infos = m_info[info->GetCountryName()];
     infos.erase(remove(infos.begin(), infos.end(), info), infos.end());
     OnMwmDeregistered(info->GetLocalFile());
@@ -188,13 +206,8 @@ void MwmSet::GetMwmsInfo(vector<shared_ptr<MwmInfo>> & info) const
 
 unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValue(MwmId const & id)
 {
-  lock_guard<mutex> lock(m_lock);
-  return LockValueImpl(id);
-}
-
-unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValueImpl(MwmId const & id)
-{
-  CHECK(id.IsAlive(), (id));
+  if (!id.IsAlive())
+    return nullptr;
   shared_ptr<MwmInfo> info = id.GetInfo();
 
   // It's better to return valid "value pointer" even for "out-of-date" files,
@@ -202,61 +215,142 @@ unique_ptr<MwmSet::MwmValueBase> MwmSet::LockValueImpl(MwmId const & id)
   //if (!info->IsUpToDate())
   //  return TMwmValueBasePtr();
 
-  ++info->m_numRefs;
-
-  // Search in cache.
-  for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
   {
-    if (it->first == id)
+    Shard & shard = GetShard(*info);
+    lock_guard<mutex> lock(shard.m_lock);
+
+    // The mwm may be deregistered after the check above, DeregisterImpl
+    // changes the status under the shard lock.
+    if (info->GetStatus() == MwmInfo::STATUS_DEREGISTERED)
+      return nullptr;
+
+    ++info->m_numRefs;
+
+    // Search in cache, starting from the most recently used values.
+    for (auto it = shard.m_entries.end(); it != shard.m_entries.begin();)
     {
-      unique_ptr<MwmValueBase> result = move(it->second);
-      m_cache.erase(it);
-      return result;
+      --it;
+      if (it->m_id == id)
+      {
+        unique_ptr<MwmValueBase> result = move(it->m_value);
+        m_cachedBytes -= it->m_size;
+        shard.m_entries.erase(it);
+        ++m_hits;
+        return result;
+      }
     }
-  }
 
-  try
-  {
-    return CreateValue(*info);
-  }
-  catch (exception const & ex)
-  {
-    LOG(LERROR, ("Can't create MWMValue for", info->GetCountryName(), "Reason", ex.what()));
+    ++m_misses;
 
-    --info->m_numRefs;
-    DeregisterImpl(id);
-    return nullptr;
+    // The value is created under the shard lock, as CreateValue may
+    // lazily initialize shared parts of |info|.
+    try
+    {
+      return CreateValue(*info);
+    }
+    catch (exception const & ex)
+    {
+      LOG(LERROR, ("Can't create MWMValue for", info->GetCountryName(), "Reason", ex.what()));
+      --info->m_numRefs;
+    }
   }
-}
 
-void MwmSet::UnlockValue(MwmId const & id, unique_ptr<MwmValueBase> && p)
-{
   lock_guard<mutex> lock(m_lock);
-  UnlockValueImpl(id, move(p));
+  DeregisterImpl(id);
+  return nullptr;
 }
 
-void MwmSet::UnlockValueImpl(MwmId const & id, unique_ptr<MwmValueBase> && p)
+void MwmSet::UnlockValue(MwmId const & id, unique_ptr<MwmValueBase> && p)
 {
   ASSERT(id.IsAlive() && p, (id));
   if (!id.IsAlive() || !p)
     return;
 
   shared_ptr<MwmInfo> const & info = id.GetInfo();
-  ASSERT_GREATER(info->m_numRefs, 0, ());
-  --info->m_numRefs;
-  if (info->m_numRefs == 0 && info->GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER)
-    VERIFY(DeregisterImpl(id), ());
+  bool needDeregister = false;
+  {
+    Shard & shard = GetShard(*info);
+    lock_guard<mutex> lock(shard.m_lock);
+
+    ASSERT_GREATER(info->m_numRefs, 0, ());
+    --info->m_numRefs;
+    needDeregister =
+        info->m_numRefs == 0 && info->GetStatus() == MwmInfo::STATUS_MARKED_TO_DEREGISTER;
+
+    if (!needDeregister && info->IsUpToDate())
+    {
+      /// @todo Probably, it's better to store only "unique by id" free caches here.
+      /// But it's no obvious if we have many threads working with the single mwm.
+
+      size_t const size = p->GetMemorySize();
+      shard.m_entries.emplace_back(id, move(p), size, m_tick++);
+      m_cachedBytes += size;
+    }
+  }
 
-  if (info->IsUpToDate())
+  if (needDeregister)
   {
-    /// @todo Probably, it's better to store only "unique by id" free caches here.
-    /// But it's no obvious if we have many threads working with the single mwm.
+    // The mwm could be locked again while the shard lock was released,
+    // in this case DeregisterImpl just leaves it marked.
+    lock_guard<mutex> lock(m_lock);
+    DeregisterImpl(id);
+  }
+
+  EvictIfNeeded();
+
+  // Value which was not put into cache is destroyed here, without any lock held.
+}
 
-    m_cache.push_back(make_pair(id, move(p)));
-    if (m_cache.size() > m_cacheSize)
+void MwmSet::EvictIfNeeded()
+{
+  vector<unique_ptr<MwmValueBase>> evicted;
+  while (m_cachedBytes > m_cacheBytes)
+  {
+    // Find the shard with the least recently used value. Shards are locked
+    // one at a time, so the choice is approximate under concurrent access.
+    size_t victim = kNumShards;
+    uint64_t oldestTick = numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < kNumShards; ++i)
     {
-      ASSERT_EQUAL(m_cache.size(), m_cacheSize + 1, ());
-      m_cache.pop_front();
+      lock_guard<mutex> lock(m_shards[i].m_lock);
+      auto const & entries = m_shards[i].m_entries;
+      if (!entries.empty() && entries.front().m_tick < oldestTick)
+      {
+        oldestTick = entries.front().m_tick;
+        victim = i;
+      }
+    }
+
+    if (victim == kNumShards)
+      break;
+
+    Shard & shard = m_shards[victim];
+    lock_guard<mutex> lock(shard.m_lock);
+    if (shard.m_entries.empty())
+      continue;
+    CacheEntry & entry = shard.m_entries.front();
+    evicted.push_back(move(entry.m_value));
+    m_cachedBytes -= entry.m_size;
+    shard.m_entries.pop_front();
+    ++m_evictions;
+  }
+}
+
+template <typename TPred>
+void MwmSet::TakeCachedValues(Shard & shard, TPred && pred,
+                              vector<unique_ptr<MwmValueBase>> & values)
+{
+  for (auto it = shard.m_entries.begin(); it != shard.m_entries.end();)
+  {
+    if (pred(*it))
+    {
+      values.push_back(move(it->m_value));
+      m_cachedBytes -= it->m_size;
+      it = shard.m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
     }
   }
 }
@@ -264,14 +358,28 @@ void MwmSet::UnlockValueImpl(MwmId const & id, unique_ptr<MwmValueBase> && p)
 void MwmSet::Clear()
 {
   lock_guard<mutex> lock(m_lock);
-  ClearCacheImpl(m_cache.begin(), m_cache.end());
+  ClearCache();
   m_info.clear();
 }
 
 void MwmSet::ClearCache()
 {
-  lock_guard<mutex> lock(m_lock);
-  ClearCacheImpl(m_cache.begin(), m_cache.end());
+  vector<unique_ptr<MwmValueBase>> values;
+  for (Shard & shard : m_shards)
+  {
+    lock_guard<mutex> lock(shard.m_lock);
+    TakeCachedValues(shard, [](CacheEntry const &) { return true; }, values);
+  }
+}
+
+MwmSet::CacheStats MwmSet::GetCacheStats() const
+{
+  CacheStats stats;
+  stats.m_hits = m_hits;
+  stats.m_misses = m_misses;
+  stats.m_evictions = m_evictions;
+  stats.m_bytes = m_cachedBytes;
+  return stats;
 }
 
 MwmSet::MwmId MwmSet::GetMwmIdByCountryFile(CountryFile const & countryFile) const
@@ -282,36 +390,21 @@ MwmSet::MwmId MwmSet::GetMwmIdByCountryFile(CountryFile const & countryFile) con
 
 MwmSet::MwmHandle MwmSet::GetMwmHandleByCountryFile(CountryFile const & countryFile)
 {
-  lock_guard<mutex> lock(m_lock);
-  return GetMwmHandleByIdImpl(GetMwmIdByCountryFileImpl(countryFile));
+  return GetMwmHandleById(GetMwmIdByCountryFile(countryFile));
 }
 
 MwmSet::MwmHandle MwmSet::GetMwmHandleById(MwmId const & id)
 {
-  lock_guard<mutex> lock(m_lock);
-  return GetMwmHandleByIdImpl(id);
-}
-
-MwmSet::MwmHandle MwmSet::GetMwmHandleByIdImpl(MwmId const & id)
-{
-  unique_ptr<MwmValueBase> value;
-  if (id.IsAlive())
-    value = LockValueImpl(id);
-  return MwmHandle(*this, id, move(value));
-}
-
-void MwmSet::ClearCacheImpl(CacheType::iterator beg, CacheType::iterator end)
-{
-  m_cache.erase(beg, end);
+  // The handle is empty when the mwm is deregistered.
+  return MwmHandle(*this, id, LockValue(id));
 }
 
 void MwmSet::ClearCache(MwmId const & id)
 {
-  auto sameId = [&id](pair<MwmSet::MwmId, unique_ptr<MwmSet::MwmValueBase>> const & p)
-  {
-    return (p.first == id);
-  };
-  ClearCacheImpl(RemoveIfKeepValid(m_cache.begin(), m_cache.end(), sameId), m_cache.end());
+  vector<unique_ptr<MwmValueBase>> values;
+  Shard & shard = GetShard(*id.GetInfo());
+  lock_guard<mutex> lock(shard.m_lock);
+  TakeCachedValues(shard, [&id](CacheEntry const & entry) { return entry.m_id == id; }, values);
 }
 
 string DebugPrint(MwmSet::RegResult result)
@@ -330,3 +423,11 @@ string DebugPrint(MwmSet::RegResult result)
       return "UnsupportedFileFormat";
   }
 }
+
+string DebugPrint(MwmSet::CacheStats const & stats)
+{
+  ostringstream ss;
+  ss << "CacheStats [ hits: " << stats.m_hits << ", misses: " << stats.m_misses
+     << ", evictions: " << stats.m_evictions << ", bytes: " << stats.m_bytes << " ]";
+  return ss.str();
+}
@@ -8,7 +8,8 @@
 
 #include "base/macros.hpp"
 
-#include "std/deque.hpp"
+#include "std/atomic.hpp"
+#include "std/list.hpp"
 #include "std/map.hpp"
 #include "std/mutex.hpp"
 #include "std/shared_ptr.hpp"
@@ -47,7 +48,7 @@ public:
   uint8_t m_maxScale;             ///< Max zoom level of mwm.
   version::MwmVersion m_version;  ///< Mwm file version.
 
-  inline Status GetStatus() const { return m_status; }
+  inline Status GetStatus() const { return m_status.load(); }
 
   inline bool IsUpToDate() const { return IsRegistered(); }
 
@@ -68,11 +69,12 @@ public:
   uint8_t GetNumRefs() const { return m_numRefs; }
 
 private:
-  inline void SetStatus(Status status) { m_status = status; }
+  inline void SetStatus(Status status) { m_status.store(status); }
 
   platform::LocalCountryFile m_file;  ///< Path to the mwm file.
-  Status m_status;                    ///< Current country status.
-  uint8_t m_numRefs;                  ///< Number of active handles.
+  atomic<Status> m_status;            ///< Current country status.
+  uint8_t m_numRefs;                  ///< Number of active handles, guarded by the cache shard lock.
+  size_t m_cacheShard;                ///< Index of the MwmSet cache shard this mwm belongs to.
 };
 
 class MwmSet
@@ -104,13 +106,32 @@ public:
   };
 
 public:
-  explicit MwmSet(size_t cacheSize = 5) : m_cacheSize(cacheSize) {}
+  /// Default budget for unlocked mwm values kept in cache, in bytes. It keeps at least
+  /// 5 values of big mwms, which hold 4 MB reader page caches, see MwmValue::GetMemorySize.
+  static size_t const kDefaultCacheBytes = 24 * 1024 * 1024;
+
+  explicit MwmSet(size_t cacheBytes = kDefaultCacheBytes);
   virtual ~MwmSet() = default;
 
   class MwmValueBase
   {
   public:
     virtual ~MwmValueBase() = default;
+
+    /// Returns an estimate of memory held by the value. It is used to
+    /// keep cached values within the MwmSet cache budget.
+    virtual size_t GetMemorySize() const { return sizeof(*this); }
+  };
+
+  /// Counters of the cache of unlocked mwm values.
+  struct CacheStats
+  {
+    CacheStats() : m_hits(0), m_misses(0), m_evictions(0), m_bytes(0) {}
+
+    uint64_t m_hits;       ///< Number of LockValue calls served from cache.
+    uint64_t m_misses;     ///< Number of LockValue calls which created a new value.
+    uint64_t m_evictions;  ///< Number of values dropped to fit into the budget.
+    size_t m_bytes;        ///< Current size of cached values.
   };
 
   // Mwm handle, which is used to refer to mwm and prevent it from
@@ -199,6 +220,8 @@ public:
 
   void ClearCache();
 
+  CacheStats GetCacheStats() const;
+
   MwmId GetMwmIdByCountryFile(platform::CountryFile const & countryFile) const;
 
   MwmHandle GetMwmHandleByCountryFile(platform::CountryFile const & countryFile);
@@ -219,22 +242,55 @@ protected:
   virtual unique_ptr<MwmValueBase> CreateValue(MwmInfo & info) const = 0;
 
 private:
-  typedef deque<pair<MwmId, unique_ptr<MwmValueBase>>> CacheType;
+  /// Number of independently locked parts of the values cache. Mwms are
+  /// spread over shards in order of registration, so with a typical number
+  /// of simultaneously used mwms every mwm gets its own lock.
+  static size_t const kNumShards = 16;
 
-  /// @precondition This function is always called under mutex m_lock.
-  MwmHandle GetMwmHandleByIdImpl(MwmId const & id);
+  struct CacheEntry
+  {
+    CacheEntry(MwmId const & id, unique_ptr<MwmValueBase> && value, size_t size, uint64_t tick)
+      : m_id(id), m_value(move(value)), m_size(size), m_tick(tick)
+    {
+    }
 
+    MwmId m_id;
+    unique_ptr<MwmValueBase> m_value;
+    size_t m_size;
+    uint64_t m_tick;  ///< Time of insertion, used to find the least recently used entry.
+  };
+
+  struct Shard
+  {
+    /// Guards m_entries and MwmInfo::m_numRefs of mwms belonging to the shard.
+    mutex m_lock;
+    /// Unlocked values, the least recently used go first.
+    list<CacheEntry> m_entries;
+  };
+
+  inline Shard & GetShard(MwmInfo const & info) { return m_shards[info.m_cacheShard]; }
+
+  /// @return nullptr if the mwm is deregistered or its value can't be created.
   unique_ptr<MwmValueBase> LockValue(MwmId const & id);
-  unique_ptr<MwmValueBase> LockValueImpl(MwmId const & id);
   void UnlockValue(MwmId const & id, unique_ptr<MwmValueBase> && p);
-  void UnlockValueImpl(MwmId const & id, unique_ptr<MwmValueBase> && p);
 
-  /// Do the cleaning for [beg, end) without acquiring the mutex.
-  /// @precondition This function is always called under mutex m_lock.
-  void ClearCacheImpl(CacheType::iterator beg, CacheType::iterator end);
+  /// Drops least recently used values until cache fits into the budget.
+  /// Must be called without any lock held.
+  void EvictIfNeeded();
+
+  /// Moves all cached values satisfying |pred| to |values|.
+  template <typename TPred>
+  void TakeCachedValues(Shard & shard, TPred && pred, vector<unique_ptr<MwmValueBase>> & values);
 
-  CacheType m_cache;
-  size_t const m_cacheSize;
+  Shard m_shards[kNumShards];
+  size_t m_nextShard;
+  size_t const m_cacheBytes;
+
+  atomic<size_t> m_cachedBytes;
+  atomic<uint64_t> m_tick;
+  atomic<uint64_t> m_hits;
+  atomic<uint64_t> m_misses;
+  atomic<uint64_t> m_evictions;
 
 protected:
   /// @precondition This function is always called under mutex m_lock.
@@ -244,10 +300,9 @@ protected:
   /// @precondition This function is always called under mutex m_lock.
   MwmId GetMwmIdByCountryFileImpl(platform::CountryFile const & countryFile) const;
 
-  /// @precondition This function is always called under mutex m_lock.
   WARN_UNUSED_RESULT inline MwmHandle GetLock(MwmId const & id)
   {
-    return MwmHandle(*this, id, LockValueImpl(id));
+    return MwmHandle(*this, id, LockValue(id));
   }
 
   // This method is called under m_lock when mwm is removed from a
@@ -256,7 +311,10 @@ protected:
 
   map<string, vector<shared_ptr<MwmInfo>>> m_info;
 
+  /// Guards the registry of mwms (m_info). Cached values are guarded by shard
+  /// locks, which are always acquired after m_lock.
   mutable mutex m_lock;
 };
 
 string DebugPrint(MwmSet::RegResult result);
+string DebugPrint(MwmSet::CacheStats const & stats);
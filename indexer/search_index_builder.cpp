@@ -19,6 +19,7 @@
 #include "platform/platform.hpp"
 
 #include "coding/reader_writer_ops.hpp"
+#include "coding/succinct_trie_builder.hpp"
 #include "coding/trie_builder.hpp"
 #include "coding/writer.hpp"
 
@@ -33,6 +34,8 @@
 #include "std/fstream.hpp"
 #include "std/initializer_list.hpp"
 #include "std/limits.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/unordered_map.hpp"
 #include "std/vector.hpp"
 
@@ -384,43 +387,86 @@ void AddFeatureNameIndexPairs(FilesContainerR const & container,
       synonyms.get(), stringsFile, categoriesHolder, header.GetScaleRange(), valueBuilder));
 }
 
+// Features are distributed between shards by blocks of consecutive features.
+uint32_t constexpr kFeaturesBlockSize = 1024;
+
 void BuildSearchIndex(FilesContainerR const & cont, CategoriesHolder const & catHolder,
-                      Writer & writer, string const & tmpFilePath)
+                      Writer & writer, string const & tmpFilePath, uint32_t threadsCount,
+                      indexer::SearchIndexFormat format)
 {
+  using TValue = SerializedFeatureInfoValue;
+  using TShard = StringsFileShard<TValue>;
+  using TMerger = StringsFileShardsMerger<TValue>;
+
+  ASSERT_GREATER(threadsCount, 0, ());
+  string const filePath = cont.GetFileName();
+
+  // Positions of the blocks in the data section are found once, so every shard
+  // decodes only the features of its blocks.
+  vector<uint64_t> blockPositions;
+  FeaturesVectorTest(cont).GetVector().GetBlockPositions(kFeaturesBlockSize, blockPositions);
+  uint32_t const blocksCount = static_cast<uint32_t>(blockPositions.size() - 1);
+
+  // Every shard tokenizes and sorts its part of features on its own thread.
+  // FeaturesVector is not thread-safe, so each shard reads its own copy of the container.
+  vector<unique_ptr<TShard>> shards;
+  for (uint32_t shard = 0; shard < threadsCount; ++shard)
   {
-    FeaturesVectorTest features(cont);
-    feature::DataHeader const & header = features.GetHeader();
-
-    serial::CodingParams cp(trie::GetCodingParams(header.GetDefCodingParams()));
-    ValueBuilder<SerializedFeatureInfoValue> valueBuilder(cp);
-
-    unique_ptr<SynonymsHolder> synonyms;
-    if (header.GetType() == feature::DataHeader::world)
-      synonyms.reset(new SynonymsHolder(GetPlatform().WritablePathForFile(SYNONYMS_FILE)));
-
-    StringsFile<SerializedFeatureInfoValue> names(tmpFilePath);
+    auto const fillFn = [&catHolder, &blockPositions, filePath, shard, threadsCount,
+                         blocksCount](StringsFile<TValue> & names)
+    {
+      FeaturesVectorTest features(filePath);
+      feature::DataHeader const & header = features.GetHeader();
 
-    features.GetVector().ForEach(FeatureInserter<StringsFile<SerializedFeatureInfoValue>>(
-        synonyms.get(), names, catHolder, header.GetScaleRange(), valueBuilder));
+      serial::CodingParams cp(trie::GetCodingParams(header.GetDefCodingParams()));
+      ValueBuilder<TValue> valueBuilder(cp);
 
-    names.EndAdding();
-    names.OpenForRead();
-    
-    trie::Build<Writer, typename StringsFile<SerializedFeatureInfoValue>::IteratorT,
-                trie::EmptyEdgeBuilder, ValueList<SerializedFeatureInfoValue>>(
-        writer, names.Begin(), names.End(), trie::EmptyEdgeBuilder());
+      unique_ptr<SynonymsHolder> synonyms;
+      if (header.GetType() == feature::DataHeader::world)
+        synonyms.reset(new SynonymsHolder(GetPlatform().WritablePathForFile(SYNONYMS_FILE)));
 
-    // at this point all readers of StringsFile should be dead
+      FeatureInserter<StringsFile<TValue>> inserter(synonyms.get(), names, catHolder,
+                                                    header.GetScaleRange(), valueBuilder);
+      for (uint32_t block = shard; block < blocksCount; block += threadsCount)
+      {
+        features.GetVector().ForEachInRange(blockPositions[block], blockPositions[block + 1],
+                                            block * kFeaturesBlockSize, inserter);
+      }
+    };
+    shards.emplace_back(new TShard(tmpFilePath + "." + strings::to_string(shard), fillFn));
   }
 
-  FileWriter::DeleteFileX(tmpFilePath);
+  // Sorted strings of the shards are merged on this thread while shards read them.
+  // Shards delete their temporary files in destructors.
+  TMerger merger(shards);
+  switch (format)
+  {
+  case indexer::SearchIndexFormat::Trie:
+    trie::Build<Writer, typename TMerger::IteratorT, trie::EmptyEdgeBuilder, ValueList<TValue>>(
+        writer, merger.Begin(), merger.End(), trie::EmptyEdgeBuilder());
+    break;
+  case indexer::SearchIndexFormat::Succinct:
+    trie::BuildSuccinctTrie<Writer, typename TMerger::IteratorT, trie::EmptyEdgeBuilder,
+                            EliasFanoValueList>(writer, merger.Begin(), merger.End(),
+                                                trie::EmptyEdgeBuilder());
+    break;
+  }
 }
 }  // namespace
 
 namespace indexer {
-bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
+bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild,
+                                 uint32_t threadsCount, SearchIndexFormat format)
 {
-  LOG(LINFO, ("Start building search index. Bits = ", search::kPointCodingBits));
+  if (threadsCount == 0)
+    threadsCount = max(thread::hardware_concurrency(), 1U);
+
+  bool const isSuccinct = (format == SearchIndexFormat::Succinct);
+  string const tag = isSuccinct ? SUCCINCT_SEARCH_INDEX_FILE_TAG : SEARCH_INDEX_FILE_TAG;
+  string const otherTag = isSuccinct ? SEARCH_INDEX_FILE_TAG : SUCCINCT_SEARCH_INDEX_FILE_TAG;
+
+  LOG(LINFO, ("Start building search index. Bits = ", search::kPointCodingBits,
+              "Threads = ", threadsCount, "Tag = ", tag));
 
   try
   {
@@ -431,23 +477,35 @@ bool BuildSearchIndexFromDatFile(string const & datFile, bool forceRebuild)
     {
       FilesContainerR readCont(datFile);
 
-      if (!forceRebuild && readCont.IsExist(SEARCH_INDEX_FILE_TAG))
+      if (!forceRebuild && readCont.IsExist(tag))
         return true;
 
       FileWriter writer(tmpFile2);
 
       CategoriesHolder catHolder(pl.GetReader(SEARCH_CATEGORIES_FILE_NAME));
 
-      BuildSearchIndex(readCont, catHolder, writer, tmpFile1);
+      BuildSearchIndex(readCont, catHolder, writer, tmpFile1, threadsCount, format);
 
       LOG(LINFO, ("Search index size = ", writer.Size()));
     }
 
     {
-      // Write to container in reversed order.
       FilesContainerW writeCont(datFile, FileWriter::OP_WRITE_EXISTING);
-      FileWriter writer = writeCont.GetWriter(SEARCH_INDEX_FILE_TAG);
-      rw_ops::Reverse(FileReader(tmpFile2), writer);
+
+      // Search reads only one of the indices, so the other one is removed.
+      if (writeCont.IsExist(otherTag))
+        writeCont.DeleteSection(otherTag);
+
+      if (isSuccinct)
+      {
+        writeCont.Write(tmpFile2, tag);
+      }
+      else
+      {
+        // Write to container in reversed order.
+        FileWriter writer = writeCont.GetWriter(tag);
+        rw_ops::Reverse(FileReader(tmpFile2), writer);
+      }
     }
 
     FileWriter::DeleteFileX(tmpFile2);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "std/cstdint.hpp"
 #include "std/string.hpp"
 
 class FilesContainerR;
@@ -7,7 +8,21 @@ class Writer;
 
 namespace indexer
 {
-bool BuildSearchIndexFromDatFile(string const & fName, bool forceRebuild = false);
+enum class SearchIndexFormat
+{
+  /// Pointer-based trie in SEARCH_INDEX_FILE_TAG section, see trie::Build.
+  Trie,
+  /// Succinct binary trie on Huffman codes of the symbols with Elias-Fano coded
+  /// value lists in SUCCINCT_SEARCH_INDEX_FILE_TAG section, see trie::BuildSuccinctTrie.
+  Succinct
+};
+
+/// Builds the search index of the format and removes the index of the other format.
+/// @param threadsCount number of threads which tokenize and sort feature names,
+/// 0 means the number of cores.
+bool BuildSearchIndexFromDatFile(string const & fName, bool forceRebuild = false,
+                                 uint32_t threadsCount = 1,
+                                 SearchIndexFormat format = SearchIndexFormat::Trie);
 
 bool AddCompresedSearchIndexSection(string const & fName, bool forceRebuild);
 
@@ -1,11 +1,27 @@
 #pragma once
 
 #include "indexer/geometry_serialization.hpp"
+#include "indexer/index.hpp"
 
+#include "coding/elias_fano_coder.hpp"
+#include "coding/file_container.hpp"
+#include "coding/huffman.hpp"
+#include "coding/mapped_trie_reader.hpp"
 #include "coding/reader.hpp"
+#include "coding/succinct_trie_reader.hpp"
 #include "coding/trie.hpp"
 #include "coding/trie_reader.hpp"
 
+#include "defines.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/string.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
 
 namespace search
 {
@@ -13,6 +29,31 @@ static const uint8_t kCategoriesLang = 128;
 static const uint8_t kPointCodingBits = 20;
 }  // namespace search
 
+namespace search
+{
+// Gets the tag of the search index section of the container. The succinct index
+// is preferred when both are present.
+// Returns false when the container has no search index.
+inline bool GetSearchIndexTag(FilesContainerR const & cont, string & tag)
+{
+  for (char const * t : {SUCCINCT_SEARCH_INDEX_FILE_TAG, SEARCH_INDEX_FILE_TAG})
+  {
+    if (cont.IsExist(t))
+    {
+      tag = t;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool HasSearchIndex(FilesContainerR const & cont)
+{
+  string tag;
+  return GetSearchIndexTag(cont, tag);
+}
+}  // namespace search
+
 namespace trie
 {
 
@@ -24,6 +65,8 @@ class ValueReader
 public:
   explicit ValueReader(serial::CodingParams const & cp) : m_cp(cp) {}
 
+  serial::CodingParams const & GetCodingParams() const { return m_cp; }
+
   struct ValueType
   {
     m2::PointD m_pt;        // Center point of feature;
@@ -39,6 +82,31 @@ public:
     v.m_rank = ReadPrimitiveFromSource<uint8_t>(src);
   }
 
+  // Skips the value by its size: the point is a varuint, the rest has a fixed size.
+  template <typename TSource>
+  void Skip(TSource & src) const
+  {
+    while (ReadPrimitiveFromSource<uint8_t>(src) & 0x80)
+      ;
+    src.Advance(sizeof(uint32_t) + sizeof(uint8_t));
+  }
+
+  // Reads the value list of the succinct search index written by EliasFanoValueList.
+  template <typename TSource, typename TCont>
+  void ReadEliasFanoList(TSource & src, TCont & values) const
+  {
+    vector<uint32_t> ids;
+    coding::DecodeEliasFano(src, ids);
+    values.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      ValueType & v = values[i];
+      v.m_pt = serial::LoadPoint(src, m_cp);
+      v.m_featureId = ids[i];
+      v.m_rank = ReadPrimitiveFromSource<uint8_t>(src);
+    }
+  }
+
   template <class TSink>
   void Save(TSink & sink, ValueType const & v) const
   {
@@ -51,6 +119,126 @@ public:
 using TEdgeValueReader = EmptyValueReader;
 using DefaultIterator =
     trie::Iterator<trie::ValueReader::ValueType, trie::TEdgeValueReader::ValueType>;
+using MappedDefaultIterator = trie::MappedIterator<trie::ValueReader, trie::TEdgeValueReader>;
+using MappedSearchTrie = trie::MappedTrie<trie::ValueReader, trie::TEdgeValueReader>;
+using DefaultIteratorNode =
+    trie::IteratorNode<trie::ValueReader::ValueType, trie::TEdgeValueReader::ValueType>;
+
+// Parsed topology of the succinct search index, which is shared by all iterators over it.
+// It keeps its own copy of the coding params, so it may outlive the value reader it's
+// created with.
+template <class TReader>
+struct SuccinctSearchData
+{
+  SuccinctSearchData(TReader const & reader, serial::CodingParams const & cp)
+    : m_codingParams(cp)
+    , m_valueReader(m_codingParams)
+    , m_topology(reader, m_valueReader, m_edgeValueReader)
+  {
+  }
+
+  serial::CodingParams const m_codingParams;
+  ValueReader const m_valueReader;
+  TEdgeValueReader const m_edgeValueReader;
+  TopologyAndOffsets<TReader, ValueReader, TEdgeValueReader> m_topology;
+};
+
+// Iterator over the succinct search index, see trie::BuildSuccinctTrie.
+// The binary trie is built on Huffman codes of the key symbols, so an edge of this iterator
+// is a path in the binary trie which spells the code of one symbol.
+template <class TReader>
+class SuccinctSearchIterator : public DefaultIterator
+{
+public:
+  using CommonData = SuccinctSearchData<TReader>;
+
+  SuccinctSearchIterator(shared_ptr<CommonData> const & common, uint32_t nodeBitPosition)
+    : m_common(common)
+  {
+    ParseNode(nodeBitPosition);
+  }
+
+  DefaultIterator * Clone() const override { return new SuccinctSearchIterator(*this); }
+
+  DefaultIterator * GoToEdge(size_t i) const override
+  {
+    ASSERT_LESS(i, m_children.size(), ());
+    return new SuccinctSearchIterator(m_common, m_children[i]);
+  }
+
+private:
+  using TCode = coding::HuffmanCoder::Code;
+
+  void ParseNode(uint32_t nodeBitPosition)
+  {
+    auto & topology = m_common->m_topology;
+
+    // Back to 0-based indices.
+    uint32_t const nodeId = topology.GetTopology().rank(nodeBitPosition) - 1;
+    if (topology.NodeIsFinal(nodeId))
+    {
+      TReader const reader =
+          topology.GetReader().SubReader(topology.Offset(nodeId), topology.ValueListSize(nodeId));
+      ReaderSource<TReader> src(reader);
+      m_common->m_valueReader.ReadEliasFanoList(src, this->m_value);
+    }
+
+    buffer_vector<pair<TrieChar, uint32_t>, 8> edges;
+    AddEdges(nodeBitPosition, TCode(), edges);
+    sort(edges.begin(), edges.end());
+
+    this->m_edge.resize(edges.size());
+    m_children.resize(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+      this->m_edge[i].m_str.push_back(edges[i].first);
+      this->m_edge[i].m_value = 0;
+      m_children[i] = edges[i].second;
+    }
+  }
+
+  // Walks down the binary trie until the bits of the path make a code of a symbol.
+  template <class TEdges>
+  void AddEdges(uint32_t bitPosition, TCode const & code, TEdges & edges) const
+  {
+    auto const & topology = m_common->m_topology;
+    succinct::rs_bit_vector const & bits = topology.GetTopology();
+
+    // rank(x) returns the number of ones in [0, x) but bit positions are counted from 1.
+    uint32_t const firstChild = 2 * static_cast<uint32_t>(bits.rank(bitPosition));
+    for (uint32_t bit = 0; bit < 2; ++bit)
+    {
+      uint32_t const child = firstChild + bit;
+      if (child > 2 * topology.NumNodes() || bits[child - 1] == 0)
+        continue;
+
+      TCode const childCode(code.bits | (bit << code.len), code.len + 1);
+      uint32_t symbol;
+      if (topology.GetEncoding().Decode(childCode, symbol))
+        edges.emplace_back(symbol, child);
+      else
+        AddEdges(child, childCode, edges);
+    }
+  }
+
+  shared_ptr<CommonData> m_common;
+
+  // Bit positions of the children in the external node representation of the binary trie.
+  buffer_vector<uint32_t, 8> m_children;
+};
+
+// Search index trie in the mapped section of the mwm, which is shared by all iterators
+// over it. Like SuccinctSearchData it keeps its own copy of the coding params.
+struct MappedSearchData
+{
+  MappedSearchData(FilesMappingContainer const & cont, serial::CodingParams const & cp)
+    : m_codingParams(cp), m_trie(cont, SEARCH_INDEX_FILE_TAG, ValueReader(m_codingParams))
+  {
+  }
+
+  serial::CodingParams const m_codingParams;
+  MappedSearchTrie const m_trie;
+};
 
 inline serial::CodingParams GetCodingParams(serial::CodingParams const & orig)
 {
@@ -58,4 +246,78 @@ inline serial::CodingParams GetCodingParams(serial::CodingParams const & orig)
                               PointU2PointD(orig.GetBasePoint(), orig.GetCoordBits()));
 }
 
+// Returns the root of the search index trie which is read from the section with the tag.
+// The succinct index is parsed on every call, see the MwmValue version.
+template <class TReader>
+DefaultIterator * ReadSearchIndexTrie(string const & tag, TReader const & reader,
+                                      ValueReader const & valueReader)
+{
+  if (tag == SUCCINCT_SEARCH_INDEX_FILE_TAG)
+  {
+    using TIter = SuccinctSearchIterator<TReader>;
+    auto const common = make_shared<typename TIter::CommonData>(reader,
+                                                                valueReader.GetCodingParams());
+    return new TIter(common, 1 /* nodeBitPosition */);
+  }
+  ASSERT_EQUAL(tag, SEARCH_INDEX_FILE_TAG, ());
+  return ReadTrie(reader, valueReader, TEdgeValueReader());
+}
+
+// Maps the search index section of the mwm once, see MwmValue::m_mappedSearchData.
+// @return False when the section can't be mapped, e.g. the mwm is in resources.
+inline bool MapSearchIndex(MwmValue const & value, serial::CodingParams const & cp)
+{
+  if (value.m_mappedSearchData)
+    return true;
+  if (value.m_searchIndexNotMapped)
+    return false;
+
+  value.m_searchIndexNotMapped = true;
+  if (value.m_file.GetDirectory().empty())
+    return false;
+  try
+  {
+    FilesMappingContainer const cont(value.m_file.GetPath(MapOptions::Map));
+    value.m_mappedSearchData = make_shared<MappedSearchData>(cont, cp);
+  }
+  catch (Reader::Exception const & e)
+  {
+    LOG(LWARNING, ("Can't map the search index of", value.GetCountryFileName(), e.Msg()));
+    return false;
+  }
+  value.m_searchIndexNotMapped = false;
+  return true;
+}
+
+// Maps the search index of the mwm when it's the trie index, see MapSearchIndex.
+// Search algorithms walk the mapped trie through value.m_mappedSearchData->m_trie
+// and fall back to ReadSearchIndexTrie below when this returns false.
+inline bool MapSearchIndexTrie(MwmValue const & value, serial::CodingParams const & cp)
+{
+  string tag;
+  VERIFY(search::GetSearchIndexTag(value.m_cont, tag), ());
+  return tag == SEARCH_INDEX_FILE_TAG && MapSearchIndex(value, cp);
+}
+
+// Returns the root of the search index trie of the mwm. The succinct index is parsed
+// once and is kept in the value, see MwmValue::m_succinctSearchData.
+// |valueReader| must outlive the returned iterator.
+inline DefaultIterator * ReadSearchIndexTrie(MwmValue const & value,
+                                             ValueReader const & valueReader)
+{
+  string tag;
+  VERIFY(search::GetSearchIndexTag(value.m_cont, tag), ());
+  ModelReaderPtr reader = value.m_cont.GetReader(tag);
+  if (tag == SUCCINCT_SEARCH_INDEX_FILE_TAG)
+  {
+    if (!value.m_succinctSearchData)
+    {
+      value.m_succinctSearchData =
+          make_shared<SuccinctSearchData<ModelReaderPtr>>(reader, valueReader.GetCodingParams());
+    }
+    return new SuccinctSearchIterator<ModelReaderPtr>(value.m_succinctSearchData,
+                                                      1 /* nodeBitPosition */);
+  }
+  return ReadTrie(reader, valueReader, TEdgeValueReader());
+}
 }  // namespace trie
@@ -6,10 +6,15 @@
 #include "base/macros.hpp"
 #include "base/mem_trie.hpp"
 #include "base/string_utils.hpp"
+#include "base/thread.hpp"
 #include "base/worker_thread.hpp"
 
 #include "coding/read_write_utils.hpp"
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/exception.hpp"
 #include "std/iterator_facade.hpp"
+#include "std/mutex.hpp"
 #include "std/queue.hpp"
 #include "std/functional.hpp"
 #include "std/unique_ptr.hpp"
@@ -300,3 +305,201 @@ void StringsFile<ValueT>::OpenForRead()
   for (size_t i = 0; i < m_offsets.size(); ++i)
     PushNextValue(i);
 }
+
+/// A part of strings which is sorted by its own thread. The thread fills
+/// its StringsFile by the passed function and then streams the sorted
+/// strings by batches to the reading thread, see StringsFileShardsMerger.
+/// StringsFile uses a WorkerThread, so the whole life of the StringsFile
+/// is on the shard thread.
+template <typename TValue>
+class StringsFileShard
+{
+public:
+  using TStringsFile = StringsFile<TValue>;
+  using TString = typename TStringsFile::TString;
+  using StringsListT = typename TStringsFile::StringsListT;
+  using TFillFn = function<void(TStringsFile &)>;
+
+  StringsFileShard(string const & fPath, TFillFn const & fillFn)
+    : m_path(fPath), m_fillFn(fillFn), m_finished(false), m_stopped(false)
+  {
+    m_thread = threads::SimpleThread(&StringsFileShard::ThreadFunc, this);
+  }
+
+  ~StringsFileShard()
+  {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    FileWriter::DeleteFileX(m_path);
+  }
+
+  /// Moves the next batch of sorted strings to |batch|.
+  /// Rethrows an exception of the shard thread.
+  /// @return false when all strings were read.
+  bool PopBatch(StringsListT & batch)
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return !m_batches.empty() || m_finished; });
+    if (m_batches.empty())
+    {
+      if (m_exception)
+        std::rethrow_exception(m_exception);
+      return false;
+    }
+    batch.swap(m_batches.front());
+    m_batches.pop_front();
+    m_cv.notify_all();
+    return true;
+  }
+
+private:
+  static size_t constexpr kBatchSize = 4096;
+  static size_t constexpr kMaxBatches = 4;
+
+  void ThreadFunc()
+  {
+    try
+    {
+      TStringsFile strings(m_path);
+      m_fillFn(strings);
+      strings.EndAdding();
+      strings.OpenForRead();
+
+      StringsListT batch;
+      bool stopped = false;
+      for (auto it = strings.Begin(); it != strings.End() && !stopped; ++it)
+      {
+        batch.push_back(*it);
+        if (batch.size() == kBatchSize)
+          stopped = !PushBatch(batch);
+      }
+      if (!stopped && !batch.empty())
+        PushBatch(batch);
+    }
+    catch (...)
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_exception = std::current_exception();
+    }
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_finished = true;
+    }
+    m_cv.notify_all();
+  }
+
+  /// Waits for a free place in the queue.
+  /// @return false when the shard is stopped.
+  bool PushBatch(StringsListT & batch)
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_batches.size() < kMaxBatches || m_stopped; });
+    if (m_stopped)
+      return false;
+    m_batches.emplace_back();
+    m_batches.back().swap(batch);
+    m_cv.notify_all();
+    return true;
+  }
+
+  string const m_path;
+  TFillFn const m_fillFn;
+
+  mutex m_mutex;
+  condition_variable m_cv;
+  deque<StringsListT> m_batches;
+  bool m_finished;
+  bool m_stopped;
+  std::exception_ptr m_exception;
+
+  threads::SimpleThread m_thread;
+
+  DISALLOW_COPY_AND_MOVE(StringsFileShard);
+};
+
+/// Merges sorted strings of the shards. Shards sort and read their strings
+/// in parallel, so only the heads of the shards are compared here.
+template <typename TValue>
+class StringsFileShardsMerger
+{
+public:
+  using TShard = StringsFileShard<TValue>;
+  using TString = typename TShard::TString;
+
+  class IteratorT : public iterator_facade<IteratorT, TString, forward_traversal_tag, TString>
+  {
+    StringsFileShardsMerger & m_merger;
+    bool m_end;
+
+    inline bool IsEnd() const { return m_merger.m_queue.empty(); }
+
+  public:
+    IteratorT(StringsFileShardsMerger & merger, bool isEnd) : m_merger(merger), m_end(isEnd)
+    {
+      // Additional check in case for empty sequence.
+      if (!m_end)
+        m_end = IsEnd();
+    }
+
+    TString dereference() const
+    {
+      ASSERT(!m_end && !IsEnd(), ());
+      return m_merger.m_queue.top().m_string;
+    }
+
+    bool equal(IteratorT const & r) const { return (m_end == r.m_end); }
+
+    void increment()
+    {
+      ASSERT(!m_end && !IsEnd(), ());
+      size_t const index = m_merger.m_queue.top().m_index;
+      m_merger.m_queue.pop();
+      if (!m_merger.PushNextValue(index))
+        m_end = IsEnd();
+    }
+  };
+
+  /// Blocks until the first batches of all the shards are ready.
+  explicit StringsFileShardsMerger(vector<unique_ptr<TShard>> & shards)
+    : m_shards(shards), m_batches(shards.size()), m_positions(shards.size(), 0)
+  {
+    for (size_t i = 0; i < m_shards.size(); ++i)
+      PushNextValue(i);
+  }
+
+  IteratorT Begin() { return IteratorT(*this, false); }
+  IteratorT End() { return IteratorT(*this, true); }
+
+private:
+  bool PushNextValue(size_t i)
+  {
+    if (m_positions[i] == m_batches[i].size())
+    {
+      if (!m_shards[i]->PopBatch(m_batches[i]))
+        return false;
+      m_positions[i] = 0;
+    }
+    m_queue.push(QValue(m_batches[i][m_positions[i]++], i));
+    return true;
+  }
+
+  struct QValue
+  {
+    TString m_string;
+    size_t m_index;
+
+    QValue(TString const & s, size_t i) : m_string(s), m_index(i) {}
+
+    inline bool operator>(QValue const & rhs) const { return !(m_string < rhs.m_string); }
+  };
+
+  vector<unique_ptr<TShard>> & m_shards;
+  vector<typename TShard::StringsListT> m_batches;
+  vector<size_t> m_positions;
+  priority_queue<QValue, vector<QValue>, greater<QValue>> m_queue;
+};
@@ -1,12 +1,16 @@
 #pragma once
 
+#include "coding/byte_stream.hpp"
 #include "coding/compressed_bit_vector.hpp"
+#include "coding/elias_fano_coder.hpp"
 #include "coding/read_write_utils.hpp"
 #include "coding/write_to_sink.hpp"
 
 #include "base/assert.hpp"
+#include "base/buffer_vector.hpp"
 
 #include "std/algorithm.hpp"
+#include "std/vector.hpp"
 
 /// Following classes are supposed to be used with StringsFile. They
 /// allow to write/read them, compare or serialize to an in-memory
@@ -153,3 +157,64 @@ private:
   buffer_vector<uint8_t, 32> m_value;
   uint32_t m_size;
 };
+
+/// EliasFanoValueList serializes a group of encoded features infos for
+/// the succinct search index. Values are sorted by feature ids, the ids
+/// are written by Elias-Fano coding and followed by the encoded centers
+/// and ranks of the features. Reading is done by
+/// trie::ValueReader::ReadEliasFanoList.
+class EliasFanoValueList
+{
+public:
+  void Append(SerializedFeatureInfoValue const & value)
+  {
+    // A value is [vu: encoded center] [4 bytes: feature id] [1 byte: rank], see
+    // trie::ValueReader::Save.
+    ArrayByteSource src(value.m_value.data());
+    ReadVarUint<uint64_t>(src);
+    size_t const pointSize = src.PtrUC() - value.m_value.data();
+    uint32_t const featureId = ReadPrimitiveFromSource<uint32_t>(src);
+    ASSERT_EQUAL(src.PtrUC() + 1, value.m_value.data() + value.m_value.size(), ());
+
+    m_values.emplace_back();
+    Value & v = m_values.back();
+    v.m_featureId = featureId;
+    v.m_point.assign(value.m_value.data(), value.m_value.data() + pointSize);
+    v.m_rank = value.m_value.back();
+  }
+
+  size_t size() const { return m_values.size(); }
+
+  bool empty() const { return m_values.empty(); }
+
+  template <typename SinkT>
+  void Dump(SinkT & sink) const
+  {
+    vector<Value> values(m_values.begin(), m_values.end());
+    stable_sort(values.begin(), values.end(), [](Value const & lhs, Value const & rhs)
+    {
+      return lhs.m_featureId < rhs.m_featureId;
+    });
+
+    vector<uint32_t> ids(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+      ids[i] = values[i].m_featureId;
+    coding::EncodeEliasFano(sink, ids);
+
+    for (Value const & v : values)
+    {
+      sink.Write(v.m_point.data(), v.m_point.size());
+      WriteToSink(sink, v.m_rank);
+    }
+  }
+
+private:
+  struct Value
+  {
+    uint32_t m_featureId;
+    buffer_vector<uint8_t, 10> m_point;
+    uint8_t m_rank;
+  };
+
+  buffer_vector<Value, 2> m_values;
+};
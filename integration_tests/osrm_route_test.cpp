@@ -234,4 +234,35 @@ namespace
 
     integration::TestRouteTime(route, 910.);
   }
+
+  UNIT_TEST(RussiaWeightsMatrixMatchesRoutesTimeTest)
+  {
+    integration::IRouterComponents & components = integration::GetOsrmComponents();
+    // Two points in Moscow and a point in Smolensk, so the matrix has cross mwm cells too.
+    vector<m2::PointD> const sources = {{37.53804, 67.53647}, {32.05489, 65.78463}};
+    vector<m2::PointD> const targets = {{37.40990, 67.64474}, {37.60169, 67.45807},
+                                        {37.53804, 67.53647}};
+
+    vector<double> weights;
+    TEST_EQUAL(integration::CalculateWeightsMatrix(components, sources, targets, weights),
+               IRouter::NoError, ());
+    TEST_EQUAL(weights.size(), sources.size() * targets.size(), ());
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+      for (size_t j = 0; j < targets.size(); ++j)
+      {
+        double const weight = weights[i * targets.size() + j];
+        if (sources[i] == targets[j])
+        {
+          TEST_LESS(weight, 1., ());
+          continue;
+        }
+        TRouteResult const routeResult =
+            integration::CalculateRoute(components, sources[i], {0., 0.}, targets[j]);
+        TEST_EQUAL(routeResult.second, IRouter::NoError, ());
+        integration::TestRouteTime(*routeResult.first, weight, 0.01);
+      }
+    }
+  }
 }  // namespace
@@ -210,6 +210,17 @@ namespace integration
     return TRouteResult(route, result);
   }
 
+  IRouter::ResultCode CalculateWeightsMatrix(IRouterComponents const & routerComponents,
+                                             vector<m2::PointD> const & sources,
+                                             vector<m2::PointD> const & targets,
+                                             vector<double> & weights)
+  {
+    RouterDelegate delegate;
+    OsrmRouter * router = dynamic_cast<OsrmRouter *>(routerComponents.GetRouter());
+    ASSERT(router, ());
+    return router->CalculateWeightsMatrix(sources, targets, delegate, weights);
+  }
+
   void TestTurnCount(routing::Route const & route, uint32_t expectedTurnCount)
   {
     // We use -1 for ignoring the "ReachedYourDestination" turn record.
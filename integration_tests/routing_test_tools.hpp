@@ -60,6 +60,13 @@ namespace integration
                               m2::PointD const & startPoint, m2::PointD const & startDirection,
                               m2::PointD const & finalPoint);
 
+  /// Calculates the weights matrix by the OSRM router of routerComponents,
+  /// see OsrmRouter::CalculateWeightsMatrix.
+  IRouter::ResultCode CalculateWeightsMatrix(IRouterComponents const & routerComponents,
+                                             vector<m2::PointD> const & sources,
+                                             vector<m2::PointD> const & targets,
+                                             vector<double> & weights);
+
   void TestTurnCount(Route const & route, uint32_t expectedTurnCount);
 
   /// Testing route length.
@@ -2183,7 +2183,7 @@ void Framework::SetRouterImpl(RouterType type)
 
   if (type == RouterType::Pedestrian)
   {
-    router = CreatePedestrianAStarBidirectionalRouter(m_model.GetIndex(), countryFileGetter);
+    router = CreatePedestrianContractionHierarchyRouter(m_model.GetIndex(), countryFileGetter);
     m_routingSession.SetRoutingSettings(routing::GetPedestrianRoutingSettings());
   }
   else
@@ -58,22 +58,49 @@ private:
   shared_ptr<routing::IVehicleModel> const m_model;
 };
 
-unique_ptr<routing::IRouter> CreatePedestrianAStarTestRouter(Index & index)
+// A* algorithms report every kVisitedVerticesPeriod-th visited vertex
+// through RouterDelegate::OnPointCheck, see AStarAlgorithm.
+uint32_t constexpr kVisitedVerticesPeriod = 4;
+
+unique_ptr<routing::IRouter> CreatePedestrianTestRouter(
+    Index & index, string const & name, unique_ptr<routing::IRoutingAlgorithm> && algorithm)
 {
   auto UKGetter = [](m2::PointD const & /* point */){return "UK_England";};
   unique_ptr<routing::IVehicleModelFactory> vehicleModelFactory(new SimplifiedPedestrianModelFactory());
-  unique_ptr<routing::IRoutingAlgorithm> algorithm(new routing::AStarRoutingAlgorithm());
-  unique_ptr<routing::IRouter> router(new routing::RoadGraphRouter("test-astar-pedestrian", index, UKGetter, move(vehicleModelFactory), move(algorithm), nullptr));
+  unique_ptr<routing::IRouter> router(new routing::RoadGraphRouter(name, index, UKGetter, move(vehicleModelFactory), move(algorithm), nullptr));
   return router;
 }
 
+unique_ptr<routing::IRouter> CreatePedestrianAStarTestRouter(Index & index)
+{
+  return CreatePedestrianTestRouter(index, "test-astar-pedestrian",
+                                    make_unique<routing::AStarRoutingAlgorithm>());
+}
+
 unique_ptr<routing::IRouter> CreatePedestrianAStarBidirectionalTestRouter(Index & index)
 {
-  auto UKGetter = [](m2::PointD const & /* point */){return "UK_England";};
-  unique_ptr<routing::IVehicleModelFactory> vehicleModelFactory(new SimplifiedPedestrianModelFactory());
-  unique_ptr<routing::IRoutingAlgorithm> algorithm(new routing::AStarBidirectionalRoutingAlgorithm());
-  unique_ptr<routing::IRouter> router(new routing::RoadGraphRouter("test-astar-bidirectional-pedestrian", index, UKGetter, move(vehicleModelFactory), move(algorithm), nullptr));
-  return router;
+  return CreatePedestrianTestRouter(index, "test-astar-bidirectional-pedestrian",
+                                    make_unique<routing::AStarBidirectionalRoutingAlgorithm>());
+}
+
+unique_ptr<routing::IRouter> CreatePedestrianAStarBidirectionalParallelTestRouter(Index & index)
+{
+  return CreatePedestrianTestRouter(
+      index, "test-astar-bidirectional-parallel-pedestrian",
+      make_unique<routing::AStarBidirectionalParallelRoutingAlgorithm>());
+}
+
+unique_ptr<routing::IRouter> CreatePedestrianAStarDenseTestRouter(Index & index)
+{
+  return CreatePedestrianTestRouter(index, "test-astar-dense-pedestrian",
+                                    make_unique<routing::AStarDenseRoutingAlgorithm>());
+}
+
+unique_ptr<routing::IRouter> CreatePedestrianAStarDenseBidirectionalTestRouter(Index & index)
+{
+  return CreatePedestrianTestRouter(
+      index, "test-astar-dense-bidirectional-pedestrian",
+      make_unique<routing::AStarDenseBidirectionalRoutingAlgorithm>());
 }
 
 m2::PointD GetPointOnEdge(routing::Edge & e, double posAlong)
@@ -97,6 +124,11 @@ void GetNearestPedestrianEdges(Index & index, m2::PointD const & pt, vector<pair
 void TestRouter(routing::IRouter & router, m2::PointD const & startPos, m2::PointD const & finalPos, routing::Route & foundRoute)
 {
   routing::RouterDelegate delegate;
+  uint64_t pointChecks = 0;
+  delegate.SetPointCheckCallback([&pointChecks](m2::PointD const & /* point */)
+                                 {
+                                   ++pointChecks;
+                                 });
   LOG(LINFO, ("Calculating routing ...", router.GetName()));
   routing::Route route("");
   my::Timer timer;
@@ -104,9 +136,13 @@ void TestRouter(routing::IRouter & router, m2::PointD const & startPos, m2::Poin
       startPos, m2::PointD::Zero() /* startDirection */, finalPos, delegate, route);
   double const elapsedSec = timer.ElapsedSeconds();
   TEST_EQUAL(routing::IRouter::NoError, resultCode, ());
+  uint64_t const visitedVertices = pointChecks * kVisitedVerticesPeriod;
   LOG(LINFO, ("Route polyline size:", route.GetPoly().GetSize()));
   LOG(LINFO, ("Route distance, meters:", route.GetTotalDistanceMeters()));
   LOG(LINFO, ("Elapsed, seconds:", elapsedSec));
+  LOG(LINFO, ("Visited vertices:", visitedVertices));
+  if (elapsedSec > 0.0)
+    LOG(LINFO, ("Visited vertices per second:", visitedVertices / elapsedSec));
   foundRoute.Swap(route);
 }
 
@@ -123,9 +159,31 @@ void TestRouters(Index & index, m2::PointD const & startPos, m2::PointD const &
 
   TestRouter(*router, startPos, finalPos, routeFoundByAstar);
 
+  // find route by parallel A*-bidirectional algorithm
+  routing::Route routeFoundByParallelAstarBidirectional("");
+  router = CreatePedestrianAStarBidirectionalParallelTestRouter(index);
+  TestRouter(*router, startPos, finalPos, routeFoundByParallelAstarBidirectional);
+
+  // find route by dense A*-bidirectional algorithm
+  routing::Route routeFoundByDenseAstarBidirectional("");
+  router = CreatePedestrianAStarDenseBidirectionalTestRouter(index);
+  TestRouter(*router, startPos, finalPos, routeFoundByDenseAstarBidirectional);
+
+  // find route by dense A* algorithm
+  routing::Route routeFoundByDenseAstar("");
+  router = CreatePedestrianAStarDenseTestRouter(index);
+  TestRouter(*router, startPos, finalPos, routeFoundByDenseAstar);
+
   double constexpr kEpsilon = 1e-6;
-  TEST(my::AlmostEqualAbs(routeFoundByAstar.GetTotalDistanceMeters(),
+  double const expectedDistance = routeFoundByAstar.GetTotalDistanceMeters();
+  TEST(my::AlmostEqualAbs(expectedDistance,
                           routeFoundByAstarBidirectional.GetTotalDistanceMeters(), kEpsilon), ());
+  TEST(my::AlmostEqualAbs(expectedDistance,
+                          routeFoundByParallelAstarBidirectional.GetTotalDistanceMeters(), kEpsilon), ());
+  TEST(my::AlmostEqualAbs(expectedDistance,
+                          routeFoundByDenseAstar.GetTotalDistanceMeters(), kEpsilon), ());
+  TEST(my::AlmostEqualAbs(expectedDistance,
+                          routeFoundByDenseAstarBidirectional.GetTotalDistanceMeters(), kEpsilon), ());
 }
 
 void TestTwoPointsOnFeature(m2::PointD const & startPos, m2::PointD const & finalPos)
@@ -0,0 +1,136 @@
+#include "routing/async_router_pool.hpp"
+
+#include "base/assert.hpp"
+#include "base/exception.hpp"
+#include "base/logging.hpp"
+#include "base/timer.hpp"
+
+#include "std/algorithm.hpp"
+
+namespace routing
+{
+
+AsyncRouterPool::AsyncRouterPool(TRouterFactory const & routerFactory, size_t workersCount)
+    : m_threadExit(false), m_maxQueueDepth(0)
+{
+  CHECK_GREATER(workersCount, 0, ());
+
+  for (size_t i = 0; i < workersCount; ++i)
+  {
+    m_routers.push_back(routerFactory());
+    CHECK(m_routers.back(), ("Router factory returned no router."));
+  }
+  m_running.resize(workersCount);
+
+  for (size_t i = 0; i < workersCount; ++i)
+    m_threads.emplace_back(&AsyncRouterPool::ThreadFunc, this, i);
+}
+
+AsyncRouterPool::~AsyncRouterPool()
+{
+  {
+    unique_lock<mutex> ul(m_guard);
+
+    m_threadExit = true;
+    m_queue.clear();
+    for (auto const & request : m_running)
+    {
+      if (request)
+        request->m_delegate.Cancel();
+    }
+    m_queueCondVar.notify_all();
+  }
+
+  for (auto & thread : m_threads)
+    thread.join();
+}
+
+void AsyncRouterPool::CalculateRoute(m2::PointD const & startPoint, m2::PointD const & direction,
+                                     m2::PointD const & finalPoint,
+                                     TReadyCallback const & readyCallback, uint32_t timeoutSec)
+{
+  auto request = make_shared<Request>();
+  request->m_startPoint = startPoint;
+  request->m_direction = direction;
+  request->m_finalPoint = finalPoint;
+  request->m_readyCallback = readyCallback;
+  // The deadline timer starts here to count the time spent in the queue.
+  request->m_delegate.SetTimeout(timeoutSec);
+
+  unique_lock<mutex> ul(m_guard);
+
+  m_queue.push_back(move(request));
+  m_maxQueueDepth = max(m_maxQueueDepth, m_queue.size());
+  m_queueCondVar.notify_one();
+}
+
+size_t AsyncRouterPool::GetQueueDepth() const
+{
+  lock_guard<mutex> l(m_guard);
+  return m_queue.size();
+}
+
+size_t AsyncRouterPool::GetMaxQueueDepth() const
+{
+  lock_guard<mutex> l(m_guard);
+  return m_maxQueueDepth;
+}
+
+void AsyncRouterPool::ThreadFunc(size_t worker)
+{
+  while (true)
+  {
+    shared_ptr<Request> request;
+    {
+      unique_lock<mutex> ul(m_guard);
+      m_queueCondVar.wait(ul, [this](){ return m_threadExit || !m_queue.empty(); });
+
+      if (m_threadExit)
+        break;
+
+      request = move(m_queue.front());
+      m_queue.pop_front();
+      m_running[worker] = request;
+    }
+
+    CalculateRoute(*m_routers[worker], *request);
+
+    {
+      lock_guard<mutex> l(m_guard);
+      m_running[worker].reset();
+    }
+  }
+}
+
+void AsyncRouterPool::CalculateRoute(IRouter & router, Request & request)
+{
+  Route route(router.GetName());
+  IRouter::ResultCode code;
+
+  if (request.m_delegate.IsCancelled())
+  {
+    LOG(LINFO, ("Route request missed its deadline in the queue."));
+    request.m_readyCallback(route, IRouter::Cancelled);
+    return;
+  }
+
+  my::Timer timer;
+  try
+  {
+    LOG(LDEBUG, ("Calculating the route from", request.m_startPoint, "to", request.m_finalPoint,
+                 "startDirection", request.m_direction));
+
+    code = router.CalculateRoute(request.m_startPoint, request.m_direction, request.m_finalPoint,
+                                 request.m_delegate, route);
+  }
+  catch (RootException const & e)
+  {
+    code = IRouter::InternalError;
+    LOG(LERROR, ("Exception happened while calculating route:", e.Msg()));
+  }
+
+  LOG(LDEBUG, ("Route request finished with", code, "elapsed seconds:", timer.ElapsedSeconds()));
+  request.m_readyCallback(route, code);
+}
+
+}  // namespace routing
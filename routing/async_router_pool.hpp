@@ -0,0 +1,86 @@
+#pragma once
+
+#include "route.hpp"
+#include "router.hpp"
+#include "router_delegate.hpp"
+
+#include "base/thread.hpp"
+
+#include "std/condition_variable.hpp"
+#include "std/deque.hpp"
+#include "std/function.hpp"
+#include "std/mutex.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/unique_ptr.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+
+/// Runs route calculations concurrently on a pool of worker threads.
+/// Unlike AsyncRouter a new request does not cancel the previous ones: requests are queued
+/// and the oldest one is taken by the first free worker. Routers keep per-route state,
+/// so every worker has its own router. Routers may share a read-only Index.
+class AsyncRouterPool final
+{
+public:
+  /// Callback takes ownership of passed route.
+  using TReadyCallback = function<void(Route &, IRouter::ResultCode)>;
+
+  /// Creates a router for a worker. Is called on the thread which constructs the pool.
+  using TRouterFactory = function<unique_ptr<IRouter>()>;
+
+  /// @param workersCount number of worker threads and routers, must be positive.
+  AsyncRouterPool(TRouterFactory const & routerFactory, size_t workersCount);
+  /// Drops queued requests without calling their callbacks and cancels running ones.
+  ~AsyncRouterPool();
+
+  /// Queues a route calculation from startPoint to finalPoint with start direction.
+  /// The ready callback is called once on a worker thread unless the pool is destroyed
+  /// while the request is queued.
+  ///
+  /// @param timeoutSec deadline of the request counted from this call, so it includes
+  /// the time spent in the queue. The request which misses its deadline in the queue
+  /// is not calculated and is reported as Cancelled. 0 is infinity.
+  void CalculateRoute(m2::PointD const & startPoint, m2::PointD const & direction,
+                      m2::PointD const & finalPoint, TReadyCallback const & readyCallback,
+                      uint32_t timeoutSec);
+
+  /// @return Number of requests waiting for a free worker.
+  size_t GetQueueDepth() const;
+
+  /// @return Maximal number of waiting requests since the pool construction.
+  size_t GetMaxQueueDepth() const;
+
+  size_t GetWorkersCount() const { return m_routers.size(); }
+
+private:
+  struct Request
+  {
+    m2::PointD m_startPoint;
+    m2::PointD m_direction;
+    m2::PointD m_finalPoint;
+    TReadyCallback m_readyCallback;
+    RouterDelegate m_delegate;
+  };
+
+  /// Worker thread function
+  void ThreadFunc(size_t worker);
+
+  /// This function is called in worker thread
+  void CalculateRoute(IRouter & router, Request & request);
+
+  mutable mutex m_guard;
+  condition_variable m_queueCondVar;
+  bool m_threadExit;
+
+  deque<shared_ptr<Request>> m_queue;
+  size_t m_maxQueueDepth;
+
+  /// Router and the current request of each worker.
+  vector<unique_ptr<IRouter>> m_routers;
+  vector<shared_ptr<Request>> m_running;
+  vector<threads::SimpleThread> m_threads;
+};
+
+}  // namespace routing
@@ -0,0 +1,568 @@
+#pragma once
+
+#include "routing/base/astar_algorithm.hpp"
+
+#include "base/assert.hpp"
+#include "base/cancellable.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cstdint.hpp"
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+namespace impl
+{
+uint32_t constexpr kInvalidVertexId = numeric_limits<uint32_t>::max();
+
+// Open-addressing hash table which assigns dense ids [0, Size()) to
+// vertices in order of their insertion. The memory is kept between
+// calls to Clear(), so the table can be reused for many searches
+// without reallocations.
+template <typename TVertex, typename THash>
+class DenseVertexIndex
+{
+public:
+  DenseVertexIndex() : m_epoch(0), m_logCapacity(0) {}
+
+  void Clear()
+  {
+    m_vertices.clear();
+    // Slots from previous epochs are treated as empty, so there is no need
+    // to wipe the table.
+    ++m_epoch;
+    if (m_epoch == 0)
+    {
+      fill(m_slots.begin(), m_slots.end(), Slot());
+      m_epoch = 1;
+    }
+  }
+
+  // Returns the id of |v|, adds |v| to the index if it's not there yet.
+  uint32_t Insert(TVertex const & v)
+  {
+    if (2 * (m_vertices.size() + 1) > m_slots.size())
+      Grow();
+
+    size_t const mask = m_slots.size() - 1;
+    for (size_t i = Bucket(v);; i = (i + 1) & mask)
+    {
+      Slot & slot = m_slots[i];
+      if (slot.m_epoch != m_epoch)
+      {
+        slot.m_epoch = m_epoch;
+        slot.m_id = static_cast<uint32_t>(m_vertices.size());
+        m_vertices.push_back(v);
+        return slot.m_id;
+      }
+      if (m_vertices[slot.m_id] == v)
+        return slot.m_id;
+    }
+  }
+
+  // Returns the id of |v| or kInvalidVertexId if |v| is not in the index.
+  uint32_t Find(TVertex const & v) const
+  {
+    if (m_slots.empty())
+      return kInvalidVertexId;
+
+    size_t const mask = m_slots.size() - 1;
+    for (size_t i = Bucket(v);; i = (i + 1) & mask)
+    {
+      Slot const & slot = m_slots[i];
+      if (slot.m_epoch != m_epoch)
+        return kInvalidVertexId;
+      if (m_vertices[slot.m_id] == v)
+        return slot.m_id;
+    }
+  }
+
+  inline TVertex const & GetVertex(uint32_t id) const
+  {
+    ASSERT_LESS(id, m_vertices.size(), ());
+    return m_vertices[id];
+  }
+
+  inline size_t Size() const { return m_vertices.size(); }
+
+private:
+  struct Slot
+  {
+    Slot() : m_epoch(0), m_id(kInvalidVertexId) {}
+
+    uint32_t m_epoch;
+    uint32_t m_id;
+  };
+
+  inline size_t Bucket(TVertex const & v) const
+  {
+    // Fibonacci hashing spreads sequential hash values (e.g. identity
+    // hash of integer vertices) over the whole table.
+    uint64_t const h = static_cast<uint64_t>(m_hash(v)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h >> (64 - m_logCapacity));
+  }
+
+  void Grow()
+  {
+    m_logCapacity = max(m_logCapacity + 1, static_cast<uint32_t>(10));
+    m_slots.assign(size_t(1) << m_logCapacity, Slot());
+    m_epoch = 1;
+
+    size_t const mask = m_slots.size() - 1;
+    for (uint32_t id = 0; id < m_vertices.size(); ++id)
+    {
+      size_t i = Bucket(m_vertices[id]);
+      while (m_slots[i].m_epoch == m_epoch)
+        i = (i + 1) & mask;
+      m_slots[i].m_epoch = m_epoch;
+      m_slots[i].m_id = id;
+    }
+  }
+
+  vector<Slot> m_slots;
+  vector<TVertex> m_vertices;
+  THash m_hash;
+  uint32_t m_epoch;
+  uint32_t m_logCapacity;
+};
+
+// Indexed 4-ary min-heap of dense vertex ids with the decrease-key
+// operation. A 4-ary heap is shallower than a binary one and its
+// children share a cache line, which makes sift-down cheaper.
+class QuaternaryHeap
+{
+public:
+  inline bool Empty() const { return m_heap.empty(); }
+
+  inline double TopKey() const
+  {
+    ASSERT(!Empty(), ());
+    return m_heap.front().first;
+  }
+
+  void Clear()
+  {
+    for (auto const & e : m_heap)
+      m_pos[e.second] = kInvalidVertexId;
+    m_heap.clear();
+  }
+
+  // Inserts |id| with |key| or decreases the key of |id| if it's already in the heap.
+  void PushOrDecrease(uint32_t id, double key)
+  {
+    if (id >= m_pos.size())
+      m_pos.resize(id + 1, kInvalidVertexId);
+
+    uint32_t pos = m_pos[id];
+    if (pos == kInvalidVertexId)
+    {
+      pos = static_cast<uint32_t>(m_heap.size());
+      m_heap.emplace_back(key, id);
+    }
+    else
+    {
+      ASSERT_LESS_OR_EQUAL(key, m_heap[pos].first, ());
+      m_heap[pos].first = key;
+    }
+    SiftUp(pos);
+  }
+
+  uint32_t Pop()
+  {
+    ASSERT(!Empty(), ());
+    uint32_t const top = m_heap.front().second;
+    m_pos[top] = kInvalidVertexId;
+    if (m_heap.size() > 1)
+    {
+      m_heap.front() = m_heap.back();
+      m_heap.pop_back();
+      SiftDown(0);
+    }
+    else
+    {
+      m_heap.pop_back();
+    }
+    return top;
+  }
+
+private:
+  static uint32_t constexpr kArity = 4;
+
+  void SiftUp(uint32_t pos)
+  {
+    TEntry const e = m_heap[pos];
+    while (pos > 0)
+    {
+      uint32_t const parent = (pos - 1) / kArity;
+      if (m_heap[parent].first <= e.first)
+        break;
+      Place(pos, m_heap[parent]);
+      pos = parent;
+    }
+    Place(pos, e);
+  }
+
+  void SiftDown(uint32_t pos)
+  {
+    TEntry const e = m_heap[pos];
+    uint32_t const size = static_cast<uint32_t>(m_heap.size());
+    while (true)
+    {
+      uint32_t const first = pos * kArity + 1;
+      if (first >= size)
+        break;
+      uint32_t const last = min(first + kArity, size);
+      uint32_t best = first;
+      for (uint32_t child = first + 1; child < last; ++child)
+      {
+        if (m_heap[child].first < m_heap[best].first)
+          best = child;
+      }
+      if (e.first <= m_heap[best].first)
+        break;
+      Place(pos, m_heap[best]);
+      pos = best;
+    }
+    Place(pos, e);
+  }
+
+  using TEntry = pair<double, uint32_t>;
+
+  inline void Place(uint32_t pos, TEntry const & e)
+  {
+    m_heap[pos] = e;
+    m_pos[e.second] = pos;
+  }
+
+  vector<TEntry> m_heap;
+  // Position in m_heap for each vertex id, kInvalidVertexId when not in the heap.
+  vector<uint32_t> m_pos;
+};
+}  // namespace impl
+
+// DenseAStarAlgorithm is a variant of AStarAlgorithm which maps vertices
+// to dense integer ids on the fly and keeps all the per-vertex data in flat
+// arrays indexed by these ids, so relaxation of an edge costs one hash
+// lookup instead of several tree lookups. The queue is an indexed 4-ary heap
+// with decrease-key, so there are no stale queue entries.
+//
+// All buffers are kept between searches, therefore an instance of the
+// algorithm is not thread-safe and should be reused by a single thread.
+//
+// Besides the requirements of AStarAlgorithm, TGraph::TVertexType must be
+// hashable by THash.
+template <typename TGraph, typename THash = hash<typename TGraph::TVertexType>>
+class DenseAStarAlgorithm
+{
+public:
+  using TGraphType = TGraph;
+  using TVertexType = typename TGraphType::TVertexType;
+  using TEdgeType = typename TGraphType::TEdgeType;
+  using Result = typename AStarAlgorithm<TGraph>::Result;
+  using TOnVisitedVertexCallback = typename AStarAlgorithm<TGraph>::TOnVisitedVertexCallback;
+
+  Result FindPath(TGraphType const & graph,
+                  TVertexType const & startVertex, TVertexType const & finalVertex,
+                  vector<TVertexType> & path,
+                  my::Cancellable const & cancellable = my::Cancellable(),
+                  TOnVisitedVertexCallback onVisitedVertexCallback = nullptr);
+
+  Result FindPathBidirectional(TGraphType const & graph,
+                               TVertexType const & startVertex, TVertexType const & finalVertex,
+                               vector<TVertexType> & path,
+                               my::Cancellable const & cancellable = my::Cancellable(),
+                               TOnVisitedVertexCallback onVisitedVertexCallback = nullptr);
+
+private:
+  // Periodicy of checking is cancellable cancelled.
+  static uint32_t constexpr kCancelledPollPeriod = 128;
+
+  // Periodicy of switching a wave of bidirectional algorithm.
+  static uint32_t constexpr kQueueSwitchPeriod = 128;
+
+  // Periodicy of calling callback about visited vertice.
+  static uint32_t constexpr kVisitedVerticesPeriod = 4;
+
+  // Precision of comparison weights.
+  static double constexpr kEpsilon = 1e-6;
+
+  // Search state in one direction. Vectors are indexed by dense vertex ids.
+  struct DirectionContext
+  {
+    void Clear()
+    {
+      queue.Clear();
+      bestDistance.clear();
+      parent.clear();
+      bestVertex = impl::kInvalidVertexId;
+    }
+
+    void EnsureSize(size_t size)
+    {
+      if (bestDistance.size() < size)
+      {
+        bestDistance.resize(size, numeric_limits<double>::max());
+        parent.resize(size, impl::kInvalidVertexId);
+      }
+    }
+
+    impl::QuaternaryHeap queue;
+    vector<double> bestDistance;
+    vector<uint32_t> parent;
+    uint32_t bestVertex = impl::kInvalidVertexId;
+  };
+
+  // See AStarAlgorithm::BidirectionalStepContext::ConsistentHeuristic.
+  struct ConsistentHeuristic
+  {
+    ConsistentHeuristic(TGraphType const & graph, TVertexType const & startVertex,
+                        TVertexType const & finalVertex)
+      : graph(graph)
+      , startVertex(startVertex)
+      , finalVertex(finalVertex)
+      , piRT(graph.HeuristicCostEstimate(finalVertex, startVertex))
+      , piFS(graph.HeuristicCostEstimate(startVertex, finalVertex))
+    {
+    }
+
+    double operator()(bool forward, TVertexType const & v) const
+    {
+      double const piF = graph.HeuristicCostEstimate(v, finalVertex);
+      double const piR = graph.HeuristicCostEstimate(v, startVertex);
+      return forward ? 0.5 * (piF - piR + piRT) : 0.5 * (piR - piF + piFS);
+    }
+
+    TGraphType const & graph;
+    TVertexType const & startVertex;
+    TVertexType const & finalVertex;
+    double const piRT;
+    double const piFS;
+  };
+
+  uint32_t InsertVertex(TVertexType const & v);
+
+  void ReconstructPath(uint32_t v, vector<uint32_t> const & parent,
+                       vector<TVertexType> & path) const;
+
+  impl::DenseVertexIndex<TVertexType, THash> m_index;
+  DirectionContext m_forward;
+  DirectionContext m_backward;
+  vector<TEdgeType> m_adj;
+};
+
+template <typename TGraph, typename THash>
+uint32_t DenseAStarAlgorithm<TGraph, THash>::InsertVertex(TVertexType const & v)
+{
+  uint32_t const id = m_index.Insert(v);
+  m_forward.EnsureSize(m_index.Size());
+  m_backward.EnsureSize(m_index.Size());
+  return id;
+}
+
+template <typename TGraph, typename THash>
+typename DenseAStarAlgorithm<TGraph, THash>::Result DenseAStarAlgorithm<TGraph, THash>::FindPath(
+    TGraphType const & graph,
+    TVertexType const & startVertex, TVertexType const & finalVertex,
+    vector<TVertexType> & path,
+    my::Cancellable const & cancellable,
+    TOnVisitedVertexCallback onVisitedVertexCallback)
+{
+  if (nullptr == onVisitedVertexCallback)
+    onVisitedVertexCallback = [](TVertexType const &, TVertexType const &){};
+
+  m_index.Clear();
+  m_forward.Clear();
+  m_backward.Clear();
+
+  DirectionContext & ctx = m_forward;
+  uint32_t const startId = InsertVertex(startVertex);
+  ctx.bestDistance[startId] = 0.0;
+  ctx.queue.PushOrDecrease(startId, 0.0);
+
+  uint32_t steps = 0;
+  while (!ctx.queue.Empty())
+  {
+    ++steps;
+
+    if (steps % kCancelledPollPeriod == 0 && cancellable.IsCancelled())
+      return Result::Cancelled;
+
+    uint32_t const v = ctx.queue.Pop();
+    double const distV = ctx.bestDistance[v];
+    // The vertex is copied as the index may reallocate its storage below.
+    TVertexType const vertexV = m_index.GetVertex(v);
+
+    if (steps % kVisitedVerticesPeriod == 0)
+      onVisitedVertexCallback(vertexV, finalVertex);
+
+    if (vertexV == finalVertex)
+    {
+      ReconstructPath(v, ctx.parent, path);
+      return Result::OK;
+    }
+
+    double const piV = graph.HeuristicCostEstimate(vertexV, finalVertex);
+
+    graph.GetOutgoingEdgesList(vertexV, m_adj);
+    for (auto const & edge : m_adj)
+    {
+      TVertexType const & vertexW = edge.GetTarget();
+      if (vertexV == vertexW)
+        continue;
+
+      double const len = edge.GetWeight();
+      double const piW = graph.HeuristicCostEstimate(vertexW, finalVertex);
+      double const reducedLen = len + piW - piV;
+
+      CHECK(reducedLen >= -kEpsilon, ("Invariant violated:", reducedLen, "<", -kEpsilon));
+      double const newReducedDist = distV + max(reducedLen, 0.0);
+
+      uint32_t const w = InsertVertex(vertexW);
+      if (newReducedDist >= ctx.bestDistance[w] - kEpsilon)
+        continue;
+
+      ctx.bestDistance[w] = newReducedDist;
+      ctx.parent[w] = v;
+      ctx.queue.PushOrDecrease(w, newReducedDist);
+    }
+  }
+
+  return Result::NoPath;
+}
+
+template <typename TGraph, typename THash>
+typename DenseAStarAlgorithm<TGraph, THash>::Result
+DenseAStarAlgorithm<TGraph, THash>::FindPathBidirectional(
+    TGraphType const & graph,
+    TVertexType const & startVertex, TVertexType const & finalVertex,
+    vector<TVertexType> & path,
+    my::Cancellable const & cancellable,
+    TOnVisitedVertexCallback onVisitedVertexCallback)
+{
+  if (nullptr == onVisitedVertexCallback)
+    onVisitedVertexCallback = [](TVertexType const &, TVertexType const &){};
+
+  m_index.Clear();
+  m_forward.Clear();
+  m_backward.Clear();
+
+  ConsistentHeuristic const heuristic(graph, startVertex, finalVertex);
+
+  bool foundAnyPath = false;
+  double bestPathReducedLength = 0.0;
+
+  uint32_t const startId = InsertVertex(startVertex);
+  m_forward.bestDistance[startId] = 0.0;
+  m_forward.queue.PushOrDecrease(startId, 0.0);
+  m_forward.bestVertex = startId;
+
+  uint32_t const finalId = InsertVertex(finalVertex);
+  m_backward.bestDistance[finalId] = 0.0;
+  m_backward.queue.PushOrDecrease(finalId, 0.0);
+  m_backward.bestVertex = finalId;
+
+  // See AStarAlgorithm::FindPathBidirectional for the explanation of the
+  // search and its stop condition; only the data layout differs here.
+  DirectionContext * cur = &m_forward;
+  DirectionContext * nxt = &m_backward;
+  bool curForward = true;
+
+  uint32_t steps = 0;
+  while (!cur->queue.Empty() && !nxt->queue.Empty())
+  {
+    ++steps;
+
+    if (steps % kCancelledPollPeriod == 0 && cancellable.IsCancelled())
+      return Result::Cancelled;
+
+    if (steps % kQueueSwitchPeriod == 0)
+    {
+      swap(cur, nxt);
+      curForward = !curForward;
+    }
+
+    if (foundAnyPath)
+    {
+      double const curTop = cur->queue.TopKey();
+      double const nxtTop = nxt->queue.TopKey();
+
+      if (curTop + nxtTop >= bestPathReducedLength - kEpsilon)
+      {
+        vector<TVertexType> pathW;
+        ReconstructPath(m_forward.bestVertex, m_forward.parent, path);
+        ReconstructPath(m_backward.bestVertex, m_backward.parent, pathW);
+        CHECK(!path.empty(), ());
+        path.insert(path.end(), pathW.rbegin(), pathW.rend());
+        return Result::OK;
+      }
+    }
+
+    uint32_t const v = cur->queue.Pop();
+    double const distV = cur->bestDistance[v];
+    TVertexType const vertexV = m_index.GetVertex(v);
+
+    if (steps % kVisitedVerticesPeriod == 0)
+      onVisitedVertexCallback(vertexV, curForward ? finalVertex : startVertex);
+
+    double const pV = heuristic(curForward, vertexV);
+
+    if (curForward)
+      graph.GetOutgoingEdgesList(vertexV, m_adj);
+    else
+      graph.GetIngoingEdgesList(vertexV, m_adj);
+
+    for (auto const & edge : m_adj)
+    {
+      TVertexType const & vertexW = edge.GetTarget();
+      if (vertexV == vertexW)
+        continue;
+
+      double const len = edge.GetWeight();
+      double const pW = heuristic(curForward, vertexW);
+      double const reducedLen = len + pW - pV;
+
+      CHECK(reducedLen >= -kEpsilon, ("Invariant violated:", reducedLen, "<", -kEpsilon));
+      double const newReducedDist = distV + max(reducedLen, 0.0);
+
+      uint32_t const w = InsertVertex(vertexW);
+      if (newReducedDist >= cur->bestDistance[w] - kEpsilon)
+        continue;
+
+      double const distW = nxt->bestDistance[w];
+      if (distW != numeric_limits<double>::max())
+      {
+        double const curPathReducedLength = newReducedDist + distW;
+        // No epsilon here: it is ok to overshoot slightly.
+        if (!foundAnyPath || bestPathReducedLength > curPathReducedLength)
+        {
+          bestPathReducedLength = curPathReducedLength;
+          foundAnyPath = true;
+          cur->bestVertex = v;
+          nxt->bestVertex = w;
+        }
+      }
+
+      cur->bestDistance[w] = newReducedDist;
+      cur->parent[w] = v;
+      cur->queue.PushOrDecrease(w, newReducedDist);
+    }
+  }
+
+  return Result::NoPath;
+}
+
+template <typename TGraph, typename THash>
+void DenseAStarAlgorithm<TGraph, THash>::ReconstructPath(uint32_t v,
+                                                         vector<uint32_t> const & parent,
+                                                         vector<TVertexType> & path) const
+{
+  path.clear();
+  for (uint32_t cur = v; cur != impl::kInvalidVertexId; cur = parent[cur])
+    path.push_back(m_index.GetVertex(cur));
+  reverse(path.begin(), path.end());
+}
+
+}  // namespace routing
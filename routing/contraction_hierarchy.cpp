@@ -0,0 +1,593 @@
+#include "routing/contraction_hierarchy.hpp"
+
+#include "indexer/mercator.hpp"
+#include "indexer/point_to_int64.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cmath.hpp"
+#include "std/functional.hpp"
+#include "std/queue.hpp"
+#include "std/unordered_map.hpp"
+
+namespace routing
+{
+namespace
+{
+double constexpr KMPH2MPS = 1000.0 / (60 * 60);
+
+// Witness searches of a contraction share a budget of settled vertices, so the contraction
+// of a vertex takes time bounded by the degrees of the vertex and its neighbors rather than
+// by the size of the graph. A search gives up after settling its part of the budget, which
+// can only lead to superfluous shortcuts. Priorities are estimated by simulated contractions,
+// for which a rough estimation is enough.
+uint32_t constexpr kWitnessSettledBudget = 2000;
+uint32_t constexpr kWitnessSettledMin = 100;
+uint32_t constexpr kSimulationSettledBudget = 200;
+uint32_t constexpr kSimulationSettledMin = 10;
+
+uint32_t constexpr kCancellationCheckPeriod = 1024;
+
+using TArc = ContractionHierarchy::Arc;
+using TRoadSegment = ContractionHierarchy::RoadSegment;
+
+TRoadSegment const kNoSegment = {0, 0, false};
+
+// Adds the arc or decreases the weight of the existing arc to the same vertex.
+void AddArc(vector<TArc> & arcs, TArc const & arc)
+{
+  for (auto & a : arcs)
+  {
+    if (a.m_vertex == arc.m_vertex)
+    {
+      if (arc.m_weightMs < a.m_weightMs)
+        a = arc;
+      return;
+    }
+  }
+  arcs.push_back(arc);
+}
+
+void RemoveArcs(vector<TArc> & arcs, uint32_t vertex)
+{
+  arcs.erase(remove_if(arcs.begin(), arcs.end(), [vertex](TArc const & a)
+                       {
+                         return a.m_vertex == vertex;
+                       }),
+             arcs.end());
+}
+
+// Keeps the remaining graph while vertices are contracted.
+class Contractor
+{
+public:
+  explicit Contractor(uint32_t verticesCount)
+    : m_outgoing(verticesCount)
+    , m_ingoing(verticesCount)
+    , m_deletedNeighbors(verticesCount, 0)
+    , m_levels(verticesCount, 0)
+    , m_distances(verticesCount, kInfinity)
+  {
+  }
+
+  void AddEdge(uint32_t from, uint32_t to, uint32_t weightMs, TRoadSegment const & segment)
+  {
+    AddArc(m_outgoing[from], {to, weightMs, ContractionHierarchy::kInvalidVertex, segment});
+    AddArc(m_ingoing[to], {from, weightMs, ContractionHierarchy::kInvalidVertex, segment});
+  }
+
+  void Contract(vector<vector<TArc>> & upward, vector<vector<TArc>> & downward)
+  {
+    using TState = pair<int64_t, uint32_t>;
+
+    uint32_t const verticesCount = static_cast<uint32_t>(m_outgoing.size());
+    upward.assign(verticesCount, vector<TArc>());
+    downward.assign(verticesCount, vector<TArc>());
+
+    priority_queue<TState, vector<TState>, greater<TState>> queue;
+    for (uint32_t v = 0; v < verticesCount; ++v)
+      queue.emplace(GetPriority(v), v);
+
+    uint32_t contracted = 0;
+    while (!queue.empty())
+    {
+      uint32_t const v = queue.top().second;
+      queue.pop();
+
+      // Priorities are changed by contractions of neighbors, so they are updated lazily:
+      // a vertex is contracted only if its current priority is still the least one.
+      int64_t const priority = GetPriority(v);
+      if (!queue.empty() && priority > queue.top().first)
+      {
+        queue.emplace(priority, v);
+        continue;
+      }
+
+      ContractVertex(v, false /* simulate */);
+
+      for (TArc const & arc : m_outgoing[v])
+      {
+        RemoveArcs(m_ingoing[arc.m_vertex], v);
+        OnNeighborContracted(arc.m_vertex, v);
+      }
+      for (TArc const & arc : m_ingoing[v])
+      {
+        RemoveArcs(m_outgoing[arc.m_vertex], v);
+        OnNeighborContracted(arc.m_vertex, v);
+      }
+
+      // All the remaining neighbors get higher ranks than v.
+      upward[v].swap(m_outgoing[v]);
+      downward[v].swap(m_ingoing[v]);
+
+      ++contracted;
+      if (contracted % 100000 == 0)
+        LOG(LINFO, ("Contracted", contracted, "vertices of", verticesCount));
+    }
+  }
+
+private:
+  static uint64_t constexpr kInfinity = numeric_limits<uint64_t>::max();
+
+  int64_t GetPriority(uint32_t v)
+  {
+    int64_t const shortcuts = ContractVertex(v, true /* simulate */);
+    int64_t const removed = m_outgoing[v].size() + m_ingoing[v].size();
+    return shortcuts - removed + m_deletedNeighbors[v] + m_levels[v];
+  }
+
+  // Levels spread contracted vertices uniformly over the graph,
+  // which keeps the search spaces of queries small.
+  void OnNeighborContracted(uint32_t v, uint32_t contracted)
+  {
+    ++m_deletedNeighbors[v];
+    m_levels[v] = max(m_levels[v], m_levels[contracted] + 1);
+  }
+
+  // Adds shortcuts u -> v -> w for which there is no witness u -> w avoiding v.
+  // @return The number of the shortcuts.
+  uint32_t ContractVertex(uint32_t v, bool simulate)
+  {
+    uint32_t const budget = simulate ? kSimulationSettledBudget : kWitnessSettledBudget;
+    uint32_t const searches = max(static_cast<uint32_t>(m_ingoing[v].size()), 1U);
+    uint32_t const settledLimit =
+        max(simulate ? kSimulationSettledMin : kWitnessSettledMin, budget / searches);
+
+    uint32_t shortcuts = 0;
+    for (TArc const & in : m_ingoing[v])
+    {
+      uint32_t const u = in.m_vertex;
+
+      uint64_t maxWeight = 0;
+      for (TArc const & out : m_outgoing[v])
+      {
+        if (out.m_vertex != u)
+          maxWeight = max(maxWeight, static_cast<uint64_t>(in.m_weightMs) + out.m_weightMs);
+      }
+      if (maxWeight == 0)
+        continue;
+
+      FindWitnesses(u, v, maxWeight, settledLimit);
+
+      for (TArc const & out : m_outgoing[v])
+      {
+        uint32_t const w = out.m_vertex;
+        if (w == u)
+          continue;
+
+        uint64_t const weight = static_cast<uint64_t>(in.m_weightMs) + out.m_weightMs;
+        if (m_distances[w] <= weight)
+          continue;
+
+        ++shortcuts;
+        if (simulate)
+          continue;
+
+        CHECK_LESS(weight, numeric_limits<uint32_t>::max(), ());
+        uint32_t const weightMs = static_cast<uint32_t>(weight);
+        AddArc(m_outgoing[u], {w, weightMs, v, kNoSegment});
+        AddArc(m_ingoing[w], {u, weightMs, v, kNoSegment});
+      }
+    }
+    return shortcuts;
+  }
+
+  // Finds distances from |source| to the vertices which are not farther than
+  // |maxWeight| in the remaining graph without |excluded|.
+  void FindWitnesses(uint32_t source, uint32_t excluded, uint64_t maxWeight, uint32_t settledLimit)
+  {
+    using TState = pair<uint64_t, uint32_t>;
+
+    for (uint32_t const v : m_touched)
+      m_distances[v] = kInfinity;
+    m_touched.clear();
+    m_heap.clear();
+
+    m_distances[source] = 0;
+    m_touched.push_back(source);
+    m_heap.emplace_back(0, source);
+
+    uint32_t settled = 0;
+    while (!m_heap.empty() && settled < settledLimit)
+    {
+      pop_heap(m_heap.begin(), m_heap.end(), greater<TState>());
+      TState const state = m_heap.back();
+      m_heap.pop_back();
+
+      if (state.first > m_distances[state.second])
+        continue;
+      if (state.first > maxWeight)
+        break;
+      ++settled;
+
+      for (TArc const & arc : m_outgoing[state.second])
+      {
+        if (arc.m_vertex == excluded)
+          continue;
+
+        uint64_t const distance = state.first + arc.m_weightMs;
+        uint64_t & current = m_distances[arc.m_vertex];
+        if (distance >= current)
+          continue;
+
+        if (current == kInfinity)
+          m_touched.push_back(arc.m_vertex);
+        current = distance;
+        m_heap.emplace_back(distance, arc.m_vertex);
+        push_heap(m_heap.begin(), m_heap.end(), greater<TState>());
+      }
+    }
+  }
+
+  vector<vector<TArc>> m_outgoing;
+  vector<vector<TArc>> m_ingoing;
+  vector<uint32_t> m_deletedNeighbors;
+  vector<uint32_t> m_levels;
+
+  // Witness search buffers.
+  vector<uint64_t> m_distances;
+  vector<uint32_t> m_touched;
+  vector<pair<uint64_t, uint32_t>> m_heap;
+};
+
+uint64_t constexpr Contractor::kInfinity;
+
+// Finds travel times from the nearest exit to every vertex by a multi-source Dijkstra,
+// the reversed edges give the times from every vertex to the nearest exit.
+// @param adjacency adjacency[v] are pairs of a neighbor and a travel time in milliseconds.
+void FindExitTimes(vector<vector<pair<uint32_t, uint32_t>>> const & adjacency,
+                   vector<uint32_t> const & exits, vector<uint32_t> & times)
+{
+  using TState = pair<uint64_t, uint32_t>;
+
+  times.assign(adjacency.size(), ContractionHierarchy::kUnreachable);
+
+  priority_queue<TState, vector<TState>, greater<TState>> queue;
+  for (uint32_t const v : exits)
+  {
+    times[v] = 0;
+    queue.emplace(0, v);
+  }
+
+  while (!queue.empty())
+  {
+    TState const state = queue.top();
+    queue.pop();
+    if (state.first > times[state.second])
+      continue;
+
+    for (auto const & edge : adjacency[state.second])
+    {
+      uint64_t const time = state.first + edge.second;
+      if (time >= times[edge.first])
+        continue;
+      times[edge.first] = static_cast<uint32_t>(time);
+      queue.emplace(time, edge.first);
+    }
+  }
+}
+
+void BuildOffsets(vector<vector<TArc>> const & arcsByVertex, vector<uint32_t> & offsets,
+                  vector<TArc> & arcs)
+{
+  offsets.assign(1, 0);
+  offsets.reserve(arcsByVertex.size() + 1);
+  arcs.clear();
+  for (auto const & vertexArcs : arcsByVertex)
+  {
+    arcs.insert(arcs.end(), vertexArcs.begin(), vertexArcs.end());
+    offsets.push_back(static_cast<uint32_t>(arcs.size()));
+  }
+}
+}  // namespace
+
+uint32_t constexpr ContractionHierarchy::kInvalidVertex;
+uint32_t constexpr ContractionHierarchy::kUnreachable;
+uint8_t constexpr ContractionHierarchy::kVersion;
+
+// static
+ContractionHierarchy::TKey ContractionHierarchy::GetKey(m2::PointD const & point)
+{
+  return static_cast<TKey>(PointToInt64(point, POINT_COORD_BITS));
+}
+
+void ContractionHierarchy::Init(vector<TKey> && keys, vector<vector<Arc>> const & upward,
+                                vector<vector<Arc>> const & downward,
+                                vector<uint32_t> && exitTimes, vector<uint32_t> && entryTimes)
+{
+  ASSERT(is_sorted(keys.begin(), keys.end()), ());
+  ASSERT_EQUAL(keys.size(), upward.size(), ());
+  ASSERT_EQUAL(keys.size(), downward.size(), ());
+  ASSERT_EQUAL(keys.size(), exitTimes.size(), ());
+  ASSERT_EQUAL(keys.size(), entryTimes.size(), ());
+
+  m_keys = move(keys);
+  BuildOffsets(upward, m_upwardOffsets, m_upwardArcs);
+  BuildOffsets(downward, m_downwardOffsets, m_downwardArcs);
+  m_exitTimes = move(exitTimes);
+  m_entryTimes = move(entryTimes);
+}
+
+bool ContractionHierarchy::GetVertex(m2::PointD const & point, uint32_t & vertex) const
+{
+  TKey const key = GetKey(point);
+  auto const it = lower_bound(m_keys.begin(), m_keys.end(), key);
+  if (it == m_keys.end() || *it != key)
+    return false;
+  vertex = static_cast<uint32_t>(distance(m_keys.begin(), it));
+  return true;
+}
+
+ContractionHierarchy::Result ContractionHierarchy::FindPath(
+    vector<pair<uint32_t, double>> const & sources, vector<pair<uint32_t, double>> const & targets,
+    my::Cancellable const & cancellable, vector<uint32_t> & path,
+    vector<RoadSegment> & segments, double & weight) const
+{
+  struct Label
+  {
+    double m_distance;
+    uint32_t m_parent;
+  };
+
+  using TLabels = unordered_map<uint32_t, Label>;
+  using TState = pair<double, uint32_t>;
+  using TQueue = priority_queue<TState, vector<TState>, greater<TState>>;
+
+  // The forward wave goes upward from the sources, the backward one goes upward from the targets.
+  TLabels labels[2];
+  TQueue queues[2];
+
+  auto const initWave = [](vector<pair<uint32_t, double>> const & vertices, TLabels & labels,
+                           TQueue & queue)
+  {
+    for (auto const & v : vertices)
+    {
+      auto const it = labels.find(v.first);
+      if (it != labels.end() && it->second.m_distance <= v.second)
+        continue;
+      labels[v.first] = {v.second, kInvalidVertex};
+      queue.emplace(v.second, v.first);
+    }
+  };
+  initWave(sources, labels[0], queues[0]);
+  initWave(targets, labels[1], queues[1]);
+
+  double best = numeric_limits<double>::infinity();
+  uint32_t meeting = kInvalidVertex;
+  uint32_t steps = 0;
+  while (true)
+  {
+    // A wave stops when it can't improve the best path.
+    bool const forward = !queues[0].empty() && queues[0].top().first < best;
+    bool const backward = !queues[1].empty() && queues[1].top().first < best;
+    if (!forward && !backward)
+      break;
+
+    if (++steps % kCancellationCheckPeriod == 0 && cancellable.IsCancelled())
+      return Result::Cancelled;
+
+    size_t const wave =
+        forward && (!backward || queues[0].top().first <= queues[1].top().first) ? 0 : 1;
+    TState const state = queues[wave].top();
+    queues[wave].pop();
+
+    uint32_t const v = state.second;
+    if (state.first > labels[wave][v].m_distance)
+      continue;
+
+    auto const opposite = labels[1 - wave].find(v);
+    if (opposite != labels[1 - wave].end() && state.first + opposite->second.m_distance < best)
+    {
+      best = state.first + opposite->second.m_distance;
+      meeting = v;
+    }
+
+    vector<uint32_t> const & offsets = wave == 0 ? m_upwardOffsets : m_downwardOffsets;
+    vector<Arc> const & arcs = wave == 0 ? m_upwardArcs : m_downwardArcs;
+    for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i)
+    {
+      Arc const & arc = arcs[i];
+      double const distance = state.first + arc.m_weightMs / 1000.0;
+      auto const it = labels[wave].find(arc.m_vertex);
+      if (it != labels[wave].end() && it->second.m_distance <= distance)
+        continue;
+      labels[wave][arc.m_vertex] = {distance, v};
+      queues[wave].emplace(distance, arc.m_vertex);
+    }
+  }
+
+  if (meeting == kInvalidVertex)
+    return Result::NoPath;
+
+  path.clear();
+  for (uint32_t v = meeting; v != kInvalidVertex; v = labels[0][v].m_parent)
+    path.push_back(v);
+  reverse(path.begin(), path.end());
+  for (uint32_t v = labels[1][meeting].m_parent; v != kInvalidVertex; v = labels[1][v].m_parent)
+    path.push_back(v);
+
+  UnpackPath(path, segments);
+  weight = best;
+  return Result::OK;
+}
+
+ContractionHierarchy::Arc const * ContractionHierarchy::FindArc(uint32_t from, uint32_t to) const
+{
+  Arc const * result = nullptr;
+  auto const update = [&result](Arc const & arc)
+  {
+    if (result == nullptr || arc.m_weightMs < result->m_weightMs)
+      result = &arc;
+  };
+
+  for (uint32_t i = m_upwardOffsets[from]; i < m_upwardOffsets[from + 1]; ++i)
+  {
+    if (m_upwardArcs[i].m_vertex == to)
+      update(m_upwardArcs[i]);
+  }
+  for (uint32_t i = m_downwardOffsets[to]; i < m_downwardOffsets[to + 1]; ++i)
+  {
+    if (m_downwardArcs[i].m_vertex == from)
+      update(m_downwardArcs[i]);
+  }
+  return result;
+}
+
+void ContractionHierarchy::UnpackPath(vector<uint32_t> & path,
+                                      vector<RoadSegment> & segments) const
+{
+  segments.clear();
+  if (path.empty())
+    return;
+
+  vector<uint32_t> result = {path.front()};
+  // Vertices which are to be reached from result.back().
+  vector<uint32_t> pending;
+  for (size_t i = 1; i < path.size(); ++i)
+  {
+    pending.push_back(path[i]);
+    while (!pending.empty())
+    {
+      Arc const * arc = FindArc(result.back(), pending.back());
+      CHECK(arc, ("No arc between", result.back(), "and", pending.back()));
+      if (arc->m_middle == kInvalidVertex)
+      {
+        segments.push_back(arc->m_segment);
+        result.push_back(pending.back());
+        pending.pop_back();
+      }
+      else
+      {
+        pending.push_back(arc->m_middle);
+      }
+    }
+  }
+  path.swap(result);
+}
+
+string DebugPrint(ContractionHierarchy::Result result)
+{
+  switch (result)
+  {
+  case ContractionHierarchy::Result::OK:
+    return "OK";
+  case ContractionHierarchy::Result::NoPath:
+    return "NoPath";
+  case ContractionHierarchy::Result::Cancelled:
+    return "Cancelled";
+  }
+  return string();
+}
+
+void ContractionHierarchyBuilder::AddRoad(uint32_t featureId, vector<m2::PointD> const & points,
+                                          double speedKMPH, bool bidirectional)
+{
+  ASSERT_GREATER(speedKMPH, 0.0, ());
+
+  double const speedMPS = speedKMPH * KMPH2MPS;
+  for (size_t i = 0; i + 1 < points.size(); ++i)
+  {
+    ContractionHierarchy::TKey const from = ContractionHierarchy::GetKey(points[i]);
+    ContractionHierarchy::TKey const to = ContractionHierarchy::GetKey(points[i + 1]);
+    if (from == to)
+      continue;
+
+    // The same formula as in the routing algorithms, see routing_algorithm.cpp.
+    double const weight = MercatorBounds::DistanceOnEarth(points[i], points[i + 1]) / speedMPS;
+    uint32_t const weightMs = static_cast<uint32_t>(round(weight * 1000.0));
+    uint32_t const lowerWeightMs = static_cast<uint32_t>(floor(weight * 1000.0));
+    uint32_t const segId = static_cast<uint32_t>(i);
+    m_edges.push_back({from, to, weightMs, lowerWeightMs, {featureId, segId, true /* forward */}});
+    if (bidirectional)
+      m_edges.push_back({to, from, weightMs, lowerWeightMs, {featureId, segId, false /* forward */}});
+  }
+}
+
+void ContractionHierarchyBuilder::AddExit(m2::PointD const & point)
+{
+  m_exits.push_back(ContractionHierarchy::GetKey(point));
+}
+
+void ContractionHierarchyBuilder::Build(ContractionHierarchy & hierarchy)
+{
+  vector<ContractionHierarchy::TKey> keys;
+  keys.reserve(m_edges.size());
+  for (auto const & e : m_edges)
+    keys.push_back(e.m_from);
+  for (auto const & e : m_edges)
+    keys.push_back(e.m_to);
+  sort(keys.begin(), keys.end());
+  keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+  auto const getVertex = [&keys](ContractionHierarchy::TKey key)
+  {
+    return static_cast<uint32_t>(distance(keys.begin(), lower_bound(keys.begin(), keys.end(), key)));
+  };
+
+  uint32_t const verticesCount = static_cast<uint32_t>(keys.size());
+  size_t const edgesCount = m_edges.size();
+
+  // Exits which are not vertices can't be reached by roads of the mwm.
+  vector<uint32_t> exits;
+  for (ContractionHierarchy::TKey const key : m_exits)
+  {
+    uint32_t const v = getVertex(key);
+    if (v < verticesCount && keys[v] == key)
+      exits.push_back(v);
+  }
+  m_exits.clear();
+
+  vector<uint32_t> exitTimes;
+  vector<uint32_t> entryTimes;
+  {
+    vector<vector<pair<uint32_t, uint32_t>>> ingoing(verticesCount);
+    vector<vector<pair<uint32_t, uint32_t>>> outgoing(verticesCount);
+    for (auto const & e : m_edges)
+    {
+      uint32_t const from = getVertex(e.m_from);
+      uint32_t const to = getVertex(e.m_to);
+      ingoing[to].emplace_back(from, e.m_lowerWeightMs);
+      outgoing[from].emplace_back(to, e.m_lowerWeightMs);
+    }
+    FindExitTimes(ingoing, exits, exitTimes);
+    FindExitTimes(outgoing, exits, entryTimes);
+  }
+
+  vector<vector<TArc>> upward;
+  vector<vector<TArc>> downward;
+  {
+    Contractor contractor(verticesCount);
+    for (auto const & e : m_edges)
+      contractor.AddEdge(getVertex(e.m_from), getVertex(e.m_to), e.m_weightMs, e.m_segment);
+    m_edges.clear();
+    m_edges.shrink_to_fit();
+
+    contractor.Contract(upward, downward);
+  }
+
+  hierarchy.Init(move(keys), upward, downward, move(exitTimes), move(entryTimes));
+  LOG(LINFO, ("Contraction hierarchy vertices:", verticesCount, "edges:", edgesCount, "arcs:",
+              hierarchy.GetArcsCount()));
+}
+}  // namespace routing
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "coding/reader.hpp"
+#include "coding/varint.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "base/assert.hpp"
+#include "base/cancellable.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/limits.hpp"
+#include "std/string.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+/// ContractionHierarchy keeps a road graph of one mwm preprocessed by vertex contraction,
+/// see http://algo2.iti.kit.edu/schultes/hwy/contract.pdf
+///
+/// Every vertex has a rank, and a shortest path consists of an "upward" part from
+/// a source followed by a "downward" part to a target. So queries run a bidirectional
+/// Dijkstra, in which both waves relax only edges leading to vertices of higher ranks.
+/// Shortcut edges remember their middle vertices and are unpacked into the original
+/// edges when the path is found. The original edges remember the road segments they
+/// go along, so the path is converted to the road graph without loading the crosses.
+///
+/// Roads of other mwms may lead to a shorter path, so the hierarchy also keeps travel
+/// times from every vertex to the nearest vertex outside of the mwm borders and back.
+/// A path which leaves the mwm is not shorter than their sum.
+///
+/// Vertices are identified by their points, weights are travel times in milliseconds.
+class ContractionHierarchy
+{
+public:
+  using TKey = uint64_t;
+
+  enum class Result
+  {
+    OK,
+    NoPath,
+    Cancelled
+  };
+
+  static uint32_t constexpr kInvalidVertex = numeric_limits<uint32_t>::max();
+  static uint32_t constexpr kUnreachable = numeric_limits<uint32_t>::max();
+
+  /// A segment of a road feature of the mwm, which an original edge goes along.
+  struct RoadSegment
+  {
+    uint32_t m_featureId;
+    uint32_t m_segId;
+    bool m_forward;
+  };
+
+  /// An edge to a vertex of a higher rank: the target of an upward edge
+  /// or the source of a downward one.
+  struct Arc
+  {
+    uint32_t m_vertex;
+    uint32_t m_weightMs;
+    // The contracted vertex a shortcut goes through, kInvalidVertex for original edges.
+    uint32_t m_middle;
+    // The road segment of an original edge, it isn't used for shortcuts.
+    RoadSegment m_segment;
+  };
+
+  static TKey GetKey(m2::PointD const & point);
+
+  /// @param keys Sorted keys of the vertices.
+  /// @param upward upward[v] are the edges v -> w, where w has a higher rank than v.
+  /// @param downward downward[v] are the edges w -> v, where w has a higher rank than v.
+  /// @param exitTimes Travel times in milliseconds from every vertex to the nearest
+  ///                  vertex outside of the mwm borders, kUnreachable if there is none.
+  /// @param entryTimes Travel times in milliseconds from the nearest vertex outside
+  ///                   of the mwm borders to every vertex, kUnreachable if there is none.
+  void Init(vector<TKey> && keys, vector<vector<Arc>> const & upward,
+            vector<vector<Arc>> const & downward, vector<uint32_t> && exitTimes,
+            vector<uint32_t> && entryTimes);
+
+  size_t GetVerticesCount() const { return m_keys.size(); }
+  size_t GetArcsCount() const { return m_upwardArcs.size() + m_downwardArcs.size(); }
+
+  /// @return False if the point is not a vertex of the hierarchy.
+  bool GetVertex(m2::PointD const & point, uint32_t & vertex) const;
+  TKey GetVertexKey(uint32_t vertex) const { return m_keys[vertex]; }
+
+  /// @return Lower bounds of the travel times in seconds from |vertex| to the nearest vertex
+  ///         outside of the mwm borders and back, infinity if there is none.
+  double GetExitTime(uint32_t vertex) const { return ToSeconds(m_exitTimes[vertex]); }
+  double GetEntryTime(uint32_t vertex) const { return ToSeconds(m_entryTimes[vertex]); }
+
+  /// Finds the fastest path from any of the sources to any of the targets.
+  /// @param sources Pairs of a vertex and a travel time in seconds to reach it.
+  /// @param targets Pairs of a vertex and a travel time in seconds from it to the finish.
+  /// @param path Vertices of the path including the source and the target.
+  /// @param segments Road segments of the original edges of the path.
+  /// @param weight Travel time of the path in seconds including the initial ones.
+  Result FindPath(vector<pair<uint32_t, double>> const & sources,
+                  vector<pair<uint32_t, double>> const & targets,
+                  my::Cancellable const & cancellable, vector<uint32_t> & path,
+                  vector<RoadSegment> & segments, double & weight) const;
+
+  template <typename TSink>
+  void Serialize(TSink & sink) const
+  {
+    WriteToSink(sink, static_cast<uint8_t>(kVersion));
+    WriteVarUint(sink, static_cast<uint64_t>(m_keys.size()));
+
+    TKey prev = 0;
+    for (TKey const key : m_keys)
+    {
+      WriteVarUint(sink, key - prev);
+      prev = key;
+    }
+
+    SerializeArcs(sink, m_upwardOffsets, m_upwardArcs);
+    SerializeArcs(sink, m_downwardOffsets, m_downwardArcs);
+    SerializeTimes(sink, m_exitTimes);
+    SerializeTimes(sink, m_entryTimes);
+  }
+
+  template <typename TSource>
+  void Deserialize(TSource & src)
+  {
+    uint8_t const version = ReadPrimitiveFromSource<uint8_t>(src);
+    CHECK_EQUAL(version, kVersion, ("Unknown contraction hierarchy section version."));
+
+    uint64_t const count = ReadVarUint<uint64_t>(src);
+    m_keys.resize(count);
+    TKey prev = 0;
+    for (auto & key : m_keys)
+    {
+      key = prev + ReadVarUint<uint64_t>(src);
+      prev = key;
+    }
+
+    DeserializeArcs(src, m_upwardOffsets, m_upwardArcs);
+    DeserializeArcs(src, m_downwardOffsets, m_downwardArcs);
+    DeserializeTimes(src, m_exitTimes);
+    DeserializeTimes(src, m_entryTimes);
+  }
+
+private:
+  static uint8_t constexpr kVersion = 1;
+
+  static double ToSeconds(uint32_t timeMs)
+  {
+    return timeMs == kUnreachable ? numeric_limits<double>::infinity() : timeMs / 1000.0;
+  }
+
+  template <typename TSink>
+  void SerializeArcs(TSink & sink, vector<uint32_t> const & offsets,
+                     vector<Arc> const & arcs) const
+  {
+    for (size_t v = 0; v < m_keys.size(); ++v)
+    {
+      WriteVarUint(sink, offsets[v + 1] - offsets[v]);
+      for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i)
+      {
+        Arc const & arc = arcs[i];
+        WriteVarUint(sink, arc.m_vertex);
+        WriteVarUint(sink, arc.m_weightMs);
+        if (arc.m_middle != kInvalidVertex)
+        {
+          WriteVarUint(sink, static_cast<uint64_t>(arc.m_middle) + 1);
+          continue;
+        }
+        WriteVarUint(sink, static_cast<uint64_t>(0));
+        WriteVarUint(sink, arc.m_segment.m_featureId);
+        WriteVarUint(sink, (static_cast<uint64_t>(arc.m_segment.m_segId) << 1) |
+                               (arc.m_segment.m_forward ? 1 : 0));
+      }
+    }
+  }
+
+  template <typename TSink>
+  void SerializeTimes(TSink & sink, vector<uint32_t> const & times) const
+  {
+    for (uint32_t const t : times)
+      WriteVarUint(sink, t == kUnreachable ? 0 : static_cast<uint64_t>(t) + 1);
+  }
+
+  template <typename TSource>
+  void DeserializeArcs(TSource & src, vector<uint32_t> & offsets, vector<Arc> & arcs)
+  {
+    offsets.assign(1, 0);
+    offsets.reserve(m_keys.size() + 1);
+    arcs.clear();
+    for (size_t v = 0; v < m_keys.size(); ++v)
+    {
+      uint32_t const count = ReadVarUint<uint32_t>(src);
+      for (uint32_t i = 0; i < count; ++i)
+      {
+        Arc arc;
+        arc.m_vertex = ReadVarUint<uint32_t>(src);
+        arc.m_weightMs = ReadVarUint<uint32_t>(src);
+        uint64_t const middle = ReadVarUint<uint64_t>(src);
+        arc.m_segment = {0, 0, false};
+        if (middle == 0)
+        {
+          arc.m_middle = kInvalidVertex;
+          arc.m_segment.m_featureId = ReadVarUint<uint32_t>(src);
+          uint64_t const segment = ReadVarUint<uint64_t>(src);
+          arc.m_segment.m_segId = static_cast<uint32_t>(segment >> 1);
+          arc.m_segment.m_forward = (segment & 1) != 0;
+        }
+        else
+        {
+          arc.m_middle = static_cast<uint32_t>(middle - 1);
+        }
+        arcs.push_back(arc);
+      }
+      offsets.push_back(static_cast<uint32_t>(arcs.size()));
+    }
+  }
+
+  template <typename TSource>
+  void DeserializeTimes(TSource & src, vector<uint32_t> & times)
+  {
+    times.resize(m_keys.size());
+    for (auto & t : times)
+    {
+      uint64_t const value = ReadVarUint<uint64_t>(src);
+      t = value == 0 ? kUnreachable : static_cast<uint32_t>(value - 1);
+    }
+  }
+
+  /// Finds the original or the shortcut edge from |from| to |to| with the least weight.
+  Arc const * FindArc(uint32_t from, uint32_t to) const;
+
+  /// Replaces shortcuts of the path by the original edges.
+  void UnpackPath(vector<uint32_t> & path, vector<RoadSegment> & segments) const;
+
+  vector<TKey> m_keys;
+  // Arcs of the vertex v are m_*Arcs[m_*Offsets[v]..m_*Offsets[v + 1]).
+  vector<uint32_t> m_upwardOffsets;
+  vector<Arc> m_upwardArcs;
+  vector<uint32_t> m_downwardOffsets;
+  vector<Arc> m_downwardArcs;
+  // Travel times in milliseconds to the nearest vertex outside of the mwm borders and back.
+  vector<uint32_t> m_exitTimes;
+  vector<uint32_t> m_entryTimes;
+};
+
+string DebugPrint(ContractionHierarchy::Result result);
+
+/// Builds ContractionHierarchy for a road graph. Vertices are contracted in the order
+/// of their edge difference (the number of added shortcuts minus the number of removed
+/// edges) with lazy updates, witnesses are looked for by local Dijkstra searches, which
+/// share a bounded number of settled vertices per contraction.
+class ContractionHierarchyBuilder
+{
+public:
+  /// Adds edges between consecutive points of the road feature with the index |featureId|.
+  void AddRoad(uint32_t featureId, vector<m2::PointD> const & points, double speedKMPH,
+               bool bidirectional);
+
+  /// Marks the point as lying outside of the mwm borders, roads of other mwms
+  /// may start there.
+  void AddExit(m2::PointD const & point);
+
+  void Build(ContractionHierarchy & hierarchy);
+
+private:
+  struct Edge
+  {
+    ContractionHierarchy::TKey m_from;
+    ContractionHierarchy::TKey m_to;
+    uint32_t m_weightMs;
+    // Travel time rounded down for the lower bounds of exit times.
+    uint32_t m_lowerWeightMs;
+    ContractionHierarchy::RoadSegment m_segment;
+  };
+
+  vector<Edge> m_edges;
+  vector<ContractionHierarchy::TKey> m_exits;
+};
+}  // namespace routing
@@ -0,0 +1,202 @@
+#include "routing/cross_mwm_overlay.hpp"
+
+#include "geometry/distance_on_sphere.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/algorithm.hpp"
+
+namespace
+{
+// The same radius as CrossMwmGraph uses to match outgoing and ingoing nodes.
+double constexpr kMwmCrossingNodeEqualityRadiusMeters = 5.0;
+}  // namespace
+
+namespace routing
+{
+// static
+uint32_t constexpr CrossMwmOverlay::kInvalidIndex;
+uint8_t constexpr CrossMwmOverlay::kVersion;
+
+void CrossMwmOverlay::Init(vector<string> && mwmNames, vector<uint32_t> && mwmVersions,
+                           vector<uint32_t> && ingoingOffsets, vector<uint32_t> && outgoingOffsets,
+                           vector<Node> && ingoing, vector<Node> && outgoing,
+                           vector<uint32_t> && nextMwms, vector<uint32_t> && nextIngoing,
+                           vector<uint32_t> && edgeOffsets, vector<Edge> && edges)
+{
+  ASSERT_EQUAL(mwmNames.size(), mwmVersions.size(), ());
+  ASSERT_EQUAL(ingoingOffsets.size(), mwmNames.size() + 1, ());
+  ASSERT_EQUAL(outgoingOffsets.size(), mwmNames.size() + 1, ());
+  ASSERT_EQUAL(outgoing.size(), nextMwms.size(), ());
+  ASSERT_EQUAL(outgoing.size(), nextIngoing.size(), ());
+  ASSERT_EQUAL(edgeOffsets.size(), ingoing.size() + 1, ());
+
+  m_mwmNames = move(mwmNames);
+  m_mwmVersions = move(mwmVersions);
+  m_ingoingOffsets = move(ingoingOffsets);
+  m_outgoingOffsets = move(outgoingOffsets);
+  m_ingoing = move(ingoing);
+  m_outgoing = move(outgoing);
+  m_nextMwms = move(nextMwms);
+  m_nextIngoing = move(nextIngoing);
+  m_edgeOffsets = move(edgeOffsets);
+  m_edges = move(edges);
+
+  m_mwmIndices.clear();
+  for (uint32_t mwm = 0; mwm < m_mwmNames.size(); ++mwm)
+    m_mwmIndices[m_mwmNames[mwm]] = mwm;
+
+  m_ingoingByNodeId.resize(m_ingoing.size());
+  for (uint32_t i = 0; i < m_ingoing.size(); ++i)
+    m_ingoingByNodeId[i] = i;
+  sort(m_ingoingByNodeId.begin(), m_ingoingByNodeId.end(), [this](uint32_t l, uint32_t r)
+  {
+    return make_pair(m_ingoing[l].m_mwm, m_ingoing[l].m_nodeId) <
+           make_pair(m_ingoing[r].m_mwm, m_ingoing[r].m_nodeId);
+  });
+}
+
+bool CrossMwmOverlay::GetMwmIndex(string const & name, uint32_t & mwm) const
+{
+  auto const it = m_mwmIndices.find(name);
+  if (it == m_mwmIndices.end())
+    return false;
+  mwm = it->second;
+  return true;
+}
+
+bool CrossMwmOverlay::FindIngoing(uint32_t mwm, WritedNodeID nodeId, uint32_t & ingoing) const
+{
+  auto const it = lower_bound(m_ingoingByNodeId.begin(), m_ingoingByNodeId.end(),
+                              make_pair(mwm, nodeId), [this](uint32_t l, pair<uint32_t, WritedNodeID> const & r)
+  {
+    return make_pair(m_ingoing[l].m_mwm, m_ingoing[l].m_nodeId) < r;
+  });
+  if (it == m_ingoingByNodeId.end() || m_ingoing[*it].m_mwm != mwm ||
+      m_ingoing[*it].m_nodeId != nodeId)
+  {
+    return false;
+  }
+  ingoing = *it;
+  return true;
+}
+
+void CrossMwmOverlayBuilder::AddMwm(string const & name, uint32_t version,
+                                    CrossRoutingContextReader const & context)
+{
+  m_mwms.emplace_back();
+  MwmData & data = m_mwms.back();
+  data.m_name = name;
+  data.m_version = version;
+
+  auto const inRange = context.GetIngoingIterators();
+  auto const outRange = context.GetOutgoingIterators();
+  data.m_ingoing.assign(inRange.first, inRange.second);
+  data.m_outgoing.assign(outRange.first, outRange.second);
+  for (auto outIt = outRange.first; outIt != outRange.second; ++outIt)
+    data.m_nextMwms.push_back(context.GetOutgoingMwmName(*outIt));
+
+  // Only the edges which CrossMwmGraph uses are kept.
+  data.m_edges.resize(data.m_ingoing.size());
+  for (auto inIt = inRange.first; inIt != inRange.second; ++inIt)
+  {
+    auto & edges = data.m_edges[distance(inRange.first, inIt)];
+    for (auto outIt = outRange.first; outIt != outRange.second; ++outIt)
+    {
+      WritedEdgeWeightT const weight = context.GetAdjacencyCost(inIt, outIt);
+      if (weight != INVALID_CONTEXT_EDGE_WEIGHT && weight != 0)
+        edges.push_back({static_cast<uint32_t>(distance(outRange.first, outIt)), weight});
+    }
+  }
+}
+
+void CrossMwmOverlayBuilder::Build(CrossMwmOverlay & overlay) const
+{
+  using Node = CrossMwmOverlay::Node;
+  uint32_t constexpr kInvalidIndex = CrossMwmOverlay::kInvalidIndex;
+
+  // Neighbours without cross routing contexts get empty ranges and zero versions.
+  vector<string> mwmNames;
+  unordered_map<string, uint32_t> mwmIndices;
+  auto const getMwmIndex = [&](string const & name)
+  {
+    auto const it = mwmIndices.find(name);
+    if (it != mwmIndices.end())
+      return it->second;
+    uint32_t const index = static_cast<uint32_t>(mwmNames.size());
+    mwmNames.push_back(name);
+    mwmIndices[name] = index;
+    return index;
+  };
+  for (MwmData const & data : m_mwms)
+    getMwmIndex(data.m_name);
+  for (MwmData const & data : m_mwms)
+  {
+    for (string const & next : data.m_nextMwms)
+      getMwmIndex(next);
+  }
+
+  vector<MwmData const *> mwms(mwmNames.size(), nullptr);
+  for (MwmData const & data : m_mwms)
+    mwms[mwmIndices[data.m_name]] = &data;
+
+  vector<uint32_t> mwmVersions(mwmNames.size(), 0);
+  vector<uint32_t> ingoingOffsets(1, 0), outgoingOffsets(1, 0), edgeOffsets(1, 0);
+  vector<Node> ingoing, outgoing;
+  vector<uint32_t> nextMwms;
+  vector<CrossMwmOverlay::Edge> edges;
+  for (uint32_t mwm = 0; mwm < mwms.size(); ++mwm)
+  {
+    if (mwms[mwm])
+    {
+      MwmData const & data = *mwms[mwm];
+      mwmVersions[mwm] = data.m_version;
+      uint32_t const outgoingBegin = static_cast<uint32_t>(outgoing.size());
+      for (IngoingCrossNode const & node : data.m_ingoing)
+        ingoing.emplace_back(node.m_nodeId, node.m_point, mwm);
+      for (size_t i = 0; i < data.m_outgoing.size(); ++i)
+      {
+        outgoing.emplace_back(data.m_outgoing[i].m_nodeId, data.m_outgoing[i].m_point, mwm);
+        nextMwms.push_back(mwmIndices[data.m_nextMwms[i]]);
+      }
+      for (auto const & nodeEdges : data.m_edges)
+      {
+        for (auto const & edge : nodeEdges)
+          edges.push_back({outgoingBegin + edge.m_outgoing, edge.m_weight});
+        edgeOffsets.push_back(static_cast<uint32_t>(edges.size()));
+      }
+    }
+    ingoingOffsets.push_back(static_cast<uint32_t>(ingoing.size()));
+    outgoingOffsets.push_back(static_cast<uint32_t>(outgoing.size()));
+  }
+
+  // Outgoing nodes are connected to ingoing nodes of the next mwms by their points.
+  size_t unmatchedCount = 0;
+  vector<uint32_t> nextIngoing(outgoing.size(), kInvalidIndex);
+  for (uint32_t i = 0; i < outgoing.size(); ++i)
+  {
+    m2::PointD const & point = outgoing[i].m_point;
+    uint32_t const nextMwm = nextMwms[i];
+    for (uint32_t j = ingoingOffsets[nextMwm]; j < ingoingOffsets[nextMwm + 1]; ++j)
+    {
+      m2::PointD const & nextPoint = ingoing[j].m_point;
+      if (ms::DistanceOnEarth(point.y, point.x, nextPoint.y, nextPoint.x) <
+          kMwmCrossingNodeEqualityRadiusMeters)
+      {
+        nextIngoing[i] = j;
+        break;
+      }
+    }
+    if (nextIngoing[i] == kInvalidIndex)
+      ++unmatchedCount;
+  }
+
+  LOG(LINFO, ("Cross mwm overlay has", mwmNames.size(), "mwms,", ingoing.size(), "ingoing and",
+              outgoing.size(), "outgoing nodes,", edges.size(), "edges.", unmatchedCount,
+              "outgoing nodes are not connected to the next mwms."));
+
+  overlay.Init(move(mwmNames), move(mwmVersions), move(ingoingOffsets), move(outgoingOffsets),
+               move(ingoing), move(outgoing), move(nextMwms), move(nextIngoing),
+               move(edgeOffsets), move(edges));
+}
+}  // namespace routing
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "routing/cross_routing_context.hpp"
+
+#include "coding/varint.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "indexer/point_to_int64.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "base/assert.hpp"
+#include "base/exception.hpp"
+
+#include "std/cstdint.hpp"
+#include "std/limits.hpp"
+#include "std/string.hpp"
+#include "std/unordered_map.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+/// Border crossings graph of all the mwms, merged from their cross routing contexts.
+/// Its vertices are ingoing cross nodes. An edge goes from an ingoing node of a mwm to an
+/// outgoing node of the same mwm, which is connected to the ingoing node of the next mwm
+/// at the same border point. The overlay is small enough to be loaded at startup, so the
+/// cross mwm router does not open transit mwms to find a path.
+class CrossMwmOverlay
+{
+public:
+  DECLARE_EXCEPTION(UnknownVersionException, RootException);
+
+  static uint32_t constexpr kInvalidIndex = numeric_limits<uint32_t>::max();
+
+  struct Node
+  {
+    Node()
+        : m_nodeId(INVALID_CONTEXT_EDGE_NODE_ID), m_point(m2::PointD::Zero()), m_mwm(kInvalidIndex)
+    {
+    }
+    Node(WritedNodeID nodeId, m2::PointD const & point, uint32_t mwm)
+        : m_nodeId(nodeId), m_point(point), m_mwm(mwm)
+    {
+    }
+
+    WritedNodeID m_nodeId;
+    // Point in lon/lat coordinates as in the cross routing context.
+    m2::PointD m_point;
+    uint32_t m_mwm;
+  };
+
+  struct Edge
+  {
+    uint32_t m_outgoing;
+    WritedEdgeWeightT m_weight;
+  };
+
+  void Init(vector<string> && mwmNames, vector<uint32_t> && mwmVersions,
+            vector<uint32_t> && ingoingOffsets, vector<uint32_t> && outgoingOffsets,
+            vector<Node> && ingoing, vector<Node> && outgoing, vector<uint32_t> && nextMwms,
+            vector<uint32_t> && nextIngoing, vector<uint32_t> && edgeOffsets,
+            vector<Edge> && edges);
+
+  uint32_t GetMwmsCount() const { return static_cast<uint32_t>(m_mwmNames.size()); }
+  string const & GetMwmName(uint32_t mwm) const { return m_mwmNames[mwm]; }
+  /// Returns version timestamp of the mwm the cross nodes were taken from,
+  /// 0 for the neighbours without cross routing contexts.
+  uint32_t GetMwmVersion(uint32_t mwm) const { return m_mwmVersions[mwm]; }
+  bool GetMwmIndex(string const & name, uint32_t & mwm) const;
+
+  /// Ingoing and outgoing nodes of the mwm are [first, second) ranges of indices.
+  pair<uint32_t, uint32_t> GetIngoingRange(uint32_t mwm) const
+  {
+    return make_pair(m_ingoingOffsets[mwm], m_ingoingOffsets[mwm + 1]);
+  }
+  pair<uint32_t, uint32_t> GetOutgoingRange(uint32_t mwm) const
+  {
+    return make_pair(m_outgoingOffsets[mwm], m_outgoingOffsets[mwm + 1]);
+  }
+
+  Node const & GetIngoing(uint32_t ingoing) const { return m_ingoing[ingoing]; }
+  Node const & GetOutgoing(uint32_t outgoing) const { return m_outgoing[outgoing]; }
+
+  /// Returns the mwm the outgoing node leads to, kInvalidIndex if it is unknown.
+  uint32_t GetNextMwm(uint32_t outgoing) const { return m_nextMwms[outgoing]; }
+  /// Returns the ingoing node of the next mwm at the same point as the outgoing node,
+  /// kInvalidIndex if there is no such node.
+  uint32_t GetNextIngoing(uint32_t outgoing) const { return m_nextIngoing[outgoing]; }
+
+  bool FindIngoing(uint32_t mwm, WritedNodeID nodeId, uint32_t & ingoing) const;
+
+  /// Calls fn(outgoing, weight) for each outgoing node reachable from the ingoing node
+  /// inside its mwm.
+  template <typename TFn>
+  void ForEachEdge(uint32_t ingoing, TFn && fn) const
+  {
+    for (uint32_t i = m_edgeOffsets[ingoing]; i < m_edgeOffsets[ingoing + 1]; ++i)
+      fn(m_edges[i].m_outgoing, m_edges[i].m_weight);
+  }
+
+  template <typename TSink>
+  void Serialize(TSink & sink) const
+  {
+    WriteToSink(sink, static_cast<uint8_t>(kVersion));
+    WriteVarUint(sink, GetMwmsCount());
+    for (uint32_t mwm = 0; mwm < GetMwmsCount(); ++mwm)
+    {
+      string const & name = m_mwmNames[mwm];
+      WriteVarUint(sink, static_cast<uint32_t>(name.size()));
+      sink.Write(name.data(), name.size());
+      WriteVarUint(sink, m_mwmVersions[mwm]);
+
+      auto const ingoing = GetIngoingRange(mwm);
+      auto const outgoing = GetOutgoingRange(mwm);
+      WriteVarUint(sink, ingoing.second - ingoing.first);
+      WriteVarUint(sink, outgoing.second - outgoing.first);
+      for (uint32_t i = ingoing.first; i < ingoing.second; ++i)
+        SerializeNode(sink, m_ingoing[i]);
+      for (uint32_t i = outgoing.first; i < outgoing.second; ++i)
+      {
+        SerializeNode(sink, m_outgoing[i]);
+        WriteVarUint(sink, EncodeIndex(m_nextMwms[i]));
+        // Nodes are deserialized in the same order, so global indices stay valid.
+        WriteVarUint(sink, EncodeIndex(m_nextIngoing[i]));
+      }
+      // Outgoing nodes of edges are stored relative to the mwm range.
+      for (uint32_t i = ingoing.first; i < ingoing.second; ++i)
+      {
+        WriteVarUint(sink, m_edgeOffsets[i + 1] - m_edgeOffsets[i]);
+        for (uint32_t e = m_edgeOffsets[i]; e < m_edgeOffsets[i + 1]; ++e)
+        {
+          WriteVarUint(sink, m_edges[e].m_outgoing - outgoing.first);
+          WriteVarUint(sink, m_edges[e].m_weight);
+        }
+      }
+    }
+  }
+
+  template <typename TSource>
+  void Deserialize(TSource & src)
+  {
+    uint8_t const version = ReadPrimitiveFromSource<uint8_t>(src);
+    if (version != kVersion)
+      MYTHROW(UnknownVersionException, ("Unknown cross mwm overlay version:", version));
+
+    vector<string> mwmNames(ReadVarUint<uint32_t>(src));
+    vector<uint32_t> mwmVersions(mwmNames.size());
+    vector<uint32_t> ingoingOffsets(1, 0), outgoingOffsets(1, 0), edgeOffsets(1, 0);
+    vector<Node> ingoing, outgoing;
+    vector<uint32_t> nextMwms, nextIngoing;
+    vector<Edge> edges;
+    for (uint32_t mwm = 0; mwm < mwmNames.size(); ++mwm)
+    {
+      mwmNames[mwm].resize(ReadVarUint<uint32_t>(src));
+      if (!mwmNames[mwm].empty())
+        src.Read(&mwmNames[mwm][0], mwmNames[mwm].size());
+      mwmVersions[mwm] = ReadVarUint<uint32_t>(src);
+
+      uint32_t const ingoingCount = ReadVarUint<uint32_t>(src);
+      uint32_t const outgoingCount = ReadVarUint<uint32_t>(src);
+      uint32_t const outgoingBegin = static_cast<uint32_t>(outgoing.size());
+      for (uint32_t i = 0; i < ingoingCount; ++i)
+        ingoing.push_back(DeserializeNode(src, mwm));
+      for (uint32_t i = 0; i < outgoingCount; ++i)
+      {
+        outgoing.push_back(DeserializeNode(src, mwm));
+        nextMwms.push_back(DecodeIndex(ReadVarUint<uint32_t>(src)));
+        nextIngoing.push_back(DecodeIndex(ReadVarUint<uint32_t>(src)));
+      }
+      for (uint32_t i = 0; i < ingoingCount; ++i)
+      {
+        uint32_t const count = ReadVarUint<uint32_t>(src);
+        for (uint32_t e = 0; e < count; ++e)
+        {
+          Edge edge;
+          edge.m_outgoing = outgoingBegin + ReadVarUint<uint32_t>(src);
+          edge.m_weight = ReadVarUint<uint32_t>(src);
+          edges.push_back(edge);
+        }
+        edgeOffsets.push_back(static_cast<uint32_t>(edges.size()));
+      }
+      ingoingOffsets.push_back(static_cast<uint32_t>(ingoing.size()));
+      outgoingOffsets.push_back(static_cast<uint32_t>(outgoing.size()));
+    }
+
+    Init(move(mwmNames), move(mwmVersions), move(ingoingOffsets), move(outgoingOffsets),
+         move(ingoing), move(outgoing), move(nextMwms), move(nextIngoing), move(edgeOffsets),
+         move(edges));
+  }
+
+private:
+  static uint8_t constexpr kVersion = 0;
+
+  static uint32_t EncodeIndex(uint32_t index) { return index == kInvalidIndex ? 0 : index + 1; }
+  static uint32_t DecodeIndex(uint32_t code) { return code == 0 ? kInvalidIndex : code - 1; }
+
+  template <typename TSink>
+  static void SerializeNode(TSink & sink, Node const & node)
+  {
+    WriteVarUint(sink, node.m_nodeId);
+    WriteVarUint(sink, static_cast<uint64_t>(PointToInt64(node.m_point, POINT_COORD_BITS)));
+  }
+
+  template <typename TSource>
+  static Node DeserializeNode(TSource & src, uint32_t mwm)
+  {
+    WritedNodeID const nodeId = ReadVarUint<uint32_t>(src);
+    m2::PointD const point =
+        Int64ToPoint(static_cast<int64_t>(ReadVarUint<uint64_t>(src)), POINT_COORD_BITS);
+    return Node(nodeId, point, mwm);
+  }
+
+  vector<string> m_mwmNames;
+  vector<uint32_t> m_mwmVersions;
+  unordered_map<string, uint32_t> m_mwmIndices;
+
+  // Nodes of mwm i are [offsets[i], offsets[i + 1]).
+  vector<uint32_t> m_ingoingOffsets;
+  vector<uint32_t> m_outgoingOffsets;
+  vector<Node> m_ingoing;
+  vector<Node> m_outgoing;
+  // Ingoing nodes sorted by mwm and node id for FindIngoing.
+  vector<uint32_t> m_ingoingByNodeId;
+
+  vector<uint32_t> m_nextMwms;
+  vector<uint32_t> m_nextIngoing;
+
+  // Edges of ingoing node i are [m_edgeOffsets[i], m_edgeOffsets[i + 1]).
+  vector<uint32_t> m_edgeOffsets;
+  vector<Edge> m_edges;
+};
+
+/// Merges cross routing contexts of mwms into CrossMwmOverlay.
+class CrossMwmOverlayBuilder
+{
+public:
+  /// \param version Version timestamp of the mwm.
+  void AddMwm(string const & name, uint32_t version, CrossRoutingContextReader const & context);
+
+  void Build(CrossMwmOverlay & overlay) const;
+
+private:
+  struct MwmData
+  {
+    string m_name;
+    uint32_t m_version;
+    vector<IngoingCrossNode> m_ingoing;
+    vector<OutgoingCrossNode> m_outgoing;
+    vector<string> m_nextMwms;
+    // Edges by ingoing nodes.
+    vector<vector<CrossMwmOverlay::Edge>> m_edges;
+  };
+
+  vector<MwmData> m_mwms;
+};
+}  // namespace routing
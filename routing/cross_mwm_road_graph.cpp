@@ -1,4 +1,5 @@
 #include "cross_mwm_road_graph.hpp"
+#include "cross_mwm_overlay.hpp"
 #include "cross_mwm_router.hpp"
 
 #include "geometry/distance_on_sphere.hpp"
@@ -12,6 +13,26 @@ double constexpr kMwmCrossingNodeEqualityRadiusMeters = 5.0;
 
 namespace routing
 {
+CrossMwmGraph::CrossMwmGraph(RoutingIndexManager & indexManager,
+                             CrossMwmOverlay const * overlay)
+    : m_indexManager(indexManager), m_overlay(overlay)
+{
+  if (!m_overlay)
+    return;
+
+  m_overlayMwmStatuses.resize(m_overlay->GetMwmsCount(), OverlayMwmStatus::Absent);
+  for (uint32_t mwm = 0; mwm < m_overlay->GetMwmsCount(); ++mwm)
+  {
+    uint32_t version;
+    if (!m_indexManager.GetRoutingMwmVersion(m_overlay->GetMwmName(mwm), version))
+      continue;
+    // Node ids of other versions of the mwm differ, so its cross context is used instead.
+    m_overlayMwmStatuses[mwm] = version == m_overlay->GetMwmVersion(mwm)
+                                    ? OverlayMwmStatus::UpToDate
+                                    : OverlayMwmStatus::Outdated;
+  }
+}
+
 IRouter::ResultCode CrossMwmGraph::SetStartNode(CrossNode const & startNode)
 {
   ASSERT(!startNode.mwmName.empty(), ());
@@ -19,20 +40,38 @@ IRouter::ResultCode CrossMwmGraph::SetStartNode(CrossNode const & startNode)
   TRoutingMappingPtr startMapping = m_indexManager.GetMappingByName(startNode.mwmName);
   MappingGuard startMappingGuard(startMapping);
   UNUSED_VALUE(startMappingGuard);
-  startMapping->LoadCrossContext();
 
   // Load source data.
-  auto const mwmOutsIter = startMapping->m_crossContext.GetOutgoingIterators();
-  size_t const outSize = distance(mwmOutsIter.first, mwmOutsIter.second);
+  uint32_t overlayMwm;
+  bool const useOverlay = GetOverlayMwm(startNode.mwmName, overlayMwm);
+  pair<uint32_t, uint32_t> overlayOuts;
+  pair<OutgoingEdgeIteratorT, OutgoingEdgeIteratorT> mwmOutsIter;
+
+  // Generate routing task from one source to several targets.
+  TRoutingNodes sources(1), targets;
+  if (useOverlay)
+  {
+    overlayOuts = m_overlay->GetOutgoingRange(overlayMwm);
+    targets.reserve(overlayOuts.second - overlayOuts.first);
+    for (uint32_t j = overlayOuts.first; j < overlayOuts.second; ++j)
+    {
+      targets.emplace_back(m_overlay->GetOutgoing(j).m_nodeId, false /* isStartNode */,
+                           startNode.mwmName);
+    }
+  }
+  else
+  {
+    startMapping->LoadCrossContext();
+    mwmOutsIter = startMapping->m_crossContext.GetOutgoingIterators();
+    targets.reserve(distance(mwmOutsIter.first, mwmOutsIter.second));
+    for (auto j = mwmOutsIter.first; j < mwmOutsIter.second; ++j)
+      targets.emplace_back(j->m_nodeId, false /* isStartNode */, startNode.mwmName);
+  }
+  size_t const outSize = targets.size();
   // Can't find the route if there are no routes outside source map.
   if (!outSize)
     return IRouter::RouteNotFound;
 
-  // Generate routing task from one source to several targets.
-  TRoutingNodes sources(1), targets;
-  targets.reserve(outSize);
-  for (auto j = mwmOutsIter.first; j < mwmOutsIter.second; ++j)
-    targets.emplace_back(j->m_nodeId, false /* isStartNode */, startNode.mwmName);
   sources[0] = FeatureGraphNode(startNode.node, startNode.reverseNode, true /* isStartNode */,
                                 startNode.mwmName);
 
@@ -45,7 +84,9 @@ IRouter::ResultCode CrossMwmGraph::SetStartNode(CrossNode const & startNode)
   {
     if (IsValidEdgeWeight(weights[i]))
     {
-      BorderCross nextNode = FindNextMwmNode(*(mwmOutsIter.first + i), startMapping);
+      BorderCross const nextNode =
+          useOverlay ? FindOverlayNextMwmNode(overlayOuts.first + static_cast<uint32_t>(i))
+                     : FindNextMwmNode(*(mwmOutsIter.first + i), startMapping);
       if (nextNode.toNode.IsValid())
         dummyEdges.emplace_back(nextNode, weights[i]);
     }
@@ -71,13 +112,29 @@ IRouter::ResultCode CrossMwmGraph::SetFinalNode(CrossNode const & finalNode)
   TRoutingMappingPtr finalMapping = m_indexManager.GetMappingByName(finalNode.mwmName);
   MappingGuard finalMappingGuard(finalMapping);
   UNUSED_VALUE(finalMappingGuard);
-  finalMapping->LoadCrossContext();
 
   // Load source data.
-  auto const mwmIngoingIter = finalMapping->m_crossContext.GetIngoingIterators();
+  vector<IngoingCrossNode> ingoingNodes;
+  uint32_t overlayMwm;
+  if (GetOverlayMwm(finalNode.mwmName, overlayMwm))
+  {
+    auto const range = m_overlay->GetIngoingRange(overlayMwm);
+    for (uint32_t j = range.first; j < range.second; ++j)
+    {
+      CrossMwmOverlay::Node const & node = m_overlay->GetIngoing(j);
+      ingoingNodes.emplace_back(node.m_nodeId, node.m_point);
+    }
+  }
+  else
+  {
+    finalMapping->LoadCrossContext();
+    auto const range = finalMapping->m_crossContext.GetIngoingIterators();
+    ingoingNodes.assign(range.first, range.second);
+  }
+  auto const mwmIngoingIter = make_pair(ingoingNodes.cbegin(), ingoingNodes.cend());
   // Generate routing task from one source to several targets.
   TRoutingNodes sources, targets(1);
-  size_t const ingoingSize = distance(mwmIngoingIter.first, mwmIngoingIter.second);
+  size_t const ingoingSize = ingoingNodes.size();
   sources.reserve(ingoingSize);
 
   // If there is no routes inside target map.
@@ -113,6 +170,14 @@ IRouter::ResultCode CrossMwmGraph::SetFinalNode(CrossNode const & finalNode)
 
 BorderCross CrossMwmGraph::FindNextMwmNode(OutgoingCrossNode const & startNode,
                                            TRoutingMappingPtr const & currentMapping) const
+{
+  return FindNextMwmNode(startNode, currentMapping->GetCountryName(),
+                         currentMapping->m_crossContext.GetOutgoingMwmName(startNode));
+}
+
+BorderCross CrossMwmGraph::FindNextMwmNode(OutgoingCrossNode const & startNode,
+                                           string const & currentMwm,
+                                           string const & nextMwm) const
 {
   m2::PointD const & startPoint = startNode.m_point;
 
@@ -123,7 +188,6 @@ BorderCross CrossMwmGraph::FindNextMwmNode(OutgoingCrossNode const & startNode,
     return it->second;
   }
 
-  string const & nextMwm = currentMapping->m_crossContext.GetOutgoingMwmName(startNode);
   TRoutingMappingPtr nextMapping;
   nextMapping = m_indexManager.GetMappingByName(nextMwm);
   // If we haven't this routing file, we skip this path.
@@ -139,7 +203,7 @@ BorderCross CrossMwmGraph::FindNextMwmNode(OutgoingCrossNode const & startNode,
         kMwmCrossingNodeEqualityRadiusMeters)
     {
       BorderCross const cross(
-          CrossNode(startNode.m_nodeId, currentMapping->GetCountryName(),
+          CrossNode(startNode.m_nodeId, currentMwm,
                     MercatorBounds::FromLatLon(targetPoint.y, targetPoint.x)),
           CrossNode(i->m_nodeId, nextMwm,
                     MercatorBounds::FromLatLon(targetPoint.y, targetPoint.x)));
@@ -162,6 +226,21 @@ void CrossMwmGraph::GetOutgoingEdgesList(BorderCross const & v,
     return;
   }
 
+  // Use the overlay if it is up to date for the mwm.
+  uint32_t overlayMwm;
+  uint32_t ingoing;
+  if (GetOverlayMwm(v.toNode.mwmName, overlayMwm) &&
+      m_overlay->FindIngoing(overlayMwm, v.toNode.node, ingoing))
+  {
+    m_overlay->ForEachEdge(ingoing, [&](uint32_t outgoing, WritedEdgeWeightT weight)
+    {
+      BorderCross const target = FindOverlayNextMwmNode(outgoing);
+      if (target.toNode.IsValid())
+        adj.emplace_back(target, weight);
+    });
+    return;
+  }
+
   // Loading cross routing section.
   TRoutingMappingPtr currentMapping = m_indexManager.GetMappingByName(v.toNode.mwmName);
   ASSERT(currentMapping->IsValid(), ());
@@ -193,6 +272,43 @@ void CrossMwmGraph::GetOutgoingEdgesList(BorderCross const & v,
   }
 }
 
+bool CrossMwmGraph::GetOverlayMwm(string const & mwmName, uint32_t & mwm) const
+{
+  return m_overlay && m_overlay->GetMwmIndex(mwmName, mwm) &&
+         m_overlayMwmStatuses[mwm] == OverlayMwmStatus::UpToDate;
+}
+
+BorderCross CrossMwmGraph::FindOverlayNextMwmNode(uint32_t outgoing) const
+{
+  CrossMwmOverlay::Node const & outgoingNode = m_overlay->GetOutgoing(outgoing);
+  uint32_t const nextMwm = m_overlay->GetNextMwm(outgoing);
+  if (nextMwm == CrossMwmOverlay::kInvalidIndex)
+    return BorderCross();
+
+  string const & currentMwmName = m_overlay->GetMwmName(outgoingNode.m_mwm);
+  string const & nextMwmName = m_overlay->GetMwmName(nextMwm);
+  switch (m_overlayMwmStatuses[nextMwm])
+  {
+    case OverlayMwmStatus::Absent:
+      // If we haven't this routing file, we skip this path.
+      return BorderCross();
+    case OverlayMwmStatus::Outdated:
+      return FindNextMwmNode(OutgoingCrossNode(outgoingNode.m_nodeId, 0 /* index */,
+                                               outgoingNode.m_point),
+                             currentMwmName, nextMwmName);
+    case OverlayMwmStatus::UpToDate:
+      break;
+  }
+
+  uint32_t const nextIngoing = m_overlay->GetNextIngoing(outgoing);
+  if (nextIngoing == CrossMwmOverlay::kInvalidIndex)
+    return BorderCross();
+  CrossMwmOverlay::Node const & ingoingNode = m_overlay->GetIngoing(nextIngoing);
+  m2::PointD const point = MercatorBounds::FromLatLon(ingoingNode.m_point.y, ingoingNode.m_point.x);
+  return BorderCross(CrossNode(outgoingNode.m_nodeId, currentMwmName, point),
+                     CrossNode(ingoingNode.m_nodeId, nextMwmName, point));
+}
+
 double CrossMwmGraph::HeuristicCostEstimate(BorderCross const & v, BorderCross const & w) const
 {
   // Simple travel time heuristic works worse than simple Dijkstra's algorithm, represented by
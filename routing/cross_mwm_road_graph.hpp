@@ -14,6 +14,8 @@
 
 namespace routing
 {
+class CrossMwmOverlay;
+
 /// OSRM graph node representation with graph mwm name and border crossing point.
 struct CrossNode
 {
@@ -102,7 +104,12 @@ public:
   using TVertexType = BorderCross;
   using TEdgeType = CrossWeightedEdge;
 
-  explicit CrossMwmGraph(RoutingIndexManager & indexManager) : m_indexManager(indexManager) {}
+  /*!
+   * \param overlay Border crossings of all the mwms, may be nullptr. Cross routing contexts are
+   * loaded for the mwms which are absent in the overlay or have other versions.
+   */
+  explicit CrossMwmGraph(RoutingIndexManager & indexManager,
+                         CrossMwmOverlay const * overlay = nullptr);
 
   void GetOutgoingEdgesList(BorderCross const & v, vector<CrossWeightedEdge> & adj) const;
   void GetIngoingEdgesList(BorderCross const & /* v */,
@@ -117,8 +124,22 @@ public:
   IRouter::ResultCode SetFinalNode(CrossNode const & finalNode);
 
 private:
+  enum class OverlayMwmStatus
+  {
+    Absent,
+    UpToDate,
+    Outdated
+  };
+
   BorderCross FindNextMwmNode(OutgoingCrossNode const & startNode,
                               TRoutingMappingPtr const & currentMapping) const;
+  BorderCross FindNextMwmNode(OutgoingCrossNode const & startNode, string const & currentMwm,
+                              string const & nextMwm) const;
+
+  /// \return True if the overlay is up to date for the mwm.
+  bool GetOverlayMwm(string const & mwmName, uint32_t & mwm) const;
+  /// Finds the cross from the outgoing node of the overlay to the next mwm.
+  BorderCross FindOverlayNextMwmNode(uint32_t outgoing) const;
   /*!
    * Adds a virtual edge to the graph so that it is possible to represent
    * the final segment of the path that leads from the map's border
@@ -131,6 +152,8 @@ private:
   map<CrossNode, vector<CrossWeightedEdge> > m_virtualEdges;
   mutable RoutingIndexManager m_indexManager;
   mutable unordered_map<m2::PointD, BorderCross, m2::PointD::Hash> m_cachedNextNodes;
+  CrossMwmOverlay const * const m_overlay;
+  vector<OverlayMwmStatus> m_overlayMwmStatuses;
 };
 
 //--------------------------------------------------------------------------------------------------
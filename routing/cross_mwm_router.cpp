@@ -43,9 +43,10 @@ IRouter::ResultCode CalculateRoute(BorderCross const & startPos, BorderCross con
 IRouter::ResultCode CalculateCrossMwmPath(TRoutingNodes const & startGraphNodes,
                                           TRoutingNodes const & finalGraphNodes,
                                           RoutingIndexManager & indexManager,
+                                          CrossMwmOverlay const * overlay,
                                           RouterDelegate const & delegate, TCheckedPath & route)
 {
-  CrossMwmGraph roadGraph(indexManager);
+  CrossMwmGraph roadGraph(indexManager, overlay);
   FeatureGraphNode startGraphNode, finalGraphNode;
   CrossNode startNode, finalNode;
 
@@ -9,6 +9,8 @@
 
 namespace routing
 {
+class CrossMwmOverlay;
+
 /*!
  * \brief The RoutePathCross struct contains information neaded to describe path inside single map.
  */
@@ -32,11 +34,13 @@ using TCheckedPath = vector<RoutePathCross>;
  * \param finalGraphNodes The vector of final routing graph nodes.
  * \param route Storage for the result records about crossing maps.
  * \param indexManager Manager for getting indexes of new countries.
+ * \param overlay Border crossings graph of all the mwms, may be nullptr.
  * \param RoutingVisualizerFn Debug visualization function.
  * \return NoError if the path exists, error code otherwise.
  */
 IRouter::ResultCode CalculateCrossMwmPath(TRoutingNodes const & startGraphNodes,
                                           TRoutingNodes const & finalGraphNodes,
                                           RoutingIndexManager & indexManager,
+                                          CrossMwmOverlay const * overlay,
                                           RouterDelegate const & delegate, TCheckedPath & route);
 }  // namespace routing
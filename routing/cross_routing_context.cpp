@@ -121,6 +121,15 @@ WritedEdgeWeightT CrossRoutingContextReader::GetAdjacencyCost(IngoingEdgeIterato
   return result;
 }
 
+size_t CrossRoutingContextReader::GetResidentSize() const
+{
+  size_t size = m_ingoingNodes.capacity() * sizeof(IngoingCrossNode) +
+                m_outgoingNodes.capacity() * sizeof(OutgoingCrossNode);
+  for (string const & name : m_neighborMwmList)
+    size += sizeof(string) + name.capacity();
+  return size;
+}
+
 size_t CrossRoutingContextWriter::GetIndexInAdjMatrix(IngoingEdgeIteratorT ingoing, OutgoingEdgeIteratorT outgoing) const
 {
   size_t ingoing_index = distance(m_ingoingNodes.cbegin(), ingoing);
@@ -67,6 +67,9 @@ public:
 
   WritedEdgeWeightT GetAdjacencyCost(IngoingEdgeIteratorT ingoing,
                                      OutgoingEdgeIteratorT outgoing) const;
+
+  /// @return Estimation of memory held by the loaded nodes in bytes.
+  size_t GetResidentSize() const;
 };
 
 /// Helper class to generate cross context section in mwm.routing file
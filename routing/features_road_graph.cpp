@@ -10,9 +10,13 @@
 
 #include "geometry/distance_on_sphere.hpp"
 
+#include "coding/file_container.hpp"
+
 #include "base/logging.hpp"
 #include "base/macros.hpp"
 
+#include "defines.hpp"
+
 namespace routing
 {
 
@@ -68,6 +72,8 @@ bool FeaturesRoadGraph::CrossCountryVehicleModel::IsOneWay(FeatureType const & f
 
 IVehicleModel * FeaturesRoadGraph::CrossCountryVehicleModel::GetVehicleModel(FeatureID const & featureId) const
 {
+  lock_guard<mutex> lock(m_cacheMutex);
+
   auto itr = m_cache.find(featureId.m_mwmId);
   if (itr != m_cache.end())
     return itr->second.get();
@@ -84,16 +90,35 @@ IVehicleModel * FeaturesRoadGraph::CrossCountryVehicleModel::GetVehicleModel(Fea
 
 void FeaturesRoadGraph::CrossCountryVehicleModel::Clear()
 {
+  lock_guard<mutex> lock(m_cacheMutex);
   m_cache.clear();
 }
 
 
-IRoadGraph::RoadInfo & FeaturesRoadGraph::RoadInfoCache::Find(FeatureID const & featureId, bool & found)
+shared_ptr<IRoadGraph::RoadInfo const> FeaturesRoadGraph::RoadInfoCache::Find(
+    FeatureID const & featureId)
+{
+  auto const itr = m_cache.find(featureId.m_mwmId);
+  if (itr == m_cache.end())
+    return nullptr;
+
+  bool found = false;
+  shared_ptr<RoadInfo const> & ri = itr->second.Find(featureId.m_index, found);
+  // The entry is taken for the feature, it stays empty until the road is inserted.
+  if (!found)
+    ri.reset();
+  return ri;
+}
+
+void FeaturesRoadGraph::RoadInfoCache::Insert(FeatureID const & featureId,
+                                              shared_ptr<RoadInfo const> const & ri)
 {
   auto res = m_cache.insert(make_pair(featureId.m_mwmId, TMwmFeatureCache()));
   if (res.second)
     res.first->second.Init(kPowOfTwoForFeatureCacheSize);
-  return res.first->second.Find(featureId.m_index, found);
+
+  bool found = false;
+  res.first->second.Find(featureId.m_index, found) = ri;
 }
 
 void FeaturesRoadGraph::RoadInfoCache::Clear()
@@ -129,9 +154,9 @@ public:
 
     FeatureID const featureId = ft.GetID();
 
-    IRoadGraph::RoadInfo const & roadInfo = m_graph.GetCachedRoadInfo(featureId, ft, speedKMPH);
+    auto const roadInfo = m_graph.GetCachedRoadInfo(featureId, ft, speedKMPH);
 
-    m_edgesLoader(featureId, roadInfo);
+    m_edgesLoader(featureId, *roadInfo);
   }
 
 private:
@@ -141,14 +166,14 @@ private:
 
 IRoadGraph::RoadInfo FeaturesRoadGraph::GetRoadInfo(FeatureID const & featureId) const
 {
-  RoadInfo const & ri = GetCachedRoadInfo(featureId);
-  ASSERT_GREATER(ri.m_speedKMPH, 0.0, ());
-  return ri;
+  auto const ri = GetCachedRoadInfo(featureId);
+  ASSERT_GREATER(ri->m_speedKMPH, 0.0, ());
+  return *ri;
 }
 
 double FeaturesRoadGraph::GetSpeedKMPH(FeatureID const & featureId) const
 {
-  double const speedKMPH = GetCachedRoadInfo(featureId).m_speedKMPH;
+  double const speedKMPH = GetCachedRoadInfo(featureId)->m_speedKMPH;
   ASSERT_GREATER(speedKMPH, 0.0, ());
   return speedKMPH;
 }
@@ -158,6 +183,114 @@ double FeaturesRoadGraph::GetMaxSpeedKMPH() const
   return m_vehicleModel.GetMaxSpeed();
 }
 
+double FeaturesRoadGraph::HeuristicCostEstimate(Junction const & v, Junction const & w) const
+{
+  double const estimate = IRoadGraph::HeuristicCostEstimate(v, w);
+  if (!m_heuristicLandmarks || !(w == m_heuristicFinal))
+    return estimate;
+
+  // Fake junctions of the finish may coincide with vertices of the table.
+  for (auto const & finish : m_heuristicFinishes)
+  {
+    if (v == finish)
+      return estimate;
+  }
+
+  uint32_t vertex;
+  if (!m_heuristicLandmarks->GetVertex(v.GetPoint(), vertex))
+    return estimate;
+
+  // Every path to the final junction either leaves the mwm, or passes a fake junction
+  // of the start (fake edges are not in the table), or goes within the mwm to one
+  // of the targets. The bound is the least of the lower bounds of these paths. Each of
+  // them is consistent, so the least one and its maximum with |estimate| are consistent too.
+  double bound = m_heuristicLandmarks->GetExitTime(vertex);
+  for (auto const & start : m_heuristicStarts)
+    bound = min(bound, IRoadGraph::HeuristicCostEstimate(v, start.first) + start.second);
+  for (auto const & target : m_heuristicTargets)
+  {
+    if (bound <= estimate)
+      break;
+    bound = min(bound, m_heuristicLandmarks->GetLowerBound(vertex, target.first) + target.second);
+  }
+  return max(estimate, bound);
+}
+
+void FeaturesRoadGraph::PrepareHeuristic(Junction const & startPos,
+                                         vector<pair<Edge, m2::PointD>> const & startVicinity,
+                                         Junction const & finalPos,
+                                         vector<pair<Edge, m2::PointD>> const & finalVicinity)
+{
+  m_heuristicLandmarks.reset();
+  m_heuristicFinal = finalPos;
+  m_heuristicTargets.clear();
+  m_heuristicStarts.clear();
+  m_heuristicFinishes.clear();
+
+  // Roads of the vicinities are loaded already and so are the landmarks of their mwms.
+  shared_ptr<LandmarksTable const> landmarks;
+  {
+    lock_guard<mutex> lock(m_cacheMutex);
+    for (auto const & vicinity : finalVicinity)
+    {
+      auto const it = m_landmarks.find(vicinity.first.GetFeatureId().m_mwmId);
+      // Landmarks of different mwms can't be used together.
+      if (it == m_landmarks.end() || (landmarks && landmarks != it->second))
+        return;
+      landmarks = it->second;
+    }
+  }
+  if (!landmarks)
+    return;
+
+  // The final junction is reached through the ends of the edges of its vicinity.
+  for (auto const & vicinity : finalVicinity)
+  {
+    Edge const & edge = vicinity.first;
+    for (Junction const & junction : {edge.GetStartJunction(), edge.GetEndJunction()})
+    {
+      uint32_t vertex;
+      if (!landmarks->GetVertex(junction.GetPoint(), vertex))
+      {
+        m_heuristicTargets.clear();
+        return;
+      }
+      m_heuristicTargets.emplace_back(vertex, IRoadGraph::HeuristicCostEstimate(junction, finalPos));
+    }
+
+    Junction const projection(vicinity.second);
+    if (!(projection == edge.GetStartJunction()) && !(projection == edge.GetEndJunction()))
+      m_heuristicFinishes.push_back(projection);
+  }
+  m_heuristicFinishes.push_back(finalPos);
+
+  m_heuristicStarts.emplace_back(startPos, IRoadGraph::HeuristicCostEstimate(startPos, finalPos));
+  for (auto const & vicinity : startVicinity)
+  {
+    Junction const projection(vicinity.second);
+    m_heuristicStarts.emplace_back(projection,
+                                   IRoadGraph::HeuristicCostEstimate(projection, finalPos));
+  }
+
+  m_heuristicLandmarks = move(landmarks);
+}
+
+shared_ptr<ContractionHierarchy const> FeaturesRoadGraph::GetContractionHierarchy(
+    Junction const & junction, MwmSet::MwmId & mwmId) const
+{
+  lock_guard<mutex> lock(m_cacheMutex);
+  for (auto const & hierarchy : m_hierarchies)
+  {
+    uint32_t vertex;
+    if (hierarchy.second->GetVertex(junction.GetPoint(), vertex))
+    {
+      mwmId = hierarchy.first;
+      return hierarchy.second;
+    }
+  }
+  return nullptr;
+}
+
 void FeaturesRoadGraph::ForEachFeatureClosestToCross(m2::PointD const & cross,
                                                      CrossEdgesLoader & edgesLoader) const
 {
@@ -182,9 +315,9 @@ void FeaturesRoadGraph::FindClosestEdges(m2::PointD const & point, uint32_t coun
 
     FeatureID const featureId = ft.GetID();
 
-    IRoadGraph::RoadInfo const & roadInfo = GetCachedRoadInfo(featureId, ft, speedKMPH);
+    auto const roadInfo = GetCachedRoadInfo(featureId, ft, speedKMPH);
 
-    finder.AddInformationSource(featureId, roadInfo);
+    finder.AddInformationSource(featureId, *roadInfo);
   };
 
   m_index.ForEachInRect(
@@ -232,8 +365,13 @@ void FeaturesRoadGraph::GetJunctionTypes(Junction const & junction, feature::Typ
 
 void FeaturesRoadGraph::ClearState()
 {
-  m_cache.Clear();
   m_vehicleModel.Clear();
+
+  lock_guard<mutex> lock(m_cacheMutex);
+  m_cache.Clear();
+  m_heuristicLandmarks.reset();
+  m_landmarks.clear();
+  m_hierarchies.clear();
   m_mwmLocks.clear();
 }
 
@@ -247,51 +385,55 @@ double FeaturesRoadGraph::GetSpeedKMPHFromFt(FeatureType const & ft) const
   return m_vehicleModel.GetSpeed(ft);
 }
 
-IRoadGraph::RoadInfo const & FeaturesRoadGraph::GetCachedRoadInfo(FeatureID const & featureId) const
+shared_ptr<IRoadGraph::RoadInfo const> FeaturesRoadGraph::GetCachedRoadInfo(
+    FeatureID const & featureId) const
 {
-  bool found = false;
-  RoadInfo & ri = m_cache.Find(featureId, found);
-
-  if (found)
-    return ri;
+  {
+    lock_guard<mutex> lock(m_cacheMutex);
+    auto ri = m_cache.Find(featureId);
+    if (ri)
+      return ri;
+  }
 
   FeatureType ft;
   Index::FeaturesLoaderGuard loader(m_index, featureId.m_mwmId);
   loader.GetFeatureByIndex(featureId.m_index, ft);
   ASSERT_EQUAL(ft.GetFeatureType(), feature::GEOM_LINE, ());
 
-  ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
-
-  ri.m_bidirectional = !IsOneWay(ft);
-  ri.m_speedKMPH = GetSpeedKMPHFromFt(ft);
-  ft.SwapPoints(ri.m_points);
-
-  LockFeatureMwm(featureId);
-
-  return ri;
+  return CacheRoadInfo(featureId, ft, GetSpeedKMPHFromFt(ft));
 }
 
-IRoadGraph::RoadInfo const & FeaturesRoadGraph::GetCachedRoadInfo(FeatureID const & featureId,
-                                                                  FeatureType & ft,
-                                                                  double speedKMPH) const
+shared_ptr<IRoadGraph::RoadInfo const> FeaturesRoadGraph::GetCachedRoadInfo(
+    FeatureID const & featureId, FeatureType & ft, double speedKMPH) const
 {
-  bool found = false;
-  RoadInfo & ri = m_cache.Find(featureId, found);
-
-  if (found)
-    return ri;
+  {
+    lock_guard<mutex> lock(m_cacheMutex);
+    auto ri = m_cache.Find(featureId);
+    if (ri)
+      return ri;
+  }
 
   // ft must be set
   ASSERT_EQUAL(featureId, ft.GetID(), ());
 
+  return CacheRoadInfo(featureId, ft, speedKMPH);
+}
+
+shared_ptr<IRoadGraph::RoadInfo const> FeaturesRoadGraph::CacheRoadInfo(
+    FeatureID const & featureId, FeatureType & ft, double speedKMPH) const
+{
   ft.ParseGeometry(FeatureType::BEST_GEOMETRY);
 
-  ri.m_bidirectional = !IsOneWay(ft);
-  ri.m_speedKMPH = speedKMPH;
-  ft.SwapPoints(ri.m_points);
+  auto ri = make_shared<RoadInfo>();
+  ri->m_bidirectional = !IsOneWay(ft);
+  ri->m_speedKMPH = speedKMPH;
+  ft.SwapPoints(ri->m_points);
 
   LockFeatureMwm(featureId);
 
+  // Another thread may have loaded the same road meanwhile, both copies are equal.
+  lock_guard<mutex> lock(m_cacheMutex);
+  m_cache.Insert(featureId, ri);
   return ri;
 }
 
@@ -300,14 +442,40 @@ void FeaturesRoadGraph::LockFeatureMwm(FeatureID const & featureId) const
   MwmSet::MwmId mwmId = featureId.m_mwmId;
   ASSERT(mwmId.IsAlive(), ());
 
-  auto const itr = m_mwmLocks.find(mwmId);
-  if (itr != m_mwmLocks.end())
-    return;
+  {
+    lock_guard<mutex> lock(m_cacheMutex);
+    if (m_mwmLocks.find(mwmId) != m_mwmLocks.end())
+      return;
+  }
 
   MwmSet::MwmHandle mwmHandle = m_index.GetMwmHandleById(mwmId);
   ASSERT(mwmHandle.IsAlive(), ());
 
-  m_mwmLocks.insert(make_pair(move(mwmId), move(mwmHandle)));
+  shared_ptr<LandmarksTable> landmarks;
+  FilesContainerR const & cont = mwmHandle.GetValue<MwmValue>()->m_cont;
+  if (cont.IsExist(ROUTING_LANDMARKS_FILE_TAG))
+  {
+    landmarks = make_shared<LandmarksTable>();
+    ReaderSource<FilesContainerR::ReaderT> src(cont.GetReader(ROUTING_LANDMARKS_FILE_TAG));
+    landmarks->Deserialize(src);
+  }
+
+  shared_ptr<ContractionHierarchy> hierarchy;
+  if (cont.IsExist(ROUTING_PEDESTRIAN_CH_FILE_TAG))
+  {
+    hierarchy = make_shared<ContractionHierarchy>();
+    ReaderSource<FilesContainerR::ReaderT> src(cont.GetReader(ROUTING_PEDESTRIAN_CH_FILE_TAG));
+    hierarchy->Deserialize(src);
+  }
+
+  // If another thread has locked the mwm meanwhile, its sections are kept.
+  lock_guard<mutex> lock(m_cacheMutex);
+  if (!m_mwmLocks.insert(make_pair(mwmId, move(mwmHandle))).second)
+    return;
+  if (landmarks)
+    m_landmarks.insert(make_pair(mwmId, move(landmarks)));
+  if (hierarchy)
+    m_hierarchies.insert(make_pair(mwmId, move(hierarchy)));
 }
 
 }  // namespace routing
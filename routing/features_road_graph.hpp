@@ -1,4 +1,6 @@
 #pragma once
+#include "routing/contraction_hierarchy.hpp"
+#include "routing/landmarks.hpp"
 #include "routing/road_graph.hpp"
 #include "routing/vehicle_model.hpp"
 
@@ -10,6 +12,7 @@
 #include "base/cache.hpp"
 
 #include "std/map.hpp"
+#include "std/mutex.hpp"
 #include "std/unique_ptr.hpp"
 #include "std/vector.hpp"
 
@@ -19,6 +22,8 @@ class FeatureType;
 namespace routing
 {
 
+// FeaturesRoadGraph allows concurrent calls of its const methods,
+// e.g. from both waves of AStarAlgorithm::FindPathBidirectionalParallel.
 class FeaturesRoadGraph : public IRoadGraph
 {
 private:
@@ -40,18 +45,24 @@ private:
     unique_ptr<IVehicleModelFactory> const m_vehicleModelFactory;
     double const m_maxSpeedKMPH;
 
+    mutable mutex m_cacheMutex;
     mutable map<MwmSet::MwmId, shared_ptr<IVehicleModel>> m_cache;
   };
 
+  // Roads are shared, so they are used after the cache is unlocked
+  // even if their cache entries are replaced.
   class RoadInfoCache
   {
   public:
-    RoadInfo & Find(FeatureID const & featureId, bool & found);
+    // Returns nullptr if the road is not cached.
+    shared_ptr<RoadInfo const> Find(FeatureID const & featureId);
+
+    void Insert(FeatureID const & featureId, shared_ptr<RoadInfo const> const & ri);
 
     void Clear();
 
   private:
-    using TMwmFeatureCache = my::Cache<uint32_t, RoadInfo>;
+    using TMwmFeatureCache = my::Cache<uint32_t, shared_ptr<RoadInfo const>>;
     map<MwmSet::MwmId, TMwmFeatureCache> m_cache;
   };
 
@@ -64,6 +75,13 @@ public:
   RoadInfo GetRoadInfo(FeatureID const & featureId) const override;
   double GetSpeedKMPH(FeatureID const & featureId) const override;
   double GetMaxSpeedKMPH() const override;
+  double HeuristicCostEstimate(Junction const & v, Junction const & w) const override;
+  void PrepareHeuristic(Junction const & startPos,
+                        vector<pair<Edge, m2::PointD>> const & startVicinity,
+                        Junction const & finalPos,
+                        vector<pair<Edge, m2::PointD>> const & finalVicinity) override;
+  shared_ptr<ContractionHierarchy const> GetContractionHierarchy(
+      Junction const & junction, MwmSet::MwmId & mwmId) const override;
   void ForEachFeatureClosestToCross(m2::PointD const & cross,
                                     CrossEdgesLoader & edgesLoader) const override;
   void FindClosestEdges(m2::PointD const & point, uint32_t count,
@@ -80,19 +98,46 @@ private:
 
   // Searches a feature RoadInfo in the cache, and if does not find then
   // loads feature from the index and takes speed for the feature from the vehicle model.
-  RoadInfo const & GetCachedRoadInfo(FeatureID const & featureId) const;
+  // m_cacheMutex must not be locked, it's held only to search and to insert the road,
+  // so other threads are not blocked while the feature is loaded.
+  shared_ptr<RoadInfo const> GetCachedRoadInfo(FeatureID const & featureId) const;
   // Searches a feature RoadInfo in the cache, and if does not find then takes passed feature and speed.
   // This version is used to prevent redundant feature loading when feature speed is known.
-  RoadInfo const & GetCachedRoadInfo(FeatureID const & featureId,
-                                     FeatureType & ft,
-                                     double speedKMPH) const;
-
+  // m_cacheMutex must not be locked.
+  shared_ptr<RoadInfo const> GetCachedRoadInfo(FeatureID const & featureId,
+                                               FeatureType & ft,
+                                               double speedKMPH) const;
+  // Makes RoadInfo of the loaded feature and puts it to the cache.
+  // m_cacheMutex must not be locked.
+  shared_ptr<RoadInfo const> CacheRoadInfo(FeatureID const & featureId, FeatureType & ft,
+                                           double speedKMPH) const;
+
+  // Locks the mwm of the feature and loads its landmarks and its contraction hierarchy
+  // if the mwm has them. The sections are read without the lock.
+  // m_cacheMutex must not be locked.
   void LockFeatureMwm(FeatureID const & featureId) const;
 
   Index & m_index;
+  // Guards m_cache, m_mwmLocks, m_landmarks and m_hierarchies.
+  mutable mutex m_cacheMutex;
   mutable RoadInfoCache m_cache;
   mutable CrossCountryVehicleModel m_vehicleModel;
   mutable map<MwmSet::MwmId, MwmSet::MwmHandle> m_mwmLocks;
+  mutable map<MwmSet::MwmId, shared_ptr<LandmarksTable const>> m_landmarks;
+  mutable map<MwmSet::MwmId, shared_ptr<ContractionHierarchy const>> m_hierarchies;
+
+  // Landmarks of the final mwm for HeuristicCostEstimate, see PrepareHeuristic.
+  // They are not changed while a route is calculated and are read without locks.
+  shared_ptr<LandmarksTable const> m_heuristicLandmarks;
+  Junction m_heuristicFinal;
+  // Vertices of m_heuristicLandmarks through which the final junction is reached
+  // with lower bounds of travel times from them to the final junction.
+  vector<pair<uint32_t, double>> m_heuristicTargets;
+  // Fake junctions of the route start with lower bounds of travel times from them
+  // to the final junction.
+  vector<pair<Junction, double>> m_heuristicStarts;
+  // Fake junctions of the route finish.
+  vector<Junction> m_heuristicFinishes;
 };
 
 }  // namespace routing
@@ -0,0 +1,271 @@
+#include "routing/landmarks.hpp"
+
+#include "indexer/mercator.hpp"
+#include "indexer/point_to_int64.hpp"
+
+#include "base/logging.hpp"
+
+#include "std/cmath.hpp"
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/queue.hpp"
+#include "std/utility.hpp"
+
+namespace routing
+{
+namespace
+{
+double constexpr KMPH2MPS = 1000.0 / (60 * 60);
+
+uint32_t constexpr kInvalidVertex = numeric_limits<uint32_t>::max();
+
+// Reversed graph in the compressed sparse row format: the ingoing edges
+// of a vertex v are m_sources[m_offsets[v]..m_offsets[v + 1]).
+struct ReversedGraph
+{
+  vector<uint32_t> m_offsets;
+  vector<uint32_t> m_sources;
+  vector<uint32_t> m_weights;
+};
+
+// Calculates travel times in milliseconds from all vertices to the nearest of |targets|.
+void CalcDistancesToTargets(ReversedGraph const & graph, vector<uint32_t> const & targets,
+                            vector<uint32_t> & distances)
+{
+  using TState = pair<uint64_t, uint32_t>;
+
+  distances.assign(graph.m_offsets.size() - 1, LandmarksTable::kUnreachable);
+  priority_queue<TState, vector<TState>, greater<TState>> queue;
+
+  for (uint32_t const target : targets)
+  {
+    distances[target] = 0;
+    queue.push(make_pair(0, target));
+  }
+  while (!queue.empty())
+  {
+    TState const state = queue.top();
+    queue.pop();
+
+    uint32_t const v = state.second;
+    if (state.first > distances[v])
+      continue;
+
+    for (uint32_t i = graph.m_offsets[v]; i < graph.m_offsets[v + 1]; ++i)
+    {
+      uint32_t const w = graph.m_sources[i];
+      uint64_t const distW = state.first + graph.m_weights[i];
+      if (distW < distances[w])
+      {
+        CHECK_LESS(distW, LandmarksTable::kUnreachable, ("Too long travel time."));
+        distances[w] = static_cast<uint32_t>(distW);
+        queue.push(make_pair(distW, w));
+      }
+    }
+  }
+}
+
+// Returns the vertex with the greatest reachable value of |distances|.
+uint32_t FindFarthestVertex(vector<uint32_t> const & distances)
+{
+  uint32_t farthest = kInvalidVertex;
+  for (uint32_t v = 0; v < distances.size(); ++v)
+  {
+    if (distances[v] == LandmarksTable::kUnreachable)
+      continue;
+    if (farthest == kInvalidVertex || distances[v] > distances[farthest])
+      farthest = v;
+  }
+  return farthest;
+}
+}  // namespace
+
+uint32_t constexpr LandmarksTable::kUnreachable;
+uint8_t constexpr LandmarksTable::kVersion;
+
+void LandmarksTable::Init(vector<TKey> && keys, vector<uint32_t> && distances,
+                          vector<uint32_t> && exitTimes, uint32_t landmarksCount,
+                          bool bidirectional)
+{
+  ASSERT(is_sorted(keys.begin(), keys.end()), ());
+  ASSERT_EQUAL(keys.size() * landmarksCount, distances.size(), ());
+  ASSERT_EQUAL(keys.size(), exitTimes.size(), ());
+
+  m_keys = move(keys);
+  m_distances = move(distances);
+  m_exitTimes = move(exitTimes);
+  m_landmarksCount = landmarksCount;
+  m_bidirectional = bidirectional;
+}
+
+// static
+LandmarksTable::TKey LandmarksTable::GetKey(m2::PointD const & point)
+{
+  return static_cast<TKey>(PointToInt64(point, POINT_COORD_BITS));
+}
+
+bool LandmarksTable::GetVertex(m2::PointD const & point, uint32_t & vertex) const
+{
+  TKey const key = GetKey(point);
+  auto const it = lower_bound(m_keys.begin(), m_keys.end(), key);
+  if (it == m_keys.end() || *it != key)
+    return false;
+  vertex = static_cast<uint32_t>(distance(m_keys.begin(), it));
+  return true;
+}
+
+double LandmarksTable::GetLowerBound(uint32_t from, uint32_t to) const
+{
+  ASSERT_LESS(from, m_keys.size(), ());
+  ASSERT_LESS(to, m_keys.size(), ());
+
+  uint32_t const * rowFrom = &m_distances[static_cast<size_t>(from) * m_landmarksCount];
+  uint32_t const * rowTo = &m_distances[static_cast<size_t>(to) * m_landmarksCount];
+
+  uint32_t best = 0;
+  for (uint32_t i = 0; i < m_landmarksCount; ++i)
+  {
+    if (rowFrom[i] == kUnreachable || rowTo[i] == kUnreachable)
+      continue;
+
+    // d(from, to) >= d(from, L) - d(to, L) and, if the graph is bidirectional,
+    // d(from, to) = d(to, from) >= d(to, L) - d(from, L).
+    if (rowFrom[i] > rowTo[i])
+      best = max(best, rowFrom[i] - rowTo[i]);
+    else if (m_bidirectional)
+      best = max(best, rowTo[i] - rowFrom[i]);
+  }
+  return best / 1000.0;
+}
+
+double LandmarksTable::GetExitTime(uint32_t vertex) const
+{
+  ASSERT_LESS(vertex, m_exitTimes.size(), ());
+  uint32_t const time = m_exitTimes[vertex];
+  if (time == kUnreachable)
+    return numeric_limits<double>::infinity();
+  return time / 1000.0;
+}
+
+void LandmarksTableBuilder::AddRoad(vector<m2::PointD> const & points, double speedKMPH,
+                                    bool bidirectional)
+{
+  ASSERT_GREATER(speedKMPH, 0.0, ());
+
+  double const speedMPS = speedKMPH * KMPH2MPS;
+  for (size_t i = 0; i + 1 < points.size(); ++i)
+  {
+    LandmarksTable::TKey const from = LandmarksTable::GetKey(points[i]);
+    LandmarksTable::TKey const to = LandmarksTable::GetKey(points[i + 1]);
+    if (from == to)
+      continue;
+
+    // The same formula as in the routing algorithms, see routing_algorithm.cpp.
+    // Weights are rounded down to keep the travel times consistent with them.
+    double const weight = MercatorBounds::DistanceOnEarth(points[i], points[i + 1]) / speedMPS;
+    uint32_t const weightMs = static_cast<uint32_t>(floor(weight * 1000.0));
+    m_edges.push_back({from, to, weightMs});
+    if (bidirectional)
+      m_edges.push_back({to, from, weightMs});
+  }
+
+  if (!bidirectional)
+    m_bidirectional = false;
+}
+
+void LandmarksTableBuilder::AddExit(m2::PointD const & point)
+{
+  m_exits.push_back(LandmarksTable::GetKey(point));
+}
+
+void LandmarksTableBuilder::Build(uint32_t landmarksCount, LandmarksTable & table)
+{
+  vector<LandmarksTable::TKey> keys;
+  keys.reserve(m_edges.size());
+  for (auto const & e : m_edges)
+    keys.push_back(e.m_from);
+  for (auto const & e : m_edges)
+    keys.push_back(e.m_to);
+  sort(keys.begin(), keys.end());
+  keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+  auto const getVertex = [&keys](LandmarksTable::TKey key)
+  {
+    return static_cast<uint32_t>(distance(keys.begin(), lower_bound(keys.begin(), keys.end(), key)));
+  };
+
+  uint32_t const verticesCount = static_cast<uint32_t>(keys.size());
+
+  ReversedGraph graph;
+  graph.m_offsets.assign(verticesCount + 1, 0);
+  for (auto const & e : m_edges)
+    ++graph.m_offsets[getVertex(e.m_to) + 1];
+  for (uint32_t v = 0; v < verticesCount; ++v)
+    graph.m_offsets[v + 1] += graph.m_offsets[v];
+
+  graph.m_sources.resize(m_edges.size());
+  graph.m_weights.resize(m_edges.size());
+  vector<uint32_t> filled(graph.m_offsets.begin(), graph.m_offsets.end() - 1);
+  for (auto const & e : m_edges)
+  {
+    uint32_t const pos = filled[getVertex(e.m_to)]++;
+    graph.m_sources[pos] = getVertex(e.m_from);
+    graph.m_weights[pos] = e.m_weight;
+  }
+  m_edges.clear();
+  m_edges.shrink_to_fit();
+
+  // Travel times to the j-th landmark are the j-th column of the matrix.
+  vector<uint32_t> matrix(static_cast<size_t>(verticesCount) * landmarksCount);
+  uint32_t count = 0;
+  if (verticesCount != 0)
+  {
+    // The first landmark is the farthest vertex from an arbitrary one.
+    vector<uint32_t> distances;
+    CalcDistancesToTargets(graph, {verticesCount / 2}, distances);
+    uint32_t landmark = FindFarthestVertex(distances);
+
+    vector<uint32_t> minDistances(verticesCount, LandmarksTable::kUnreachable);
+    while (landmark != kInvalidVertex && count < landmarksCount)
+    {
+      CalcDistancesToTargets(graph, {landmark}, distances);
+      for (uint32_t v = 0; v < verticesCount; ++v)
+      {
+        minDistances[v] = min(minDistances[v], distances[v]);
+        matrix[static_cast<size_t>(v) * landmarksCount + count] = distances[v];
+      }
+      ++count;
+
+      landmark = FindFarthestVertex(minDistances);
+      if (landmark != kInvalidVertex && minDistances[landmark] == 0)
+        landmark = kInvalidVertex;
+    }
+  }
+
+  if (count < landmarksCount)
+  {
+    // Drops the columns of landmarks which have not been found.
+    for (size_t v = 0; v < verticesCount; ++v)
+    {
+      for (uint32_t i = 0; i < count; ++i)
+        matrix[v * count + i] = matrix[v * landmarksCount + i];
+    }
+    matrix.resize(static_cast<size_t>(verticesCount) * count);
+  }
+
+  vector<uint32_t> exits;
+  for (LandmarksTable::TKey const key : m_exits)
+  {
+    auto const it = lower_bound(keys.begin(), keys.end(), key);
+    if (it != keys.end() && *it == key)
+      exits.push_back(static_cast<uint32_t>(distance(keys.begin(), it)));
+  }
+  m_exits.clear();
+
+  vector<uint32_t> exitTimes;
+  CalcDistancesToTargets(graph, exits, exitTimes);
+
+  LOG(LINFO, ("Landmarks:", count, "vertices:", verticesCount, "exits:", exits.size()));
+  table.Init(move(keys), move(matrix), move(exitTimes), count, m_bidirectional);
+}
+}  // namespace routing
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "coding/endianness.hpp"
+#include "coding/reader.hpp"
+#include "coding/varint.hpp"
+#include "coding/write_to_sink.hpp"
+
+#include "geometry/point2d.hpp"
+
+#include "base/assert.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cstdint.hpp"
+#include "std/vector.hpp"
+
+namespace routing
+{
+/// LandmarksTable keeps travel times from road graph vertices of one mwm to a few
+/// landmark vertices and estimates travel times between vertices with them via
+/// the triangle inequality: d(v, w) >= d(v, L) - d(w, L). This is the ALT heuristic,
+/// see http://research.microsoft.com/pubs/154937/soda05.pdf
+///
+/// Vertices are identified by their points. Travel times are kept in whole milliseconds
+/// and are calculated with edge weights rounded down, so the estimates are not only
+/// lower bounds but also consistent for the road graph of the mwm.
+///
+/// Roads of other mwms may lead to a shorter path, so the table also keeps travel times
+/// from every vertex to the nearest vertex outside of the mwm borders. A path which
+/// leaves the mwm is not shorter than that.
+class LandmarksTable
+{
+public:
+  using TKey = uint64_t;
+
+  static uint32_t constexpr kUnreachable = 0xFFFFFFFF;
+
+  LandmarksTable() : m_landmarksCount(0), m_bidirectional(false) {}
+
+  /// @param keys Sorted keys of the vertices.
+  /// @param distances Travel times in milliseconds from every vertex to every landmark,
+  ///                  distances[i * landmarksCount + j] is the time from keys[i]
+  ///                  to the j-th landmark, kUnreachable for unreachable landmarks.
+  /// @param exitTimes Travel times in milliseconds from every vertex to the nearest
+  ///                  vertex outside of the mwm borders, kUnreachable if there is none.
+  /// @param bidirectional True when every edge of the graph can be traversed
+  ///                      in both directions at the same time.
+  void Init(vector<TKey> && keys, vector<uint32_t> && distances, vector<uint32_t> && exitTimes,
+            uint32_t landmarksCount, bool bidirectional);
+
+  static TKey GetKey(m2::PointD const & point);
+
+  uint32_t GetLandmarksCount() const { return m_landmarksCount; }
+  size_t GetVerticesCount() const { return m_keys.size(); }
+
+  /// @return False if the point is not a vertex of the table.
+  bool GetVertex(m2::PointD const & point, uint32_t & vertex) const;
+
+  /// @return A lower bound of the travel time in seconds from |from| to |to| within the mwm,
+  ///         zero if no landmark helps.
+  double GetLowerBound(uint32_t from, uint32_t to) const;
+
+  /// @return The travel time in seconds from |vertex| to the nearest vertex outside
+  ///         of the mwm borders, infinity if there is none.
+  double GetExitTime(uint32_t vertex) const;
+
+  template <typename TSink>
+  void Serialize(TSink & sink) const
+  {
+    WriteToSink(sink, static_cast<uint8_t>(kVersion));
+    WriteToSink(sink, static_cast<uint8_t>(m_bidirectional ? 1 : 0));
+    WriteVarUint(sink, m_landmarksCount);
+    WriteVarUint(sink, static_cast<uint64_t>(m_keys.size()));
+
+    TKey prev = 0;
+    for (TKey const key : m_keys)
+    {
+      WriteVarUint(sink, key - prev);
+      prev = key;
+    }
+    for (uint32_t const d : m_distances)
+      WriteToSink(sink, d);
+    for (uint32_t const t : m_exitTimes)
+      WriteToSink(sink, t);
+  }
+
+  template <typename TSource>
+  void Deserialize(TSource & src)
+  {
+    uint8_t const version = ReadPrimitiveFromSource<uint8_t>(src);
+    CHECK_EQUAL(version, kVersion, ("Unknown landmarks section version."));
+    m_bidirectional = ReadPrimitiveFromSource<uint8_t>(src) != 0;
+    m_landmarksCount = ReadVarUint<uint32_t>(src);
+
+    uint64_t const count = ReadVarUint<uint64_t>(src);
+    m_keys.resize(count);
+    TKey prev = 0;
+    for (auto & key : m_keys)
+    {
+      key = prev + ReadVarUint<uint64_t>(src);
+      prev = key;
+    }
+
+    m_distances.resize(count * m_landmarksCount);
+    src.Read(m_distances.data(), m_distances.size() * sizeof(uint32_t));
+    for (auto & d : m_distances)
+      d = SwapIfBigEndian(d);
+
+    m_exitTimes.resize(count);
+    src.Read(m_exitTimes.data(), m_exitTimes.size() * sizeof(uint32_t));
+    for (auto & t : m_exitTimes)
+      t = SwapIfBigEndian(t);
+  }
+
+private:
+  static uint8_t constexpr kVersion = 1;
+
+  vector<TKey> m_keys;
+  // Travel times in milliseconds, a row of m_landmarksCount values per vertex.
+  vector<uint32_t> m_distances;
+  // Travel times in milliseconds to the nearest vertex outside of the mwm borders.
+  vector<uint32_t> m_exitTimes;
+  uint32_t m_landmarksCount;
+  bool m_bidirectional;
+};
+
+/// Builds LandmarksTable for a road graph. Landmarks are chosen by the farthest
+/// heuristic: every next landmark is the vertex farthest from the ones chosen so far.
+class LandmarksTableBuilder
+{
+public:
+  LandmarksTableBuilder() : m_bidirectional(true) {}
+
+  /// Adds edges between consecutive points of a road.
+  void AddRoad(vector<m2::PointD> const & points, double speedKMPH, bool bidirectional);
+
+  /// Marks the point as lying outside of the mwm borders, roads of other mwms
+  /// may start there.
+  void AddExit(m2::PointD const & point);
+
+  void Build(uint32_t landmarksCount, LandmarksTable & table);
+
+private:
+  struct Edge
+  {
+    LandmarksTable::TKey m_from;
+    LandmarksTable::TKey m_to;
+    // Travel time in milliseconds rounded down.
+    uint32_t m_weight;
+  };
+
+  vector<Edge> m_edges;
+  vector<LandmarksTable::TKey> m_exits;
+  bool m_bidirectional;
+};
+}  // namespace routing
@@ -113,6 +113,7 @@ void OsrmFtSegMapping::Clear()
 {
   m_offsets.clear();
   m_handle.Unmap();
+  m_backwardIndex.Clear();
 }
 
 void OsrmFtSegMapping::Load(FilesMappingContainer & cont, platform::LocalCountryFile const & localFile)
@@ -150,6 +151,15 @@ bool OsrmFtSegMapping::IsMapped() const
   return m_handle.IsValid();
 }
 
+size_t OsrmFtSegMapping::GetResidentSize() const
+{
+  size_t size = m_offsets.capacity() * sizeof(OsrmMappingTypes::SegOffset) +
+                m_backwardIndex.GetResidentSize();
+  if (IsMapped())
+    size += static_cast<size_t>(m_handle.GetSize());
+  return size;
+}
+
 void OsrmFtSegMapping::DumpSegmentsByFID(uint32_t fID) const
 {
 #ifdef DEBUG
@@ -395,7 +405,10 @@ void OsrmFtSegBackwardIndex::Construct(OsrmFtSegMapping & mapping, uint32_t maxN
   m_table = feature::FeaturesOffsetsTable::CreateIfNotExistsAndLoad(localFile);
 
   if (Load(bitsFileName, nodesFileName))
+  {
+    UpdateResidentSize();
     return;
+  }
 
   LOG(LINFO, ("Backward routing index is absent! Creating new one."));
   mapping.Map(routingFile);
@@ -446,6 +459,7 @@ void OsrmFtSegBackwardIndex::Construct(OsrmFtSegMapping & mapping, uint32_t maxN
 
   LOG(LINFO, ("Writing additional indexes to data files", bitsFileName, nodesFileName));
   Save(bitsFileName, nodesFileName);
+  UpdateResidentSize();
 }
 
 TNodesList const & OsrmFtSegBackwardIndex::GetNodeIdByFid(uint32_t fid) const
@@ -462,12 +476,23 @@ TNodesList const & OsrmFtSegBackwardIndex::GetNodeIdByFid(uint32_t fid) const
   return m_nodeIds[nodeIdx];
 }
 
+void OsrmFtSegBackwardIndex::UpdateResidentSize()
+{
+  m_residentSize = m_nodeIds.capacity() * sizeof(TNodesList);
+  for (TNodesList const & nodes : m_nodeIds)
+    m_residentSize += nodes.capacity() * sizeof(TOsrmNodeId);
+  m_residentSize += static_cast<size_t>(succinct::mapper::size_of(m_rankIndex));
+  if (m_table)
+    m_residentSize += m_table->byte_size();
+}
+
 void OsrmFtSegBackwardIndex::Clear()
 {
   m_nodeIds.clear();
   succinct::rs_bit_vector().swap(m_rankIndex);
   m_table.reset();
   m_mappedBits.reset();
+  m_residentSize = 0;
 }
 
 }
@@ -109,6 +109,10 @@ class OsrmFtSegBackwardIndex
 
   bool m_oldFormat;
 
+  // Estimation of memory held by the index in bytes.
+  size_t m_residentSize = 0;
+
+  void UpdateResidentSize();
   void Save(string const & nodesFileName, string const & bitsFileName);
   bool Load(string const & nodesFileName, string const & bitsFileName);
 
@@ -119,6 +123,8 @@ public:
 
   TNodesList const & GetNodeIdByFid(uint32_t fid) const;
 
+  size_t GetResidentSize() const { return m_residentSize; }
+
   void Clear();
 };
 
@@ -133,6 +139,10 @@ public:
   void Map(FilesMappingContainer & cont);
   void Unmap();
   bool IsMapped() const;
+  bool IsLoaded() const { return !m_offsets.empty(); }
+
+  /// @return Estimation of memory held by the loaded and the mapped data in bytes.
+  size_t GetResidentSize() const;
 
   template <class ToDo> void ForEachFtSeg(TOsrmNodeId nodeId, ToDo toDo) const
   {
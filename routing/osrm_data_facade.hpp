@@ -296,6 +296,13 @@ public:
     m_handleShortcuts.Unmap();
     m_handleFanoMatrix.Unmap();
   }
+
+  /// @return Size of the mapped sections in bytes.
+  size_t GetResidentSize() const
+  {
+    return static_cast<size_t>(m_handleEdgeData.GetSize() + m_handleEdgeId.GetSize() +
+                               m_handleShortcuts.GetSize() + m_handleFanoMatrix.GetSize());
+  }
 };
 
 }
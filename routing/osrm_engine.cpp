@@ -33,6 +33,13 @@ void FindWeightsMatrix(TRoutingNodes const & sources, TRoutingNodes const & targ
                        TRawDataFacade & facade, vector<EdgeWeight> & result)
 {
   SearchEngineData engineData;
+  FindWeightsMatrix(sources, targets, facade, engineData, result);
+}
+
+void FindWeightsMatrix(TRoutingNodes const & sources, TRoutingNodes const & targets,
+                       TRawDataFacade & facade, SearchEngineData & engineData,
+                       vector<EdgeWeight> & result)
+{
   NMManyToManyRouting<TRawDataFacade> pathFinder(&facade, engineData);
   PhantomNodeArray sourcesTaskVector(sources.size());
   PhantomNodeArray targetsTaskVector(targets.size());
@@ -9,6 +9,8 @@
 
 #include "3party/osrm/osrm-backend/data_structures/query_edge.hpp"
 
+struct SearchEngineData;
+
 namespace routing
 {
 /// Single graph node representation for routing task
@@ -86,6 +88,15 @@ using TRawDataFacade = OsrmRawDataFacade<QueryEdge::EdgeData>;
 void FindWeightsMatrix(TRoutingNodes const & sources, TRoutingNodes const & targets,
                        TRawDataFacade & facade, vector<EdgeWeight> & result);
 
+/*!
+   * \brief FindWeightsMatrix The same as above, but uses the search heaps of engineData.
+   * Pass the same engineData to reuse the heaps for a batch of calls. Calls with different
+   * engineData instances may run on different threads simultaneously.
+   */
+void FindWeightsMatrix(TRoutingNodes const & sources, TRoutingNodes const & targets,
+                       TRawDataFacade & facade, SearchEngineData & engineData,
+                       vector<EdgeWeight> & result);
+
 /*! Find single shortest path in a single MWM between 2 OSRM nodes
    * \param source Source OSRM graph node to make path.
    * \param taget Target OSRM graph node to make path.
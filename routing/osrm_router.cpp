@@ -1,4 +1,5 @@
 #include "car_model.hpp"
+#include "cross_mwm_overlay.hpp"
 #include "cross_mwm_router.hpp"
 #include "online_cross_fetcher.hpp"
 #include "osrm2feature_map.hpp"
@@ -17,19 +18,28 @@
 #include "indexer/index.hpp"
 #include "indexer/scales.hpp"
 
+#include "coding/reader.hpp"
 #include "coding/reader_wrapper.hpp"
 
+#include "defines.hpp"
+
 #include "base/logging.hpp"
 #include "base/math.hpp"
 #include "base/scope_guard.hpp"
+#include "base/thread.hpp"
 #include "base/timer.hpp"
 
 #include "std/algorithm.hpp"
+#include "std/atomic.hpp"
 #include "std/limits.hpp"
+#include "std/map.hpp"
 #include "std/string.hpp"
+#include "std/thread.hpp"
+#include "std/unique_ptr.hpp"
 
 #include "3party/osrm/osrm-backend/data_structures/query_edge.hpp"
 #include "3party/osrm/osrm-backend/data_structures/internal_route_result.hpp"
+#include "3party/osrm/osrm-backend/data_structures/search_engine_data.hpp"
 #include "3party/osrm/osrm-backend/descriptors/description_factory.hpp"
 
 #define INTERRUPT_WHEN_CANCELLED(DELEGATE) \
@@ -50,6 +60,41 @@ double constexpr kMwmLoadedProgress = 10.0f;
 double constexpr kPointsFoundProgress = 15.0f;
 double constexpr kCrossPathFoundProgress = 50.0f;
 double constexpr kPathFoundProgress = 70.0f;
+// Minimal count of the weights matrix rows in a single many-to-many search. Each search
+// explores the backward spaces of all its targets, so too small tasks waste the time.
+size_t constexpr kMinWeightsMatrixRowsPerTask = 8;
+// OSRM weights are in tenths of a second.
+double constexpr kOsrmWeightToSeconds = 0.1;
+
+// Part of the weights matrix with the sources and the targets in a single mwm.
+struct WeightsMatrixTask
+{
+  TRoutingMappingPtr m_mapping;
+  // Indices of the sources (rows) and the targets (columns) of the matrix.
+  vector<size_t> m_sources;
+  vector<size_t> m_targets;
+};
+
+// Returns the weight of the first pair of the candidates with a route, target candidates are
+// in the outer loop. It is the pair OsrmRouter::FindRouteFromCases builds the route for.
+// |weights| is a many-to-many matrix with |columnsCount| columns, candidates of the source are
+// its rows [rowsBegin, rowsEnd), candidates of the target are its columns
+// [columnsBegin, columnsEnd).
+EdgeWeight GetFirstCandidatesWeight(vector<EdgeWeight> const & weights, size_t columnsCount,
+                                    size_t rowsBegin, size_t rowsEnd, size_t columnsBegin,
+                                    size_t columnsEnd)
+{
+  for (size_t column = columnsBegin; column < columnsEnd; ++column)
+  {
+    for (size_t row = rowsBegin; row < rowsEnd; ++row)
+    {
+      EdgeWeight const weight = weights[row * columnsCount + column];
+      if (weight != INVALID_EDGE_WEIGHT)
+        return weight;
+    }
+  }
+  return INVALID_EDGE_WEIGHT;
+}
 } //  namespace
 // TODO (ldragunov) Switch all RawRouteData and incapsulate to own omim types.
 using RawRouteData = InternalRouteResult;
@@ -346,6 +391,18 @@ bool OsrmRouter::CheckRoutingAbility(m2::PointD const & startPoint, m2::PointD c
 OsrmRouter::OsrmRouter(Index * index, TCountryFileFn const & countryFileFn)
     : m_pIndex(index), m_indexManager(countryFileFn, index)
 {
+  try
+  {
+    ReaderSource<ModelReaderPtr> src(GetPlatform().GetReader(CROSS_MWM_OVERLAY_FILE));
+    auto overlay = make_shared<CrossMwmOverlay>();
+    overlay->Deserialize(src);
+    m_overlay = overlay;
+    LOG(LINFO, ("Cross mwm overlay of", m_overlay->GetMwmsCount(), "mwms is loaded."));
+  }
+  catch (RootException const & e)
+  {
+    LOG(LINFO, ("Cross mwm overlay is not loaded:", e.Msg()));
+  }
 }
 
 string OsrmRouter::GetName() const
@@ -360,6 +417,228 @@ void OsrmRouter::ClearState()
   m_indexManager.Clear();
 }
 
+// static
+double const OsrmRouter::kNoRouteWeight = numeric_limits<double>::max();
+
+OsrmRouter::ResultCode OsrmRouter::CalculateWeightsMatrix(vector<m2::PointD> const & sources,
+                                                          vector<m2::PointD> const & targets,
+                                                          RouterDelegate const & delegate,
+                                                          vector<double> & weights)
+{
+  my::HighResTimer timer(true);
+  weights.assign(sources.size() * targets.size(), kNoRouteWeight);
+  if (weights.empty())
+    return NoError;
+
+  m_indexManager.Trim();
+
+  // Each point is snapped once even if it is repeated or is both a source and a target.
+  vector<m2::PointD> points(sources);
+  points.insert(points.end(), targets.begin(), targets.end());
+  sort(points.begin(), points.end());
+  points.erase(unique(points.begin(), points.end()), points.end());
+  auto const getPointIndex = [&points](m2::PointD const & point)
+  {
+    return static_cast<size_t>(distance(points.begin(),
+                                        lower_bound(points.begin(), points.end(), point)));
+  };
+
+  vector<TFeatureGraphNodeVec> nodes(points.size());
+  vector<TRoutingMappingPtr> mappings(points.size());
+  map<string, unique_ptr<MappingGuard>> guards;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    bool const isSource = find(sources.begin(), sources.end(), points[i]) != sources.end();
+    TRoutingMappingPtr mapping = m_indexManager.GetMappingByPoint(points[i]);
+    if (!mapping->IsValid())
+    {
+      ResultCode const code = mapping->GetError();
+      if (code != NoError)
+        return code;
+      return isSource ? StartPointNotFound : EndPointNotFound;
+    }
+
+    unique_ptr<MappingGuard> & guard = guards[mapping->GetCountryName()];
+    if (!guard)
+      guard.reset(new MappingGuard(mapping));
+
+    if (FindPhantomNodes(points[i], m2::PointD::Zero(), nodes[i], kMaxNodeCandidatesCount,
+                         mapping) != NoError ||
+        nodes[i].empty())
+    {
+      return isSource ? StartPointNotFound : EndPointNotFound;
+    }
+    mappings[i] = mapping;
+    INTERRUPT_WHEN_CANCELLED(delegate);
+  }
+  LOG(LINFO, ("Duration of the", points.size(), "points lookup", timer.ElapsedNano()));
+  timer.Reset();
+
+  // Pairs of points in a single mwm are split into tasks, rows of a mwm are split
+  // between the threads too.
+  size_t const threadsCount = max(thread::hardware_concurrency(), 1U);
+  map<string, WeightsMatrixTask> mwmTasks;
+  for (size_t i = 0; i < sources.size(); ++i)
+  {
+    TRoutingMappingPtr const & mapping = mappings[getPointIndex(sources[i])];
+    WeightsMatrixTask & task = mwmTasks[mapping->GetCountryName()];
+    task.m_mapping = mapping;
+    task.m_sources.push_back(i);
+  }
+  for (size_t i = 0; i < targets.size(); ++i)
+  {
+    auto const it = mwmTasks.find(mappings[getPointIndex(targets[i])]->GetCountryName());
+    if (it != mwmTasks.end())
+      it->second.m_targets.push_back(i);
+  }
+
+  vector<WeightsMatrixTask> tasks;
+  for (auto const & mwmTask : mwmTasks)
+  {
+    WeightsMatrixTask const & task = mwmTask.second;
+    if (task.m_targets.empty())
+      continue;
+    size_t const rowsPerTask = max(kMinWeightsMatrixRowsPerTask,
+                                   (task.m_sources.size() + threadsCount - 1) / threadsCount);
+    for (size_t begin = 0; begin < task.m_sources.size(); begin += rowsPerTask)
+    {
+      size_t const end = min(begin + rowsPerTask, task.m_sources.size());
+      tasks.push_back({task.m_mapping,
+                       vector<size_t>(task.m_sources.begin() + begin, task.m_sources.begin() + end),
+                       task.m_targets});
+    }
+  }
+
+  // Workers write disjoint cells of the matrix. Each of them reuses its own search heaps
+  // for all its tasks, mwm data facades are only read.
+  atomic<size_t> nextTask(0);
+  auto const runTasks = [&]()
+  {
+    SearchEngineData engineData;
+    TRoutingNodes taskSources;
+    TRoutingNodes taskTargets;
+    // Candidates of the i-th point of a task are in [offsets[i], offsets[i + 1]).
+    vector<size_t> sourceOffsets;
+    vector<size_t> targetOffsets;
+    vector<EdgeWeight> taskWeights;
+    auto const addCandidates = [&nodes, &getPointIndex](vector<m2::PointD> const & matrixPoints,
+                                                        vector<size_t> const & indices,
+                                                        TRoutingNodes & candidates,
+                                                        vector<size_t> & offsets)
+    {
+      candidates.clear();
+      offsets.clear();
+      for (size_t index : indices)
+      {
+        TFeatureGraphNodeVec const & pointNodes = nodes[getPointIndex(matrixPoints[index])];
+        offsets.push_back(candidates.size());
+        candidates.insert(candidates.end(), pointNodes.begin(), pointNodes.end());
+      }
+      offsets.push_back(candidates.size());
+    };
+
+    for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+    {
+      if (delegate.IsCancelled())
+        return;
+
+      // All the candidates of the points are searched at once, so a cell of the matrix
+      // is chosen from the same candidates as CalculateRoute chooses the route from.
+      WeightsMatrixTask const & task = tasks[i];
+      addCandidates(sources, task.m_sources, taskSources, sourceOffsets);
+      addCandidates(targets, task.m_targets, taskTargets, targetOffsets);
+
+      FindWeightsMatrix(taskSources, taskTargets, task.m_mapping->m_dataFacade, engineData,
+                        taskWeights);
+      for (size_t row = 0; row < task.m_sources.size(); ++row)
+      {
+        for (size_t column = 0; column < task.m_targets.size(); ++column)
+        {
+          EdgeWeight const weight = GetFirstCandidatesWeight(
+              taskWeights, taskTargets.size(), sourceOffsets[row], sourceOffsets[row + 1],
+              targetOffsets[column], targetOffsets[column + 1]);
+          if (weight != INVALID_EDGE_WEIGHT)
+          {
+            weights[task.m_sources[row] * targets.size() + task.m_targets[column]] =
+                weight * kOsrmWeightToSeconds;
+          }
+        }
+      }
+    }
+  };
+
+  vector<threads::SimpleThread> workers;
+  for (size_t i = 1; i < min(threadsCount, tasks.size()); ++i)
+    workers.emplace_back(runTasks);
+  runTasks();
+  for (auto & worker : workers)
+    worker.join();
+  INTERRUPT_WHEN_CANCELLED(delegate);
+  LOG(LINFO, ("Duration of the", tasks.size(), "single mwm weights matrix tasks",
+              timer.ElapsedNano()));
+  timer.Reset();
+
+  // Pairs of points in different mwms.
+  size_t crossMwmPairsCount = 0;
+  for (size_t i = 0; i < sources.size(); ++i)
+  {
+    size_t const source = getPointIndex(sources[i]);
+    for (size_t j = 0; j < targets.size(); ++j)
+    {
+      size_t const target = getPointIndex(targets[j]);
+      if (mappings[source]->GetMwmId() == mappings[target]->GetMwmId())
+        continue;
+
+      EdgeWeight const weight = FindCrossMwmWeight(nodes[source], nodes[target], delegate);
+      INTERRUPT_WHEN_CANCELLED(delegate);
+      if (weight != INVALID_EDGE_WEIGHT)
+        weights[i * targets.size() + j] = weight * kOsrmWeightToSeconds;
+      ++crossMwmPairsCount;
+    }
+  }
+  if (crossMwmPairsCount != 0)
+  {
+    m_indexManager.ForEachMapping([](pair<string, TRoutingMappingPtr> const & indexPair)
+                                  {
+                                    indexPair.second->FreeCrossContext();
+                                  });
+    LOG(LINFO, ("Duration of the", crossMwmPairsCount, "cross mwm weights",
+                timer.ElapsedNano()));
+  }
+
+  return NoError;
+}
+
+EdgeWeight OsrmRouter::FindCrossMwmWeight(TFeatureGraphNodeVec const & source,
+                                          TFeatureGraphNodeVec const & target,
+                                          RouterDelegate const & delegate)
+{
+  TCheckedPath path;
+  if (CalculateCrossMwmPath(source, target, m_indexManager, m_overlay.get(), delegate, path) !=
+      NoError)
+  {
+    return INVALID_EDGE_WEIGHT;
+  }
+
+  EdgeWeight weight = 0;
+  for (RoutePathCross const & cross : path)
+  {
+    ASSERT_EQUAL(cross.startNode.mwmName, cross.finalNode.mwmName, ());
+    TRoutingMappingPtr mwmMapping = m_indexManager.GetMappingByName(cross.startNode.mwmName);
+    ASSERT(mwmMapping->IsValid(), ());
+    MappingGuard mwmMappingGuard(mwmMapping);
+    UNUSED_VALUE(mwmMappingGuard);
+    RawRoutingResult routingResult;
+    if (!FindSingleRoute(cross.startNode, cross.finalNode, mwmMapping->m_dataFacade,
+                         routingResult))
+    {
+      return INVALID_EDGE_WEIGHT;
+    }
+    weight += routingResult.shortestPathLength;
+  }
+  return weight;
+}
+
 bool OsrmRouter::FindRouteFromCases(TFeatureGraphNodeVec const & source,
                                     TFeatureGraphNodeVec const & target, TDataFacade & facade,
                                     RawRoutingResult & rawRoutingResult)
@@ -531,7 +810,7 @@ OsrmRouter::ResultCode OsrmRouter::CalculateRoute(m2::PointD const & startPoint,
                                                   RouterDelegate const & delegate, Route & route)
 {
   my::HighResTimer timer(true);
-  m_indexManager.Clear();  // TODO (Dragunov) make proper index manager cleaning
+  m_indexManager.Trim();
 
   TRoutingMappingPtr startMapping = m_indexManager.GetMappingByPoint(startPoint);
   TRoutingMappingPtr targetMapping = m_indexManager.GetMappingByPoint(finalPoint);
@@ -629,8 +908,8 @@ OsrmRouter::ResultCode OsrmRouter::CalculateRoute(m2::PointD const & startPoint,
   {
     LOG(LINFO, ("Multiple mwm routing case"));
     TCheckedPath finalPath;
-    ResultCode code = CalculateCrossMwmPath(startTask, m_cachedTargets, m_indexManager, delegate,
-                                            finalPath);
+    ResultCode code = CalculateCrossMwmPath(startTask, m_cachedTargets, m_indexManager,
+                                            m_overlay.get(), delegate, finalPath);
     timer.Reset();
     INTERRUPT_WHEN_CANCELLED(delegate);
     delegate.OnProgress(kCrossPathFoundProgress);
@@ -6,6 +6,8 @@
 #include "routing/router.hpp"
 #include "routing/routing_mapping.hpp"
 
+#include "std/shared_ptr.hpp"
+#include "std/vector.hpp"
 
 namespace feature { class TypesHolder; }
 
@@ -17,6 +19,7 @@ class FeatureType;
 
 namespace routing
 {
+class CrossMwmOverlay;
 struct RoutePathCross;
 using TCheckedPath = vector<RoutePathCross>;
 
@@ -37,6 +40,25 @@ public:
 
   virtual void ClearState() override;
 
+  /*!
+   * \brief CalculateWeightsMatrix finds travel times from each of the sources to each of the
+   * targets without building the routes. All the points are snapped to roads once per call.
+   * Pairs of points in a single mwm are processed by batched many-to-many searches, which run
+   * in parallel for different mwms and for different parts of the sources. Pairs of points in
+   * different mwms are processed one by one by the cross mwm router.
+   * \param sources Start points in mercator.
+   * \param targets Final points in mercator.
+   * \param delegate Routing callbacks delegate, only the cancellation is checked.
+   * \param weights Result matrix, where sources are rows. Weights are in seconds,
+   * kNoRouteWeight when there is no route between the points.
+   * \return NoError if all the points are snapped to roads, error code otherwise.
+   */
+  ResultCode CalculateWeightsMatrix(vector<m2::PointD> const & sources,
+                                    vector<m2::PointD> const & targets,
+                                    RouterDelegate const & delegate, vector<double> & weights);
+
+  static double const kNoRouteWeight;
+
   /*! Find single shortest path in a single MWM between 2 sets of edges
      * \param source: vector of source edges to make path
      * \param taget: vector of target edges to make path
@@ -100,11 +122,22 @@ private:
   ResultCode MakeRouteFromCrossesPath(TCheckedPath const & path, RouterDelegate const & delegate,
                                       Route & route);
 
+  /*!
+   * \brief Finds the weight of the path through several mwms in OSRM units.
+   * \return INVALID_EDGE_WEIGHT if there is no path.
+   */
+  EdgeWeight FindCrossMwmWeight(TFeatureGraphNodeVec const & source,
+                                TFeatureGraphNodeVec const & target,
+                                RouterDelegate const & delegate);
+
   Index const * m_pIndex;
 
   TFeatureGraphNodeVec m_cachedTargets;
   m2::PointD m_cachedTargetPoint;
 
   RoutingIndexManager m_indexManager;
+
+  // Border crossings graph of all the mwms, it is loaded once if the file exists.
+  shared_ptr<CrossMwmOverlay const> m_overlay;
 };
 }  // namespace routing
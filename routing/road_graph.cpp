@@ -18,6 +18,7 @@ namespace routing
 
 namespace
 {
+double constexpr KMPH2MPS = 1000.0 / (60 * 60);
 
 inline bool PointsAlmostEqualAbs(const m2::PointD & pt1, const m2::PointD & pt2)
 {
@@ -224,6 +225,11 @@ void IRoadGraph::GetRegularOutgoingEdges(Junction const & junction, TEdgeVector
   ForEachFeatureClosestToCross(cross, loader);
 }
 
+bool IRoadGraph::HasFakeEdges(Junction const & junction) const
+{
+  return m_outgoingEdges.find(junction) != m_outgoingEdges.end();
+}
+
 void IRoadGraph::ResetFakes()
 {
   m_outgoingEdges.clear();
@@ -384,6 +390,25 @@ double IRoadGraph::GetSpeedKMPH(Edge const & edge) const
   return speedKMPH;
 }
 
+double IRoadGraph::HeuristicCostEstimate(Junction const & v, Junction const & w) const
+{
+  double const maxSpeedMPS = GetMaxSpeedKMPH() * KMPH2MPS;
+  return MercatorBounds::DistanceOnEarth(v.GetPoint(), w.GetPoint()) / maxSpeedMPS;
+}
+
+shared_ptr<ContractionHierarchy const> IRoadGraph::GetContractionHierarchy(
+    Junction const & /* junction */, MwmSet::MwmId & /* mwmId */) const
+{
+  return nullptr;
+}
+
+void IRoadGraph::PrepareHeuristic(Junction const & /* startPos */,
+                                  vector<pair<Edge, m2::PointD>> const & /* startVicinity */,
+                                  Junction const & /* finalPos */,
+                                  vector<pair<Edge, m2::PointD>> const & /* finalVicinity */)
+{
+}
+
 void IRoadGraph::GetEdgeTypes(Edge const & edge, feature::TypesHolder & types) const
 {
   if (edge.IsFake())
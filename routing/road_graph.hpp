@@ -8,10 +8,12 @@
 
 #include "std/initializer_list.hpp"
 #include "std/map.hpp"
+#include "std/shared_ptr.hpp"
 #include "std/vector.hpp"
 
 namespace routing
 {
+class ContractionHierarchy;
 
 /// The Junction class represents a node description on a road network graph
 class Junction
@@ -127,6 +129,9 @@ public:
   /// positions.
   void AddFakeEdges(Junction const & junction, vector<pair<Edge, m2::PointD>> const & vicinities);
 
+  /// @return True if the outgoing edges of the junction are changed by fake edges.
+  bool HasFakeEdges(Junction const & junction) const;
+
   /// Returns RoadInfo for a road corresponding to featureId.
   virtual RoadInfo GetRoadInfo(FeatureID const & featureId) const = 0;
 
@@ -139,6 +144,25 @@ public:
   /// Returns max speed in KM/H
   virtual double GetMaxSpeedKMPH() const = 0;
 
+  /// Returns a lower bound of the travel time in seconds from v to w, which must be
+  /// consistent, see AStarAlgorithm. The default one is the straight-line distance
+  /// at the max speed.
+  virtual double HeuristicCostEstimate(Junction const & v, Junction const & w) const;
+
+  /// Lets the graph prepare a tighter HeuristicCostEstimate to finalPos for a route
+  /// from startPos. Must be called after the fake edges of both positions are added
+  /// with the same vicinities. The default graph has nothing to prepare.
+  virtual void PrepareHeuristic(Junction const & startPos,
+                                vector<pair<Edge, m2::PointD>> const & startVicinity,
+                                Junction const & finalPos,
+                                vector<pair<Edge, m2::PointD>> const & finalVicinity);
+
+  /// Returns a preprocessed hierarchy which has the junction as its vertex and the mwm
+  /// of the hierarchy, nullptr if there is no such hierarchy. The default graph has
+  /// no hierarchies.
+  virtual shared_ptr<ContractionHierarchy const> GetContractionHierarchy(
+      Junction const & junction, MwmSet::MwmId & mwmId) const;
+
   /// Calls edgesLoader on each feature which is close to cross.
   virtual void ForEachFeatureClosestToCross(m2::PointD const & cross,
                                             CrossEdgesLoader & edgesLoader) const = 0;
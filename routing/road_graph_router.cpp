@@ -211,6 +211,7 @@ IRouter::ResultCode RoadGraphRouter::CalculateRoute(m2::PointD const & startPoin
   m_roadGraph->ResetFakes();
   m_roadGraph->AddFakeEdges(startPos, startVicinity);
   m_roadGraph->AddFakeEdges(finalPos, finalVicinity);
+  m_roadGraph->PrepareHeuristic(startPos, startVicinity, finalPos, finalVicinity);
 
   vector<Junction> path;
   IRoutingAlgorithm::Result const resultCode =
@@ -276,4 +277,23 @@ unique_ptr<IRouter> CreatePedestrianAStarBidirectionalRouter(Index & index, TCou
   return router;
 }
 
+unique_ptr<IRouter> CreatePedestrianAStarBidirectionalParallelRouter(Index & index, TCountryFileFn const & countryFileFn)
+{
+  unique_ptr<IVehicleModelFactory> vehicleModelFactory(new PedestrianModelFactory());
+  unique_ptr<IRoutingAlgorithm> algorithm(new AStarBidirectionalParallelRoutingAlgorithm());
+  unique_ptr<IDirectionsEngine> directionsEngine(new PedestrianDirectionsEngine());
+  unique_ptr<IRouter> router(new RoadGraphRouter("astar-bidirectional-parallel-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine)));
+  return router;
+}
+
+unique_ptr<IRouter> CreatePedestrianContractionHierarchyRouter(Index & index, TCountryFileFn const & countryFileFn)
+{
+  unique_ptr<IVehicleModelFactory> vehicleModelFactory(new PedestrianModelFactory());
+  unique_ptr<IRoutingAlgorithm> fallback(new AStarBidirectionalRoutingAlgorithm());
+  unique_ptr<IRoutingAlgorithm> algorithm(new ContractionHierarchyRoutingAlgorithm(move(fallback)));
+  unique_ptr<IDirectionsEngine> directionsEngine(new PedestrianDirectionsEngine());
+  unique_ptr<IRouter> router(new RoadGraphRouter("ch-pedestrian", index, countryFileFn, move(vehicleModelFactory), move(algorithm), move(directionsEngine)));
+  return router;
+}
+
 }  // namespace routing
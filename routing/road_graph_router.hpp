@@ -56,4 +56,10 @@ private:
 unique_ptr<IRouter> CreatePedestrianAStarRouter(Index & index, TCountryFileFn const & countryFileFn);
 
 unique_ptr<IRouter> CreatePedestrianAStarBidirectionalRouter(Index & index, TCountryFileFn const & countryFileFn);
+
+unique_ptr<IRouter> CreatePedestrianAStarBidirectionalParallelRouter(Index & index, TCountryFileFn const & countryFileFn);
+
+/// Uses the pedestrian contraction hierarchies of mwms, falls back to
+/// the bidirectional A* for mwms without them.
+unique_ptr<IRouter> CreatePedestrianContractionHierarchyRouter(Index & index, TCountryFileFn const & countryFileFn);
 }  // namespace routing
@@ -14,12 +14,16 @@ INCLUDEPATH += $$ROOT_DIR/3party/jansson/src \
 
 SOURCES += \
     async_router.cpp \
+    async_router_pool.cpp \
     base/followed_polyline.cpp \
     car_model.cpp \
+    contraction_hierarchy.cpp \
+    cross_mwm_overlay.cpp \
     cross_mwm_road_graph.cpp \
     cross_mwm_router.cpp \
     cross_routing_context.cpp \
     features_road_graph.cpp \
+    landmarks.cpp \
     nearest_edge_finder.cpp \
     online_absent_fetcher.cpp \
     online_cross_fetcher.cpp \
@@ -45,14 +49,19 @@ SOURCES += \
 
 HEADERS += \
     async_router.hpp \
+    async_router_pool.hpp \
     base/astar_algorithm.hpp \
+    base/dense_astar_algorithm.hpp \
     base/followed_polyline.hpp \
     car_model.hpp \
+    contraction_hierarchy.hpp \
+    cross_mwm_overlay.hpp \
     cross_mwm_road_graph.hpp \
     cross_mwm_router.hpp \
     cross_routing_context.hpp \
     directions_engine.hpp \
     features_road_graph.hpp \
+    landmarks.hpp \
     nearest_edge_finder.hpp \
     online_absent_fetcher.hpp \
     online_cross_fetcher.hpp \
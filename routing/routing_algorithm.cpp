@@ -1,12 +1,20 @@
+#include "routing/contraction_hierarchy.hpp"
 #include "routing/road_graph.hpp"
 #include "routing/routing_algorithm.hpp"
 #include "routing/base/astar_algorithm.hpp"
 #include "routing/base/astar_progress.hpp"
+#include "routing/base/dense_astar_algorithm.hpp"
 
 #include "base/assert.hpp"
+#include "base/logging.hpp"
 
 #include "indexer/mercator.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/limits.hpp"
+#include "std/map.hpp"
+#include "std/queue.hpp"
+
 namespace routing
 {
 
@@ -44,10 +52,7 @@ public:
   using TVertexType = Junction;
   using TEdgeType = WeightedEdge;
 
-  RoadGraph(IRoadGraph const & roadGraph)
-    : m_roadGraph(roadGraph)
-    , m_maxSpeedMPS(roadGraph.GetMaxSpeedKMPH() * KMPH2MPS)
-  {}
+  RoadGraph(IRoadGraph const & roadGraph) : m_roadGraph(roadGraph) {}
 
   void GetOutgoingEdgesList(Junction const & v, vector<WeightedEdge> & adj) const
   {
@@ -85,15 +90,25 @@ public:
 
   double HeuristicCostEstimate(Junction const & v, Junction const & w) const
   {
-    return TimeBetweenSec(v, w, m_maxSpeedMPS);
+    return m_roadGraph.HeuristicCostEstimate(v, w);
   }
 
 private:
   IRoadGraph const & m_roadGraph;
-  double const m_maxSpeedMPS;
+};
+
+struct JunctionHash
+{
+  size_t operator()(Junction const & j) const
+  {
+    m2::PointD const & p = j.GetPoint();
+    size_t const hx = hash<double>()(p.x);
+    return hx ^ (hash<double>()(p.y) + 0x9e3779b9 + (hx << 6) + (hx >> 2));
+  }
 };
 
 typedef AStarAlgorithm<RoadGraph> TAlgorithmImpl;
+typedef DenseAStarAlgorithm<RoadGraph, JunctionHash> TDenseAlgorithmImpl;
 
 IRoutingAlgorithm::Result Convert(TAlgorithmImpl::Result value)
 {
@@ -106,6 +121,208 @@ IRoutingAlgorithm::Result Convert(TAlgorithmImpl::Result value)
   ASSERT(false, ("Unexpected TAlgorithmImpl::Result value:", value));
   return IRoutingAlgorithm::Result::NoPath;
 }
+
+function<void(Junction const &, Junction const &)> MakeDirectedVisitFn(
+    RouterDelegate const & delegate, AStarProgress & progress)
+{
+  return [&delegate, &progress](Junction const & junction, Junction const & /* target */)
+  {
+    delegate.OnPointCheck(junction.GetPoint());
+    auto const lastValue = progress.GetLastValue();
+    auto const newValue = progress.GetProgressForDirectedAlgo(junction.GetPoint());
+    if (newValue - lastValue > kProgressInterval)
+      delegate.OnProgress(newValue);
+  };
+}
+
+function<void(Junction const &, Junction const &)> MakeBidirectedVisitFn(
+    RouterDelegate const & delegate, AStarProgress & progress)
+{
+  return [&delegate, &progress](Junction const & junction, Junction const & target)
+  {
+    delegate.OnPointCheck(junction.GetPoint());
+    auto const lastValue = progress.GetLastValue();
+    auto const newValue =
+        progress.GetProgressForBidirectedAlgo(junction.GetPoint(), target.GetPoint());
+    if (newValue - lastValue > kProgressInterval)
+      delegate.OnProgress(newValue);
+  };
+}
+
+// The route ends are usually fake junctions, which are connected to a few
+// vertices of a hierarchy, so the search for the vertices is bounded.
+size_t constexpr kMaxAccessJunctions = 64;
+
+/// Vertices of a hierarchy which are reachable from a route end (or from which a route end
+/// is reachable) through junctions which are not vertices of the hierarchy.
+struct AccessVertices
+{
+  // Travel times from the route end and the previous junctions on the fastest paths.
+  map<Junction, pair<double, Junction>> m_labels;
+  // Vertices with travel times for ContractionHierarchy::FindPath.
+  vector<pair<uint32_t, double>> m_vertices;
+  map<uint32_t, Junction> m_junctions;
+  // Travel time to the other route end if it is reachable without the hierarchy.
+  double m_directWeight = numeric_limits<double>::infinity();
+  // Lower bound of travel times of the paths which don't go through m_vertices:
+  // they cross vertices of other hierarchies or junctions which are not settled.
+  double m_escapeWeight = numeric_limits<double>::infinity();
+};
+
+/// Runs Dijkstra from |start| over outgoing (|forward|) or ingoing edges, which stops
+/// at vertices of |hierarchy|. If |hierarchy| is nullptr it's set to the hierarchy
+/// of the nearest vertex and |mwmId| is set to its mwm.
+void FindAccessVertices(IRoadGraph const & roadGraph, RoadGraph const & graph,
+                        Junction const & start, Junction const & finish, bool forward,
+                        shared_ptr<ContractionHierarchy const> & hierarchy,
+                        MwmSet::MwmId & mwmId, AccessVertices & access)
+{
+  using TState = pair<double, Junction>;
+
+  priority_queue<TState, vector<TState>, greater<TState>> queue;
+  access.m_labels[start] = make_pair(0.0, start);
+  queue.emplace(0.0, start);
+
+  vector<WeightedEdge> adj;
+  size_t settled = 0;
+  while (!queue.empty() && settled < kMaxAccessJunctions)
+  {
+    TState const state = queue.top();
+    queue.pop();
+
+    Junction const & v = state.second;
+    if (state.first > access.m_labels[v].first)
+      continue;
+    ++settled;
+
+    if (v == finish)
+      access.m_directWeight = min(access.m_directWeight, state.first);
+
+    MwmSet::MwmId vertexMwmId;
+    auto const vertexHierarchy = roadGraph.GetContractionHierarchy(v, vertexMwmId);
+    if (vertexHierarchy)
+    {
+      if (!hierarchy)
+      {
+        hierarchy = vertexHierarchy;
+        mwmId = vertexMwmId;
+      }
+      uint32_t vertex;
+      if (hierarchy == vertexHierarchy && hierarchy->GetVertex(v.GetPoint(), vertex))
+      {
+        access.m_vertices.emplace_back(vertex, state.first);
+        access.m_junctions.insert(make_pair(vertex, v));
+      }
+      else
+      {
+        access.m_escapeWeight = min(access.m_escapeWeight, state.first);
+      }
+      // Vertices of other hierarchies are not crossed as well.
+      continue;
+    }
+
+    if (forward)
+      graph.GetOutgoingEdgesList(v, adj);
+    else
+      graph.GetIngoingEdgesList(v, adj);
+
+    for (auto const & edge : adj)
+    {
+      Junction const & w = edge.GetTarget();
+      double const distance = state.first + edge.GetWeight();
+      auto const it = access.m_labels.find(w);
+      if (it != access.m_labels.end() && it->second.first <= distance)
+        continue;
+      access.m_labels[w] = make_pair(distance, v);
+      queue.emplace(distance, w);
+    }
+  }
+
+  // Labels of the junctions left in the queue are not less than the top one.
+  if (!queue.empty())
+    access.m_escapeWeight = min(access.m_escapeWeight, queue.top().first);
+}
+
+/// @return A lower bound of the travel time of a path which goes through the access vertices
+///         of the route ends and leaves the mwm of |hierarchy|, or which avoids the access
+///         vertices, infinity if there is no such path.
+double GetEscapeWeight(ContractionHierarchy const & hierarchy, AccessVertices const & sources,
+                       AccessVertices const & targets)
+{
+  double toExit = sources.m_escapeWeight;
+  for (auto const & v : sources.m_vertices)
+    toExit = min(toExit, v.second + hierarchy.GetExitTime(v.first));
+  double fromExit = targets.m_escapeWeight;
+  for (auto const & v : targets.m_vertices)
+    fromExit = min(fromExit, v.second + hierarchy.GetEntryTime(v.first));
+  return toExit + fromExit;
+}
+
+/// Appends the junctions from the route end to |junction| (forward access)
+/// or from |junction| to the route end (backward access).
+void AppendAccessPath(AccessVertices const & access, Junction const & junction, bool forward,
+                      vector<Junction> & path)
+{
+  vector<Junction> chain;
+  Junction v = junction;
+  while (true)
+  {
+    chain.push_back(v);
+    auto const it = access.m_labels.find(v);
+    ASSERT(it != access.m_labels.end(), ());
+    if (it->second.second == v)
+      break;
+    v = it->second.second;
+  }
+  if (forward)
+    reverse(chain.begin(), chain.end());
+  path.insert(path.end(), chain.begin(), chain.end());
+}
+
+/// Converts the road segments of the hierarchy path to junctions of the road graph,
+/// which must be the ends of the graph edges.
+bool AppendHierarchyPath(IRoadGraph const & graph, MwmSet::MwmId const & mwmId,
+                         vector<ContractionHierarchy::RoadSegment> const & segments,
+                         vector<Junction> & path)
+{
+  // Consecutive segments usually belong to the same road.
+  IRoadGraph::RoadInfo road;
+  uint32_t roadFeatureId = 0;
+  bool hasRoad = false;
+
+  IRoadGraph::TEdgeVector edges;
+  for (auto const & segment : segments)
+  {
+    if (!hasRoad || roadFeatureId != segment.m_featureId)
+    {
+      road = graph.GetRoadInfo(FeatureID(mwmId, segment.m_featureId));
+      roadFeatureId = segment.m_featureId;
+      hasRoad = true;
+    }
+    if (segment.m_segId + 1 >= road.m_points.size())
+      return false;
+
+    Junction const start = road.m_points[segment.m_forward ? segment.m_segId : segment.m_segId + 1];
+    Junction const end = road.m_points[segment.m_forward ? segment.m_segId + 1 : segment.m_segId];
+    if (!(start == path.back()))
+      return false;
+
+    // Edges near the route ends can be replaced by the fake ones.
+    if (graph.HasFakeEdges(start))
+    {
+      edges.clear();
+      graph.GetOutgoingEdges(start, edges);
+      auto const it = find_if(edges.begin(), edges.end(), [&end](Edge const & e)
+                              {
+                                return e.GetEndJunction() == end;
+                              });
+      if (it == edges.end())
+        return false;
+    }
+    path.push_back(end);
+  }
+  return true;
+}
 }  // namespace
 
 string DebugPrint(IRoutingAlgorithm::Result const & value)
@@ -131,17 +348,7 @@ IRoutingAlgorithm::Result AStarRoutingAlgorithm::CalculateRoute(IRoadGraph const
                                                                 vector<Junction> & path)
 {
   AStarProgress progress(0, 100);
-
-  function<void(Junction const &, Junction const &)> onVisitJunctionFn =
-      [&delegate, &progress](Junction const & junction, Junction const & /* target */)
-  {
-    delegate.OnPointCheck(junction.GetPoint());
-    auto const lastValue = progress.GetLastValue();
-    auto const newValue = progress.GetProgressForDirectedAlgo(junction.GetPoint());
-    if (newValue - lastValue > kProgressInterval)
-      delegate.OnProgress(newValue);
-
-  };
+  auto const onVisitJunctionFn = MakeDirectedVisitFn(delegate, progress);
 
   my::Cancellable const & cancellable = delegate;
   progress.Initialize(startPos.GetPoint(), finalPos.GetPoint());
@@ -157,17 +364,7 @@ IRoutingAlgorithm::Result AStarBidirectionalRoutingAlgorithm::CalculateRoute(
     RouterDelegate const & delegate, vector<Junction> & path)
 {
   AStarProgress progress(0, 100);
-
-  function<void(Junction const &, Junction const &)> onVisitJunctionFn =
-      [&delegate, &progress](Junction const & junction, Junction const & target)
-  {
-    delegate.OnPointCheck(junction.GetPoint());
-    auto const lastValue = progress.GetLastValue();
-    auto const newValue =
-        progress.GetProgressForBidirectedAlgo(junction.GetPoint(), target.GetPoint());
-    if (newValue - lastValue > kProgressInterval)
-      delegate.OnProgress(newValue);
-  };
+  auto const onVisitJunctionFn = MakeBidirectedVisitFn(delegate, progress);
 
   my::Cancellable const & cancellable = delegate;
   progress.Initialize(startPos.GetPoint(), finalPos.GetPoint());
@@ -176,4 +373,146 @@ IRoutingAlgorithm::Result AStarBidirectionalRoutingAlgorithm::CalculateRoute(
   return Convert(res);
 }
 
+// *************************** AStar-bidirectional parallel routing algorithm implementation **************
+
+IRoutingAlgorithm::Result AStarBidirectionalParallelRoutingAlgorithm::CalculateRoute(
+    IRoadGraph const & graph, Junction const & startPos, Junction const & finalPos,
+    RouterDelegate const & delegate, vector<Junction> & path)
+{
+  AStarProgress progress(0, 100);
+  auto const onVisitJunctionFn = MakeBidirectedVisitFn(delegate, progress);
+
+  my::Cancellable const & cancellable = delegate;
+  progress.Initialize(startPos.GetPoint(), finalPos.GetPoint());
+  TAlgorithmImpl::Result const res =
+      TAlgorithmImpl().FindPathBidirectionalParallel<JunctionHash>(
+          RoadGraph(graph), startPos, finalPos, path, cancellable, onVisitJunctionFn);
+  return Convert(res);
+}
+
+// *************************** AStar dense routing algorithm implementation *******************************
+
+struct AStarDenseRoutingAlgorithm::Impl
+{
+  TDenseAlgorithmImpl m_algorithm;
+};
+
+AStarDenseRoutingAlgorithm::AStarDenseRoutingAlgorithm() : m_impl(new Impl()) {}
+
+AStarDenseRoutingAlgorithm::~AStarDenseRoutingAlgorithm() {}
+
+IRoutingAlgorithm::Result AStarDenseRoutingAlgorithm::CalculateRoute(
+    IRoadGraph const & graph, Junction const & startPos, Junction const & finalPos,
+    RouterDelegate const & delegate, vector<Junction> & path)
+{
+  AStarProgress progress(0, 100);
+  auto const onVisitJunctionFn = MakeDirectedVisitFn(delegate, progress);
+
+  my::Cancellable const & cancellable = delegate;
+  progress.Initialize(startPos.GetPoint(), finalPos.GetPoint());
+  TDenseAlgorithmImpl::Result const res = m_impl->m_algorithm.FindPath(
+      RoadGraph(graph), startPos, finalPos, path, cancellable, onVisitJunctionFn);
+  return Convert(res);
+}
+
+// *************************** AStar-bidirectional dense routing algorithm implementation *****************
+
+struct AStarDenseBidirectionalRoutingAlgorithm::Impl
+{
+  TDenseAlgorithmImpl m_algorithm;
+};
+
+AStarDenseBidirectionalRoutingAlgorithm::AStarDenseBidirectionalRoutingAlgorithm()
+  : m_impl(new Impl())
+{
+}
+
+AStarDenseBidirectionalRoutingAlgorithm::~AStarDenseBidirectionalRoutingAlgorithm() {}
+
+IRoutingAlgorithm::Result AStarDenseBidirectionalRoutingAlgorithm::CalculateRoute(
+    IRoadGraph const & graph, Junction const & startPos, Junction const & finalPos,
+    RouterDelegate const & delegate, vector<Junction> & path)
+{
+  AStarProgress progress(0, 100);
+  auto const onVisitJunctionFn = MakeBidirectedVisitFn(delegate, progress);
+
+  my::Cancellable const & cancellable = delegate;
+  progress.Initialize(startPos.GetPoint(), finalPos.GetPoint());
+  TDenseAlgorithmImpl::Result const res = m_impl->m_algorithm.FindPathBidirectional(
+      RoadGraph(graph), startPos, finalPos, path, cancellable, onVisitJunctionFn);
+  return Convert(res);
+}
+
+// *************************** Contraction hierarchy routing algorithm implementation *********************
+
+ContractionHierarchyRoutingAlgorithm::ContractionHierarchyRoutingAlgorithm(
+    unique_ptr<IRoutingAlgorithm> && fallback)
+  : m_fallback(move(fallback))
+{
+  ASSERT(m_fallback, ());
+}
+
+IRoutingAlgorithm::Result ContractionHierarchyRoutingAlgorithm::CalculateRoute(
+    IRoadGraph const & graph, Junction const & startPos, Junction const & finalPos,
+    RouterDelegate const & delegate, vector<Junction> & path)
+{
+  RoadGraph const roadGraph(graph);
+
+  shared_ptr<ContractionHierarchy const> hierarchy;
+  MwmSet::MwmId mwmId;
+  AccessVertices sources;
+  FindAccessVertices(graph, roadGraph, startPos, finalPos, true /* forward */, hierarchy, mwmId,
+                     sources);
+  AccessVertices targets;
+  if (hierarchy)
+  {
+    FindAccessVertices(graph, roadGraph, finalPos, startPos, false /* forward */, hierarchy,
+                       mwmId, targets);
+  }
+
+  if (!hierarchy || sources.m_vertices.empty() || targets.m_vertices.empty())
+  {
+    LOG(LDEBUG, ("No contraction hierarchy for the route, the fallback algorithm is used."));
+    return m_fallback->CalculateRoute(graph, startPos, finalPos, delegate, path);
+  }
+
+  vector<uint32_t> vertices;
+  vector<ContractionHierarchy::RoadSegment> segments;
+  double weight = numeric_limits<double>::infinity();
+  ContractionHierarchy::Result const res = hierarchy->FindPath(
+      sources.m_vertices, targets.m_vertices, delegate, vertices, segments, weight);
+  if (res == ContractionHierarchy::Result::Cancelled)
+    return Result::Cancelled;
+
+  // A path which leaves the mwm of the hierarchy may be shorter.
+  double const bestWeight = min(sources.m_directWeight, weight);
+  if (GetEscapeWeight(*hierarchy, sources, targets) < bestWeight)
+  {
+    LOG(LDEBUG, ("The route may leave the mwm of the hierarchy, the fallback algorithm is used."));
+    return m_fallback->CalculateRoute(graph, startPos, finalPos, delegate, path);
+  }
+
+  path.clear();
+  if (sources.m_directWeight <= weight)
+  {
+    AppendAccessPath(sources, finalPos, true /* forward */, path);
+    return Result::OK;
+  }
+
+  if (res == ContractionHierarchy::Result::OK)
+  {
+    AppendAccessPath(sources, sources.m_junctions[vertices.front()], true /* forward */, path);
+    if (AppendHierarchyPath(graph, mwmId, segments, path))
+    {
+      path.pop_back();
+      AppendAccessPath(targets, targets.m_junctions[vertices.back()], false /* forward */, path);
+      return Result::OK;
+    }
+    path.clear();
+  }
+
+  // The path is not connected to the road graph or there is no path.
+  return m_fallback->CalculateRoute(graph, startPos, finalPos, delegate, path);
+}
+
 }  // namespace routing
@@ -7,6 +7,7 @@
 
 #include "std/functional.hpp"
 #include "std/string.hpp"
+#include "std/unique_ptr.hpp"
 #include "std/vector.hpp"
 
 namespace routing
@@ -51,4 +52,68 @@ public:
                         vector<Junction> & path) override;
 };
 
+// AStar-bidirectional routing algorithm implementation, which runs
+// the forward and the backward waves on two threads simultaneously.
+// The road graph must allow concurrent calls of its const methods.
+class AStarBidirectionalParallelRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override;
+};
+
+// AStar routing algorithm implementation over dense vertex ids.
+// Keeps its search buffers between calls, see DenseAStarAlgorithm.
+class AStarDenseRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  AStarDenseRoutingAlgorithm();
+  ~AStarDenseRoutingAlgorithm();
+
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override;
+
+private:
+  struct Impl;
+  unique_ptr<Impl> m_impl;
+};
+
+// AStar-bidirectional routing algorithm implementation over dense vertex ids.
+class AStarDenseBidirectionalRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  AStarDenseBidirectionalRoutingAlgorithm();
+  ~AStarDenseBidirectionalRoutingAlgorithm();
+
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override;
+
+private:
+  struct Impl;
+  unique_ptr<Impl> m_impl;
+};
+
+// Routing algorithm over a contraction hierarchy of the road graph, see ContractionHierarchy.
+// Hierarchies are built for single mwms, so the fallback algorithm is used when the route
+// ends are not connected to vertices of the same hierarchy or there is no path inside it.
+class ContractionHierarchyRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  explicit ContractionHierarchyRoutingAlgorithm(unique_ptr<IRoutingAlgorithm> && fallback);
+
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override;
+
+private:
+  unique_ptr<IRoutingAlgorithm> const m_fallback;
+};
+
 }  // namespace routing
@@ -13,6 +13,9 @@
 
 #include "base/logging.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/vector.hpp"
+
 
 using platform::CountryFile;
 using platform::LocalCountryFile;
@@ -48,10 +51,7 @@ namespace routing
 {
 
 RoutingMapping::RoutingMapping(string const & countryFile, MwmSet * pIndex)
-    : m_mapCounter(0),
-      m_facadeCounter(0),
-      m_crossContextLoaded(0),
-      m_countryFile(countryFile),
+    : m_countryFile(countryFile),
       m_error(IRouter::ResultCode::RouteFileNotExist)
 {
   m_handle = pIndex->GetMwmHandleByCountryFile(CountryFile(countryFile));
@@ -89,11 +89,11 @@ RoutingMapping::~RoutingMapping()
 void RoutingMapping::Map()
 {
   ++m_mapCounter;
-  if (!m_segMapping.IsMapped())
-  {
+  // Loaded offsets and backward index are kept after Unmap() to reuse them by the next route.
+  if (!m_segMapping.IsLoaded())
     m_segMapping.Load(m_container, m_handle.GetInfo()->GetLocalFile());
+  if (!m_segMapping.IsMapped())
     m_segMapping.Map(m_container);
-  }
 }
 
 void RoutingMapping::Unmap()
@@ -137,6 +137,15 @@ void RoutingMapping::FreeCrossContext()
   m_crossContext = CrossRoutingContextReader();
 }
 
+size_t RoutingMapping::GetResidentSize() const
+{
+  return sizeof(RoutingMapping) + m_dataFacade.GetResidentSize() +
+         m_segMapping.GetResidentSize() + m_crossContext.GetResidentSize();
+}
+
+// static
+size_t const RoutingIndexManager::kDefaultResidentSizeLimit = 200 * 1024 * 1024;
+
 TRoutingMappingPtr RoutingIndexManager::GetMappingByPoint(m2::PointD const & point)
 {
   string const name = m_countryFileFn(point);
@@ -148,6 +157,8 @@ TRoutingMappingPtr RoutingIndexManager::GetMappingByPoint(m2::PointD const & poi
 
 TRoutingMappingPtr RoutingIndexManager::GetMappingByName(string const & mapName)
 {
+  m_lastUse[mapName] = ++m_useTick;
+
   // Check if we have already loaded this file.
   auto mapIter = m_mapping.find(mapName);
   if (mapIter != m_mapping.end())
@@ -156,7 +167,71 @@ TRoutingMappingPtr RoutingIndexManager::GetMappingByName(string const & mapName)
   // Or load and check file.
   TRoutingMappingPtr newMapping(new RoutingMapping(mapName, m_index));
   m_mapping[mapName] = newMapping;
+  Trim();
   return newMapping;
 }
 
+void RoutingIndexManager::Trim()
+{
+  struct Candidate
+  {
+    uint64_t m_lastUse;
+    string m_name;
+    size_t m_size;
+
+    bool operator<(Candidate const & rhs) const { return m_lastUse < rhs.m_lastUse; }
+  };
+
+  size_t residentSize = 0;
+  vector<Candidate> candidates;
+  for (auto const & mapping : m_mapping)
+  {
+    size_t const size = mapping.second->GetResidentSize();
+    residentSize += size;
+    if (mapping.second.unique() && !mapping.second->IsLocked())
+      candidates.push_back({m_lastUse[mapping.first], mapping.first, size});
+  }
+  if (residentSize <= m_residentSizeLimit)
+    return;
+
+  sort(candidates.begin(), candidates.end());
+  for (Candidate const & candidate : candidates)
+  {
+    if (residentSize <= m_residentSizeLimit)
+      break;
+    LOG(LDEBUG, ("Evict routing mapping", candidate.m_name, "of", candidate.m_size, "bytes."));
+    m_mapping.erase(candidate.m_name);
+    m_lastUse.erase(candidate.m_name);
+    residentSize -= candidate.m_size;
+  }
+
+  if (residentSize > m_residentSizeLimit)
+  {
+    LOG(LDEBUG, ("Routing mappings in use hold", residentSize, "bytes, the limit is",
+                 m_residentSizeLimit));
+  }
+}
+
+size_t RoutingIndexManager::GetResidentSize() const
+{
+  size_t residentSize = 0;
+  for (auto const & mapping : m_mapping)
+    residentSize += mapping.second->GetResidentSize();
+  return residentSize;
+}
+
+bool RoutingIndexManager::GetRoutingMwmVersion(string const & mapName, uint32_t & version) const
+{
+  MwmSet::MwmId const id = m_index->GetMwmIdByCountryFile(CountryFile(mapName));
+  if (!id.IsAlive())
+    return false;
+
+  shared_ptr<MwmInfo> const & info = id.GetInfo();
+  if (!HasOptions(info->GetLocalFile().GetFiles(), MapOptions::MapWithCarRouting))
+    return false;
+
+  version = info->m_version.timestamp;
+  return true;
+}
+
 }  // namespace routing
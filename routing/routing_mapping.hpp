@@ -41,6 +41,12 @@ struct RoutingMapping
 
   bool IsValid() const { return m_handle.IsAlive() && m_error == IRouter::ResultCode::NoError; }
 
+  /// @return true while the data is used, e.g. by MappingGuard.
+  bool IsLocked() const { return m_mapCounter != 0 || m_facadeCounter != 0; }
+
+  /// @return Estimation of memory held by the mapping in bytes, including the mapped sections.
+  size_t GetResidentSize() const;
+
   IRouter::ResultCode GetError() const { return m_error; }
 
   /*!
@@ -52,9 +58,9 @@ struct RoutingMapping
   Index::MwmId const & GetMwmId() const { return m_handle.GetId(); }
 
 private:
-  size_t m_mapCounter;
-  size_t m_facadeCounter;
-  bool m_crossContextLoaded;
+  size_t m_mapCounter = 0;
+  size_t m_facadeCounter = 0;
+  bool m_crossContextLoaded = false;
   string m_countryFile;
   FilesMappingContainer m_container;
   IRouter::ResultCode m_error;
@@ -84,12 +90,17 @@ public:
 
 /*! Manager for loading, cashing and building routing indexes.
  * Builds and shares special routing contexts.
+ * Least recently used mappings are evicted when the cache exceeds the resident size limit.
 */
 class RoutingIndexManager
 {
 public:
-  RoutingIndexManager(TCountryFileFn const & countryFileFn, MwmSet * index)
-      : m_countryFileFn(countryFileFn), m_index(index)
+  /// Default limit of memory held by the cached mappings in bytes.
+  static size_t const kDefaultResidentSizeLimit;
+
+  RoutingIndexManager(TCountryFileFn const & countryFileFn, MwmSet * index,
+                      size_t residentSizeLimit = kDefaultResidentSizeLimit)
+      : m_countryFileFn(countryFileFn), m_index(index), m_residentSizeLimit(residentSizeLimit)
   {
     ASSERT(index, ());
   }
@@ -98,18 +109,44 @@ public:
 
   TRoutingMappingPtr GetMappingByName(string const & mapName);
 
+  /*!
+   * \brief Checks if the mwm is registered together with its routing file
+   * without opening the routing file.
+   * \param version Version timestamp of the registered mwm.
+   */
+  bool GetRoutingMwmVersion(string const & mapName, uint32_t & version) const;
+
   template <class TFunctor>
   void ForEachMapping(TFunctor toDo)
   {
     for_each(m_mapping.begin(), m_mapping.end(), toDo);
   }
 
-  void Clear() { m_mapping.clear(); }
+  /*!
+   * \brief Evicts least recently used mappings while the cache exceeds the resident size limit.
+   * Mappings which are locked or referenced outside of the manager, e.g. by MappingGuard,
+   * are never evicted, so the limit may be exceeded while they are in use.
+   */
+  void Trim();
+
+  /// @return Estimation of memory held by all the cached mappings in bytes.
+  size_t GetResidentSize() const;
+
+  void Clear()
+  {
+    m_mapping.clear();
+    m_lastUse.clear();
+  }
 
 private:
   TCountryFileFn m_countryFileFn;
   unordered_map<string, TRoutingMappingPtr> m_mapping;
   MwmSet * m_index;
+
+  size_t m_residentSizeLimit;
+  // Tick of the last GetMappingByName call for each cached mapping.
+  unordered_map<string, uint64_t> m_lastUse;
+  uint64_t m_useTick = 0;
 };
 
 }  // namespace routing
@@ -1,7 +1,10 @@
 #include "testing/testing.hpp"
 
 #include "routing/base/astar_algorithm.hpp"
+#include "routing/base/dense_astar_algorithm.hpp"
+
 #include "std/map.hpp"
+#include "std/random.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
@@ -70,6 +73,70 @@ void TestAStar(UndirectedGraph const & graph, vector<unsigned> const & expectedR
   actualRoute.clear();
   TEST_EQUAL(TAlgorithm::Result::OK, algo.FindPathBidirectional(graph, 0u, 4u, actualRoute), ());
   TEST_EQUAL(expectedRoute, actualRoute, ());
+
+  actualRoute.clear();
+  TEST_EQUAL(TAlgorithm::Result::OK,
+             algo.FindPathBidirectionalParallel(graph, 0u, 4u, actualRoute), ());
+  TEST_EQUAL(expectedRoute, actualRoute, ());
+
+  using TDenseAlgorithm = DenseAStarAlgorithm<UndirectedGraph>;
+
+  TDenseAlgorithm denseAlgo;
+
+  actualRoute.clear();
+  TEST_EQUAL(TDenseAlgorithm::Result::OK, denseAlgo.FindPath(graph, 0u, 4u, actualRoute), ());
+  TEST_EQUAL(expectedRoute, actualRoute, ());
+
+  actualRoute.clear();
+  TEST_EQUAL(TDenseAlgorithm::Result::OK,
+             denseAlgo.FindPathBidirectional(graph, 0u, 4u, actualRoute), ());
+  TEST_EQUAL(expectedRoute, actualRoute, ());
+}
+
+double GetRouteLength(UndirectedGraph const & graph, vector<unsigned> const & route)
+{
+  double length = 0.0;
+  vector<Edge> adj;
+  for (size_t i = 0; i + 1 < route.size(); ++i)
+  {
+    graph.GetOutgoingEdgesList(route[i], adj);
+    double weight = -1.0;
+    for (auto const & e : adj)
+    {
+      if (e.GetTarget() == route[i + 1] && (weight < 0.0 || e.GetWeight() < weight))
+        weight = e.GetWeight();
+    }
+    TEST_GREATER_OR_EQUAL(weight, 0.0, (route[i], route[i + 1]));
+    length += weight;
+  }
+  return length;
+}
+
+void BuildRandomGrid(unsigned side, mt19937 & rng, UndirectedGraph & graph)
+{
+  uniform_int_distribution<unsigned> weights(1, 20);
+  for (unsigned y = 0; y < side; ++y)
+  {
+    for (unsigned x = 0; x < side; ++x)
+    {
+      unsigned const v = y * side + x;
+      if (x + 1 < side)
+        graph.AddEdge(v, v + 1, weights(rng));
+      if (y + 1 < side)
+        graph.AddEdge(v, v + side, weights(rng));
+    }
+  }
+}
+
+// Random graph with small weights, so there are many paths of the same length and
+// the waves of the parallel search offer many meeting vertices at the same time.
+void BuildRandomGraph(unsigned verticesCount, unsigned edgesCount, mt19937 & rng,
+                      UndirectedGraph & graph)
+{
+  uniform_int_distribution<unsigned> vertices(0, verticesCount - 1);
+  uniform_int_distribution<unsigned> weights(1, 3);
+  for (unsigned i = 0; i < edgesCount; ++i)
+    graph.AddEdge(vertices(rng), vertices(rng), weights(rng));
 }
 
 UNIT_TEST(AStarAlgorithm_Sample)
@@ -88,4 +155,129 @@ UNIT_TEST(AStarAlgorithm_Sample)
   TestAStar(graph, expectedRoute);
 }
 
+UNIT_TEST(AStarAlgorithm_DenseMatchesMapBased)
+{
+  unsigned const kSide = 40;
+  mt19937 rng(0);
+
+  UndirectedGraph graph;
+  BuildRandomGrid(kSide, rng, graph);
+
+  AStarAlgorithm<UndirectedGraph> algo;
+  // The same instance is used for all the queries to check that buffers are reset properly.
+  DenseAStarAlgorithm<UndirectedGraph> denseAlgo;
+  uniform_int_distribution<unsigned> vertices(0, kSide * kSide - 1);
+  for (size_t i = 0; i < 50; ++i)
+  {
+    unsigned const start = vertices(rng);
+    unsigned const finish = vertices(rng);
+
+    vector<unsigned> expectedRoute;
+    TEST_EQUAL(AStarAlgorithm<UndirectedGraph>::Result::OK,
+               algo.FindPath(graph, start, finish, expectedRoute), ());
+    double const expectedLength = GetRouteLength(graph, expectedRoute);
+
+    vector<unsigned> route;
+    TEST_EQUAL(AStarAlgorithm<UndirectedGraph>::Result::OK,
+               denseAlgo.FindPath(graph, start, finish, route), ());
+    TEST_EQUAL(start, route.front(), ());
+    TEST_EQUAL(finish, route.back(), ());
+    TEST_EQUAL(expectedLength, GetRouteLength(graph, route), (start, finish));
+
+    if (start == finish)
+      continue;
+
+    route.clear();
+    TEST_EQUAL(AStarAlgorithm<UndirectedGraph>::Result::OK,
+               denseAlgo.FindPathBidirectional(graph, start, finish, route), ());
+    TEST_EQUAL(start, route.front(), ());
+    TEST_EQUAL(finish, route.back(), ());
+    TEST_EQUAL(expectedLength, GetRouteLength(graph, route), (start, finish));
+  }
+}
+
+UNIT_TEST(AStarAlgorithm_ParallelBidirectionalMatchesSequential)
+{
+  using TAlgorithm = AStarAlgorithm<UndirectedGraph>;
+
+  unsigned const kSide = 60;
+  mt19937 rng(1);
+
+  UndirectedGraph graph;
+  BuildRandomGrid(kSide, rng, graph);
+  // A vertex without edges.
+  unsigned const isolated = kSide * kSide;
+
+  TAlgorithm algo;
+  uniform_int_distribution<unsigned> vertices(0, kSide * kSide - 1);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    unsigned const start = vertices(rng);
+    unsigned const finish = vertices(rng);
+
+    vector<unsigned> expectedRoute;
+    TEST_EQUAL(TAlgorithm::Result::OK,
+               algo.FindPathBidirectional(graph, start, finish, expectedRoute), ());
+
+    vector<unsigned> route;
+    TEST_EQUAL(TAlgorithm::Result::OK,
+               algo.FindPathBidirectionalParallel(graph, start, finish, route), ());
+    TEST_EQUAL(start, route.front(), ());
+    TEST_EQUAL(finish, route.back(), ());
+    TEST_EQUAL(GetRouteLength(graph, expectedRoute), GetRouteLength(graph, route),
+               (start, finish));
+  }
+
+  vector<unsigned> route;
+  TEST_EQUAL(TAlgorithm::Result::NoPath,
+             algo.FindPathBidirectionalParallel(graph, 0u, isolated, route), ());
+  TEST_EQUAL(TAlgorithm::Result::NoPath,
+             algo.FindPathBidirectionalParallel(graph, isolated, 0u, route), ());
+
+  my::Cancellable cancellable;
+  cancellable.Cancel();
+  TEST_EQUAL(TAlgorithm::Result::Cancelled,
+             algo.FindPathBidirectionalParallel(graph, 0u, kSide * kSide - 1, route, cancellable),
+             ());
+}
+
+UNIT_TEST(AStarAlgorithm_ParallelBidirectionalStress)
+{
+  using TAlgorithm = AStarAlgorithm<UndirectedGraph>;
+
+  mt19937 rng(2);
+  TAlgorithm algo;
+  for (size_t i = 0; i < 50; ++i)
+  {
+    unsigned const verticesCount = 50 + 20 * i;
+    UndirectedGraph graph;
+    BuildRandomGraph(verticesCount, 2 * verticesCount, rng, graph);
+
+    uniform_int_distribution<unsigned> vertices(0, verticesCount - 1);
+    for (size_t j = 0; j < 40; ++j)
+    {
+      unsigned const start = vertices(rng);
+      unsigned const finish = vertices(rng);
+      // FindPathBidirectional doesn't find a path from an isolated vertex to itself.
+      if (start == finish)
+        continue;
+
+      vector<unsigned> expectedRoute;
+      TAlgorithm::Result const expected =
+          algo.FindPathBidirectional(graph, start, finish, expectedRoute);
+
+      vector<unsigned> route;
+      TEST_EQUAL(expected, algo.FindPathBidirectionalParallel(graph, start, finish, route),
+                 (verticesCount, start, finish));
+      if (expected != TAlgorithm::Result::OK)
+        continue;
+
+      TEST_EQUAL(start, route.front(), ());
+      TEST_EQUAL(finish, route.back(), ());
+      TEST_EQUAL(GetRouteLength(graph, expectedRoute), GetRouteLength(graph, route),
+                 (verticesCount, start, finish));
+    }
+  }
+}
+
 }  // namespace routing_test
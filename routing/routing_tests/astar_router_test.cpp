@@ -2,6 +2,7 @@
 
 #include "routing/routing_tests/road_graph_builder.hpp"
 
+#include "routing/contraction_hierarchy.hpp"
 #include "routing/routing_algorithm.hpp"
 #include "routing/features_road_graph.hpp"
 #include "routing/route.hpp"
@@ -9,9 +10,13 @@
 
 #include "indexer/classificator_loader.hpp"
 
+#include "indexer/mercator.hpp"
+
 #include "base/logging.hpp"
 #include "base/macros.hpp"
 
+#include "std/cmath.hpp"
+
 using namespace routing;
 using namespace routing_test;
 
@@ -48,6 +53,115 @@ void AddRoad(RoadGraphMockSource & graph, initializer_list<m2::PointD> const & p
   graph.AddRoad(IRoadGraph::RoadInfo(true /* bidir */, speedKMPH, points));
 }
 
+class HierarchyRoadGraphMock : public RoadGraphMockSource
+{
+public:
+  void AddRoad(double speedKMPH, vector<m2::PointD> const & points)
+  {
+    m_builder.AddRoad(AddMockRoad(speedKMPH, points), points, speedKMPH, true /* bidirectional */);
+  }
+
+  // Adds a road of another mwm, which isn't in the hierarchy.
+  void AddForeignRoad(double speedKMPH, vector<m2::PointD> const & points)
+  {
+    AddMockRoad(speedKMPH, points);
+    for (auto const & point : points)
+      m_builder.AddExit(point);
+  }
+
+  void BuildHierarchy()
+  {
+    auto hierarchy = make_shared<ContractionHierarchy>();
+    m_builder.Build(*hierarchy);
+    m_hierarchy = hierarchy;
+  }
+
+  // IRoadGraph overrides:
+  shared_ptr<ContractionHierarchy const> GetContractionHierarchy(
+      Junction const & junction, MwmSet::MwmId & mwmId) const override
+  {
+    uint32_t vertex;
+    if (!m_hierarchy || !m_hierarchy->GetVertex(junction.GetPoint(), vertex))
+      return nullptr;
+    mwmId = MakeTestFeatureID(0).m_mwmId;
+    return m_hierarchy;
+  }
+
+private:
+  uint32_t AddMockRoad(double speedKMPH, vector<m2::PointD> const & points)
+  {
+    IRoadGraph::RoadInfo ri(true /* bidir */, speedKMPH, {});
+    ri.m_points.assign(points.begin(), points.end());
+    RoadGraphMockSource::AddRoad(move(ri));
+    return m_roadsCount++;
+  }
+
+  ContractionHierarchyBuilder m_builder;
+  shared_ptr<ContractionHierarchy const> m_hierarchy;
+  uint32_t m_roadsCount = 0;
+};
+
+class CountingRoutingAlgorithm : public IRoutingAlgorithm
+{
+public:
+  CountingRoutingAlgorithm(size_t & calls) : m_calls(calls) {}
+
+  // IRoutingAlgorithm overrides:
+  Result CalculateRoute(IRoadGraph const & graph, Junction const & startPos,
+                        Junction const & finalPos, RouterDelegate const & delegate,
+                        vector<Junction> & path) override
+  {
+    ++m_calls;
+    return AStarRoutingAlgorithm().CalculateRoute(graph, startPos, finalPos, delegate, path);
+  }
+
+private:
+  size_t & m_calls;
+};
+
+double GetPathTimeSec(IRoadGraph const & graph, vector<Junction> const & path)
+{
+  double time = 0.0;
+  IRoadGraph::TEdgeVector edges;
+  for (size_t i = 0; i + 1 < path.size(); ++i)
+  {
+    graph.GetOutgoingEdges(path[i], edges);
+    auto const it = find_if(edges.begin(), edges.end(), [&](Edge const & e)
+                            {
+                              return e.GetEndJunction() == path[i + 1];
+                            });
+    TEST(it != edges.end(), (path[i], path[i + 1]));
+    double const speedMPS = graph.GetSpeedKMPH(*it) * 1000.0 / (60 * 60);
+    time += MercatorBounds::DistanceOnEarth(path[i].GetPoint(), path[i + 1].GetPoint()) / speedMPS;
+  }
+  return time;
+}
+
+// Builds a 5x5 grid of roads with the step of 10, the i-th road is
+// the horizontal one y = 10 * i for i < 5 and the vertical one x = 10 * (i - 5) otherwise.
+void BuildGrid(HierarchyRoadGraphMock & graph)
+{
+  double const speeds[] = {5.0, 3.0, 4.5, 2.0, 4.0, 3.5, 5.0, 2.5, 4.0, 3.0};
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    vector<m2::PointD> points;
+    for (uint32_t j = 0; j < 5; ++j)
+      points.push_back(i < 5 ? m2::PointD(10 * j, 10 * i) : m2::PointD(10 * (i - 5), 10 * j));
+    graph.AddRoad(speeds[i], points);
+  }
+}
+
+// Adds fake edges from |pos| to the |segId|-th segment of the |road|-th road of the grid.
+void AddFakeEdges(HierarchyRoadGraphMock & graph, Junction const & pos, uint32_t road,
+                  uint32_t segId)
+{
+  IRoadGraph::RoadInfo const ri = graph.GetRoadInfo(MakeTestFeatureID(road));
+  Edge const edge(MakeTestFeatureID(road), true /* forward */, segId, ri.m_points[segId],
+                  ri.m_points[segId + 1]);
+  m2::PointD const proj = road < 5 ? m2::PointD(pos.GetPoint().x, ri.m_points[0].y)
+                                   : m2::PointD(ri.m_points[0].x, pos.GetPoint().y);
+  graph.AddFakeEdges(pos, {make_pair(edge, proj)});
+}
 }  // namespace
 
 UNIT_TEST(AStarRouter_Graph2_Simple1)
@@ -266,3 +380,93 @@ UNIT_TEST(AStarRouter_SimpleGraph_PickTheFasterRoad3)
              ());
   TEST_EQUAL(path, vector<Junction>({m2::PointD(2,2), m2::PointD(2,1), m2::PointD(10,1), m2::PointD(10,2)}), ());
 }
+
+UNIT_TEST(ContractionHierarchyRouter_MatchesAStar)
+{
+  classificator::Load();
+
+  HierarchyRoadGraphMock graph;
+  BuildGrid(graph);
+
+  Junction const startPos = m2::PointD(13, 21);
+  Junction const finalPos = m2::PointD(31, 38);
+
+  size_t fallbackCalls = 0;
+  ContractionHierarchyRoutingAlgorithm algorithm(
+      make_unique<CountingRoutingAlgorithm>(fallbackCalls));
+
+  auto const testRoute = [&](size_t expectedFallbackCalls)
+  {
+    RouterDelegate delegate;
+    vector<Junction> expected;
+    TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+               AStarRoutingAlgorithm().CalculateRoute(graph, startPos, finalPos, delegate, expected),
+               ());
+
+    vector<Junction> path;
+    TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+               algorithm.CalculateRoute(graph, startPos, finalPos, delegate, path), ());
+    TEST_EQUAL(startPos, path.front(), ());
+    TEST_EQUAL(finalPos, path.back(), ());
+    TEST_LESS(fabs(GetPathTimeSec(graph, expected) - GetPathTimeSec(graph, path)), 1e-3, (path));
+    TEST_EQUAL(expectedFallbackCalls, fallbackCalls, ());
+  };
+
+  graph.ResetFakes();
+  AddFakeEdges(graph, startPos, 2 /* road */, 1 /* segId */);
+  AddFakeEdges(graph, finalPos, 8 /* road */, 3 /* segId */);
+
+  // There is no hierarchy yet.
+  testRoute(1);
+
+  graph.BuildHierarchy();
+  testRoute(1);
+
+  // Both ends are on the same segment.
+  graph.ResetFakes();
+  Junction const nearPos = m2::PointD(17, 19);
+  AddFakeEdges(graph, startPos, 2 /* road */, 1 /* segId */);
+  AddFakeEdges(graph, nearPos, 2 /* road */, 1 /* segId */);
+
+  RouterDelegate delegate;
+  vector<Junction> path;
+  TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+             algorithm.CalculateRoute(graph, startPos, nearPos, delegate, path), ());
+  TEST_EQUAL(path, vector<Junction>({startPos, m2::PointD(13, 20), m2::PointD(17, 20), nearPos}),
+             ());
+  TEST_EQUAL(1, fallbackCalls, ());
+}
+
+UNIT_TEST(ContractionHierarchyRouter_LeavesMwm)
+{
+  classificator::Load();
+
+  HierarchyRoadGraphMock graph;
+  BuildGrid(graph);
+  // The fastest route goes along the diagonal road of another mwm.
+  graph.AddForeignRoad(5.0 /* speedKMPH */, {m2::PointD(10, 20), m2::PointD(30, 40)});
+  graph.BuildHierarchy();
+
+  Junction const startPos = m2::PointD(13, 21);
+  Junction const finalPos = m2::PointD(31, 38);
+  graph.ResetFakes();
+  AddFakeEdges(graph, startPos, 2 /* road */, 1 /* segId */);
+  AddFakeEdges(graph, finalPos, 8 /* road */, 3 /* segId */);
+
+  RouterDelegate delegate;
+  vector<Junction> expected;
+  TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+             AStarRoutingAlgorithm().CalculateRoute(graph, startPos, finalPos, delegate, expected),
+             ());
+  TEST(find(expected.begin(), expected.end(), Junction(m2::PointD(30, 40))) != expected.end(),
+       (expected));
+
+  size_t fallbackCalls = 0;
+  ContractionHierarchyRoutingAlgorithm algorithm(
+      make_unique<CountingRoutingAlgorithm>(fallbackCalls));
+  vector<Junction> path;
+  TEST_EQUAL(IRoutingAlgorithm::Result::OK,
+             algorithm.CalculateRoute(graph, startPos, finalPos, delegate, path), ());
+  TEST_LESS(fabs(GetPathTimeSec(graph, expected) - GetPathTimeSec(graph, path)), 1e-3, (path));
+  TEST_EQUAL(1, fallbackCalls, ());
+}
@@ -1,6 +1,7 @@
 #include "testing/testing.hpp"
 
 #include "routing/async_router.hpp"
+#include "routing/async_router_pool.hpp"
 #include "routing/router.hpp"
 #include "routing/online_absent_fetcher.hpp"
 
@@ -8,9 +9,12 @@
 
 #include "base/timer.hpp"
 
+#include "std/chrono.hpp"
 #include "std/condition_variable.hpp"
+#include "std/limits.hpp"
 #include "std/mutex.hpp"
 #include "std/string.hpp"
+#include "std/thread.hpp"
 #include "std/vector.hpp"
 
 using namespace routing;
@@ -55,6 +59,56 @@ public:
   void GetAbsentCountries(vector<string> & countries) override { countries = m_absent; }
 };
 
+// Blocks route calculations until the gate is opened.
+struct RouterGate
+{
+  mutex m_lock;
+  condition_variable m_cv;
+  uint32_t m_running = 0;
+  bool m_open = false;
+
+  void Open()
+  {
+    lock_guard<mutex> l(m_lock);
+    m_open = true;
+    m_cv.notify_all();
+  }
+
+  // Waits until the gate is opened or the count of routers running simultaneously
+  // reaches the expected one.
+  bool Wait(uint32_t expectedRunning)
+  {
+    unique_lock<mutex> lk(m_lock);
+    ++m_running;
+    m_cv.notify_all();
+    return m_cv.wait_for(lk, seconds(10), [&]
+    {
+      return m_open || m_running >= expectedRunning;
+    });
+  }
+};
+
+class GateRouter : public IRouter
+{
+  RouterGate & m_gate;
+  uint32_t const m_expectedRunning;
+
+public:
+  GateRouter(RouterGate & gate, uint32_t expectedRunning)
+    : m_gate(gate), m_expectedRunning(expectedRunning)
+  {
+  }
+
+  // IRouter overrides:
+  string GetName() const override { return "Gate"; }
+  ResultCode CalculateRoute(m2::PointD const & startPoint, m2::PointD const & startDirection,
+                            m2::PointD const & finalPoint, RouterDelegate const & delegate,
+                            Route & route) override
+  {
+    return m_gate.Wait(m_expectedRunning) ? ResultCode::NoError : ResultCode::InternalError;
+  }
+};
+
 void DummyStatisticsCallback(map<string, string> const &) {}
 
 struct DummyResultCallback
@@ -70,11 +124,11 @@ struct DummyResultCallback
 
   void operator()(Route & route, ResultCode code)
   {
-    m_codes.push_back(code);
-    auto const & absent = route.GetAbsentCountries();
-    m_absent.emplace_back(absent.begin(), absent.end());
     {
       lock_guard<mutex> calledLock(m_lock);
+      m_codes.push_back(code);
+      auto const & absent = route.GetAbsentCountries();
+      m_absent.emplace_back(absent.begin(), absent.end());
       ++m_called;
       TEST_LESS_OR_EQUAL(m_called, m_expected,
                          ("The result callback called more times than expected."));
@@ -128,4 +182,56 @@ UNIT_TEST(StandartAsyncFogTest)
   TEST_EQUAL(resultCallback.m_absent.size(), 1, ());
   TEST(resultCallback.m_absent[0].empty(), ());
 }
+
+UNIT_TEST(AsyncRouterPoolConcurrentRequestsTest)
+{
+  uint32_t constexpr kWorkersCount = 3;
+  RouterGate gate;
+  DummyResultCallback resultCallback(kWorkersCount /* expectedCalls */);
+  {
+    AsyncRouterPool pool([&gate]()
+    {
+      return unique_ptr<IRouter>(new GateRouter(gate, kWorkersCount));
+    }, kWorkersCount);
+    TEST_EQUAL(pool.GetWorkersCount(), kWorkersCount, ());
+
+    // Each router waits for all the others, so requests must be calculated simultaneously.
+    for (uint32_t i = 0; i < kWorkersCount; ++i)
+    {
+      pool.CalculateRoute({1, 2}, {3, 4}, {5, 6}, bind(ref(resultCallback), _1, _2),
+                          0 /* timeoutSec */);
+    }
+    resultCallback.WaitFinish();
+    TEST_EQUAL(pool.GetQueueDepth(), 0, ());
+  }
+
+  TEST_EQUAL(resultCallback.m_codes, vector<ResultCode>(kWorkersCount, ResultCode::NoError), ());
+}
+
+UNIT_TEST(AsyncRouterPoolDeadlineTest)
+{
+  RouterGate gate;
+  DummyResultCallback resultCallback(2 /* expectedCalls */);
+  {
+    AsyncRouterPool pool([&gate]()
+    {
+      return unique_ptr<IRouter>(new GateRouter(gate, numeric_limits<uint32_t>::max()));
+    }, 1 /* workersCount */);
+
+    pool.CalculateRoute({1, 2}, {3, 4}, {5, 6}, bind(ref(resultCallback), _1, _2),
+                        0 /* timeoutSec */);
+    pool.CalculateRoute({1, 2}, {3, 4}, {5, 6}, bind(ref(resultCallback), _1, _2),
+                        1 /* timeoutSec */);
+    TEST_GREATER_OR_EQUAL(pool.GetMaxQueueDepth(), 1, ());
+
+    // The second request waits for the only worker longer than its deadline.
+    this_thread::sleep_for(milliseconds(1500));
+    gate.Open();
+    resultCallback.WaitFinish();
+  }
+
+  TEST_EQUAL(resultCallback.m_codes.size(), 2, ());
+  TEST_EQUAL(resultCallback.m_codes[0], ResultCode::NoError, ());
+  TEST_EQUAL(resultCallback.m_codes[1], ResultCode::Cancelled, ());
+}
 }  //  namespace
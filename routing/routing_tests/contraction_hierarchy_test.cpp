@@ -0,0 +1,266 @@
+#include "testing/testing.hpp"
+
+#include "routing/contraction_hierarchy.hpp"
+
+#include "indexer/mercator.hpp"
+
+#include "coding/reader.hpp"
+#include "coding/writer.hpp"
+
+#include "std/cmath.hpp"
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/map.hpp"
+#include "std/queue.hpp"
+#include "std/random.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+using namespace routing;
+
+namespace
+{
+double constexpr KMPH2MPS = 1000.0 / (60 * 60);
+
+using TKey = ContractionHierarchy::TKey;
+
+class TestRoads
+{
+public:
+  void AddRoad(m2::PointD const & from, m2::PointD const & to, double speedKMPH,
+               bool bidirectional)
+  {
+    m_builder.AddRoad(static_cast<uint32_t>(m_roads.size()), {from, to}, speedKMPH, bidirectional);
+    m_roads.emplace_back(from, to);
+
+    double const weight = MercatorBounds::DistanceOnEarth(from, to) / (speedKMPH * KMPH2MPS);
+    double const weightSec = round(weight * 1000.0) / 1000.0;
+    TKey const fromKey = ContractionHierarchy::GetKey(from);
+    TKey const toKey = ContractionHierarchy::GetKey(to);
+    AddEdge(fromKey, toKey, weightSec);
+    if (bidirectional)
+      AddEdge(toKey, fromKey, weightSec);
+  }
+
+  // Returns the travel time in seconds, infinity if there is no path.
+  double GetDistance(TKey start, TKey finish) const
+  {
+    using TState = pair<double, TKey>;
+
+    map<TKey, double> distances;
+    priority_queue<TState, vector<TState>, greater<TState>> queue;
+    distances[start] = 0.0;
+    queue.push(make_pair(0.0, start));
+    while (!queue.empty())
+    {
+      TState const state = queue.top();
+      queue.pop();
+      if (state.second == finish)
+        return state.first;
+      if (state.first > distances[state.second])
+        continue;
+
+      auto const it = m_edges.find(state.second);
+      if (it == m_edges.end())
+        continue;
+      for (auto const & edge : it->second)
+      {
+        double const dist = state.first + edge.second;
+        auto const jt = distances.find(edge.first);
+        if (jt == distances.end() || dist < jt->second)
+        {
+          distances[edge.first] = dist;
+          queue.push(make_pair(dist, edge.first));
+        }
+      }
+    }
+    return numeric_limits<double>::infinity();
+  }
+
+  // Returns the travel time of the edge in seconds, infinity if there is no edge.
+  double GetEdgeWeight(TKey from, TKey to) const
+  {
+    auto const it = m_edges.find(from);
+    if (it == m_edges.end())
+      return numeric_limits<double>::infinity();
+    auto const jt = it->second.find(to);
+    return jt == it->second.end() ? numeric_limits<double>::infinity() : jt->second;
+  }
+
+  // Returns the keys of the ends of the segment.
+  pair<TKey, TKey> GetSegmentKeys(ContractionHierarchy::RoadSegment const & segment) const
+  {
+    TEST_LESS(segment.m_featureId, m_roads.size(), ());
+    TEST_EQUAL(0, segment.m_segId, ());
+    auto const & road = m_roads[segment.m_featureId];
+    TKey const from = ContractionHierarchy::GetKey(road.first);
+    TKey const to = ContractionHierarchy::GetKey(road.second);
+    return segment.m_forward ? make_pair(from, to) : make_pair(to, from);
+  }
+
+  ContractionHierarchyBuilder & GetBuilder() { return m_builder; }
+
+private:
+  void AddEdge(TKey from, TKey to, double weight)
+  {
+    auto & edges = m_edges[from];
+    auto const it = edges.find(to);
+    if (it == edges.end() || weight < it->second)
+      edges[to] = weight;
+  }
+
+  ContractionHierarchyBuilder m_builder;
+  map<TKey, map<TKey, double>> m_edges;
+  vector<pair<m2::PointD, m2::PointD>> m_roads;
+};
+
+m2::PointD GetGridPoint(uint32_t x, uint32_t y) { return m2::PointD(x * 0.001, y * 0.001); }
+
+uint32_t GetVertex(ContractionHierarchy const & hierarchy, m2::PointD const & point)
+{
+  uint32_t vertex = ContractionHierarchy::kInvalidVertex;
+  TEST(hierarchy.GetVertex(point, vertex), (point));
+  return vertex;
+}
+}  // namespace
+
+UNIT_TEST(ContractionHierarchy_ShortestPathsOnGrid)
+{
+  uint32_t constexpr kSide = 15;
+
+  TestRoads roads;
+  mt19937 rng(0);
+  uniform_real_distribution<double> speeds(1.0, 5.0);
+  uniform_int_distribution<uint32_t> oneWay(0, 9);
+  for (uint32_t y = 0; y < kSide; ++y)
+  {
+    for (uint32_t x = 0; x + 1 < kSide; ++x)
+    {
+      roads.AddRoad(GetGridPoint(x, y), GetGridPoint(x + 1, y), speeds(rng), oneWay(rng) != 0);
+      roads.AddRoad(GetGridPoint(y, x), GetGridPoint(y, x + 1), speeds(rng), oneWay(rng) != 0);
+    }
+  }
+  // An isolated road.
+  roads.AddRoad(GetGridPoint(kSide + 5, 0), GetGridPoint(kSide + 6, 0), 5.0, true);
+
+  // Roads of other mwms may start at the corner, the other point isn't a vertex.
+  m2::PointD const exit = GetGridPoint(kSide - 1, 0);
+  roads.GetBuilder().AddExit(exit);
+  roads.GetBuilder().AddExit(GetGridPoint(kSide + 1, kSide + 1));
+
+  ContractionHierarchy builtHierarchy;
+  roads.GetBuilder().Build(builtHierarchy);
+  TEST_EQUAL(kSide * kSide + 2, builtHierarchy.GetVerticesCount(), ());
+
+  vector<char> buffer;
+  MemWriter<vector<char>> writer(buffer);
+  builtHierarchy.Serialize(writer);
+
+  ContractionHierarchy hierarchy;
+  MemReader reader(buffer.data(), buffer.size());
+  ReaderSource<MemReader> src(reader);
+  hierarchy.Deserialize(src);
+  TEST_EQUAL(builtHierarchy.GetVerticesCount(), hierarchy.GetVerticesCount(), ());
+  TEST_EQUAL(builtHierarchy.GetArcsCount(), hierarchy.GetArcsCount(), ());
+
+  my::Cancellable cancellable;
+  uniform_int_distribution<uint32_t> coords(0, kSide - 1);
+  for (size_t i = 0; i < 300; ++i)
+  {
+    m2::PointD const from = GetGridPoint(coords(rng), coords(rng));
+    m2::PointD const to = GetGridPoint(coords(rng), coords(rng));
+    uint32_t const source = GetVertex(hierarchy, from);
+    uint32_t const target = GetVertex(hierarchy, to);
+
+    double const expected = roads.GetDistance(ContractionHierarchy::GetKey(from),
+                                              ContractionHierarchy::GetKey(to));
+
+    vector<uint32_t> path;
+    vector<ContractionHierarchy::RoadSegment> segments;
+    double weight;
+    auto const result =
+        hierarchy.FindPath({{source, 0.0}}, {{target, 0.0}}, cancellable, path, segments, weight);
+    if (expected == numeric_limits<double>::infinity())
+    {
+      TEST_EQUAL(ContractionHierarchy::Result::NoPath, result, (from, to));
+      continue;
+    }
+
+    TEST_EQUAL(ContractionHierarchy::Result::OK, result, (from, to));
+    TEST_LESS(fabs(expected - weight), 1e-6, (from, to));
+    TEST_EQUAL(source, path.front(), ());
+    TEST_EQUAL(target, path.back(), ());
+
+    // The path must consist of the original edges, which go along the road segments.
+    TEST_EQUAL(path.size(), segments.size() + 1, ());
+    double pathWeight = 0.0;
+    for (size_t j = 0; j + 1 < path.size(); ++j)
+    {
+      TKey const fromKey = hierarchy.GetVertexKey(path[j]);
+      TKey const toKey = hierarchy.GetVertexKey(path[j + 1]);
+      pathWeight += roads.GetEdgeWeight(fromKey, toKey);
+      TEST_EQUAL(make_pair(fromKey, toKey), roads.GetSegmentKeys(segments[j]), ());
+    }
+    TEST_LESS(fabs(expected - pathWeight), 1e-6, (from, to));
+  }
+
+  // Exit times are lower bounds of the travel times to the exit and back,
+  // the weights of the edges are rounded down for them.
+  TKey const exitKey = ContractionHierarchy::GetKey(exit);
+  double const roundingError = 0.001 * kSide * kSide;
+  for (uint32_t y = 0; y < kSide; ++y)
+  {
+    for (uint32_t x = 0; x < kSide; ++x)
+    {
+      m2::PointD const point = GetGridPoint(x, y);
+      uint32_t const vertex = GetVertex(hierarchy, point);
+      TKey const key = ContractionHierarchy::GetKey(point);
+
+      double const toExit = roads.GetDistance(key, exitKey);
+      double const fromExit = roads.GetDistance(exitKey, key);
+      TEST_LESS_OR_EQUAL(hierarchy.GetExitTime(vertex), toExit, (point));
+      TEST_LESS_OR_EQUAL(hierarchy.GetEntryTime(vertex), fromExit, (point));
+      if (toExit != numeric_limits<double>::infinity())
+        TEST_LESS(toExit - hierarchy.GetExitTime(vertex), roundingError, (point));
+      if (fromExit != numeric_limits<double>::infinity())
+        TEST_LESS(fromExit - hierarchy.GetEntryTime(vertex), roundingError, (point));
+    }
+  }
+  TEST_EQUAL(0.0, hierarchy.GetExitTime(GetVertex(hierarchy, exit)), ());
+  TEST_EQUAL(numeric_limits<double>::infinity(),
+             hierarchy.GetExitTime(GetVertex(hierarchy, GetGridPoint(kSide + 5, 0))), ());
+
+  // Initial travel times are taken into account.
+  {
+    uint32_t const nearSource = GetVertex(hierarchy, GetGridPoint(0, 0));
+    uint32_t const farSource = GetVertex(hierarchy, GetGridPoint(kSide - 1, kSide - 1));
+    uint32_t const target = GetVertex(hierarchy, GetGridPoint(1, 1));
+
+    vector<uint32_t> path;
+    vector<ContractionHierarchy::RoadSegment> segments;
+    double weight;
+    TEST_EQUAL(ContractionHierarchy::Result::OK,
+               hierarchy.FindPath({{nearSource, 1e6}, {farSource, 0.0}}, {{target, 10.0}},
+                                  cancellable, path, segments, weight),
+               ());
+    TEST_EQUAL(farSource, path.front(), ());
+    double const expected = roads.GetDistance(hierarchy.GetVertexKey(farSource),
+                                              hierarchy.GetVertexKey(target));
+    TEST_LESS(fabs(expected + 10.0 - weight), 1e-6, ());
+  }
+
+  // Other connected component.
+  {
+    vector<uint32_t> path;
+    vector<ContractionHierarchy::RoadSegment> segments;
+    double weight;
+    TEST_EQUAL(ContractionHierarchy::Result::NoPath,
+               hierarchy.FindPath({{GetVertex(hierarchy, GetGridPoint(0, 0)), 0.0}},
+                                  {{GetVertex(hierarchy, GetGridPoint(kSide + 5, 0)), 0.0}},
+                                  cancellable, path, segments, weight),
+               ());
+  }
+
+  uint32_t vertex;
+  TEST(!hierarchy.GetVertex(GetGridPoint(kSide + 1, kSide + 1), vertex), ());
+}
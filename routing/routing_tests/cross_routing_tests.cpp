@@ -1,5 +1,6 @@
 #include "testing/testing.hpp"
 
+#include "routing/cross_mwm_overlay.hpp"
 #include "routing/cross_mwm_road_graph.hpp"
 #include "routing/cross_mwm_router.hpp"
 #include "routing/cross_routing_context.hpp"
@@ -102,4 +103,109 @@ UNIT_TEST(TestAdjacencyMatrix)
              routing::INVALID_CONTEXT_EDGE_WEIGHT, ("Default cost"));
 }
 
+// Cross mwm overlay tests.
+UNIT_TEST(TestCrossMwmOverlay)
+{
+  // aMap has ingoing nodes 1 and 2 and outgoing node 3 to bMap.
+  // bMap has ingoing node 4 at the point of node 3 and outgoing node 5 to cMap, which is absent.
+  m2::PointD const border(10.0, 20.0);
+  vector<char> aBuffer, bBuffer;
+  {
+    CrossRoutingContextWriter context;
+    context.AddIngoingNode(1, m2::PointD::Zero());
+    context.AddIngoingNode(2, m2::PointD(1.0, 1.0));
+    context.AddOutgoingNode(3, "bMap", border);
+    context.ReserveAdjacencyMatrix();
+    auto ins = context.GetIngoingIterators();
+    auto outs = context.GetOutgoingIterators();
+    context.SetAdjacencyCost(ins.first, outs.first, 7);
+    MemWriter<vector<char>> writer(aBuffer);
+    context.Save(writer);
+  }
+  {
+    CrossRoutingContextWriter context;
+    context.AddIngoingNode(4, border);
+    context.AddOutgoingNode(5, "cMap", m2::PointD(30.0, 40.0));
+    context.ReserveAdjacencyMatrix();
+    auto ins = context.GetIngoingIterators();
+    auto outs = context.GetOutgoingIterators();
+    context.SetAdjacencyCost(ins.first, outs.first, 11);
+    MemWriter<vector<char>> writer(bBuffer);
+    context.Save(writer);
+  }
+
+  CrossMwmOverlayBuilder builder;
+  {
+    CrossRoutingContextReader aContext, bContext;
+    MemReader aReader(aBuffer.data(), aBuffer.size());
+    aContext.Load(aReader);
+    MemReader bReader(bBuffer.data(), bBuffer.size());
+    bContext.Load(bReader);
+    builder.AddMwm("aMap", 150101, aContext);
+    builder.AddMwm("bMap", 150102, bContext);
+  }
+  CrossMwmOverlay builtOverlay;
+  builder.Build(builtOverlay);
+
+  vector<char> buffer;
+  {
+    MemWriter<vector<char>> writer(buffer);
+    builtOverlay.Serialize(writer);
+  }
+  CrossMwmOverlay overlay;
+  {
+    MemReader reader(buffer.data(), buffer.size());
+    ReaderSource<MemReader> src(reader);
+    overlay.Deserialize(src);
+  }
+
+  TEST_EQUAL(overlay.GetMwmsCount(), 3, ());
+  uint32_t aMwm, bMwm, cMwm;
+  TEST(overlay.GetMwmIndex("aMap", aMwm), ());
+  TEST(overlay.GetMwmIndex("bMap", bMwm), ());
+  TEST(overlay.GetMwmIndex("cMap", cMwm), ());
+  TEST_EQUAL(overlay.GetMwmVersion(aMwm), 150101, ());
+  TEST_EQUAL(overlay.GetMwmVersion(bMwm), 150102, ());
+  TEST_EQUAL(overlay.GetMwmVersion(cMwm), 0, ("cMap has no cross context."));
+  auto const cIngoing = overlay.GetIngoingRange(cMwm);
+  TEST_EQUAL(cIngoing.first, cIngoing.second, ());
+
+  uint32_t ingoing;
+  TEST(overlay.FindIngoing(aMwm, 1, ingoing), ());
+  TEST(!overlay.FindIngoing(aMwm, 4, ingoing), ());
+  vector<pair<uint32_t, WritedEdgeWeightT>> edges;
+  auto const collect = [&edges](uint32_t outgoing, WritedEdgeWeightT weight)
+  {
+    edges.emplace_back(outgoing, weight);
+  };
+  overlay.ForEachEdge(ingoing, collect);
+  TEST_EQUAL(edges.size(), 1, ());
+  uint32_t const aOutgoing = edges[0].first;
+  TEST_EQUAL(edges[0].second, 7, ());
+  TEST_EQUAL(overlay.GetOutgoing(aOutgoing).m_nodeId, 3, ());
+  TEST_EQUAL(overlay.GetNextMwm(aOutgoing), bMwm, ());
+
+  // The outgoing node of aMap is connected to the ingoing node of bMap at the same point.
+  uint32_t const bIngoing = overlay.GetNextIngoing(aOutgoing);
+  TEST_NOT_EQUAL(bIngoing, CrossMwmOverlay::kInvalidIndex, ());
+  TEST_EQUAL(overlay.GetIngoing(bIngoing).m_nodeId, 4, ());
+  TEST_EQUAL(overlay.GetIngoing(bIngoing).m_mwm, bMwm, ());
+  TEST(overlay.GetIngoing(bIngoing).m_point.EqualDxDy(border, 1e-5), ());
+
+  edges.clear();
+  TEST(overlay.FindIngoing(bMwm, 4, ingoing), ());
+  TEST_EQUAL(ingoing, bIngoing, ());
+  overlay.ForEachEdge(ingoing, collect);
+  TEST_EQUAL(edges.size(), 1, ());
+  TEST_EQUAL(edges[0].second, 11, ());
+  TEST_EQUAL(overlay.GetNextMwm(edges[0].first), cMwm, ());
+  TEST_EQUAL(overlay.GetNextIngoing(edges[0].first), CrossMwmOverlay::kInvalidIndex, ());
+
+  // The second ingoing node of aMap has no edges.
+  edges.clear();
+  TEST(overlay.FindIngoing(aMwm, 2, ingoing), ());
+  overlay.ForEachEdge(ingoing, collect);
+  TEST(edges.empty(), ());
+}
+
 }
@@ -0,0 +1,200 @@
+#include "testing/testing.hpp"
+
+#include "routing/landmarks.hpp"
+
+#include "indexer/mercator.hpp"
+#include "indexer/point_to_int64.hpp"
+
+#include "coding/reader.hpp"
+#include "coding/writer.hpp"
+
+#include "std/functional.hpp"
+#include "std/limits.hpp"
+#include "std/map.hpp"
+#include "std/queue.hpp"
+#include "std/random.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+using namespace routing;
+
+namespace
+{
+double constexpr KMPH2MPS = 1000.0 / (60 * 60);
+
+using TKey = LandmarksTable::TKey;
+using TAdjacency = map<TKey, vector<pair<TKey, double>>>;
+
+class TestRoads
+{
+public:
+  void AddRoad(vector<m2::PointD> const & points, double speedKMPH)
+  {
+    m_builder.AddRoad(points, speedKMPH, true /* bidirectional */);
+    for (size_t i = 0; i + 1 < points.size(); ++i)
+    {
+      double const weight =
+          MercatorBounds::DistanceOnEarth(points[i], points[i + 1]) / (speedKMPH * KMPH2MPS);
+      TKey const from = LandmarksTable::GetKey(points[i]);
+      TKey const to = LandmarksTable::GetKey(points[i + 1]);
+      m_adjacency[from].emplace_back(to, weight);
+      m_adjacency[to].emplace_back(from, weight);
+    }
+  }
+
+  double GetDistance(m2::PointD const & from, m2::PointD const & to) const
+  {
+    using TState = pair<double, TKey>;
+
+    TKey const start = LandmarksTable::GetKey(from);
+    TKey const finish = LandmarksTable::GetKey(to);
+
+    map<TKey, double> distances;
+    priority_queue<TState, vector<TState>, greater<TState>> queue;
+    distances[start] = 0.0;
+    queue.push(make_pair(0.0, start));
+    while (!queue.empty())
+    {
+      TState const state = queue.top();
+      queue.pop();
+      if (state.second == finish)
+        return state.first;
+      if (state.first > distances[state.second])
+        continue;
+
+      auto const it = m_adjacency.find(state.second);
+      if (it == m_adjacency.end())
+        continue;
+      for (auto const & edge : it->second)
+      {
+        double const dist = state.first + edge.second;
+        auto const jt = distances.find(edge.first);
+        if (jt == distances.end() || dist < jt->second)
+        {
+          distances[edge.first] = dist;
+          queue.push(make_pair(dist, edge.first));
+        }
+      }
+    }
+    return numeric_limits<double>::infinity();
+  }
+
+  template <typename TFn>
+  void ForEachEdge(TFn && fn) const
+  {
+    for (auto const & adjacency : m_adjacency)
+    {
+      for (auto const & edge : adjacency.second)
+        fn(adjacency.first, edge.first, edge.second);
+    }
+  }
+
+  LandmarksTableBuilder & GetBuilder() { return m_builder; }
+
+private:
+  LandmarksTableBuilder m_builder;
+  TAdjacency m_adjacency;
+};
+
+m2::PointD GetGridPoint(uint32_t x, uint32_t y) { return m2::PointD(x * 0.001, y * 0.001); }
+}  // namespace
+
+UNIT_TEST(Landmarks_LowerBoundsOnGrid)
+{
+  uint32_t constexpr kSide = 12;
+
+  TestRoads roads;
+  mt19937 rng(0);
+  uniform_real_distribution<double> speeds(1.0, 5.0);
+  for (uint32_t y = 0; y < kSide; ++y)
+  {
+    for (uint32_t x = 0; x + 1 < kSide; ++x)
+    {
+      roads.AddRoad({GetGridPoint(x, y), GetGridPoint(x + 1, y)}, speeds(rng));
+      roads.AddRoad({GetGridPoint(y, x), GetGridPoint(y, x + 1)}, speeds(rng));
+    }
+  }
+  // An isolated road.
+  roads.AddRoad({GetGridPoint(kSide + 5, 0), GetGridPoint(kSide + 6, 0)}, 5.0);
+
+  // The right side of the grid is outside of the mwm borders.
+  vector<m2::PointD> exits;
+  for (uint32_t y = 0; y < kSide; ++y)
+  {
+    exits.push_back(GetGridPoint(kSide - 1, y));
+    roads.GetBuilder().AddExit(exits.back());
+  }
+
+  LandmarksTable builtTable;
+  roads.GetBuilder().Build(8 /* landmarksCount */, builtTable);
+  TEST_EQUAL(8, builtTable.GetLandmarksCount(), ());
+  TEST_EQUAL(kSide * kSide + 2, builtTable.GetVerticesCount(), ());
+
+  vector<char> buffer;
+  MemWriter<vector<char>> writer(buffer);
+  builtTable.Serialize(writer);
+
+  LandmarksTable table;
+  MemReader reader(buffer.data(), buffer.size());
+  ReaderSource<MemReader> src(reader);
+  table.Deserialize(src);
+  TEST_EQUAL(builtTable.GetLandmarksCount(), table.GetLandmarksCount(), ());
+  TEST_EQUAL(builtTable.GetVerticesCount(), table.GetVerticesCount(), ());
+
+  auto const getVertex = [&table](m2::PointD const & point)
+  {
+    uint32_t vertex;
+    TEST(table.GetVertex(point, vertex), (point));
+    return vertex;
+  };
+
+  size_t boundsCount = 0;
+  uniform_int_distribution<uint32_t> coords(0, kSide - 1);
+  vector<m2::PointD> targets;
+  for (size_t i = 0; i < 300; ++i)
+  {
+    m2::PointD const from = GetGridPoint(coords(rng), coords(rng));
+    m2::PointD const to = GetGridPoint(coords(rng), coords(rng));
+    targets.push_back(to);
+
+    double const bound = table.GetLowerBound(getVertex(from), getVertex(to));
+    if (bound > 0.0)
+      ++boundsCount;
+    TEST_LESS_OR_EQUAL(bound, roads.GetDistance(from, to), (from, to));
+  }
+  TEST_GREATER(boundsCount, 0, ());
+
+  // The bounds are consistent: bound(v, t) <= weight(v, w) + bound(w, t).
+  targets.resize(20);
+  roads.ForEachEdge([&](TKey from, TKey to, double weight)
+  {
+    uint32_t const v = getVertex(Int64ToPoint(from, POINT_COORD_BITS));
+    uint32_t const w = getVertex(Int64ToPoint(to, POINT_COORD_BITS));
+    for (auto const & target : targets)
+    {
+      uint32_t const t = getVertex(target);
+      TEST_LESS_OR_EQUAL(table.GetLowerBound(v, t), weight + table.GetLowerBound(w, t), ());
+    }
+  });
+
+  for (size_t i = 0; i < 30; ++i)
+  {
+    m2::PointD const point = GetGridPoint(coords(rng), coords(rng));
+    double distance = numeric_limits<double>::infinity();
+    for (auto const & exit : exits)
+      distance = min(distance, roads.GetDistance(point, exit));
+
+    // Every edge weight is rounded down by less than a millisecond.
+    double const exitTime = table.GetExitTime(getVertex(point));
+    TEST_LESS_OR_EQUAL(exitTime, distance, (point));
+    TEST_GREATER(exitTime, distance - 0.001 * 2 * kSide, (point));
+  }
+
+  uint32_t vertex;
+  // Not a vertex.
+  TEST(!table.GetVertex(GetGridPoint(kSide + 1, kSide + 1), vertex), ());
+  // Other connected component.
+  uint32_t const isolated = getVertex(GetGridPoint(kSide + 5, 0));
+  TEST_EQUAL(0.0, table.GetLowerBound(isolated, getVertex(GetGridPoint(0, 0))), ());
+  TEST_EQUAL(numeric_limits<double>::infinity(), table.GetExitTime(isolated), ());
+}
@@ -96,4 +96,27 @@ UNIT_TEST(IndexManagerLockManagementTest)
   manager.Clear();
   TEST_EQUAL(generator.GetNumRefs(), 0, ());
 }
+
+UNIT_TEST(IndexManagerResidentSizeLimitTest)
+{
+  string const fileName("1TestCountry");
+  LocalFileGenerator generator(fileName);
+  RoutingIndexManager manager([&fileName](m2::PointD const & q) { return fileName; },
+                              &generator.GetMwmSet(), 0 /* residentSizeLimit */);
+  {
+    auto testMapping = manager.GetMappingByName(fileName);
+    TEST(testMapping->IsValid(), ());
+    TEST_GREATER_OR_EQUAL(testMapping->GetResidentSize(), sizeof(RoutingMapping), ());
+    TEST_EQUAL(manager.GetResidentSize(), testMapping->GetResidentSize(), ());
+
+    // Referenced mapping is not evicted even if the limit is exceeded.
+    manager.Trim();
+    TEST_EQUAL(generator.GetNumRefs(), 1, ());
+  }
+  TEST_EQUAL(generator.GetNumRefs(), 1, ());
+
+  manager.Trim();
+  TEST_EQUAL(generator.GetNumRefs(), 0, ());
+  TEST_EQUAL(manager.GetResidentSize(), 0, ());
+}
 }  // namespace
@@ -25,8 +25,10 @@ SOURCES += \
   astar_progress_test.cpp \
   astar_router_test.cpp \
   async_router_test.cpp \
+  contraction_hierarchy_test.cpp \
   cross_routing_tests.cpp \
   followed_polyline_test.cpp \
+  landmarks_test.cpp \
   nearest_edge_finder_tests.cpp \
   online_cross_fetcher_test.cpp \
   osrm_router_test.cpp \
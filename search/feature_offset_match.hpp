@@ -1,4 +1,5 @@
 #pragma once
+#include "search/match_features_cache.hpp"
 #include "search/search_common.hpp"
 #include "search/search_query.hpp"
 #include "search/search_query_params.hpp"
@@ -12,8 +13,6 @@
 
 #include "std/algorithm.hpp"
 #include "std/target_os.hpp"
-#include "std/unique_ptr.hpp"
-#include "std/unordered_set.hpp"
 #include "std/utility.hpp"
 #include "std/vector.hpp"
 
@@ -31,50 +30,55 @@ size_t CalcEqualLength(TSrcIter b, TSrcIter e, TCompIter bC, TCompIter eC)
   return count;
 }
 
-inline trie::DefaultIterator * MoveTrieIteratorToString(trie::DefaultIterator const & trieRoot,
-                                                        strings::UniString const & queryS,
-                                                        size_t & symbolsMatched,
-                                                        bool & bFullEdgeMatched)
+// Moves iter from trieRoot to the node of queryS, which may end in the middle of an edge.
+// TIter is MappedIterator or IteratorNode, see coding/trie.hpp.
+// @param[out] edgeRest When it is not null and queryS ends in the middle of an edge,
+// the rest of the edge after queryS is appended to it.
+// @return False if queryS isn't matched.
+template <typename TIter>
+bool MoveTrieIteratorToString(TIter const & trieRoot, strings::UniString const & queryS,
+                              TIter & res, bool & bFullEdgeMatched,
+                              strings::UniString * edgeRest = nullptr)
 {
-  symbolsMatched = 0;
   bFullEdgeMatched = false;
 
-  unique_ptr<trie::DefaultIterator> pIter(trieRoot.Clone());
-
+  TIter iter = trieRoot;
+  size_t symbolsMatched = 0;
   size_t const szQuery = queryS.size();
 
   while (symbolsMatched < szQuery)
   {
     bool bMatched = false;
 
-    ASSERT_LESS(pIter->m_edge.size(), std::numeric_limits<uint32_t>::max(), ());
-    uint32_t const edgeCount = static_cast<uint32_t>(pIter->m_edge.size());
-
-    for (uint32_t i = 0; i < edgeCount; ++i)
+    for (typename TIter::EdgeIterator it(iter); !it.IsEnd(); it.Next())
     {
-      size_t const szEdge = pIter->m_edge[i].m_str.size();
+      auto const & edge = it.GetString();
+      size_t const szEdge = edge.size();
 
-      size_t const count = CalcEqualLength(
-                                        pIter->m_edge[i].m_str.begin(),
-                                        pIter->m_edge[i].m_str.end(),
-                                        queryS.begin() + symbolsMatched,
-                                        queryS.end());
+      size_t const count = CalcEqualLength(edge.begin(), edge.end(),
+                                           queryS.begin() + symbolsMatched, queryS.end());
 
       if ((count > 0) && (count == szEdge || szQuery == count + symbolsMatched))
       {
-        pIter.reset(pIter->GoToEdge(i));
+        if (edgeRest && count != szEdge)
+          edgeRest->append(edge.begin() + count, edge.end());
 
         bFullEdgeMatched = (count == szEdge);
         symbolsMatched += count;
         bMatched = true;
+
+        // |it| refers to |iter|, so it's not used after the assignment.
+        TIter const child = it.GetChild();
+        iter = child;
         break;
       }
     }
 
     if (!bMatched)
-      return NULL;
+      return false;
   }
-  return pIter->Clone();
+  res = iter;
+  return true;
 }
 
 namespace
@@ -96,20 +100,20 @@ namespace
   }
 }
 
-template <typename F>
-void FullMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar const * rootPrefix,
+template <typename TIter, typename F>
+void FullMatchInTrie(TIter const & trieRoot, strings::UniChar const * rootPrefix,
                      size_t rootPrefixSize, strings::UniString s, F & f)
 {
   if (!CheckMatchString(rootPrefix, rootPrefixSize, s))
       return;
 
-  size_t symbolsMatched = 0;
+  TIter iter = trieRoot;
   bool bFullEdgeMatched;
-  unique_ptr<trie::DefaultIterator> const pIter(
-      MoveTrieIteratorToString(trieRoot, s, symbolsMatched, bFullEdgeMatched));
-
-  if (!pIter || (!s.empty() && !bFullEdgeMatched) || symbolsMatched != s.size())
+  if (!MoveTrieIteratorToString(trieRoot, s, iter, bFullEdgeMatched) ||
+      (!s.empty() && !bFullEdgeMatched))
+  {
     return;
+  }
 
 #if defined(OMIM_OS_IPHONE) && !defined(__clang__)
   // Here is the dummy mutex to avoid mysterious iOS GCC-LLVM bug here.
@@ -117,121 +121,216 @@ void FullMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar co
   threads::MutexGuard dummyG(dummyM);
 #endif
 
-  ASSERT_EQUAL ( symbolsMatched, s.size(), () );
-  for (size_t i = 0; i < pIter->m_value.size(); ++i)
-    f(pIter->m_value[i]);
+  iter.ForEachValue([&f](typename TIter::ValueType const & value) { f(value); });
 }
 
-template <typename F>
-void PrefixMatchInTrie(trie::DefaultIterator const & trieRoot, strings::UniChar const * rootPrefix,
+// Nodes of the mapped trie are kept on the stack of values and are not allocated
+// on the heap.
+template <typename TIter, typename F>
+void PrefixMatchInTrie(TIter const & trieRoot, strings::UniChar const * rootPrefix,
                        size_t rootPrefixSize, strings::UniString s, F & f)
 {
   if (!CheckMatchString(rootPrefix, rootPrefixSize, s))
       return;
 
-  using TQueue = vector<trie::DefaultIterator *>;
-  TQueue trieQueue;
+  vector<TIter> trieQueue;
   {
-    size_t symbolsMatched = 0;
+    TIter rootIter = trieRoot;
     bool bFullEdgeMatched;
-    trie::DefaultIterator * pRootIter =
-        MoveTrieIteratorToString(trieRoot, s, symbolsMatched, bFullEdgeMatched);
+    if (!MoveTrieIteratorToString(trieRoot, s, rootIter, bFullEdgeMatched))
+      return;
+    trieQueue.push_back(rootIter);
+  }
 
-    UNUSED_VALUE(symbolsMatched);
-    UNUSED_VALUE(bFullEdgeMatched);
+  while (!trieQueue.empty())
+  {
+    TIter const iter = trieQueue.back();
+    trieQueue.pop_back();
 
-    if (!pRootIter)
-      return;
+    iter.ForEachValue([&f](typename TIter::ValueType const & value) { f(value); });
 
-    trieQueue.push_back(pRootIter);
+    for (typename TIter::EdgeIterator it(iter); !it.IsEnd(); it.Next())
+      trieQueue.push_back(it.GetChild());
   }
+}
+
+// The same as PrefixMatchInTrie above but also passes to f the rest of the matched
+// string after s: f(value, restBegin, restEnd).
+// @return False if nothing is matched only because s is shorter than rootPrefix,
+// i.e. an extension of s may match strings which are not matched by s.
+template <typename TIter, typename F>
+bool PrefixMatchInTrieWithRest(TIter const & trieRoot, strings::UniChar const * rootPrefix,
+                               size_t rootPrefixSize, strings::UniString s, F && f)
+{
+  if (s.size() < rootPrefixSize)
+    return !StartsWith(rootPrefix, rootPrefix + rootPrefixSize, s.begin(), s.end());
+  if (!CheckMatchString(rootPrefix, rootPrefixSize, s))
+    return true;
 
-  // 'f' can throw an exception. So be prepared to delete unprocessed elements.
-  MY_SCOPE_GUARD(doDelete, GetRangeDeletor(trieQueue, DeleteFunctor()));
+  using TNode = pair<TIter, strings::UniString>;
+  vector<TNode> trieQueue;
+  {
+    TIter rootIter = trieRoot;
+    bool bFullEdgeMatched;
+    strings::UniString rest;
+    if (!MoveTrieIteratorToString(trieRoot, s, rootIter, bFullEdgeMatched, &rest))
+      return true;
+    trieQueue.emplace_back(rootIter, move(rest));
+  }
 
   while (!trieQueue.empty())
   {
-    // Next 2 lines don't throw any exceptions while moving
-    // ownership from container to smart pointer.
-    unique_ptr<trie::DefaultIterator> const pIter(trieQueue.back());
+    TNode const node = move(trieQueue.back());
     trieQueue.pop_back();
 
-    for (size_t i = 0; i < pIter->m_value.size(); ++i)
-      f(pIter->m_value[i]);
+    TIter const & iter = node.first;
+    strings::UniString const & rest = node.second;
+    iter.ForEachValue([&f, &rest](typename TIter::ValueType const & value)
+                      {
+                        f(value, rest.begin(), rest.end());
+                      });
 
-    for (size_t i = 0; i < pIter->m_edge.size(); ++i)
-      trieQueue.push_back(pIter->GoToEdge(i));
+    for (typename TIter::EdgeIterator it(iter); !it.IsEnd(); it.Next())
+    {
+      strings::UniString childRest(rest);
+      childRest.append(it.GetString().begin(), it.GetString().end());
+      trieQueue.emplace_back(it.GetChild(), move(childRest));
+    }
   }
+  return true;
 }
 
+// Intersects sets of values found for the query tokens by feature ids.
+// Values of the previous step are kept sorted by feature ids with a bitmap of
+// the ids for membership tests. The buffers are reused between steps, so
+// intersections of the common tokens do not allocate a node per value.
 template <class TFilter>
 class OffsetIntersecter
 {
   using ValueT = trie::ValueReader::ValueType;
 
-  struct HashFn
+  struct LessByFeatureId
   {
-    size_t operator() (ValueT const & v) const
+    bool operator() (ValueT const & v1, ValueT const & v2) const
     {
-      return v.m_featureId;
+      return v1.m_featureId < v2.m_featureId;
     }
   };
-  struct EqualFn
+  struct EqualByFeatureId
   {
     bool operator() (ValueT const & v1, ValueT const & v2) const
     {
-      return (v1.m_featureId == v2.m_featureId);
+      return v1.m_featureId == v2.m_featureId;
     }
   };
 
-  using TSet = unordered_set<ValueT, HashFn, EqualFn>;
+  static uint32_t constexpr kWordBits = 64;
 
   TFilter const & m_filter;
-  unique_ptr<TSet> m_prevSet;
-  unique_ptr<TSet> m_set;
+  bool m_hasPrevStep;
+  // Values of the previous step sorted by feature ids without duplicates.
+  vector<ValueT> m_prevValues;
+  // Bit i is set iff feature i is in m_prevValues.
+  vector<uint64_t> m_prevBits;
+  // Values of the current step in the order they were found, may contain duplicates.
+  vector<ValueT> m_values;
+
+  bool IsInPrevStep(uint32_t featureId) const
+  {
+    size_t const word = featureId / kWordBits;
+    return word < m_prevBits.size() && ((m_prevBits[word] >> (featureId % kWordBits)) & 1) != 0;
+  }
+
+  void ClearPrevBits()
+  {
+    // All bits of the words are from the previous step, so the words are just zeroed.
+    for (auto const & value : m_prevValues)
+      m_prevBits[value.m_featureId / kWordBits] = 0;
+  }
+
+  void SetPrevBits()
+  {
+    if (!m_prevValues.empty())
+    {
+      size_t const wordsCount = m_prevValues.back().m_featureId / kWordBits + 1;
+      if (m_prevBits.size() < wordsCount)
+        m_prevBits.resize(wordsCount, 0);
+    }
+    for (auto const & value : m_prevValues)
+      m_prevBits[value.m_featureId / kWordBits] |= uint64_t(1) << (value.m_featureId % kWordBits);
+  }
 
 public:
-  explicit OffsetIntersecter(TFilter const & filter) : m_filter(filter), m_set(new TSet) {}
+  explicit OffsetIntersecter(TFilter const & filter) : m_filter(filter), m_hasPrevStep(false) {}
 
-  void operator() (ValueT const & v)
+  // @return True if the value is taken by the current step.
+  bool operator() (ValueT const & v)
   {
-    if (m_prevSet && !m_prevSet->count(v))
-      return;
+    if (m_hasPrevStep && !IsInPrevStep(v.m_featureId))
+      return false;
 
     if (!m_filter(v.m_featureId))
-      return;
+      return false;
 
-    m_set->insert(v);
+    m_values.push_back(v);
+    return true;
   }
 
   void NextStep()
   {
-    if (!m_prevSet)
-      m_prevSet.reset(new TSet);
+    ClearPrevBits();
+
+    // The first found value of a feature is kept.
+    m_prevValues.swap(m_values);
+    m_values.clear();
+    stable_sort(m_prevValues.begin(), m_prevValues.end(), LessByFeatureId());
+    m_prevValues.erase(unique(m_prevValues.begin(), m_prevValues.end(), EqualByFeatureId()),
+                       m_prevValues.end());
+    SetPrevBits();
+
+    m_hasPrevStep = true;
+  }
+
+  bool HasPrevStep() const { return m_hasPrevStep; }
 
-    m_prevSet.swap(m_set);
-    m_set->clear();
+  // Values of the last finished step sorted by feature ids.
+  vector<ValueT> const & GetPrevValues() const { return m_prevValues; }
+
+  // Makes values, which are sorted by feature ids without duplicates, the result
+  // of the last finished step, e.g. to continue intersection from a cached step.
+  void SetPrevStep(vector<ValueT> const & values)
+  {
+    ASSERT(is_sorted(values.begin(), values.end(), LessByFeatureId()), ());
+    ClearPrevBits();
+    m_prevValues = values;
+    m_values.clear();
+    SetPrevBits();
+    m_hasPrevStep = true;
   }
 
   template <class ToDo>
   void ForEachResult(ToDo && toDo) const
   {
-    if (!m_prevSet)
+    if (!m_hasPrevStep)
       return;
-    for (auto const & value : *m_prevSet)
+    for (auto const & value : m_prevValues)
       toDo(value);
   }
 };
 }  // namespace search::impl
 
+// Root of the trie of a language: the first symbol of the edge is the language code,
+// the rest of the edge is the prefix of all strings in the root.
+template <typename TIter>
 struct TrieRootPrefix
 {
-  trie::DefaultIterator const & m_root;
+  TIter const & m_root;
   strings::UniChar const * m_prefix;
   size_t m_prefixSize;
 
-  TrieRootPrefix(trie::DefaultIterator const & root,
-                 trie::DefaultIterator::Edge::EdgeStrT const & edge)
+  // |edge| should outlive the prefix.
+  template <typename TEdgeStr>
+  TrieRootPrefix(TIter const & root, TEdgeStr const & edge)
     : m_root(root)
   {
     if (edge.size() == 1)
@@ -282,9 +381,9 @@ private:
 
 // Calls toDo for each feature corresponding to at least one synonym.
 // *NOTE* toDo may be called several times for the same feature.
-template <typename ToDo>
+template <typename TIter, typename ToDo>
 void MatchTokenInTrie(SearchQueryParams::TSynonymsVector const & syns,
-                      TrieRootPrefix const & trieRoot, ToDo && toDo)
+                      TrieRootPrefix<TIter> const & trieRoot, ToDo && toDo)
 {
   for (auto const & syn : syns)
   {
@@ -296,9 +395,9 @@ void MatchTokenInTrie(SearchQueryParams::TSynonymsVector const & syns,
 // Calls toDo for each feature whose tokens contains at least one
 // synonym as a prefix.
 // *NOTE* toDo may be called serveral times for the same feature.
-template <typename ToDo>
+template <typename TIter, typename ToDo>
 void MatchTokenPrefixInTrie(SearchQueryParams::TSynonymsVector const & syns,
-                            TrieRootPrefix const & trieRoot, ToDo && toDo)
+                            TrieRootPrefix<TIter> const & trieRoot, ToDo && toDo)
 {
   for (auto const & syn : syns)
   {
@@ -309,9 +408,9 @@ void MatchTokenPrefixInTrie(SearchQueryParams::TSynonymsVector const & syns,
 
 // Fills holder with features whose names correspond to tokens list up to synonyms.
 // *NOTE* the same feature may be put in the same holder's slot several times.
-template <typename THolder>
+template <typename TIter, typename THolder>
 void MatchTokensInTrie(vector<SearchQueryParams::TSynonymsVector> const & tokens,
-                       TrieRootPrefix const & trieRoot, THolder && holder)
+                       TrieRootPrefix<TIter> const & trieRoot, THolder && holder)
 {
   holder.Resize(tokens.size());
   for (size_t i = 0; i < tokens.size(); ++i)
@@ -324,10 +423,10 @@ void MatchTokensInTrie(vector<SearchQueryParams::TSynonymsVector> const & tokens
 // Fills holder with features whose names correspond to tokens list up to synonyms,
 // also, last holder's slot will be filled with features corresponding to prefixTokens.
 // *NOTE* the same feature may be put in the same holder's slot several times.
-template <typename THolder>
+template <typename TIter, typename THolder>
 void MatchTokensAndPrefixInTrie(vector<SearchQueryParams::TSynonymsVector> const & tokens,
                                 SearchQueryParams::TSynonymsVector const & prefixTokens,
-                                TrieRootPrefix const & trieRoot, THolder && holder)
+                                TrieRootPrefix<TIter> const & trieRoot, THolder && holder)
 {
   MatchTokensInTrie(tokens, trieRoot, holder);
 
@@ -339,27 +438,25 @@ void MatchTokensAndPrefixInTrie(vector<SearchQueryParams::TSynonymsVector> const
 // Fills holder with categories whose description matches to at least one
 // token from a search query.
 // *NOTE* query prefix will be treated as a complete token in the function.
-template <typename THolder>
-bool MatchCategoriesInTrie(SearchQueryParams const & params, trie::DefaultIterator const & trieRoot,
+template <typename TIter, typename THolder>
+bool MatchCategoriesInTrie(SearchQueryParams const & params, TIter const & trieRoot,
                            THolder && holder)
 {
-  ASSERT_LESS(trieRoot.m_edge.size(), numeric_limits<uint32_t>::max(), ());
-  uint32_t const numLangs = static_cast<uint32_t>(trieRoot.m_edge.size());
-  for (uint32_t langIx = 0; langIx < numLangs; ++langIx)
+  for (typename TIter::EdgeIterator it(trieRoot); !it.IsEnd(); it.Next())
   {
-    auto const & edge = trieRoot.m_edge[langIx].m_str;
+    auto const & edge = it.GetString();
     ASSERT_GREATER_OR_EQUAL(edge.size(), 1, ());
     if (edge[0] == search::kCategoriesLang)
     {
-      unique_ptr<trie::DefaultIterator> const catRoot(trieRoot.GoToEdge(langIx));
-      MatchTokensInTrie(params.m_tokens, TrieRootPrefix(*catRoot, edge), holder);
+      TIter const catRoot = it.GetChild();
+      MatchTokensInTrie(params.m_tokens, TrieRootPrefix<TIter>(catRoot, edge), holder);
 
       // Last token's prefix is used as a complete token here, to
       // limit the number of features in the last bucket of a
       // holder. Probably, this is a false optimization.
       holder.Resize(params.m_tokens.size() + 1);
       holder.SwitchTo(params.m_tokens.size());
-      MatchTokenInTrie(params.m_prefixTokens, TrieRootPrefix(*catRoot, edge), holder);
+      MatchTokenInTrie(params.m_prefixTokens, TrieRootPrefix<TIter>(catRoot, edge), holder);
       return true;
     }
   }
@@ -368,21 +465,18 @@ bool MatchCategoriesInTrie(SearchQueryParams const & params, trie::DefaultIterat
 
 // Calls toDo with trie root prefix and language code on each language
 // allowed by params.
-template <typename ToDo>
-void ForEachLangPrefix(SearchQueryParams const & params, trie::DefaultIterator const & trieRoot,
-                       ToDo && toDo)
+template <typename TIter, typename ToDo>
+void ForEachLangPrefix(SearchQueryParams const & params, TIter const & trieRoot, ToDo && toDo)
 {
-  ASSERT_LESS(trieRoot.m_edge.size(), numeric_limits<uint32_t>::max(), ());
-  uint32_t const numLangs = static_cast<uint32_t>(trieRoot.m_edge.size());
-  for (uint32_t langIx = 0; langIx < numLangs; ++langIx)
+  for (typename TIter::EdgeIterator it(trieRoot); !it.IsEnd(); it.Next())
   {
-    auto const & edge = trieRoot.m_edge[langIx].m_str;
+    auto const & edge = it.GetString();
     ASSERT_GREATER_OR_EQUAL(edge.size(), 1, ());
     int8_t const lang = static_cast<int8_t>(edge[0]);
     if (edge[0] < search::kCategoriesLang && params.IsLangExist(lang))
     {
-      unique_ptr<trie::DefaultIterator> const langRoot(trieRoot.GoToEdge(langIx));
-      TrieRootPrefix langPrefix(*langRoot, edge);
+      TIter const langRoot = it.GetChild();
+      TrieRootPrefix<TIter> langPrefix(langRoot, edge);
       toDo(langPrefix, lang);
     }
   }
@@ -390,8 +484,8 @@ void ForEachLangPrefix(SearchQueryParams const & params, trie::DefaultIterator c
 
 // Calls toDo for each feature whose description contains *ALL* tokens from a search query.
 // Each feature will be passed to toDo only once.
-template <typename TFilter, typename ToDo>
-void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator const & trieRoot,
+template <typename TIter, typename TFilter, typename ToDo>
+void MatchFeaturesInTrie(SearchQueryParams const & params, TIter const & trieRoot,
                          TFilter const & filter, ToDo && toDo)
 {
   TrieValuesHolder<TFilter> categoriesHolder(filter);
@@ -400,7 +494,7 @@ void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator
   impl::OffsetIntersecter<TFilter> intersecter(filter);
   for (size_t i = 0; i < params.m_tokens.size(); ++i)
   {
-    ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix & langRoot, int8_t lang)
+    ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix<TIter> & langRoot, int8_t lang)
     {
       MatchTokenInTrie(params.m_tokens[i], langRoot, intersecter);
     });
@@ -410,7 +504,7 @@ void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator
 
   if (!params.m_prefixTokens.empty())
   {
-    ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix & langRoot, int8_t /* lang */)
+    ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix<TIter> & langRoot, int8_t /* lang */)
     {
       MatchTokenPrefixInTrie(params.m_prefixTokens, langRoot, intersecter);
     });
@@ -420,4 +514,85 @@ void MatchFeaturesInTrie(SearchQueryParams const & params, trie::DefaultIterator
 
   intersecter.ForEachResult(forward<ToDo>(toDo));
 }
+
+// The same as MatchFeaturesInTrie above but reuses candidates of the previous query
+// kept in cache and keeps candidates of this query there. The filter should accept
+// the same features as the filter of the previous query.
+// @return True if the cached candidates were reused.
+template <typename TIter, typename TFilter, typename ToDo>
+bool MatchFeaturesInTrie(SearchQueryParams const & params, TIter const & trieRoot,
+                         TFilter const & filter, MatchFeaturesCache & cache, ToDo && toDo)
+{
+  TrieValuesHolder<TFilter> categoriesHolder(filter);
+  CHECK(MatchCategoriesInTrie(params, trieRoot, categoriesHolder), ("Can't find categories."));
+
+  // The cache is updated only when matching is finished, as filter may throw.
+  MatchFeaturesCache next;
+  impl::OffsetIntersecter<TFilter> intersecter(filter);
+
+  bool const hasTokens = cache.HasTokens(params);
+  if (hasTokens)
+  {
+    if (cache.HasTokensStep())
+      intersecter.SetPrevStep(cache.GetTokensValues());
+  }
+  else
+  {
+    for (size_t i = 0; i < params.m_tokens.size(); ++i)
+    {
+      ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix<TIter> & langRoot, int8_t lang)
+      {
+        MatchTokenInTrie(params.m_tokens[i], langRoot, intersecter);
+      });
+      categoriesHolder.ForEachValue(i, intersecter);
+      intersecter.NextStep();
+    }
+  }
+  next.SetTokens(params, intersecter.HasPrevStep(), intersecter.GetPrevValues());
+
+  bool const canNarrowPrefix = hasTokens && cache.CanNarrowPrefix(params);
+  if (!params.m_prefixTokens.empty())
+  {
+    next.StartPrefix(params);
+    auto addValue = [&](uint32_t synonym, MatchFeaturesCache::TValue const & value,
+                        strings::UniChar const * restBegin,
+                        strings::UniChar const * restEnd)
+    {
+      if (intersecter(value))
+        next.AddPrefixValue(synonym, value, restBegin, restEnd);
+    };
+
+    if (canNarrowPrefix)
+    {
+      cache.ForEachPrefixValue(params, addValue);
+    }
+    else
+    {
+      ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix<TIter> & langRoot, int8_t /* lang */)
+      {
+        for (size_t i = 0; i < params.m_prefixTokens.size(); ++i)
+        {
+          auto const & syn = params.m_prefixTokens[i];
+          ASSERT(!syn.empty(), ());
+          bool const canNarrow = impl::PrefixMatchInTrieWithRest(
+              langRoot.m_root, langRoot.m_prefix, langRoot.m_prefixSize, syn,
+              [&](MatchFeaturesCache::TValue const & value,
+                  strings::UniChar const * restBegin,
+                  strings::UniChar const * restEnd)
+              {
+                addValue(static_cast<uint32_t>(i), value, restBegin, restEnd);
+              });
+          if (!canNarrow)
+            next.DisablePrefix();
+        }
+      });
+    }
+    categoriesHolder.ForEachValue(params.m_tokens.size(), intersecter);
+    intersecter.NextStep();
+  }
+
+  intersecter.ForEachResult(forward<ToDo>(toDo));
+  cache.Swap(next);
+  return hasTokens && (params.m_prefixTokens.empty() || canNarrowPrefix);
+}
 }  // namespace search
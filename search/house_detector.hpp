@@ -7,6 +7,7 @@
 
 #include "geometry/point2d.hpp"
 
+#include "std/deque.hpp"
 #include "std/string.hpp"
 #include "std/queue.hpp"
 
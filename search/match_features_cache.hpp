@@ -0,0 +1,224 @@
+#pragma once
+
+#include "search/search_common.hpp"
+#include "search/search_query_params.hpp"
+
+#include "indexer/mwm_set.hpp"
+#include "indexer/search_trie.hpp"
+
+#include "base/assert.hpp"
+#include "base/string_utils.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/cstdint.hpp"
+#include "std/iterator.hpp"
+#include "std/list.hpp"
+#include "std/utility.hpp"
+#include "std/vector.hpp"
+
+namespace search
+{
+/// Candidates found by MatchFeaturesInTrie for the previous query in one mwm.
+/// Autocomplete queries usually differ from the previous one by the last characters
+/// of the prefix, so the next query with the same complete tokens reuses features
+/// matching all of them. If its prefix extends the previous one, features found by
+/// the previous prefix are narrowed instead of walking the trie again.
+class MatchFeaturesCache
+{
+public:
+  using TValue = trie::ValueReader::ValueType;
+
+  /// Maximal number of prefix candidates to keep. The candidates of short prefixes
+  /// in big mwms are not kept, the trie is walked again for them.
+  static size_t constexpr kMaxPrefixValues = 20000;
+  /// Maximal number of features matching the complete tokens to keep. When there are
+  /// more of them nothing is kept.
+  static size_t constexpr kMaxTokensValues = 20000;
+
+  /// Value found by a prefix synonym with the rest of the matched string after it.
+  struct PrefixValue
+  {
+    TValue m_value;
+    uint32_t m_synonym;
+    uint32_t m_restBegin;
+    uint32_t m_restSize;
+  };
+
+  MatchFeaturesCache() : m_isValid(false), m_hasTokensStep(false), m_canNarrowPrefix(false) {}
+
+  void Clear() { MatchFeaturesCache().Swap(*this); }
+
+  void Swap(MatchFeaturesCache & rhs)
+  {
+    swap(m_isValid, rhs.m_isValid);
+    m_tokens.swap(rhs.m_tokens);
+    m_langs.swap(rhs.m_langs);
+    swap(m_hasTokensStep, rhs.m_hasTokensStep);
+    m_tokensValues.swap(rhs.m_tokensValues);
+    m_prefixTokens.swap(rhs.m_prefixTokens);
+    swap(m_canNarrowPrefix, rhs.m_canNarrowPrefix);
+    m_prefixValues.swap(rhs.m_prefixValues);
+    m_restChars.swap(rhs.m_restChars);
+  }
+
+  /// @return True if features matching the complete tokens of params are kept.
+  bool HasTokens(SearchQueryParams const & params) const
+  {
+    return m_isValid && m_tokens == params.m_tokens && m_langs == params.m_langs;
+  }
+
+  /// @return True if every prefix synonym of params extends the kept one.
+  bool CanNarrowPrefix(SearchQueryParams const & params) const
+  {
+    if (!m_canNarrowPrefix || m_prefixTokens.size() != params.m_prefixTokens.size())
+      return false;
+    for (size_t i = 0; i < m_prefixTokens.size(); ++i)
+    {
+      auto const & prev = m_prefixTokens[i];
+      auto const & next = params.m_prefixTokens[i];
+      if (!StartsWith(next.begin(), next.end(), prev.begin(), prev.end()))
+        return false;
+    }
+    return true;
+  }
+
+  /// Calls toDo(synonym, value, restBegin, restEnd) for each kept prefix candidate which
+  /// matches prefix synonyms of params. [restBegin, restEnd) is the rest of the matched
+  /// string after the new synonym.
+  template <typename ToDo>
+  void ForEachPrefixValue(SearchQueryParams const & params, ToDo && toDo) const
+  {
+    ASSERT(CanNarrowPrefix(params), ());
+    for (auto const & v : m_prefixValues)
+    {
+      auto const & prev = m_prefixTokens[v.m_synonym];
+      auto const & next = params.m_prefixTokens[v.m_synonym];
+      size_t const added = next.size() - prev.size();
+      strings::UniChar const * restBegin = m_restChars.data() + v.m_restBegin;
+      strings::UniChar const * restEnd = restBegin + v.m_restSize;
+      if (StartsWith(restBegin, restEnd, next.begin() + prev.size(), next.end()))
+        toDo(v.m_synonym, v.m_value, restBegin + added, restEnd);
+    }
+  }
+
+  /// @name Filling of the cache for the current query.
+  //@{
+  void SetTokens(SearchQueryParams const & params, bool hasTokensStep,
+                 vector<TValue> const & tokensValues)
+  {
+    if (tokensValues.size() > kMaxTokensValues)
+    {
+      Clear();
+      return;
+    }
+    m_isValid = true;
+    m_tokens = params.m_tokens;
+    m_langs = params.m_langs;
+    m_hasTokensStep = hasTokensStep;
+    m_tokensValues = tokensValues;
+  }
+
+  void StartPrefix(SearchQueryParams const & params)
+  {
+    m_prefixTokens = params.m_prefixTokens;
+    // Prefix candidates are reused only with the same tokens.
+    m_canNarrowPrefix = m_isValid;
+  }
+
+  template <typename TIter>
+  void AddPrefixValue(uint32_t synonym, TValue const & value, TIter restBegin, TIter restEnd)
+  {
+    if (!m_canNarrowPrefix)
+      return;
+    if (m_prefixValues.size() == kMaxPrefixValues)
+    {
+      DisablePrefix();
+      return;
+    }
+    PrefixValue v;
+    v.m_value = value;
+    v.m_synonym = synonym;
+    v.m_restBegin = static_cast<uint32_t>(m_restChars.size());
+    v.m_restSize = static_cast<uint32_t>(distance(restBegin, restEnd));
+    m_restChars.insert(m_restChars.end(), restBegin, restEnd);
+    m_prefixValues.push_back(v);
+  }
+
+  /// The next query can't reuse the prefix candidates, e.g. they are too many.
+  void DisablePrefix()
+  {
+    m_canNarrowPrefix = false;
+    vector<PrefixValue>().swap(m_prefixValues);
+    vector<strings::UniChar>().swap(m_restChars);
+  }
+  //@}
+
+  bool HasTokensStep() const { return m_hasTokensStep; }
+  vector<TValue> const & GetTokensValues() const { return m_tokensValues; }
+
+private:
+  bool m_isValid;
+  vector<SearchQueryParams::TSynonymsVector> m_tokens;
+  SearchQueryParams::TLangsSet m_langs;
+
+  // Result of the intersection of features matching the complete tokens.
+  bool m_hasTokensStep;
+  vector<TValue> m_tokensValues;
+
+  SearchQueryParams::TSynonymsVector m_prefixTokens;
+  bool m_canNarrowPrefix;
+  vector<PrefixValue> m_prefixValues;
+  vector<strings::UniChar> m_restChars;
+};
+
+/// MatchFeaturesCache of the recently searched mwms. The least recently used cache
+/// is dropped when there are kMaxMwms of them and one more mwm is searched.
+class MwmMatchFeaturesCaches
+{
+public:
+  static size_t constexpr kMaxMwms = 16;
+
+  /// @return The cache of the mwm, it's created when there is none.
+  MatchFeaturesCache & Get(MwmSet::MwmId const & id)
+  {
+    auto const it = find_if(m_caches.begin(), m_caches.end(),
+                            [&id](TEntry const & entry) { return entry.first == id; });
+    if (it == m_caches.end())
+    {
+      if (m_caches.size() == kMaxMwms)
+        m_caches.pop_back();
+      m_caches.emplace_front(id, MatchFeaturesCache());
+    }
+    else
+    {
+      m_caches.splice(m_caches.begin(), m_caches, it);
+    }
+    return m_caches.front().second;
+  }
+
+  /// Drops the caches of deregistered mwms, ids of which keep their MwmInfo alive.
+  void RemoveDeregistered()
+  {
+    m_caches.remove_if([](TEntry const & entry) { return !entry.first.IsAlive(); });
+  }
+
+  void Clear() { m_caches.clear(); }
+
+  size_t GetSize() const { return m_caches.size(); }
+
+private:
+  using TEntry = pair<MwmSet::MwmId, MatchFeaturesCache>;
+
+  // The most recently used cache is the first one.
+  list<TEntry> m_caches;
+};
+
+/// Hits and misses of MatchFeaturesCache, one per mwm search.
+struct MatchFeaturesCacheStats
+{
+  MatchFeaturesCacheStats() : m_hits(0), m_misses(0) {}
+
+  uint64_t m_hits;
+  uint64_t m_misses;
+};
+}  // namespace search
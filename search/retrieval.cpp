@@ -10,10 +10,15 @@
 #include "coding/reader_wrapper.hpp"
 
 #include "base/logging.hpp"
+#include "base/thread.hpp"
 
 #include "std/algorithm.hpp"
+#include "std/atomic.hpp"
 #include "std/cmath.hpp"
+#include "std/exception.hpp"
 #include "std/limits.hpp"
+#include "std/mutex.hpp"
+#include "std/thread.hpp"
 
 namespace search
 {
@@ -23,29 +28,69 @@ namespace
 // Otherwise, slow path is used.
 uint64_t constexpr kFastPathThreshold = 100;
 
-struct EmptyFilter
+// Period of cancellation checks during a search index walk, in values.
+uint32_t constexpr kCancellationCheckPeriod = 1024;
+
+struct CancelException
 {
-  inline bool operator()(uint32_t /* featureId */) const { return true; }
+};
+
+// Passes all features and aborts the search index walk by
+// CancelException when cancellable is cancelled.
+class CancellableFilter
+{
+public:
+  explicit CancellableFilter(my::Cancellable const & cancellable)
+    : m_cancellable(cancellable), m_counter(0)
+  {
+  }
+
+  bool operator()(uint32_t /* featureId */) const
+  {
+    if (++m_counter % kCancellationCheckPeriod == 0 && m_cancellable.IsCancelled())
+      throw CancelException();
+    return true;
+  }
+
+private:
+  my::Cancellable const & m_cancellable;
+  mutable uint32_t m_counter;
 };
 
 // Retrieves from the search index corresponding to |handle| all
-// features matching to |params|.
-void RetrieveAddressFeatures(MwmSet::MwmHandle const & handle, SearchQueryParams const & params,
-                             vector<uint32_t> & featureIds)
+// features matching to |params|. Returns false when cancelled.
+WARN_UNUSED_RESULT bool RetrieveAddressFeatures(MwmSet::MwmHandle const & handle,
+                                                SearchQueryParams const & params,
+                                                my::Cancellable const & cancellable,
+                                                vector<uint32_t> & featureIds)
 {
   auto * value = handle.GetValue<MwmValue>();
   ASSERT(value, ());
   serial::CodingParams codingParams(trie::GetCodingParams(value->GetHeader().GetDefCodingParams()));
-  ModelReaderPtr searchReader = value->m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
-  unique_ptr<trie::DefaultIterator> const trieRoot(
-      trie::ReadTrie(SubReaderWrapper<Reader>(searchReader.GetPtr()),
-                     trie::ValueReader(codingParams), trie::TEdgeValueReader()));
 
   auto collector = [&](trie::ValueReader::ValueType const & value)
   {
     featureIds.push_back(value.m_featureId);
   };
-  MatchFeaturesInTrie(params, *trieRoot, EmptyFilter(), collector);
+  try
+  {
+    if (trie::MapSearchIndexTrie(*value, codingParams))
+    {
+      MatchFeaturesInTrie(params, value->m_mappedSearchData->m_trie.GetRoot(),
+                          CancellableFilter(cancellable), collector);
+    }
+    else
+    {
+      trie::ValueReader const valueReader(codingParams);
+      trie::DefaultIteratorNode const trieRoot(trie::ReadSearchIndexTrie(*value, valueReader));
+      MatchFeaturesInTrie(params, trieRoot, CancellableFilter(cancellable), collector);
+    }
+  }
+  catch (CancelException const &)
+  {
+    return false;
+  }
+  return true;
 }
 
 // Retrieves from the geomery index corresponding to handle all
@@ -284,7 +329,7 @@ void Retrieval::Init(Index & index, vector<shared_ptr<MwmInfo>> const & infos,
     if (!handle.IsAlive())
       continue;
     auto * value = handle.GetValue<MwmValue>();
-    if (!value || !value->m_cont.IsExist(SEARCH_INDEX_FILE_TAG) ||
+    if (!value || !HasSearchIndex(value->m_cont) ||
         !value->m_cont.IsExist(INDEX_FILE_TAG))
     {
       continue;
@@ -329,6 +374,9 @@ bool Retrieval::RetrieveForScale(double scale, Callback & callback)
   m2::RectD viewport = m_viewport;
   viewport.Scale(scale);
 
+  if (!RetrieveAddressFeaturesForNewBuckets(viewport))
+    return false;
+
   for (auto & bucket : m_buckets)
   {
     if (IsCancelled())
@@ -339,12 +387,9 @@ bool Retrieval::RetrieveForScale(double scale, Callback & callback)
 
     if (!bucket.m_intersectsWithViewport)
     {
-      // This is the first time viewport intersects with mwm. Retrieve
-      // all matching features from the search index.
+      // This is the first time viewport intersects with mwm. All
+      // matching features from the search index are already retrieved.
       ASSERT(!bucket.m_strategy, ());
-      RetrieveAddressFeatures(bucket.m_handle, m_params, bucket.m_addressFeatures);
-      if (IsCancelled())
-        return false;
       if (bucket.m_addressFeatures.size() < kFastPathThreshold)
       {
         bucket.m_strategy.reset(
@@ -379,6 +424,65 @@ bool Retrieval::RetrieveForScale(double scale, Callback & callback)
   return true;
 }
 
+bool Retrieval::RetrieveAddressFeaturesForNewBuckets(m2::RectD const & viewport)
+{
+  vector<Bucket *> buckets;
+  for (auto & bucket : m_buckets)
+  {
+    if (!bucket.m_finished && !bucket.m_intersectsWithViewport &&
+        viewport.IsIntersect(bucket.m_bounds))
+    {
+      buckets.push_back(&bucket);
+    }
+  }
+
+  // Each worker walks search indices of its own buckets, so the
+  // buckets are not shared between threads. The first exception of
+  // the workers, e.g. a reader error, stops them and is rethrown on
+  // the calling thread when all the workers are joined.
+  atomic<size_t> nextBucket(0);
+  atomic<bool> failed(false);
+  mutex errorMutex;
+  exception_ptr error;
+  auto const retrieve = [&]()
+  {
+    try
+    {
+      for (size_t i = nextBucket++; i < buckets.size() && !failed; i = nextBucket++)
+      {
+        if (IsCancelled())
+          return;
+        Bucket & bucket = *buckets[i];
+        if (!RetrieveAddressFeatures(bucket.m_handle, m_params, *this /* cancellable */,
+                                     bucket.m_addressFeatures))
+        {
+          return;
+        }
+      }
+    }
+    catch (...)
+    {
+      lock_guard<mutex> lock(errorMutex);
+      if (!error)
+        error = current_exception();
+      failed = true;
+    }
+  };
+
+  size_t const threadsCount =
+      min(buckets.size(), static_cast<size_t>(max(thread::hardware_concurrency(), 1U)));
+  vector<threads::SimpleThread> workers;
+  for (size_t i = 1; i < threadsCount; ++i)
+    workers.emplace_back(retrieve);
+  retrieve();
+  for (auto & worker : workers)
+    worker.join();
+
+  if (error)
+    rethrow_exception(error);
+  return !IsCancelled();
+}
+
 bool Retrieval::Finished() const
 {
   for (auto const & bucket : m_buckets)
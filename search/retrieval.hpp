@@ -27,7 +27,8 @@ public:
 
     // Called each time a bunch of features for an mwm is retrieved.
     // This method may be called several times for the same mwm,
-    // reporting disjoint sets of features.
+    // reporting disjoint sets of features. It is always called on the
+    // thread which runs Go(), in the order of mwms passed to Init().
     virtual void OnFeaturesRetrieved(MwmSet::MwmId const & id, double scale,
                                      vector<uint32_t> const & featureIds) = 0;
   };
@@ -131,6 +132,13 @@ private:
   // non-decreasing.
   WARN_UNUSED_RESULT bool RetrieveForScale(double scale, Callback & callback);
 
+  // Retrieves all matching features from the search indices of the
+  // buckets which are intersected by |viewport| for the first time.
+  // Search indices of different mwms are walked in parallel. Returns
+  // false when cancelled. Exceptions of the walks, e.g. reader errors,
+  // are rethrown on the calling thread.
+  WARN_UNUSED_RESULT bool RetrieveAddressFeaturesForNewBuckets(m2::RectD const & viewport);
+
   // Returns true when all buckets are marked as finished.
   bool Finished() const;
 
@@ -20,6 +20,7 @@ HEADERS += \
     keyword_matcher.hpp \
     latlon_match.hpp \
     locality_finder.hpp \
+    match_features_cache.hpp \
     params.hpp \
     query_saver.hpp \
     result.hpp \
@@ -163,6 +163,20 @@ void Engine::EmitResults(SearchParams const & params, Results & res)
   params.m_callback(res);
 }
 
+void Engine::LogMatchCacheStats(MatchFeaturesCacheStats const & prevStats)
+{
+  MatchFeaturesCacheStats const & stats = m_pQuery->GetMatchCacheStats();
+  uint64_t const hits = stats.m_hits - prevStats.m_hits;
+  uint64_t const misses = stats.m_misses - prevStats.m_misses;
+  if (hits == 0 && misses == 0)
+    return;
+
+  LOG(LDEBUG, ("Features matching cache hits:", hits, "misses:", misses));
+  alohalytics::LogEvent("searchMatchCache",
+                        alohalytics::TStringMap({{"hits", strings::to_string(hits)},
+                                                 {"misses", strings::to_string(misses)}}));
+}
+
 void Engine::SetRankPivot(SearchParams const & params,
                           m2::RectD const & viewport, bool viewportSearch)
 {
@@ -223,6 +237,7 @@ void Engine::SearchAsync()
   m_pQuery->SetQuery(params.m_query);
 
   Results res;
+  MatchFeaturesCacheStats const cacheStats = m_pQuery->GetMatchCacheStats();
 
   // Call m_pQuery->IsCanceled() everywhere it needed without storing return value.
   // This flag can be changed from another thread.
@@ -284,6 +299,8 @@ void Engine::SearchAsync()
       EmitResults(params, res);
   }
 
+  LogMatchCacheStats(cacheStats);
+
   // Emit finish marker to client.
   params.m_callback(Results::GetEndMarker(m_pQuery->IsCancelled()));
 }
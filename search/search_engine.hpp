@@ -22,6 +22,7 @@ namespace search
 {
 
 class Query;
+struct MatchFeaturesCacheStats;
 
 class EngineData;
 
@@ -69,6 +70,8 @@ private:
   void SearchAsync();
 
   void EmitResults(SearchParams const & params, Results & res);
+  /// Reports hits and misses of the features matching cache since prevStats.
+  void LogMatchCacheStats(MatchFeaturesCacheStats const & prevStats);
 
   threads::Mutex m_searchMutex, m_updateMutex;
   atomic_flag m_isReadyThread;
@@ -14,9 +14,15 @@
 #include "platform/local_country_file.hpp"
 #include "platform/platform.hpp"
 
+#include "coding/file_writer.hpp"
+#include "coding/reader.hpp"
+
 #include "base/scope_guard.hpp"
 #include "base/string_utils.hpp"
 
+#include "std/algorithm.hpp"
+#include "std/thread.hpp"
+
 namespace
 {
 void InitParams(string const & query, search::SearchQueryParams & params)
@@ -247,3 +253,90 @@ UNIT_TEST(Retrieval_3Mwms)
     TEST_EQUAL(3, callback.GetNumFeatures(), ());
   }
 }
+
+// Search indices of mwms are walked by several threads, so there are more mwms
+// than threads to check that every mwm is retrieved once and errors are passed
+// to the calling thread.
+UNIT_TEST(Retrieval_MoreMwmsThanThreads)
+{
+  classificator::Load();
+  Platform & platform = GetPlatform();
+
+  size_t const mwmsCount = max(thread::hardware_concurrency(), 1U) + 3;
+  size_t const featuresCount = 1000;
+
+  vector<platform::LocalCountryFile> files;
+  for (size_t i = 0; i < mwmsCount; ++i)
+  {
+    files.emplace_back(platform.WritableDir(),
+                       platform::CountryFile("CafeTown" + strings::to_string(i)), 0);
+  }
+  MY_SCOPE_GUARD(deleteFiles, [&]()
+  {
+    for (auto & file : files)
+      file.DeleteFromDisk(MapOptions::Map);
+  });
+
+  for (size_t i = 0; i < mwmsCount; ++i)
+  {
+    TestMwmBuilder builder(files[i]);
+    for (size_t j = 0; j < featuresCount; ++j)
+      builder.AddPOI(m2::PointD(i, j % 10), "Cafe " + strings::to_string(j), "en");
+  }
+
+  search::SearchQueryParams params;
+  InitParams("cafe", params);
+  m2::RectD const viewport(m2::PointD(-1.0, -1.0), m2::PointD(mwmsCount, 10.0));
+
+  // Every index keeps its own mwm values, so the search indices are read anew.
+  auto const registerMaps = [&](Index & index, vector<MwmSet::MwmId> & ids)
+  {
+    for (auto const & file : files)
+    {
+      auto const p = index.RegisterMap(file);
+      TEST_EQUAL(p.second, MwmSet::RegResult::Success, ());
+      ids.push_back(p.first);
+    }
+  };
+
+  {
+    Index index;
+    vector<MwmSet::MwmId> ids;
+    registerMaps(index, ids);
+    vector<shared_ptr<MwmInfo>> infos;
+    index.GetMwmsInfo(infos);
+
+    MultiMwmCallback callback(ids);
+    search::Retrieval retrieval;
+    retrieval.Init(index, infos, viewport, params, search::Retrieval::Limits());
+    retrieval.Go(callback);
+    TEST_EQUAL(mwmsCount, callback.GetNumMwms(), ());
+    TEST_EQUAL(mwmsCount * featuresCount, callback.GetNumFeatures(), ());
+  }
+
+  {
+    Index index;
+    vector<MwmSet::MwmId> ids;
+    registerMaps(index, ids);
+    vector<shared_ptr<MwmInfo>> infos;
+    index.GetMwmsInfo(infos);
+
+    MultiMwmCallback callback(ids);
+    search::Retrieval retrieval;
+    retrieval.Init(index, infos, viewport, params, search::Retrieval::Limits());
+
+    // The mwm is already open, so its search index is read from the truncated file.
+    FileWriter(files.back().GetPath(MapOptions::Map), FileWriter::OP_WRITE_TRUNCATE);
+
+    bool thrown = false;
+    try
+    {
+      retrieval.Go(callback);
+    }
+    catch (Reader::Exception const &)
+    {
+      thrown = true;
+    }
+    TEST(thrown, ());
+  }
+}
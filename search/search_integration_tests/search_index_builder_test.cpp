@@ -0,0 +1,79 @@
+#include "testing/testing.hpp"
+
+#include "indexer/classificator_loader.hpp"
+#include "indexer/search_index_builder.hpp"
+
+#include "search/search_integration_tests/test_mwm_builder.hpp"
+
+#include "platform/local_country_file.hpp"
+#include "platform/platform.hpp"
+
+#include "coding/file_container.hpp"
+
+#include "base/scope_guard.hpp"
+#include "base/string_utils.hpp"
+
+#include "defines.hpp"
+
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+vector<char> ReadSection(string const & path, string const & tag)
+{
+  FilesContainerR cont(path);
+  ModelReaderPtr reader = cont.GetReader(tag);
+  vector<char> data(static_cast<size_t>(reader.Size()));
+  reader.Read(0, data.data(), data.size());
+  return data;
+}
+}  // namespace
+
+// Features are split between shards by blocks, so the index is built by several shards
+// only from several blocks of features.
+UNIT_TEST(BuildSearchIndex_ShardsGiveTheSameIndex)
+{
+  classificator::Load();
+  Platform & platform = GetPlatform();
+
+  platform::LocalCountryFile file(platform.WritableDir(), platform::CountryFile("ShardsTown"), 0);
+  MY_SCOPE_GUARD(deleteFile, [&]()
+  {
+    file.DeleteFromDisk(MapOptions::Map);
+  });
+
+  {
+    TestMwmBuilder builder(file);
+    for (int i = 0; i < 5000; ++i)
+    {
+      builder.AddPOI(m2::PointD(i % 100, i / 100),
+                     "Station " + strings::to_string(i % 1300) + " line " +
+                         strings::to_string(i % 7),
+                     "en");
+    }
+  }
+  TEST_EQUAL(MapOptions::Map, file.GetFiles(), ());
+  string const path = file.GetPath(MapOptions::Map);
+
+  for (auto const format : {indexer::SearchIndexFormat::Trie, indexer::SearchIndexFormat::Succinct})
+  {
+    string const tag = (format == indexer::SearchIndexFormat::Trie)
+                           ? SEARCH_INDEX_FILE_TAG
+                           : SUCCINCT_SEARCH_INDEX_FILE_TAG;
+
+    TEST(indexer::BuildSearchIndexFromDatFile(path, true /* forceRebuild */, 1 /* threadsCount */,
+                                              format),
+         ());
+    vector<char> const expected = ReadSection(path, tag);
+    TEST(!expected.empty(), ());
+
+    for (uint32_t threadsCount : {2, 3, 8})
+    {
+      TEST(indexer::BuildSearchIndexFromDatFile(path, true /* forceRebuild */, threadsCount,
+                                                format),
+           ());
+      TEST(expected == ReadSection(path, tag), (tag, threadsCount));
+    }
+  }
+}
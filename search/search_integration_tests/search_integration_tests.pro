@@ -7,7 +7,7 @@ TEMPLATE = app
 
 ROOT_DIR = ../..
 DEPENDENCIES = generator routing search storage stats_client jansson indexer platform geometry coding base \
-               tess2 protobuf tomcrypt
+               tess2 protobuf tomcrypt succinct
 
 !linux* {
   DEPENDENCIES += opening_hours \
@@ -23,6 +23,7 @@ macx-*: LIBS *= "-framework IOKit"
 SOURCES += \
     ../../testing/testingmain.cpp \
     retrieval_test.cpp \
+    search_index_builder_test.cpp \
     smoke_test.cpp \
     test_mwm_builder.cpp \
     test_search_engine.cpp \
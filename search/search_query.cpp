@@ -169,6 +169,7 @@ void Query::SetViewportByIndex(TMWMVector const & mwmsInfo, m2::RectD const & vi
 
     m_viewport[idx] = viewport;
     UpdateViewportOffsets(mwmsInfo, viewport, m_offsetsInViewport[idx]);
+    m_matchCache[idx + 1].Clear();
 
 #ifdef FIND_LOCALITY_TEST
     m_locality.SetViewportByIndex(viewport, idx);
@@ -236,6 +237,9 @@ void Query::ClearCaches()
   m_houseDetector.ClearCaches();
 
   m_locality.ClearCacheAll();
+
+  for (auto & caches : m_matchCache)
+    caches.Clear();
 }
 
 void Query::ClearCache(size_t ind)
@@ -243,6 +247,7 @@ void Query::ClearCache(size_t ind)
   // clear cache and free memory
   TOffsetsVector emptyV;
   emptyV.swap(m_offsetsInViewport[ind]);
+  m_matchCache[ind + 1].Clear();
 
   m_viewport[ind].MakeEmpty();
 }
@@ -1461,7 +1466,7 @@ void Query::SearchAddress(Results & res)
     MwmSet::MwmId mwmId(info);
     Index::MwmHandle const mwmHandle = m_pIndex->GetMwmHandleById(mwmId);
     MwmValue const * pMwm = mwmHandle.GetValue<MwmValue>();
-    if (pMwm && pMwm->m_cont.IsExist(SEARCH_INDEX_FILE_TAG) &&
+    if (pMwm && HasSearchIndex(pMwm->m_cont) &&
         pMwm->GetHeader().GetType() == TFHeader::world)
     {
       impl::Locality city;
@@ -1751,14 +1756,23 @@ void Query::SearchLocality(MwmValue const * pMwm, impl::Locality & res1, impl::R
   InitParams(true /* localitySearch */, params);
 
   serial::CodingParams cp(trie::GetCodingParams(pMwm->GetHeader().GetDefCodingParams()));
+  if (trie::MapSearchIndexTrie(*pMwm, cp))
+  {
+    SearchLocality(pMwm, pMwm->m_mappedSearchData->m_trie.GetRoot(), params, res1, res2);
+    return;
+  }
 
-  ModelReaderPtr searchReader = pMwm->m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
-
-  unique_ptr<trie::DefaultIterator> const trieRoot(
-      trie::ReadTrie(SubReaderWrapper<Reader>(searchReader.GetPtr()), trie::ValueReader(cp),
-                     trie::TEdgeValueReader()));
+  trie::ValueReader const valueReader(cp);
+  trie::DefaultIteratorNode const trieRoot(trie::ReadSearchIndexTrie(*pMwm, valueReader));
+  SearchLocality(pMwm, trieRoot, params, res1, res2);
+}
 
-  ForEachLangPrefix(params, *trieRoot, [&](TrieRootPrefix & langRoot, int8_t lang)
+template <class TIter>
+void Query::SearchLocality(MwmValue const * pMwm, TIter const & trieRoot,
+                           SearchQueryParams const & params, impl::Locality & res1,
+                           impl::Region & res2)
+{
+  ForEachLangPrefix(params, trieRoot, [&](TrieRootPrefix<TIter> & langRoot, int8_t lang)
   {
     impl::DoFindLocality doFind(*this, pMwm, lang);
     MatchTokensInTrie(params.m_tokens, langRoot, doFind);
@@ -1851,7 +1865,7 @@ void Query::SearchInMWM(Index::MwmHandle const & mwmHandle, SearchQueryParams co
                         ViewportID viewportId /*= DEFAULT_V*/)
 {
   MwmValue const * const value = mwmHandle.GetValue<MwmValue>();
-  if (!value || !value->m_cont.IsExist(SEARCH_INDEX_FILE_TAG))
+  if (!value || !HasSearchIndex(value->m_cont))
     return;
 
   TFHeader const & header = value->GetHeader();
@@ -1861,17 +1875,34 @@ void Query::SearchInMWM(Index::MwmHandle const & mwmHandle, SearchQueryParams co
     return;
 
   serial::CodingParams cp(trie::GetCodingParams(header.GetDefCodingParams()));
-  ModelReaderPtr searchReader = value->m_cont.GetReader(SEARCH_INDEX_FILE_TAG);
-  unique_ptr<trie::DefaultIterator> const trieRoot(
-      trie::ReadTrie(SubReaderWrapper<Reader>(searchReader.GetPtr()), trie::ValueReader(cp),
-                     trie::TEdgeValueReader()));
   MwmSet::MwmId const mwmId = mwmHandle.GetId();
+  ViewportID const filterViewportId = isWorld ? DEFAULT_V : viewportId;
   FeaturesFilter filter(
-      (viewportId == DEFAULT_V || isWorld) ? 0 : &m_offsetsInViewport[viewportId][mwmId], *this);
-  MatchFeaturesInTrie(params, *trieRoot, filter, [&](TTrieValue const & value)
+      filterViewportId == DEFAULT_V ? 0 : &m_offsetsInViewport[filterViewportId][mwmId], *this);
+  for (auto & caches : m_matchCache)
+    caches.RemoveDeregistered();
+  MatchFeaturesCache & cache = m_matchCache[filterViewportId + 1].Get(mwmId);
+  auto addResult = [&](TTrieValue const & value)
   {
     AddResultFromTrie(value, mwmId, viewportId);
-  });
+  };
+
+  bool isHit;
+  if (trie::MapSearchIndexTrie(*value, cp))
+  {
+    isHit = MatchFeaturesInTrie(params, value->m_mappedSearchData->m_trie.GetRoot(), filter,
+                                cache, addResult);
+  }
+  else
+  {
+    trie::ValueReader const valueReader(cp);
+    trie::DefaultIteratorNode const trieRoot(trie::ReadSearchIndexTrie(*value, valueReader));
+    isHit = MatchFeaturesInTrie(params, trieRoot, filter, cache, addResult);
+  }
+  if (isHit)
+    ++m_matchCacheStats.m_hits;
+  else
+    ++m_matchCacheStats.m_misses;
 }
 
 void Query::SuggestStrings(Results & res)
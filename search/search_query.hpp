@@ -1,6 +1,7 @@
 #pragma once
 #include "intermediate_result.hpp"
 #include "keyword_lang_matcher.hpp"
+#include "match_features_cache.hpp"
 
 #include "indexer/ftypes_matcher.hpp"
 #include "indexer/search_trie.hpp"
@@ -109,6 +110,9 @@ public:
 
   void ClearCaches();
 
+  /// @return Hits and misses of the features matching cache since the query creation.
+  MatchFeaturesCacheStats const & GetMatchCacheStats() const { return m_matchCacheStats; }
+
   struct CancelException {};
 
   /// @name This stuff is public for implementation classes in search_query.cpp
@@ -167,6 +171,11 @@ private:
   /// @param[out] res1  Best city-locality
   /// @param[out] res2  Best region-locality
   void SearchLocality(MwmValue const * pMwm, impl::Locality & res1, impl::Region & res2);
+  /// The same as above but walks the search index trie from trieRoot.
+  template <class TIter>
+  void SearchLocality(MwmValue const * pMwm, TIter const & trieRoot,
+                      SearchQueryParams const & params, impl::Locality & res1,
+                      impl::Region & res2);
 
   void SearchFeatures();
 
@@ -230,6 +239,11 @@ private:
   TOffsetsVector m_offsetsInViewport[COUNT_V];
   bool m_supportOldFormat;
 
+  /// Candidates of the previous query in recently searched mwms for DEFAULT_V (index 0)
+  /// and each viewport (index vID + 1). Are dropped when features in viewport are recached.
+  MwmMatchFeaturesCaches m_matchCache[COUNT_V + 1];
+  MatchFeaturesCacheStats m_matchCacheStats;
+
   template <class TParam>
   class TCompare
   {
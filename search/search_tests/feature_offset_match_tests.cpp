@@ -0,0 +1,333 @@
+#include "testing/testing.hpp"
+
+#include "search/feature_offset_match.hpp"
+
+#include "coding/byte_stream.hpp"
+#include "coding/reader.hpp"
+#include "coding/trie_builder.hpp"
+
+#include "base/string_utils.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/string.hpp"
+#include "std/vector.hpp"
+
+using search::impl::OffsetIntersecter;
+
+namespace
+{
+using TValue = trie::ValueReader::ValueType;
+
+TValue MakeValue(uint32_t featureId, uint8_t rank = 0)
+{
+  TValue value;
+  value.m_pt = m2::PointD(featureId, featureId);
+  value.m_featureId = featureId;
+  value.m_rank = rank;
+  return value;
+}
+
+struct OddFeaturesFilter
+{
+  bool operator()(uint32_t featureId) const { return featureId % 2 == 1; }
+};
+
+serial::CodingParams const & GetTestCodingParams()
+{
+  static serial::CodingParams const cp(search::kPointCodingBits, m2::PointD(0, 0));
+  return cp;
+}
+
+struct TrieEntry
+{
+  strings::UniString m_key;
+  TValue m_value;
+
+  TrieEntry() = default;
+  TrieEntry(string const & key, uint32_t featureId)
+    : m_key(strings::MakeUniString(key)), m_value(MakeValue(featureId))
+  {
+  }
+  TrieEntry(uint8_t lang, string const & key, uint32_t featureId)
+    : m_key(1, lang), m_value(MakeValue(featureId))
+  {
+    strings::UniString const s = strings::MakeUniString(key);
+    m_key.append(s.begin(), s.end());
+  }
+
+  uint32_t GetKeySize() const { return m_key.size(); }
+  trie::TrieChar const * GetKeyData() const { return m_key.data(); }
+  TValue const & GetValue() const { return m_value; }
+  void const * value_data() const { return &m_value.m_featureId; }
+  size_t value_size() const { return sizeof(m_value.m_featureId); }
+
+  void Swap(TrieEntry & rhs)
+  {
+    m_key.swap(rhs.m_key);
+    swap(m_value, rhs.m_value);
+  }
+
+  bool operator<(TrieEntry const & rhs) const
+  {
+    if (m_key != rhs.m_key)
+      return m_key < rhs.m_key;
+    return m_value.m_featureId < rhs.m_value.m_featureId;
+  }
+  bool operator==(TrieEntry const & rhs) const
+  {
+    return m_key == rhs.m_key && m_value.m_featureId == rhs.m_value.m_featureId;
+  }
+};
+
+class TrieValueList
+{
+public:
+  void Append(TValue const & value) { m_values.push_back(value); }
+  uint32_t size() const { return m_values.size(); }
+  bool empty() const { return m_values.empty(); }
+
+  template <typename TSink>
+  void Dump(TSink & sink) const
+  {
+    trie::ValueReader const reader(GetTestCodingParams());
+    for (auto const & value : m_values)
+      reader.Save(sink, value);
+  }
+
+private:
+  vector<TValue> m_values;
+};
+
+struct FeatureIdsCollector
+{
+  vector<uint32_t> m_ids;
+
+  void operator()(TValue const & value) { m_ids.push_back(value.m_featureId); }
+};
+
+template <typename TIter>
+vector<uint8_t> BuildTrie(TIter beg, TIter end)
+{
+  vector<uint8_t> serial;
+  PushBackByteSink<vector<uint8_t>> sink(serial);
+  trie::Build<PushBackByteSink<vector<uint8_t>>, TIter, trie::EmptyEdgeBuilder, TrieValueList>(
+      sink, beg, end, trie::EmptyEdgeBuilder());
+  reverse(serial.begin(), serial.end());
+  return serial;
+}
+
+template <class TFilter>
+vector<TValue> GetResults(OffsetIntersecter<TFilter> const & intersecter)
+{
+  vector<TValue> results;
+  intersecter.ForEachResult([&results](TValue const & value) { results.push_back(value); });
+  return results;
+}
+
+template <class TFilter>
+vector<uint32_t> GetResultIds(OffsetIntersecter<TFilter> const & intersecter)
+{
+  vector<uint32_t> ids;
+  for (auto const & value : GetResults(intersecter))
+    ids.push_back(value.m_featureId);
+  return ids;
+}
+}  // namespace
+
+UNIT_TEST(OffsetIntersecter_Smoke)
+{
+  OddFeaturesFilter const filter;
+  OffsetIntersecter<OddFeaturesFilter> intersecter(filter);
+  TEST(GetResults(intersecter).empty(), ());
+
+  for (uint32_t id : {1001, 3, 7, 5, 3, 8, 129})
+    intersecter(MakeValue(id));
+  intersecter.NextStep();
+  TEST_EQUAL(GetResultIds(intersecter), vector<uint32_t>({3, 5, 7, 129, 1001}), ());
+
+  for (uint32_t id : {9, 1001, 5, 129, 64, 1001})
+    intersecter(MakeValue(id));
+  intersecter.NextStep();
+  TEST_EQUAL(GetResultIds(intersecter), vector<uint32_t>({5, 129, 1001}), ());
+
+  // Features of the previous steps, which are not found by the current one, are dropped.
+  intersecter(MakeValue(3));
+  intersecter(MakeValue(129));
+  intersecter.NextStep();
+  TEST_EQUAL(GetResultIds(intersecter), vector<uint32_t>({129}), ());
+
+  intersecter.NextStep();
+  TEST(GetResults(intersecter).empty(), ());
+
+  intersecter(MakeValue(129));
+  intersecter.NextStep();
+  TEST(GetResults(intersecter).empty(), ());
+}
+
+UNIT_TEST(OffsetIntersecter_KeepsFirstValue)
+{
+  OddFeaturesFilter const filter;
+  OffsetIntersecter<OddFeaturesFilter> intersecter(filter);
+
+  intersecter(MakeValue(7, 1 /* rank */));
+  intersecter(MakeValue(7, 2 /* rank */));
+  intersecter(MakeValue(5, 3 /* rank */));
+  intersecter.NextStep();
+
+  auto const results = GetResults(intersecter);
+  TEST_EQUAL(results.size(), 2, ());
+  TEST_EQUAL(results[0].m_featureId, 5, ());
+  TEST_EQUAL(results[0].m_rank, 3, ());
+  TEST_EQUAL(results[1].m_featureId, 7, ());
+  TEST_EQUAL(results[1].m_rank, 1, ());
+}
+
+UNIT_TEST(PrefixMatchInTrie_Mapped)
+{
+  vector<TrieEntry> entries = {
+      TrieEntry("moscow", 1), TrieEntry("mos", 2),  TrieEntry("most", 3),  TrieEntry("minsk", 4),
+      TrieEntry("moscow", 5), TrieEntry("paris", 6), TrieEntry("par", 7), TrieEntry("m", 8)};
+  sort(entries.begin(), entries.end());
+
+  vector<uint8_t> const serial = BuildTrie(entries.begin(), entries.end());
+
+  trie::ValueReader const valueReader(GetTestCodingParams());
+  trie::TEdgeValueReader const edgeValueReader;
+  trie::DefaultIteratorNode const root(
+      trie::ReadTrie(MemReader(serial.data(), serial.size()), valueReader, edgeValueReader));
+  trie::MappedDefaultIterator const mappedRoot(serial.data(), serial.data() + serial.size(),
+                                               false /* isLeaf */, trie::DEFAULT_CHAR,
+                                               valueReader, edgeValueReader);
+
+  for (char const * prefix : {"", "m", "mo", "mos", "mosc", "moscow", "moscowa", "p", "x"})
+  {
+    strings::UniString const s = strings::MakeUniString(prefix);
+
+    FeatureIdsCollector expected;
+    search::impl::PrefixMatchInTrie(root, nullptr, 0, s, expected);
+    FeatureIdsCollector actual;
+    search::impl::PrefixMatchInTrie(mappedRoot, nullptr, 0, s, actual);
+
+    sort(expected.m_ids.begin(), expected.m_ids.end());
+    sort(actual.m_ids.begin(), actual.m_ids.end());
+    TEST_EQUAL(expected.m_ids, actual.m_ids, (prefix));
+  }
+
+  FeatureIdsCollector moscow;
+  search::impl::PrefixMatchInTrie(mappedRoot, nullptr, 0, strings::MakeUniString("mosc"), moscow);
+  sort(moscow.m_ids.begin(), moscow.m_ids.end());
+  TEST_EQUAL(moscow.m_ids, vector<uint32_t>({1, 5}), ());
+}
+
+UNIT_TEST(MatchFeaturesInTrie_Cached)
+{
+  vector<TrieEntry> entries = {
+      TrieEntry(0, "moscow", 1),  TrieEntry(0, "mos", 2),     TrieEntry(0, "most", 3),
+      TrieEntry(0, "minsk", 5),   TrieEntry(0, "museum", 7),  TrieEntry(0, "street", 1),
+      TrieEntry(0, "street", 7),  TrieEntry(0, "street", 9),  TrieEntry(1, "mosfilm", 9),
+      TrieEntry(1, "moscow", 11), TrieEntry(1, "mosque", 13), TrieEntry(2, "moscow", 15),
+      TrieEntry(search::kCategoriesLang, "museum", 17)};
+  sort(entries.begin(), entries.end());
+  vector<uint8_t> const serial = BuildTrie(entries.begin(), entries.end());
+
+  trie::ValueReader const valueReader(GetTestCodingParams());
+  trie::TEdgeValueReader const edgeValueReader;
+  trie::DefaultIteratorNode const root(
+      trie::ReadTrie(MemReader(serial.data(), serial.size()), valueReader, edgeValueReader));
+  trie::MappedDefaultIterator const mappedRoot(serial.data(), serial.data() + serial.size(),
+                                               false /* isLeaf */, trie::DEFAULT_CHAR,
+                                               valueReader, edgeValueReader);
+
+  OddFeaturesFilter const filter;
+  search::MatchFeaturesCache cache;
+  search::SearchQueryParams params;
+  params.m_langs.insert(0);
+  params.m_langs.insert(1);
+
+  // Checks that the cached matching gives the same features as the usual one.
+  auto const match = [&](vector<string> const & tokens, string const & prefix)
+  {
+    params.m_tokens.clear();
+    for (auto const & token : tokens)
+      params.m_tokens.push_back({strings::MakeUniString(token)});
+    params.m_prefixTokens.clear();
+    if (!prefix.empty())
+      params.m_prefixTokens.push_back(strings::MakeUniString(prefix));
+
+    FeatureIdsCollector expected;
+    search::MatchFeaturesInTrie(params, root, filter, expected);
+    FeatureIdsCollector mapped;
+    search::MatchFeaturesInTrie(params, mappedRoot, filter, mapped);
+    TEST_EQUAL(expected.m_ids, mapped.m_ids, (tokens, prefix));
+    FeatureIdsCollector actual;
+    bool const isHit = search::MatchFeaturesInTrie(params, mappedRoot, filter, cache, actual);
+    TEST_EQUAL(expected.m_ids, actual.m_ids, (tokens, prefix));
+    return isHit;
+  };
+
+  TEST(!match({}, "m"), ());
+  // Strings of lang 1 have the common prefix "mos", which is not matched by shorter prefixes.
+  TEST(!match({}, "mo"), ());
+  TEST(!match({}, "mos"), ());
+  TEST(match({}, "mosc"), ());
+  TEST(match({}, "moscow"), ());
+  TEST(!match({}, "mus"), ());
+  // The prefix is also matched with categories as a complete token.
+  TEST(match({}, "museum"), ());
+
+  TEST(!match({"street"}, "m"), ());
+  TEST(!match({"street"}, "mos"), ());
+  TEST(match({"street"}, "mosf"), ());
+  TEST(match({"street"}, ""), ());
+  TEST(!match({"street"}, "z"), ());
+  TEST(match({"street"}, "zz"), ());
+
+  params.m_langs.insert(2);
+  TEST(!match({"street"}, "zz"), ());
+
+  cache.Clear();
+  TEST(!match({}, "mosc"), ());
+}
+
+UNIT_TEST(MatchFeaturesCache_TokensValuesAreLimited)
+{
+  search::SearchQueryParams params;
+  params.m_tokens.push_back({strings::MakeUniString("street")});
+
+  search::MatchFeaturesCache cache;
+  vector<TValue> values(search::MatchFeaturesCache::kMaxTokensValues);
+  cache.SetTokens(params, true /* hasTokensStep */, values);
+  TEST(cache.HasTokens(params), ());
+
+  values.push_back(MakeValue(0));
+  cache.SetTokens(params, true /* hasTokensStep */, values);
+  TEST(!cache.HasTokens(params), ());
+  TEST(cache.GetTokensValues().empty(), ());
+}
+
+UNIT_TEST(MwmMatchFeaturesCaches_Smoke)
+{
+  search::SearchQueryParams params;
+  params.m_tokens.push_back({strings::MakeUniString("street")});
+
+  size_t const kMaxMwms = search::MwmMatchFeaturesCaches::kMaxMwms;
+  vector<MwmSet::MwmId> ids;
+  for (size_t i = 0; i <= kMaxMwms; ++i)
+    ids.emplace_back(make_shared<MwmInfo>());
+
+  search::MwmMatchFeaturesCaches caches;
+  for (size_t i = 0; i < kMaxMwms; ++i)
+    caches.Get(ids[i]).SetTokens(params, false /* hasTokensStep */, {});
+  TEST_EQUAL(caches.GetSize(), kMaxMwms, ());
+
+  // The first mwm is used again, so the second one is the least recently used.
+  TEST(caches.Get(ids[0]).HasTokens(params), ());
+  caches.Get(ids[kMaxMwms]);
+  TEST_EQUAL(caches.GetSize(), kMaxMwms, ());
+  TEST(caches.Get(ids[0]).HasTokens(params), ());
+  TEST(!caches.Get(ids[1]).HasTokens(params), ());
+
+  // Mwms which aren't registered in MwmSet are not alive.
+  caches.RemoveDeregistered();
+  TEST_EQUAL(caches.GetSize(), 0, ());
+}
@@ -0,0 +1,210 @@
+#include "testing/testing.hpp"
+
+#include "search/feature_offset_match.hpp"
+
+#include "indexer/search_trie.hpp"
+#include "indexer/string_file.hpp"
+#include "indexer/string_file_values.hpp"
+
+#include "coding/byte_stream.hpp"
+#include "coding/file_container.hpp"
+#include "coding/file_writer.hpp"
+#include "coding/reader.hpp"
+#include "coding/succinct_trie_builder.hpp"
+#include "coding/trie_builder.hpp"
+#include "coding/writer.hpp"
+
+#include "base/logging.hpp"
+#include "base/scope_guard.hpp"
+#include "base/string_utils.hpp"
+#include "base/timer.hpp"
+
+#include "std/algorithm.hpp"
+#include "std/bind.hpp"
+#include "std/random.hpp"
+#include "std/shared_ptr.hpp"
+#include "std/string.hpp"
+#include "std/tuple.hpp"
+#include "std/vector.hpp"
+
+namespace
+{
+using TValue = SerializedFeatureInfoValue;
+using TString = StringsFile<TValue>::TString;
+using TTrieValue = trie::ValueReader::ValueType;
+using TResult = tuple<uint32_t, uint8_t, double, double>;
+
+serial::CodingParams const & GetTestCodingParams()
+{
+  static serial::CodingParams const cp(search::kPointCodingBits, m2::PointD(0, 0));
+  return cp;
+}
+
+vector<TString> MakeEntries(size_t count, vector<string> & words)
+{
+  mt19937 rng(0);
+  uniform_int_distribution<int> letter('a', 'h');
+  uniform_int_distribution<size_t> length(3, 10);
+  uniform_int_distribution<uint32_t> featureId(0, 200000);
+  uniform_real_distribution<double> coord(-100, 100);
+  uniform_int_distribution<int> rank(0, 255);
+
+  trie::ValueReader const saver(GetTestCodingParams());
+  vector<TString> entries;
+  for (size_t i = 0; i < count; ++i)
+  {
+    string word(length(rng), 'a');
+    for (auto & c : word)
+      c = static_cast<char>(letter(rng));
+    words.push_back(word);
+
+    TTrieValue v;
+    v.m_pt = m2::PointD(coord(rng), coord(rng));
+    v.m_featureId = featureId(rng);
+    v.m_rank = static_cast<uint8_t>(rank(rng));
+
+    TValue value;
+    PushBackByteSink<TValue::ValueT> sink(value.m_value);
+    saver.Save(sink, v);
+    entries.emplace_back(strings::MakeUniString(word), static_cast<signed char>(i % 2), value);
+  }
+  sort(entries.begin(), entries.end());
+  return entries;
+}
+
+struct ResultsCollector
+{
+  vector<TResult> m_results;
+
+  void operator()(TTrieValue const & v)
+  {
+    m_results.emplace_back(v.m_featureId, v.m_rank, v.m_pt.x, v.m_pt.y);
+  }
+};
+
+template <typename TIter>
+vector<TResult> PrefixMatch(TIter const & root, strings::UniString const & s)
+{
+  ResultsCollector collector;
+  search::impl::PrefixMatchInTrie(root, nullptr, 0, s, collector);
+  sort(collector.m_results.begin(), collector.m_results.end());
+  return collector.m_results;
+}
+
+// Measures root construction too, as every search query reads the trie root anew.
+template <typename TMakeRoot>
+double BenchmarkPrefixMatch(TMakeRoot const & makeRoot,
+                            vector<strings::UniString> const & prefixes)
+{
+  my::Timer timer;
+  size_t count = 0;
+  for (auto const & prefix : prefixes)
+  {
+    auto const root = makeRoot();
+    count += PrefixMatch(root, prefix).size();
+  }
+  TEST_GREATER(count, 0, ());
+  return timer.ElapsedSeconds();
+}
+}  // namespace
+
+// Builds both formats of the search index on the same strings, checks that prefix matching
+// gives the same values and logs sizes of the indices and times of prefix matching.
+// The succinct index is timed both when it's parsed for every query and when it's parsed
+// once, as search does with MwmValue::m_succinctSearchData. The other index is also timed
+// when it's mapped, as search does with MwmValue::m_mappedSearchData.
+UNIT_TEST(SearchIndexFormats_Benchmark)
+{
+  vector<string> words;
+  vector<TString> const entries = MakeEntries(20000, words);
+
+  vector<uint8_t> trieBuffer;
+  {
+    PushBackByteSink<vector<uint8_t>> sink(trieBuffer);
+    trie::Build<PushBackByteSink<vector<uint8_t>>, vector<TString>::const_iterator,
+                trie::EmptyEdgeBuilder, ValueList<TValue>>(sink, entries.begin(), entries.end(),
+                                                          trie::EmptyEdgeBuilder());
+    reverse(trieBuffer.begin(), trieBuffer.end());
+  }
+
+  vector<uint8_t> succinctBuffer;
+  {
+    MemWriter<vector<uint8_t>> writer(succinctBuffer);
+    trie::BuildSuccinctTrie<MemWriter<vector<uint8_t>>, vector<TString>::const_iterator,
+                            trie::EmptyEdgeBuilder, EliasFanoValueList>(
+        writer, entries.begin(), entries.end(), trie::EmptyEdgeBuilder());
+  }
+
+  trie::ValueReader const valueReader(GetTestCodingParams());
+  MemReader const trieReader(trieBuffer.data(), trieBuffer.size());
+  MemReader const succinctReader(succinctBuffer.data(), succinctBuffer.size());
+  trie::DefaultIteratorNode const trieRoot(
+      trie::ReadSearchIndexTrie(SEARCH_INDEX_FILE_TAG, trieReader, valueReader));
+  trie::DefaultIteratorNode const succinctRoot(
+      trie::ReadSearchIndexTrie(SUCCINCT_SEARCH_INDEX_FILE_TAG, succinctReader, valueReader));
+
+  vector<strings::UniString> prefixes;
+  for (size_t i = 0; i < words.size(); i += 97)
+  {
+    for (size_t len = 2; len <= 4; ++len)
+    {
+      strings::UniString prefix(1, static_cast<strings::UniChar>(i % 2));
+      strings::UniString const word = strings::MakeUniString(words[i].substr(0, len));
+      prefix.append(word.begin(), word.end());
+      prefixes.push_back(prefix);
+    }
+  }
+
+  string const fName = "search_index_formats_test.tmp";
+  {
+    FilesContainerW cont(fName);
+    FileWriter writer = cont.GetWriter(SEARCH_INDEX_FILE_TAG);
+    writer.Write(trieBuffer.data(), trieBuffer.size());
+  }
+  MY_SCOPE_GUARD(deleteFile, bind(&FileWriter::DeleteFileX, fName));
+  // The section stays mapped when the container is closed.
+  shared_ptr<trie::MappedSearchData> mappedData;
+  {
+    FilesMappingContainer const cont(fName);
+    mappedData = make_shared<trie::MappedSearchData>(cont, GetTestCodingParams());
+  }
+  trie::MappedDefaultIterator const mappedRoot = mappedData->m_trie.GetRoot();
+
+  for (auto const & prefix : prefixes)
+  {
+    TEST(PrefixMatch(trieRoot, prefix) == PrefixMatch(succinctRoot, prefix), (prefix));
+    TEST(PrefixMatch(trieRoot, prefix) == PrefixMatch(mappedRoot, prefix), (prefix));
+  }
+  TEST_EQUAL(PrefixMatch(succinctRoot, strings::UniString()).size(), entries.size(), ());
+  TEST_EQUAL(PrefixMatch(mappedRoot, strings::UniString()).size(), entries.size(), ());
+
+  double const trieTime = BenchmarkPrefixMatch([&]()
+  {
+    return trie::DefaultIteratorNode(
+        trie::ReadSearchIndexTrie(SEARCH_INDEX_FILE_TAG, trieReader, valueReader));
+  }, prefixes);
+  double const succinctTime = BenchmarkPrefixMatch([&]()
+  {
+    return trie::DefaultIteratorNode(
+        trie::ReadSearchIndexTrie(SUCCINCT_SEARCH_INDEX_FILE_TAG, succinctReader, valueReader));
+  }, prefixes);
+
+  auto const succinctData =
+      make_shared<trie::SuccinctSearchData<MemReader>>(succinctReader, GetTestCodingParams());
+  double const succinctCachedTime = BenchmarkPrefixMatch([&]()
+  {
+    return trie::DefaultIteratorNode(
+        new trie::SuccinctSearchIterator<MemReader>(succinctData, 1 /* nodeBitPosition */));
+  }, prefixes);
+
+  double const mappedTime = BenchmarkPrefixMatch([&]()
+  {
+    return mappedData->m_trie.GetRoot();
+  }, prefixes);
+
+  LOG(LINFO, ("Entries:", entries.size(), "prefixes:", prefixes.size()));
+  LOG(LINFO, ("Trie size:", trieBuffer.size(), "prefix match seconds:", trieTime,
+              "when it's mapped:", mappedTime));
+  LOG(LINFO, ("Succinct trie size:", succinctBuffer.size(), "prefix match seconds:",
+              succinctTime, "with the index parsed once:", succinctCachedTime));
+}
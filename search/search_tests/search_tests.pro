@@ -6,7 +6,7 @@ CONFIG -= app_bundle
 TEMPLATE = app
 
 ROOT_DIR = ../..
-DEPENDENCIES = search indexer platform geometry coding base protobuf tomcrypt
+DEPENDENCIES = search indexer platform geometry coding base protobuf tomcrypt succinct
 
 include($$ROOT_DIR/common.pri)
 
@@ -17,12 +17,14 @@ macx-*: LIBS *= "-framework IOKit"
 SOURCES += \
     ../../testing/testingmain.cpp \
     algos_tests.cpp \
+    feature_offset_match_tests.cpp \
     house_detector_tests.cpp \
     keyword_lang_matcher_test.cpp \
     keyword_matcher_test.cpp \
     latlon_match_test.cpp \
     locality_finder_test.cpp \
     query_saver_tests.cpp \
+    search_index_formats_test.cpp \
     string_intersection_test.cpp \
     string_match_test.cpp \
 
@@ -8,6 +8,9 @@
 using std::exception;
 using std::logic_error;
 using std::runtime_error;
+using std::exception_ptr;
+using std::current_exception;
+using std::rethrow_exception;
 
 #ifdef DEBUG_NEW
 #define new DEBUG_NEW
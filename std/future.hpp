@@ -0,0 +1,14 @@
+#pragma once
+
+#ifdef new
+#undef new
+#endif
+
+#include <future>
+
+using std::future;
+using std::promise;
+
+#ifdef DEBUG_NEW
+#define new DEBUG_NEW
+#endif
@@ -8,6 +8,7 @@
 
 using std::lock_guard;
 using std::mutex;
+using std::try_to_lock;
 using std::unique_lock;
 
 #ifdef DEBUG_NEW